@@ -0,0 +1,35 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+namespace alpaca::bench {
+
+/// Keeps the optimiser from discarding a computed value.
+template <typename T> inline void do_not_optimize(T const& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static_cast<void>(*static_cast<T const volatile*>(&value));
+#endif
+}
+
+/// Runs `body` `iterations` times after a short warm-up and prints the mean cost per operation.
+template <typename Body>
+double run(std::string const& name, std::size_t iterations, std::size_t operations_per_iteration, Body&& body) {
+    for (std::size_t i = 0; i < iterations / 10 + 1; ++i) {
+        body();
+    }
+    auto const started = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+        body();
+    }
+    auto const elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started);
+    double const ns_per_op = elapsed.count() / static_cast<double>(iterations * operations_per_iteration);
+    std::printf("%-48s %12.3f ns/op\n", name.c_str(), ns_per_op);
+    return ns_per_op;
+}
+
+} // namespace alpaca::bench
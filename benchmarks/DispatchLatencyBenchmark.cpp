@@ -0,0 +1,100 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "alpaca/Chrono.hpp"
+#include "alpaca/Json.hpp"
+#include "alpaca/Streaming.hpp"
+
+namespace alpaca::streaming {
+
+/// Replays payloads through the same inbound queue the socket thread feeds.
+class WebSocketClientHarness {
+  public:
+    static void enqueue(WebSocketClient& client, Json const& payload) {
+        client.enqueue_incoming_message(payload, fast_utc_now());
+    }
+};
+
+} // namespace alpaca::streaming
+
+namespace {
+
+using alpaca::streaming::DispatcherOptions;
+using alpaca::streaming::DispatchWaitStrategy;
+using alpaca::streaming::WebSocketClient;
+using alpaca::streaming::WebSocketClientHarness;
+
+constexpr std::size_t kMessages = 20'000;
+// Sparse enough that a blocking dispatcher is asleep when each payload arrives, which is where wake-up latency shows.
+constexpr std::chrono::microseconds kInterval{50};
+
+std::vector<alpaca::Json> make_payloads() {
+    std::vector<alpaca::Json> payloads;
+    payloads.reserve(kMessages);
+    for (std::size_t i = 0; i < kMessages; ++i) {
+        payloads.push_back(alpaca::Json{
+            {"T", "t"                                     },
+            {"S", i % 2 == 0 ? "AAPL" : "MSFT"            },
+            {"i", std::to_string(i)                       },
+            {"p", 190.0 + static_cast<double>(i % 100) / 100},
+            {"s", 100                                     }
+        });
+    }
+    return payloads;
+}
+
+void replay(std::string const& name, DispatcherOptions const& options, std::vector<alpaca::Json> const& payloads) {
+    WebSocketClient client{"wss://example.com", "key", "secret"};
+    client.set_incoming_message_limit(0);
+    client.set_dispatcher_options(options);
+    client.set_message_handler([](alpaca::streaming::StreamMessage const&, alpaca::streaming::MessageCategory) {
+    });
+    client.reset_stats();
+
+    auto next = std::chrono::steady_clock::now();
+    for (auto const& payload : payloads) {
+        next += kInterval;
+        while (std::chrono::steady_clock::now() < next) {
+        }
+        WebSocketClientHarness::enqueue(client, payload);
+    }
+    while (client.stats().receive_to_dispatch.count < payloads.size()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+
+    auto const stats = client.reset_stats();
+    auto const& latency = stats.receive_to_dispatch;
+    double const busy_share = static_cast<double>(stats.dispatcher_work_ns) /
+                              static_cast<double>(stats.dispatcher_work_ns + stats.dispatcher_spin_ns + 1);
+    std::printf("%-32s p50 %8lld ns  p99 %8lld ns  max %9llu ns  work/(work+spin) %5.1f%%\n", name.c_str(),
+                static_cast<long long>(latency.percentile(0.5).count()),
+                static_cast<long long>(latency.percentile(0.99).count()),
+                static_cast<unsigned long long>(latency.max_ns), busy_share * 100.0);
+}
+
+} // namespace
+
+/// Usage: alpaca-cpp-DispatchLatencyBenchmark [cpu]
+/// The optional CPU pins the busy-poll dispatcher; pick an isolated core for representative numbers.
+int main(int argc, char** argv) {
+    if (std::thread::hardware_concurrency() < 2) {
+        std::printf("warning: a single CPU is available, so the busy-poll dispatcher competes with the producer\n");
+    }
+    auto const payloads = make_payloads();
+
+    DispatcherOptions blocking;
+    replay("receive-to-dispatch/block", blocking, payloads);
+
+    DispatcherOptions busy_poll;
+    busy_poll.wait_strategy = DispatchWaitStrategy::BusyPoll;
+    if (argc > 1) {
+        busy_poll.cpu_affinity = static_cast<unsigned>(std::strtoul(argv[1], nullptr, 10));
+    }
+    replay("receive-to-dispatch/busy-poll", busy_poll, payloads);
+    return 0;
+}
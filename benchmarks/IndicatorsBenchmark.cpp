@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "BenchmarkSupport.hpp"
+#include "alpaca/Indicators.hpp"
+
+namespace {
+
+constexpr std::size_t kBars = 100'000;
+constexpr std::size_t kPeriod = 20;
+constexpr std::size_t kIterations = 50;
+
+std::vector<alpaca::StockBar> make_bars() {
+    std::vector<alpaca::StockBar> bars;
+    bars.reserve(kBars);
+    for (std::size_t i = 0; i < kBars; ++i) {
+        double const base = 150.0 + 10.0 * std::sin(static_cast<double>(i) * 0.01);
+        alpaca::StockBar bar;
+        bar.timestamp = alpaca::Timestamp{std::chrono::minutes{static_cast<std::int64_t>(i)}};
+        bar.open = alpaca::Money{base - 0.1};
+        bar.high = alpaca::Money{base + 0.4};
+        bar.low = alpaca::Money{base - 0.5};
+        bar.close = alpaca::Money{base};
+        bar.volume = 1000 + i % 97;
+        bars.push_back(bar);
+    }
+    return bars;
+}
+
+// Naive references: what callers wrote before BarSeries existed, recomputing each window over AoS bars.
+std::vector<double> naive_sma(std::vector<alpaca::StockBar> const& bars, std::size_t period) {
+    std::vector<double> out(bars.size(), alpaca::indicators::kWarmup);
+    for (std::size_t i = period - 1; i < bars.size(); ++i) {
+        double sum = 0.0;
+        for (std::size_t j = i + 1 - period; j <= i; ++j) {
+            sum += bars[j].close.to_double();
+        }
+        out[i] = sum / static_cast<double>(period);
+    }
+    return out;
+}
+
+std::vector<double> naive_stddev(std::vector<alpaca::StockBar> const& bars, std::size_t period) {
+    std::vector<double> out(bars.size(), alpaca::indicators::kWarmup);
+    for (std::size_t i = period - 1; i < bars.size(); ++i) {
+        double sum = 0.0;
+        for (std::size_t j = i + 1 - period; j <= i; ++j) {
+            sum += bars[j].close.to_double();
+        }
+        double const mean = sum / static_cast<double>(period);
+        double squares = 0.0;
+        for (std::size_t j = i + 1 - period; j <= i; ++j) {
+            double const delta = bars[j].close.to_double() - mean;
+            squares += delta * delta;
+        }
+        out[i] = std::sqrt(squares / static_cast<double>(period));
+    }
+    return out;
+}
+
+std::vector<double> naive_vwap(std::vector<alpaca::StockBar> const& bars) {
+    std::vector<double> out(bars.size(), alpaca::indicators::kWarmup);
+    double price_volume = 0.0;
+    double volume = 0.0;
+    for (std::size_t i = 0; i < bars.size(); ++i) {
+        double const typical = (bars[i].high.to_double() + bars[i].low.to_double() + bars[i].close.to_double()) / 3.0;
+        price_volume += typical * static_cast<double>(bars[i].volume);
+        volume += static_cast<double>(bars[i].volume);
+        out[i] = price_volume / volume;
+    }
+    return out;
+}
+
+std::vector<double> naive_atr(std::vector<alpaca::StockBar> const& bars, std::size_t period) {
+    std::vector<double> out(bars.size(), alpaca::indicators::kWarmup);
+    double value = 0.0;
+    for (std::size_t i = 0; i < bars.size(); ++i) {
+        double const high = bars[i].high.to_double();
+        double const low = bars[i].low.to_double();
+        double range = high - low;
+        if (i > 0) {
+            double const previous = bars[i - 1].close.to_double();
+            range = std::max({range, std::abs(high - previous), std::abs(low - previous)});
+        }
+        if (i < period) {
+            value += range;
+            if (i + 1 == period) {
+                value /= static_cast<double>(period);
+                out[i] = value;
+            }
+        } else {
+            value = (value * static_cast<double>(period - 1) + range) / static_cast<double>(period);
+            out[i] = value;
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+int main() {
+    namespace ind = alpaca::indicators;
+    auto const bars = make_bars();
+    auto const series = alpaca::BarSeries::from_bars(bars);
+
+    alpaca::bench::run("sma/naive-aos", kIterations, kBars, [&] {
+        alpaca::bench::do_not_optimize(naive_sma(bars, kPeriod));
+    });
+    alpaca::bench::run("sma/batch-micro-units", kIterations, kBars, [&] {
+        alpaca::bench::do_not_optimize(ind::sma(series.closes(), kPeriod));
+    });
+
+    alpaca::bench::run("stddev/naive-aos", kIterations, kBars, [&] {
+        alpaca::bench::do_not_optimize(naive_stddev(bars, kPeriod));
+    });
+    alpaca::bench::run("stddev/batch", kIterations, kBars, [&] {
+        alpaca::bench::do_not_optimize(ind::rolling_stddev(series.closes(), kPeriod));
+    });
+
+    alpaca::bench::run("vwap/naive-aos", kIterations, kBars, [&] {
+        alpaca::bench::do_not_optimize(naive_vwap(bars));
+    });
+    alpaca::bench::run("vwap/batch", kIterations, kBars, [&] {
+        alpaca::bench::do_not_optimize(ind::vwap(series));
+    });
+
+    alpaca::bench::run("atr/naive-aos", kIterations, kBars, [&] {
+        alpaca::bench::do_not_optimize(naive_atr(bars, kPeriod));
+    });
+    alpaca::bench::run("atr/batch", kIterations, kBars, [&] {
+        alpaca::bench::do_not_optimize(ind::atr(series, kPeriod));
+    });
+
+    alpaca::bench::run("ema/batch", kIterations, kBars, [&] {
+        alpaca::bench::do_not_optimize(ind::ema(series.closes(), kPeriod));
+    });
+    alpaca::bench::run("rsi/batch", kIterations, kBars, [&] {
+        alpaca::bench::do_not_optimize(ind::rsi(series.closes(), kPeriod));
+    });
+    alpaca::bench::run("sma/incremental", kIterations, kBars, [&] {
+        ind::SimpleMovingAverage average(kPeriod);
+        double last = 0.0;
+        for (auto const& bar : bars) {
+            last = average.update(bar.close).value_or(last);
+        }
+        alpaca::bench::do_not_optimize(last);
+    });
+    return 0;
+}
@@ -0,0 +1,63 @@
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BenchmarkSupport.hpp"
+#include "alpaca/Configuration.hpp"
+#include "alpaca/HttpClient.hpp"
+#include "alpaca/TradingClient.hpp"
+
+namespace {
+
+constexpr std::size_t kOrders = 300;
+constexpr std::size_t kIterations = 3;
+constexpr std::chrono::microseconds kRoundTrip{2000};
+
+/// Stands in for the network: every request takes one simulated round-trip and is accepted.
+class SimulatedRoundTripClient : public alpaca::HttpClient {
+  public:
+    alpaca::HttpResponse send(alpaca::HttpRequest const&) override {
+        std::this_thread::sleep_for(kRoundTrip);
+        return alpaca::HttpResponse{200,
+                                    R"({"id":"61e69015-8549-4bfd-b9c3-01e75843f47d","client_order_id":"c",)"
+                                    R"("created_at":"2024-03-16T18:38:01.942282Z","symbol":"AAPL","side":"buy",)"
+                                    R"("type":"limit","time_in_force":"day","status":"accepted"})",
+                                    {}};
+    }
+};
+
+} // namespace
+
+int main() {
+    alpaca::TradingClient client(alpaca::Configuration::Paper("key", "secret"),
+                                 std::make_shared<SimulatedRoundTripClient>());
+    std::vector<alpaca::NewOrderRequest> basket(kOrders);
+    for (std::size_t i = 0; i < kOrders; ++i) {
+        basket[i].symbol = "AAPL";
+        basket[i].type = alpaca::OrderType::LIMIT;
+        basket[i].quantity = "1";
+        basket[i].limit_price = "187.42";
+        basket[i].client_order_id = "basket-" + std::to_string(i);
+    }
+
+    alpaca::bench::run("order-basket/300-at-2ms/serial", kIterations, kOrders, [&client, &basket]() {
+        for (auto const& request : basket) {
+            auto order = client.submit_order(request);
+            alpaca::bench::do_not_optimize(order);
+        }
+    });
+
+    for (std::size_t window : {8U, 32U}) {
+        alpaca::SubmitOrdersOptions options;
+        options.max_in_flight = window;
+        alpaca::bench::run("order-basket/300-at-2ms/window-" + std::to_string(window), kIterations, kOrders,
+                           [&client, &basket, &options]() {
+                               auto response = client.submit_orders(basket, options);
+                               alpaca::bench::do_not_optimize(response);
+                           });
+    }
+    return 0;
+}
@@ -0,0 +1,63 @@
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "BenchmarkSupport.hpp"
+#include "alpaca/Json.hpp"
+#include "alpaca/models/Order.hpp"
+
+namespace {
+
+constexpr std::size_t kOrders = 500;
+constexpr std::size_t kIterations = 50;
+
+// A list_orders(status=open) page: every field the API sends for a resting limit order, most of them null.
+std::string make_open_orders_body() {
+    std::string body = "[";
+    for (std::size_t i = 0; i < kOrders; ++i) {
+        if (i > 0) {
+            body += ',';
+        }
+        auto const n = std::to_string(i);
+        body += R"({"id":"61e69015-8549-4bfd-b9c3-)" + std::string(12 - n.size(), '0') + n +
+                R"(","client_order_id":"strat-7-)" + n +
+                R"(","created_at":"2024-03-16T18:38:01.942282Z","updated_at":"2024-03-16T18:38:01.942282Z",)"
+                R"("submitted_at":"2024-03-16T18:38:01.937734Z","filled_at":null,"expired_at":null,)"
+                R"("canceled_at":null,"failed_at":null,"replaced_at":null,"replaced_by":null,"replaces":null,)"
+                R"("asset_id":"b0b6dd9d-8b9b-48a9-ba46-b9d54906e415","symbol":"SYM)" +
+                n +
+                R"(","asset_class":"us_equity","notional":null,"qty":"100","filled_qty":"0","filled_avg_price":null,)"
+                R"("order_class":"simple","order_type":"limit","type":"limit","side":"buy","time_in_force":"day",)"
+                R"("limit_price":"187.42","stop_price":null,"status":"new","extended_hours":false,"legs":null,)"
+                R"("trail_percent":null,"trail_price":null,"hwm":null,"subtag":null,"source":null})";
+    }
+    body += "]";
+    return body;
+}
+
+} // namespace
+
+int main() {
+    auto const body = make_open_orders_body();
+
+    // The null string fields the API sends would make the DOM path throw, so it gets a copy with them removed.
+    auto dom_body = body;
+    for (auto const* field : {R"("replaced_by":null,)", R"("replaces":null,)"}) {
+        std::string const needle(field);
+        for (auto pos = dom_body.find(needle); pos != std::string::npos; pos = dom_body.find(needle, pos)) {
+            dom_body.erase(pos, needle.size());
+        }
+    }
+
+    alpaca::bench::run("order-decode/list-500/json-dom", kIterations, kOrders, [&dom_body]() {
+        auto orders = alpaca::Json::parse(dom_body).get<std::vector<alpaca::Order>>();
+        alpaca::bench::do_not_optimize(orders);
+    });
+
+    alpaca::bench::run("order-decode/list-500/direct", kIterations, kOrders, [&body]() {
+        std::vector<alpaca::Order> orders;
+        alpaca::decode_json(body, orders);
+        alpaca::bench::do_not_optimize(orders);
+    });
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include <cstddef>
+#include <string>
+
+#include "BenchmarkSupport.hpp"
+#include "alpaca/Json.hpp"
+#include "alpaca/OrderPayloadWriter.hpp"
+#include "alpaca/OrderTemplate.hpp"
+
+namespace {
+
+constexpr std::size_t kIterations = 200'000;
+
+alpaca::NewOrderRequest make_limit_order() {
+    alpaca::NewOrderRequest request;
+    request.symbol = "AAPL";
+    request.side = alpaca::OrderSide::BUY;
+    request.type = alpaca::OrderType::LIMIT;
+    request.time_in_force = alpaca::TimeInForce::DAY;
+    request.quantity = "100";
+    request.limit_price = "187.42";
+    request.client_order_id = "strat-7-000000123456";
+    return request;
+}
+
+alpaca::NewOrderRequest make_bracket_order() {
+    auto request = make_limit_order();
+    request.order_class = alpaca::OrderClass::BRACKET;
+    request.take_profit = alpaca::TakeProfitParams{.limit_price = "190.00"};
+    request.stop_loss = alpaca::StopLossParams{.stop_price = "185.00", .limit_price = "184.90"};
+    return request;
+}
+
+alpaca::ReplaceOrderRequest make_replace() {
+    alpaca::ReplaceOrderRequest request;
+    request.quantity = "100";
+    request.limit_price = "187.43";
+    request.client_order_id = "strat-7-000000123457";
+    return request;
+}
+
+// The body submit_order used to hand to RestClient: build the Json DOM, then dump it into a fresh string.
+template <typename Request> void bench_dom(char const* name, Request const& request) {
+    alpaca::bench::run(name, kIterations, 1, [&request]() {
+        std::string body = alpaca::to_json_payload(request).dump();
+        alpaca::bench::do_not_optimize(body);
+    });
+}
+
+template <typename Request> void bench_direct(char const* name, Request const& request) {
+    alpaca::bench::run(name, kIterations, 1, [&request]() {
+        auto const body = alpaca::format_order_payload(request);
+        alpaca::bench::do_not_optimize(body);
+    });
+}
+
+// A strategy reusing one request still copies the varying fields into it for every order.
+void bench_request_reuse(char const* name, alpaca::NewOrderRequest request) {
+    alpaca::bench::run(name, kIterations, 1, [&request]() {
+        request.quantity = "100";
+        request.limit_price = "187.42";
+        request.client_order_id = "strat-7-000000123456";
+        auto const body = alpaca::format_order_payload(request);
+        alpaca::bench::do_not_optimize(body);
+    });
+}
+
+void bench_template(char const* name, alpaca::NewOrderRequest const& request) {
+    alpaca::OrderTemplate const order_template(request);
+    alpaca::bench::run(name, kIterations, 1, [&order_template]() {
+        auto const body = order_template.format({"100", "187.42", "strat-7-000000123456"});
+        alpaca::bench::do_not_optimize(body);
+    });
+}
+
+} // namespace
+
+int main() {
+    auto const limit = make_limit_order();
+    auto const bracket = make_bracket_order();
+    auto const replace = make_replace();
+
+    bench_dom("order-payload/new-limit/json-dom", limit);
+    bench_direct("order-payload/new-limit/direct", limit);
+    bench_dom("order-payload/new-bracket/json-dom", bracket);
+    bench_direct("order-payload/new-bracket/direct", bracket);
+    bench_request_reuse("order-payload/new-limit/request-reuse", limit);
+    bench_template("order-payload/new-limit/template", limit);
+    bench_request_reuse("order-payload/new-bracket/request-reuse", bracket);
+    bench_template("order-payload/new-bracket/template", bracket);
+    bench_dom("order-payload/replace/json-dom", replace);
+    bench_direct("order-payload/replace/direct", replace);
+    return 0;
+}
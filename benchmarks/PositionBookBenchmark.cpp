@@ -0,0 +1,87 @@
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "BenchmarkSupport.hpp"
+#include "alpaca/Configuration.hpp"
+#include "alpaca/Json.hpp"
+#include "alpaca/PositionBook.hpp"
+#include "alpaca/TradingClient.hpp"
+#include "alpaca/models/Position.hpp"
+
+namespace {
+
+constexpr std::size_t kSymbols = 200;
+constexpr std::size_t kIterations = 2000;
+
+std::string symbol_name(std::size_t i) {
+    return "SYM" + std::to_string(i);
+}
+
+// The body of a list_positions response; decoding it is the floor of polling before any network time.
+std::string make_positions_body() {
+    std::string body = "[";
+    for (std::size_t i = 0; i < kSymbols; ++i) {
+        if (i > 0) {
+            body += ',';
+        }
+        body += R"({"asset_id":"b0b6dd9d-8b9b-48a9-ba46-b9d54906e415","symbol":")" + symbol_name(i) +
+                R"(","exchange":"NASDAQ","asset_class":"us_equity","asset_marginable":true,"qty":"100",)"
+                R"("qty_available":"100","avg_entry_price":"187.42","side":"long","market_value":"18800",)"
+                R"("cost_basis":"18742","unrealized_pl":"58","unrealized_plpc":"0.0031","unrealized_intraday_pl":"58",)"
+                R"("unrealized_intraday_plpc":"0.0031","current_price":"188","lastday_price":"186.5",)"
+                R"("change_today":"0.008"})";
+    }
+    body += "]";
+    return body;
+}
+
+} // namespace
+
+int main() {
+    alpaca::TradingClient client(alpaca::Configuration::Paper("key", "secret"));
+    alpaca::PositionBook book(client);
+    for (std::size_t i = 0; i < kSymbols; ++i) {
+        alpaca::streaming::OrderUpdateMessage fill;
+        fill.event = "fill";
+        fill.order.id = "order-" + std::to_string(i);
+        fill.order.symbol = symbol_name(i);
+        fill.order.asset_class = "us_equity";
+        fill.order.status = alpaca::OrderStatus::FILLED;
+        fill.order.filled_qty = "100";
+        fill.order.filled_avg_price = "187.42";
+        book.apply(fill);
+    }
+
+    std::vector<alpaca::streaming::QuoteMessage> quotes(kSymbols);
+    for (std::size_t i = 0; i < kSymbols; ++i) {
+        quotes[i].symbol = symbol_name(i);
+        quotes[i].bid_price = alpaca::Money(187, 990'000);
+        quotes[i].ask_price = alpaca::Money(188, 10'000);
+    }
+
+    auto const body = make_positions_body();
+    alpaca::bench::run("positions/list-200/json-decode", kIterations / 20, 1, [&body]() {
+        auto positions = alpaca::Json::parse(body).get<std::vector<alpaca::Position>>();
+        alpaca::bench::do_not_optimize(positions);
+    });
+
+    alpaca::bench::run("positions/portfolio-200/book", kIterations, 1, [&book]() {
+        auto total = book.portfolio();
+        alpaca::bench::do_not_optimize(total);
+    });
+
+    alpaca::bench::run("positions/position/book", kIterations, kSymbols, [&book]() {
+        for (std::size_t i = 0; i < kSymbols; ++i) {
+            auto position = book.position("SYM42");
+            alpaca::bench::do_not_optimize(position);
+        }
+    });
+
+    alpaca::bench::run("positions/mark-quote/book", kIterations, kSymbols, [&book, &quotes]() {
+        for (auto const& quote : quotes) {
+            book.apply(quote);
+        }
+    });
+    return 0;
+}
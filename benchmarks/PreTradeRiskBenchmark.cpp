@@ -0,0 +1,74 @@
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "BenchmarkSupport.hpp"
+#include "alpaca/Configuration.hpp"
+#include "alpaca/PositionBook.hpp"
+#include "alpaca/PreTradeRisk.hpp"
+#include "alpaca/TradingClient.hpp"
+
+namespace {
+
+constexpr std::size_t kSymbols = 200;
+constexpr std::size_t kIterations = 20000;
+
+std::string symbol_name(std::size_t i) {
+    return "SYM" + std::to_string(i);
+}
+
+} // namespace
+
+int main() {
+    alpaca::TradingClient client(alpaca::Configuration::Paper("key", "secret"));
+    alpaca::PositionBook book(client);
+
+    alpaca::RiskLimits limits;
+    limits.max_order_qty = alpaca::Money("5000");
+    limits.max_order_notional = alpaca::Money("1000000");
+    limits.max_position = alpaca::Money("20000");
+    limits.price_collar_bps = 100;
+    alpaca::PreTradeRisk::Options options;
+    options.default_limits = limits;
+    alpaca::PreTradeRisk risk(book, options);
+
+    std::vector<alpaca::NewOrderRequest> orders(kSymbols);
+    for (std::size_t i = 0; i < kSymbols; ++i) {
+        alpaca::streaming::QuoteMessage quote;
+        quote.symbol = symbol_name(i);
+        quote.bid_price = alpaca::Money(187, 990'000);
+        quote.ask_price = alpaca::Money(188, 10'000);
+        risk.apply(quote);
+
+        orders[i].symbol = symbol_name(i);
+        orders[i].type = alpaca::OrderType::LIMIT;
+        orders[i].quantity = "100";
+        orders[i].limit_price = "188.05";
+    }
+
+    alpaca::bench::run("risk/check-limit-order/all-rules", kIterations / kSymbols, kSymbols, [&risk, &orders]() {
+        for (auto const& order : orders) {
+            auto decision = risk.check(order);
+            alpaca::bench::do_not_optimize(decision);
+        }
+    });
+
+    alpaca::bench::run("risk/apply-quote", kIterations / kSymbols, kSymbols, [&risk]() {
+        alpaca::streaming::QuoteMessage quote;
+        quote.symbol = "SYM42";
+        quote.bid_price = alpaca::Money(187, 990'000);
+        quote.ask_price = alpaca::Money(188, 10'000);
+        for (std::size_t i = 0; i < kSymbols; ++i) {
+            risk.apply(quote);
+        }
+    });
+
+    for (auto const& rule : risk.stats().rules) {
+        if (rule.evaluations > 0) {
+            std::printf("%-48s %12.3f ns/op\n", ("risk/rule/" + alpaca::to_string(rule.rule)).c_str(),
+                        static_cast<double>(rule.total_time.count()) / static_cast<double>(rule.evaluations));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,153 @@
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "BenchmarkSupport.hpp"
+#include "alpaca/BackfillCoordinator.hpp"
+#include "alpaca/Configuration.hpp"
+#include "alpaca/HttpClient.hpp"
+#include "alpaca/Json.hpp"
+#include "alpaca/MarketDataClient.hpp"
+#include "alpaca/SequenceGapTracker.hpp"
+#include "alpaca/Streaming.hpp"
+
+namespace alpaca::streaming {
+
+/// Hands payloads to the client the way its dispatcher does.
+class WebSocketClientHarness {
+  public:
+    static void handle(WebSocketClient& client, Json const& payload) {
+        client.handle_payload(payload);
+    }
+};
+
+} // namespace alpaca::streaming
+
+namespace {
+
+constexpr std::size_t kSymbols = 500;
+constexpr std::size_t kMessages = 100'000;
+constexpr std::size_t kIterations = 50;
+
+struct Event {
+    std::string channel;
+    std::string symbol;
+    std::uint64_t sequence{0};
+};
+
+std::vector<Event> make_events() {
+    std::vector<std::string> symbols;
+    symbols.reserve(kSymbols);
+    for (std::size_t i = 0; i < kSymbols; ++i) {
+        symbols.push_back("SYM" + std::to_string(i));
+    }
+    std::vector<Event> events;
+    events.reserve(kMessages);
+    std::vector<std::uint64_t> next(kSymbols, 1);
+    for (std::size_t i = 0; i < kMessages; ++i) {
+        auto const symbol = (i * 7919) % kSymbols;
+        // One gap every 1000 messages keeps the slow path in the mix.
+        next[symbol] += i % 1000 == 0 ? 3 : 1;
+        events.push_back(Event{i % 3 == 0 ? "q" : "t", symbols[symbol], next[symbol]});
+    }
+    return events;
+}
+
+// What evaluate_sequence_gap did before the tracker: build "channel|symbol" per message and look it up by string.
+struct StringKeyedTracker {
+    std::unordered_map<std::string, std::uint64_t> last;
+
+    bool observe(Event const& event) {
+        auto const key = event.channel + "|" + event.symbol;
+        auto const it = last.find(key);
+        if (it == last.end()) {
+            last.emplace(key, event.sequence);
+            return false;
+        }
+        bool const gap = event.sequence > it->second + 1;
+        if (event.sequence > it->second) {
+            it->second = event.sequence;
+        }
+        return gap;
+    }
+};
+
+/// Answers every replay with no trades, so gaps cost the client their bookkeeping but no network time.
+class EmptyReplayHttpClient : public alpaca::HttpClient {
+  public:
+    alpaca::HttpResponse send(alpaca::HttpRequest const&) override {
+        return alpaca::HttpResponse{200, R"({"trades":{},"next_page_token":null})", {}};
+    }
+};
+
+std::vector<alpaca::Json> make_payloads(std::vector<Event> const& events) {
+    std::vector<alpaca::Json> payloads;
+    payloads.reserve(events.size());
+    for (auto const& event : events) {
+        payloads.push_back(alpaca::Json{
+            {"T", event.channel         },
+            {"S", event.symbol          },
+            {"i", std::to_string(event.sequence)},
+            {"t", "2024-05-01T12:00:00Z"},
+            {"p", 100.0                 },
+            {"s", 10                    }
+        });
+    }
+    return payloads;
+}
+
+void run_client(std::string const& name, alpaca::streaming::WebSocketClient& client,
+                std::vector<alpaca::Json> const& payloads) {
+    client.set_message_handler([](alpaca::streaming::StreamMessage const&, alpaca::streaming::MessageCategory) {
+    });
+    alpaca::bench::run(name, kIterations, kMessages, [&client, &payloads]() {
+        for (auto const& payload : payloads) {
+            alpaca::streaming::WebSocketClientHarness::handle(client, payload);
+        }
+    });
+}
+
+} // namespace
+
+int main() {
+    auto const events = make_events();
+
+    StringKeyedTracker legacy;
+    alpaca::bench::run("sequence-gap/string-keyed-map", kIterations, kMessages, [&events, &legacy]() {
+        std::size_t gaps = 0;
+        for (auto const& event : events) {
+            gaps += legacy.observe(event) ? 1 : 0;
+        }
+        alpaca::bench::do_not_optimize(gaps);
+    });
+
+    alpaca::streaming::SequenceGapTracker tracker;
+    alpaca::bench::run("sequence-gap/interned-slots", kIterations, kMessages, [&events, &tracker]() {
+        std::size_t gaps = 0;
+        for (auto const& event : events) {
+            auto const slot = tracker.slot(event.channel, event.symbol);
+            gaps += tracker.observe(slot, event.sequence).has_value() ? 1 : 0;
+        }
+        alpaca::bench::do_not_optimize(gaps);
+    });
+
+    // The same traffic through the client's payload path, first without gap tracking and then with the default
+    // policy automatic backfill installs, so the difference is what gap tracking costs per message.
+    auto const payloads = make_payloads(events);
+    alpaca::streaming::WebSocketClient untracked{"wss://example.com", "key", "secret"};
+    run_client("sequence-gap/client-without-policy", untracked, payloads);
+
+    alpaca::MarketDataClient market(alpaca::Configuration::Paper("key", "secret"),
+                                    std::make_shared<EmptyReplayHttpClient>());
+    auto coordinator =
+    std::make_shared<alpaca::streaming::BackfillCoordinator>(market, alpaca::streaming::StreamFeed::MarketData);
+    coordinator->set_error_handler([](std::exception_ptr) {
+    });
+    alpaca::streaming::WebSocketClient tracked{"wss://example.com", "key", "secret"};
+    tracked.enable_automatic_backfill(coordinator);
+    run_client("sequence-gap/client-with-backfill-policy", tracked, payloads);
+    coordinator->wait_for_idle();
+    return 0;
+}
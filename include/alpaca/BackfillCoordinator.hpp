@@ -1,10 +1,18 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
 #include <cstdint>
+#include <deque>
+#include <exception>
 #include <functional>
 #include <mutex>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -23,6 +31,13 @@ enum class StreamFeed;
 
 /// Coordinates REST backfill requests when sequence gaps are detected on the
 /// streaming connection.
+///
+/// Replays run on a dedicated worker pool so gap detection never blocks the
+/// streaming dispatcher. Pending requests for different symbols are coalesced
+/// into multi-symbol REST calls, and replay handlers are invoked from the
+/// worker threads with records sorted by timestamp. A coalesced call pages
+/// until every symbol has its own window and limit covered, and a symbol
+/// whose replay returns nothing is reported as a failure.
 class BackfillCoordinator {
   public:
     struct Options {
@@ -36,25 +51,78 @@ class BackfillCoordinator {
         bool request_trades{true};
         /// Enables replaying missing bar data.
         bool request_bars{true};
+        /// Number of worker threads performing REST replays. Zero runs
+        /// replays synchronously on the thread reporting the gap.
+        std::size_t worker_threads{1};
+        /// Maximum number of queued replay requests. Requests beyond the
+        /// limit are dropped and counted in `dropped_requests()`.
+        std::size_t max_queued_requests{256};
+        /// Maximum number of symbols coalesced into a single REST call.
+        std::size_t max_symbols_per_request{100};
+        /// How long a worker waits for additional gaps before issuing a
+        /// request, allowing bursts across symbols to share one call.
+        std::chrono::milliseconds coalesce_window{0};
+    };
+
+    /// What `request_backfill` did with a gap.
+    enum class Scheduling {
+        /// No replay will run for the gap.
+        Skipped,
+        /// A new replay was queued or ran synchronously. For trade gaps the
+        /// trade replay observer is notified exactly once for it.
+        Scheduled,
+        /// The gap widened a replay for the same stream that had not started
+        /// yet. That replay's single notification covers this gap too.
+        Merged,
     };
 
     using TradeReplayHandler = std::function<void(std::string const&, std::vector<alpaca::StockTrade> const&)>;
     using BarReplayHandler = std::function<void(std::string const&, std::vector<alpaca::StockBar> const&)>;
+    using ErrorHandler = std::function<void(std::exception_ptr)>;
+    /// Notified once per trade replay after the replay handler ran. Failed or
+    /// dropped replays are reported with `succeeded == false` and no records.
+    using TradeReplayObserver =
+    std::function<void(std::string const&, std::vector<alpaca::StockTrade> const&, bool succeeded)>;
 
     BackfillCoordinator(MarketDataClient& market_data_client, StreamFeed feed);
     BackfillCoordinator(MarketDataClient& market_data_client, StreamFeed feed, Options options);
+    /// Stops the workers after their current replay, and reports queued trade
+    /// replays to the observer as failed. Must not run on a worker thread,
+    /// that is from a replay handler, observer or error handler.
+    ~BackfillCoordinator();
+
+    BackfillCoordinator(BackfillCoordinator const&) = delete;
+    BackfillCoordinator& operator=(BackfillCoordinator const&) = delete;
 
     void set_trade_replay_handler(TradeReplayHandler handler);
     void set_bar_replay_handler(BarReplayHandler handler);
+    /// Receives failures raised by REST replays executed on the worker pool,
+    /// and a `BackfillIncomplete` error naming symbols whose replay returned
+    /// no records.
+    void set_error_handler(ErrorHandler handler);
+    /// Installs the observer used by `WebSocketClient` to merge replayed trades
+    /// back into the live stream.
+    void set_trade_replay_observer(TradeReplayObserver observer);
 
     /// Records the latest timestamp observed for a stream identifier so the
     /// coordinator can derive replay windows for future sequence gaps.
     void record_payload(std::string const& stream_id, Json const& payload);
+    /// Hands over the timestamps around a sequence gap in place of recording
+    /// every payload: `payload` revealed the gap and `previous_time` is the
+    /// raw event time of the payload before it, empty when unknown.
+    void record_gap(std::string const& stream_id, Json const& payload, std::string_view previous_time);
 
     /// Invoked when a sequence gap is detected. Dispatches REST calls to fetch
     /// missing records for the provided stream identifier.
-    void request_backfill(std::string const& stream_id, std::uint64_t from_sequence, std::uint64_t to_sequence,
-                          Json const& payload);
+    Scheduling request_backfill(std::string const& stream_id, std::uint64_t from_sequence, std::uint64_t to_sequence,
+                                Json const& payload);
+
+    /// Blocks until every queued replay has completed.
+    void wait_for_idle();
+
+    [[nodiscard]] std::size_t pending_requests() const;
+    [[nodiscard]] std::uint64_t dropped_requests() const;
+    [[nodiscard]] std::uint64_t issued_requests() const;
 
   private:
     enum class PayloadKind {
@@ -62,6 +130,15 @@ class BackfillCoordinator {
         Bar
     };
 
+    struct ReplayJob {
+        PayloadKind kind{PayloadKind::Trade};
+        std::string symbol;
+        std::string state_key;
+        Timestamp start{};
+        Timestamp end{};
+        int limit{0};
+    };
+
     struct StreamState {
         std::optional<Timestamp> previous_timestamp{};
         std::optional<Timestamp> last_timestamp{};
@@ -71,19 +148,37 @@ class BackfillCoordinator {
     [[nodiscard]] std::optional<Timestamp> extract_timestamp(Json const& payload) const;
     [[nodiscard]] std::optional<PayloadKind> classify_payload(Json const& payload) const;
 
-    void replay_trades(std::string const& stream_id, Timestamp start, Timestamp end, int limit,
-                       TradeReplayHandler const& handler);
-    void replay_bars(std::string const& stream_id, Timestamp start, Timestamp end, int limit,
-                     BarReplayHandler const& handler);
+    void worker_loop();
+    [[nodiscard]] std::vector<ReplayJob> take_batch_locked();
+    /// Replays `batch`, counting in `notified` the leading jobs whose trade
+    /// observer has already been told the outcome.
+    void execute_batch(std::vector<ReplayJob> const& batch, std::size_t& notified);
+    /// Tells the trade observer that the jobs of `batch` past the first
+    /// `notified` failed.
+    void notify_trade_failure(std::vector<ReplayJob> const& batch, std::size_t notified = 0);
+    void replay_trades(std::vector<ReplayJob> const& batch, TradeReplayHandler const& handler, std::size_t& notified);
+    void replay_bars(std::vector<ReplayJob> const& batch, BarReplayHandler const& handler);
+    /// Reports symbols whose replay came back empty to the error handler.
+    void report_missing(std::vector<std::string> const& symbols);
 
     MarketDataClient* market_data_client_;
     StreamFeed feed_;
     Options options_;
 
-    std::mutex mutex_;
+    mutable std::mutex mutex_;
+    std::condition_variable queue_cv_;
+    std::condition_variable idle_cv_;
     std::unordered_map<std::string, StreamState> states_;
+    std::deque<ReplayJob> queue_{};
+    std::vector<std::thread> workers_{};
+    std::size_t active_workers_{0};
+    bool stopping_{false};
+    std::atomic<std::uint64_t> dropped_requests_{0};
+    std::atomic<std::uint64_t> issued_requests_{0};
     TradeReplayHandler trade_handler_{};
     BarReplayHandler bar_handler_{};
+    ErrorHandler error_handler_{};
+    TradeReplayObserver trade_observer_{};
 };
 
 } // namespace alpaca::streaming
@@ -11,6 +11,17 @@ namespace alpaca {
     return std::chrono::time_point_cast<Timestamp::duration>(std::chrono::system_clock::now());
 }
 
+/// Returns the current UTC timestamp from the CPU timestamp counter, calibrated
+/// against the system clock on first use and re-anchored about once a second.
+/// Costs a few nanoseconds on x86-64 processors with an invariant TSC and falls
+/// back to `utc_now()` elsewhere. Intended for local latency measurement.
+[[nodiscard]] Timestamp fast_utc_now() noexcept;
+
+/// Runs the calibration behind `fast_utc_now()`, which spins for about 2 ms,
+/// so the first reading on a hot path does not pay for it. Later calls return
+/// immediately. Clients that time messages call it from their constructors.
+void calibrate_fast_clock() noexcept;
+
 /// Convenience helper producing a timestamp \p duration ago from now.
 template <typename Rep, typename Period>
 [[nodiscard]] inline Timestamp since(std::chrono::duration<Rep, Period> duration) {
@@ -30,6 +30,8 @@ enum class ErrorCode {
     RestClientConfigurationMissing,
     HttpClientRequired,
     ApiResponseError,
+    PreTradeRiskRejected,
+    BackfillIncomplete,
 };
 
 class Exception : public std::runtime_error {
@@ -225,6 +227,27 @@ class WebSocketQueueLimitException : public StreamingException {
     std::size_t limit_;
 };
 
+/// Raised when a local pre-trade risk rule refuses an order before it is sent.
+class RiskRejectedException : public Exception {
+  public:
+    RiskRejectedException(std::string rule, std::string symbol, std::string message)
+      : Exception(ErrorCode::PreTradeRiskRejected, std::move(message),
+                  {
+                      {"rule",   rule  },
+                      {"symbol", symbol}
+    }),
+        rule_(std::move(rule)) {
+    }
+
+    /// Name of the rule that refused the order, such as "price_collar".
+    [[nodiscard]] std::string const& rule() const noexcept {
+        return rule_;
+    }
+
+  private:
+    std::string rule_;
+};
+
 /// Classifies an API error response and throws the appropriate Exception subtype.
 [[noreturn]] void ThrowException(long status_code, std::string message, std::string body, HttpHeaders headers,
                                  std::optional<std::string> error_code = std::nullopt);
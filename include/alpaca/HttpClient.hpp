@@ -30,11 +30,26 @@ struct HttpRequest {
     std::string ca_bundle_dir;
 };
 
+/// Where the time went inside one `HttpClient::send`. Clients that do not
+/// measure a stage leave it at zero.
+struct HttpTimings {
+    /// Waiting for a free connection from the pool.
+    std::chrono::nanoseconds connection_wait{0};
+    /// From the start of the transfer until the request was sent, including
+    /// any connect and TLS handshake.
+    std::chrono::nanoseconds send{0};
+    /// From the request being sent until the first response byte arrived.
+    std::chrono::nanoseconds first_byte{0};
+    /// From the first response byte until the body was complete.
+    std::chrono::nanoseconds body{0};
+};
+
 /// Represents the result of an HTTP request.
 struct HttpResponse {
     long status_code{0};
     std::string body;
     HttpHeaders headers;
+    HttpTimings timings{};
 };
 
 /// Defines the interface used to issue HTTP requests.
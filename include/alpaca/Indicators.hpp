@@ -0,0 +1,179 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "alpaca/Money.hpp"
+#include "alpaca/models/BarSeries.hpp"
+#include "alpaca/models/MarketData.hpp"
+
+namespace alpaca::indicators {
+
+/// Placeholder written by the batch kernels for positions inside the warm-up window.
+inline constexpr double kWarmup = std::numeric_limits<double>::quiet_NaN();
+
+/// Batch kernels accept either `double` prices or `Money` micro-unit columns (for example `BarSeries::closes()`).
+/// Micro-unit inputs produce dollar-denominated outputs. Every kernel returns one value per input element and fills
+/// the warm-up window with `kWarmup`. The kernels make one pass over contiguous columns. Rolling windows and
+/// recursive filters (EMA, Wilder smoothing) carry state from one element to the next, so those loops run
+/// sequentially; only the per-element pre-passes (price conversion, gains and losses, true ranges) are independent.
+
+/// Converts a micro-unit column to dollar prices.
+[[nodiscard]] std::vector<double> to_prices(std::span<std::int64_t const> micro_units);
+
+/// The running sum is recomputed from the window every `period` values, so rounding does not build up over long series.
+[[nodiscard]] std::vector<double> sma(std::span<double const> values, std::size_t period);
+/// Exact variant: the rolling window sum is kept in integer micro-units so it never drifts.
+[[nodiscard]] std::vector<double> sma(std::span<std::int64_t const> micro_units, std::size_t period);
+
+/// Exponential moving average with `alpha = 2 / (period + 1)`, seeded with the SMA of the first `period` values.
+[[nodiscard]] std::vector<double> ema(std::span<double const> values, std::size_t period);
+[[nodiscard]] std::vector<double> ema(std::span<std::int64_t const> micro_units, std::size_t period);
+
+/// Population standard deviation over a rolling window, updated with Welford's method so long series do not drift.
+[[nodiscard]] std::vector<double> rolling_stddev(std::span<double const> values, std::size_t period);
+[[nodiscard]] std::vector<double> rolling_stddev(std::span<std::int64_t const> micro_units, std::size_t period);
+
+/// Wilder's relative strength index in the range [0, 100].
+[[nodiscard]] std::vector<double> rsi(std::span<double const> values, std::size_t period);
+[[nodiscard]] std::vector<double> rsi(std::span<std::int64_t const> micro_units, std::size_t period);
+
+/// Cumulative volume-weighted average of the typical price `(high + low + close) / 3`.
+[[nodiscard]] std::vector<double> vwap(BarSeries const& series);
+
+/// Wilder's average true range.
+[[nodiscard]] std::vector<double> atr(BarSeries const& series, std::size_t period);
+
+/// Incremental counterparts consume one value or bar at a time (for example from the streaming bar handler) and
+/// produce the same series as the batch kernels. `update` returns `std::nullopt` until the warm-up window is full.
+/// Apart from `SimpleMovingAverage`, the `Money` overloads convert to `double` first.
+
+/// Fed `Money`, keeps its window sum in integer micro-units like the micro-unit batch kernel, so it stays exact. Fed
+/// `double`, recomputes the sum from the window every `period` values like the double batch kernel. An instance takes
+/// one kind of input until `reset`; switching kinds throws `InvalidArgumentException`.
+class SimpleMovingAverage {
+  public:
+    explicit SimpleMovingAverage(std::size_t period);
+
+    std::optional<double> update(double value);
+    std::optional<double> update(Money value);
+
+    [[nodiscard]] std::optional<double> value() const;
+    void reset();
+
+  private:
+    enum class Input : std::uint8_t {
+        None,
+        Double,
+        Micro
+    };
+
+    void use_input(Input input);
+    /// Advances the ring past the value just written and reports whether it wrapped.
+    bool advance() noexcept;
+
+    std::size_t period_;
+    Input input_{Input::None};
+    std::vector<double> window_{};
+    std::vector<std::int64_t> micro_window_{};
+    std::size_t head_{0};
+    std::size_t count_{0};
+    double sum_{0.0};
+    std::int64_t micro_sum_{0};
+};
+
+class ExponentialMovingAverage {
+  public:
+    explicit ExponentialMovingAverage(std::size_t period);
+
+    std::optional<double> update(double value);
+    std::optional<double> update(Money value) {
+        return update(value.to_double());
+    }
+
+    [[nodiscard]] std::optional<double> value() const;
+    void reset();
+
+  private:
+    std::size_t period_;
+    double alpha_;
+    std::size_t count_{0};
+    double seed_sum_{0.0};
+    double value_{0.0};
+};
+
+class RollingStdDev {
+  public:
+    explicit RollingStdDev(std::size_t period);
+
+    std::optional<double> update(double value);
+    std::optional<double> update(Money value) {
+        return update(value.to_double());
+    }
+
+    [[nodiscard]] std::optional<double> value() const;
+    void reset();
+
+  private:
+    std::size_t period_;
+    std::vector<double> window_{};
+    std::size_t head_{0};
+    std::size_t count_{0};
+    double mean_{0.0};
+    /// Sum of squared deviations from `mean_` over the window.
+    double m2_{0.0};
+};
+
+class RelativeStrengthIndex {
+  public:
+    explicit RelativeStrengthIndex(std::size_t period);
+
+    std::optional<double> update(double value);
+    std::optional<double> update(Money value) {
+        return update(value.to_double());
+    }
+
+    [[nodiscard]] std::optional<double> value() const;
+    void reset();
+
+  private:
+    std::size_t period_;
+    std::size_t count_{0};
+    double previous_{0.0};
+    double average_gain_{0.0};
+    double average_loss_{0.0};
+};
+
+class VolumeWeightedAveragePrice {
+  public:
+    std::optional<double> update(StockBar const& bar);
+
+    [[nodiscard]] std::optional<double> value() const;
+    void reset();
+
+  private:
+    double price_volume_{0.0};
+    double volume_{0.0};
+};
+
+class AverageTrueRange {
+  public:
+    explicit AverageTrueRange(std::size_t period);
+
+    std::optional<double> update(StockBar const& bar);
+
+    [[nodiscard]] std::optional<double> value() const;
+    void reset();
+
+  private:
+    std::size_t period_;
+    std::size_t count_{0};
+    std::int64_t previous_close_{0};
+    double value_{0.0};
+};
+
+} // namespace alpaca::indicators
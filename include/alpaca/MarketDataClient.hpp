@@ -7,6 +7,7 @@
 #include "alpaca/Configuration.hpp"
 #include "alpaca/Pagination.hpp"
 #include "alpaca/RestClient.hpp"
+#include "alpaca/models/BarSeries.hpp"
 #include "alpaca/models/CorporateActions.hpp"
 #include "alpaca/models/MarketData.hpp"
 #include "alpaca/models/News.hpp"
@@ -50,6 +51,8 @@ class MarketDataClient {
     [[nodiscard]] StockBars get_stock_bars(std::string const& symbol, StockBarsRequest const& request = {}) const;
     [[nodiscard]] std::vector<StockBar> get_all_stock_bars(std::string const& symbol,
                                                            StockBarsRequest request = {}) const;
+    /// Pages through the bars endpoint and decodes every page straight into a column-oriented series.
+    [[nodiscard]] BarSeries get_stock_bar_series(std::string const& symbol, StockBarsRequest request = {}) const;
     [[nodiscard]] StockSnapshot get_stock_snapshot(std::string const& symbol) const;
     [[nodiscard]] MultiStockSnapshots get_stock_snapshots(MultiStockSnapshotsRequest const& request) const;
     [[nodiscard]] CryptoSnapshot get_crypto_snapshot(std::string const& feed, std::string const& symbol,
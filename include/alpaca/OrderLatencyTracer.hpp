@@ -0,0 +1,168 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "alpaca/Json.hpp"
+#include "alpaca/StreamStatistics.hpp"
+#include "alpaca/Streaming.hpp"
+#include "alpaca/models/Common.hpp"
+
+namespace alpaca {
+
+/// Stages timed for each order submitted through a traced `TradingClient`.
+enum class OrderStage : std::uint8_t {
+    /// Writing the request body.
+    Serialize,
+    /// Pacing before the request and backoff between retries.
+    RateLimitWait,
+    /// Waiting for a pooled connection.
+    ConnectionAcquire,
+    /// Sending the request, including any connect and TLS handshake.
+    Send,
+    /// Request sent to the first response byte.
+    FirstByte,
+    /// First response byte to the complete body.
+    BodyComplete,
+    /// Decoding the `Order` from the body.
+    Decode,
+    /// The whole `submit_order` call.
+    Response,
+    /// Submission to the `new` event on the trade_updates stream.
+    Accepted,
+    /// Submission to the first `fill` or `partial_fill` event.
+    Filled,
+};
+
+inline constexpr std::size_t kOrderStageCount = 10;
+
+/// Snake-case stage name, such as "first_byte".
+[[nodiscard]] std::string to_string(OrderStage stage);
+
+/// Timeline of one order submission. The HTTP stages are zero when the
+/// HTTP client does not measure them.
+struct OrderTrace {
+    std::string client_order_id;
+    std::string order_id;
+    std::string symbol;
+    /// Wall-clock time `submit_order` was called.
+    Timestamp started_at{};
+    std::chrono::nanoseconds serialize{0};
+    std::chrono::nanoseconds rate_limit_wait{0};
+    std::chrono::nanoseconds connection_acquire{0};
+    std::chrono::nanoseconds send{0};
+    std::chrono::nanoseconds first_byte{0};
+    std::chrono::nanoseconds body_complete{0};
+    std::chrono::nanoseconds decode{0};
+    std::chrono::nanoseconds response{0};
+    /// Filled in when the stream event arrives, which may be after the trace
+    /// was first recorded.
+    std::optional<std::chrono::nanoseconds> accepted{};
+    std::optional<std::chrono::nanoseconds> filled{};
+    std::size_t attempts{0};
+    /// Empty when the submission succeeded.
+    std::string error{};
+};
+
+/// Durations are written in nanoseconds; stream stages that have not
+/// happened are null.
+void to_json(Json& j, OrderTrace const& trace);
+
+/// Collects order entry latency from `TradingClient::set_latency_tracer`.
+///
+/// Every stage has its own histogram. The most recent traces are kept in a
+/// ring for export. Stream events are matched to submissions by client
+/// order id, and an event that arrives before the REST response is held
+/// until the submission is recorded. Orders submitted without a client
+/// order id can only be matched once the response has named one.
+class OrderLatencyTracer {
+  public:
+    struct Options {
+        /// Traces kept for `recent`; the oldest are dropped first.
+        std::size_t recent_capacity{256};
+        /// Submissions waiting for stream events, and early events waiting
+        /// for submissions. The oldest are dropped first.
+        std::size_t pending_capacity{4096};
+    };
+
+    OrderLatencyTracer();
+    explicit OrderLatencyTracer(Options options);
+
+    OrderLatencyTracer(OrderLatencyTracer const&) = delete;
+    OrderLatencyTracer& operator=(OrderLatencyTracer const&) = delete;
+
+    /// Records a finished submission that started at `started`. Called by
+    /// `TradingClient`.
+    void record(OrderTrace trace, std::chrono::steady_clock::time_point started);
+
+    /// Times `new` and fill events against their submissions.
+    void apply(streaming::OrderUpdateMessage const& update);
+    /// Message handler that applies order updates and then passes every
+    /// message on to `next`.
+    [[nodiscard]] streaming::MessageHandler handler(streaming::MessageHandler next = {});
+    /// Installs `handler(next)` as the client's message handler.
+    void attach(streaming::WebSocketClient& client, streaming::MessageHandler next = {});
+
+    [[nodiscard]] streaming::HistogramSnapshot histogram(OrderStage stage) const;
+    /// Recent traces, oldest first.
+    [[nodiscard]] std::vector<OrderTrace> recent() const;
+
+  private:
+    struct StringHash {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view value) const noexcept {
+            return std::hash<std::string_view>{}(value);
+        }
+    };
+
+    template <typename Value>
+    using StringMap = std::unordered_map<std::string, Value, StringHash, std::equal_to<>>;
+
+    using Clock = std::chrono::steady_clock;
+
+    /// A submission waiting for its stream events. `sequence` finds its
+    /// trace in the ring while it is still there.
+    struct Pending {
+        Clock::time_point started{};
+        std::uint64_t sequence{0};
+        bool accepted{false};
+    };
+
+    /// Stream events seen before their submission was recorded.
+    struct Early {
+        std::optional<Clock::time_point> accepted{};
+        std::optional<Clock::time_point> filled{};
+    };
+
+    void record_stage(OrderStage stage, std::chrono::nanoseconds value) noexcept;
+    /// Applies one stream event to a pending submission. Returns whether the
+    /// submission is done with.
+    bool resolve_locked(Pending& pending, bool fill, Clock::time_point at);
+    void remember_pending_locked(std::string const& client_order_id, Pending pending);
+    void remember_early_locked(std::string const& client_order_id, bool fill, Clock::time_point at);
+
+    Options options_;
+    std::array<streaming::LatencyHistogram, kOrderStageCount> histograms_{};
+
+    mutable std::mutex mutex_;
+    std::deque<OrderTrace> recent_;
+    /// Sequence number of `recent_.front()`.
+    std::uint64_t first_sequence_{0};
+    StringMap<Pending> pending_;
+    std::deque<std::string> pending_order_;
+    StringMap<Early> early_;
+    std::deque<std::string> early_order_;
+};
+
+} // namespace alpaca
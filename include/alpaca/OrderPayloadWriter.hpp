@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "alpaca/models/Order.hpp"
+
+namespace alpaca {
+
+/// Appends the JSON body for `request` to `out` without building a `Json`
+/// value. The bytes are identical to `to_json_payload(request).dump()`: keys
+/// in sorted order, the same string escaping, and the same exception for
+/// strings that are not valid UTF-8.
+void append_order_payload(std::string& out, NewOrderRequest const& request);
+void append_order_payload(std::string& out, ReplaceOrderRequest const& request);
+
+/// Only the equity request types are supported; the multi-asset and OTC
+/// requests carry extra fields and must go through `to_json_payload`.
+template <typename Request> void append_order_payload(std::string& out, Request const& request) = delete;
+
+/// Formats `request` into a buffer owned by the calling thread and reused by
+/// its next call, so steady-state formatting does not allocate. The view is
+/// valid until the thread formats another payload.
+[[nodiscard]] std::string_view format_order_payload(NewOrderRequest const& request);
+[[nodiscard]] std::string_view format_order_payload(ReplaceOrderRequest const& request);
+
+template <typename Request> std::string_view format_order_payload(Request const& request) = delete;
+
+} // namespace alpaca
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "alpaca/models/Order.hpp"
+
+namespace alpaca {
+
+/// An order shape validated and serialised once, for strategies that send
+/// many orders differing only in quantity, limit price and client order id.
+///
+/// The constructor checks the fields that stay the same from order to order
+/// and renders them into JSON fragments. Formatting an order then splices
+/// the varying fields between those fragments. The result is byte for byte
+/// what `format_order_payload` writes for the equivalent `NewOrderRequest`.
+class OrderTemplate {
+  public:
+    /// Values that change per order. Empty fields are left out of the body.
+    struct Fields {
+        std::string_view qty{};
+        std::string_view limit_price{};
+        std::string_view client_order_id{};
+    };
+
+    /// Takes every field of `request` except `quantity`, `limit_price` and
+    /// `client_order_id`, which come from `Fields`. Throws
+    /// `InvalidArgumentException` when a field the order type or class
+    /// requires is missing.
+    explicit OrderTemplate(NewOrderRequest request);
+
+    /// Appends the body for one order to `out`. Throws
+    /// `InvalidArgumentException` when `fields` lacks a quantity, or lacks a
+    /// limit price a limit order needs, or carries one it cannot use.
+    void append(std::string& out, Fields const& fields) const;
+
+    /// Formats into the calling thread's payload buffer, shared with
+    /// `format_order_payload`. The view is valid until the thread formats
+    /// another payload.
+    [[nodiscard]] std::string_view format(Fields const& fields) const;
+
+    /// The invariant fields, with the varying ones cleared.
+    [[nodiscard]] NewOrderRequest const& request() const noexcept {
+        return request_;
+    }
+
+  private:
+    void validate(Fields const& fields) const;
+
+    NewOrderRequest request_;
+    bool limit_priced_{false};
+    bool notional_sized_{false};
+    /// Members that sort between `client_order_id` and `limit_price`.
+    std::string after_client_order_id_;
+    /// Members that sort between `limit_price` and `qty`.
+    std::string after_limit_price_;
+    /// Members that sort after `qty`.
+    std::string after_qty_;
+};
+
+} // namespace alpaca
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "alpaca/Streaming.hpp"
+#include "alpaca/TradingClient.hpp"
+#include "alpaca/models/Order.hpp"
+
+namespace alpaca {
+
+/// Every open order, nested legs included, following `list_orders` pages of
+/// `page_size` back through time until a page adds no new order.
+[[nodiscard]] std::vector<Order> list_open_orders(TradingClient& client, int page_size = 500);
+
+/// Local view of the account's orders, kept current by the `trade_updates`
+/// stream so lookups and open-order queries need no REST round-trip.
+///
+/// Orders are indexed by id and by client order id. An update only replaces
+/// the stored order when it is not older: a terminal order never returns to
+/// an open status, an older `updated_at` is ignored and the filled quantity
+/// never goes backwards. REST snapshots from `seed` and `reconcile` go through
+/// the same rules, so a slow snapshot cannot undo a newer stream event. All
+/// members are thread-safe.
+class OrderTracker {
+  public:
+    struct Options {
+        /// Interval between background reconciliations once
+        /// `start_reconciliation` is called.
+        std::chrono::milliseconds reconcile_interval{std::chrono::seconds{30}};
+        /// Orders requested per `list_orders` page; 500 is the API maximum.
+        int page_size{500};
+        /// Terminal orders kept for lookups after they close. The oldest are
+        /// forgotten first.
+        std::size_t closed_order_capacity{4096};
+    };
+
+    struct Stats {
+        /// Updates that replaced the stored order.
+        std::uint64_t applied_updates{0};
+        /// Updates ignored because the stored order was newer.
+        std::uint64_t stale_updates{0};
+        std::uint64_t reconciliations{0};
+        /// Open orders the snapshot no longer listed and that were refreshed
+        /// with `get_order` during reconciliation.
+        std::uint64_t reconciled_orders{0};
+    };
+
+    using ErrorHandler = std::function<void(std::string const&)>;
+
+    explicit OrderTracker(TradingClient& client);
+    OrderTracker(TradingClient& client, Options options);
+    ~OrderTracker();
+
+    OrderTracker(OrderTracker const&) = delete;
+    OrderTracker& operator=(OrderTracker const&) = delete;
+
+    /// Loads every open order from `list_orders`. Attach the tracker to the
+    /// stream first so no event falls between the snapshot and the stream.
+    void seed();
+    /// Reloads the open orders and refreshes, via `get_order`, any order the
+    /// tracker holds as open that the snapshot no longer lists. A refresh
+    /// that fails goes to the error handler and is retried on the next pass;
+    /// the other orders are still refreshed.
+    void reconcile();
+
+    /// Runs `reconcile` every `reconcile_interval` on a background thread.
+    /// Failures go to the error handler.
+    void start_reconciliation();
+    void stop_reconciliation();
+    void set_error_handler(ErrorHandler handler);
+
+    /// Applies one `trade_updates` event.
+    void apply(streaming::OrderUpdateMessage const& update);
+    /// Applies an order from any source under the same staleness rules.
+    void apply(Order const& order);
+
+    /// Message handler that applies order updates and then passes every
+    /// message on to `next`.
+    [[nodiscard]] streaming::MessageHandler handler(streaming::MessageHandler next = {});
+    /// Installs `handler(next)` as the client's message handler.
+    void attach(streaming::WebSocketClient& client, streaming::MessageHandler next = {});
+
+    [[nodiscard]] std::optional<Order> find(std::string_view order_id) const;
+    [[nodiscard]] std::optional<Order> find_by_client_order_id(std::string_view client_order_id) const;
+    [[nodiscard]] std::vector<Order> open_orders() const;
+    [[nodiscard]] std::vector<Order> open_orders(std::string_view symbol) const;
+    [[nodiscard]] std::size_t open_order_count() const;
+    [[nodiscard]] Stats stats() const;
+
+  private:
+    struct StringHash {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view value) const noexcept {
+            return std::hash<std::string_view>{}(value);
+        }
+    };
+
+    template <typename Value>
+    using StringMap = std::unordered_map<std::string, Value, StringHash, std::equal_to<>>;
+
+    /// Stores `order` unless the stored copy is newer. Returns whether it was stored.
+    bool merge_locked(Order const& order);
+    void forget_closed_locked();
+    void run_reconciliation();
+    void report_error(std::string const& message);
+
+    TradingClient& client_;
+    Options options_;
+
+    mutable std::mutex mutex_;
+    StringMap<Order> orders_;
+    StringMap<std::string> ids_by_client_order_id_;
+    /// Ids of terminal orders, oldest first, for `closed_order_capacity`.
+    std::deque<std::string> closed_ids_;
+    std::size_t open_count_{0};
+    Stats stats_{};
+    ErrorHandler error_handler_;
+
+    std::mutex reconcile_mutex_;
+    std::condition_variable reconcile_cv_;
+    bool reconcile_stop_{false};
+    std::thread reconcile_thread_;
+};
+
+} // namespace alpaca
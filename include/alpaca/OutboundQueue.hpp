@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <string>
+
+namespace alpaca::streaming::detail {
+
+/// Unbounded multi-producer, single-consumer queue of serialised frames.
+///
+/// Producers link nodes with a single atomic exchange and never block; the
+/// consumer side must be driven by one thread at a time. `WebSocketClient`
+/// elects the consumer with an atomic flag so whichever sender finds the
+/// queue idle drains it, preserving the order frames were enqueued in.
+class OutboundQueue {
+  public:
+    OutboundQueue();
+    ~OutboundQueue();
+
+    OutboundQueue(OutboundQueue const&) = delete;
+    OutboundQueue& operator=(OutboundQueue const&) = delete;
+
+    void push(std::string frame);
+    /// Removes the oldest frame. Consumer only.
+    std::optional<std::string> pop();
+
+    [[nodiscard]] bool empty() const noexcept {
+        return size_.load() == 0;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return size_.load();
+    }
+
+    /// Claims the consumer role; returns false when another thread holds it.
+    bool try_acquire_consumer() noexcept {
+        return !consuming_.test_and_set(std::memory_order_acquire);
+    }
+
+    void release_consumer() noexcept {
+        consuming_.clear(std::memory_order_release);
+    }
+
+  private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        std::string frame{};
+    };
+
+    std::atomic<Node*> head_;
+    Node* tail_;
+    std::atomic<std::size_t> size_{0};
+    std::atomic_flag consuming_ = ATOMIC_FLAG_INIT;
+};
+
+} // namespace alpaca::streaming::detail
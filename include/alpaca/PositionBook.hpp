@@ -0,0 +1,223 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "alpaca/Money.hpp"
+#include "alpaca/Streaming.hpp"
+#include "alpaca/TradingClient.hpp"
+
+namespace alpaca {
+
+/// Positions and P&L kept current from the streams instead of polling
+/// `list_positions`.
+///
+/// The book starts from `list_positions` and `list_option_positions`, applies
+/// fills from `trade_updates` and marks every position to the latest quote
+/// midpoint or trade price from the market data stream. All arithmetic is in
+/// `Money` micro-units. Option quantities are scaled by the contract
+/// multiplier when valued. Positions and fills with amounts `Money` cannot
+/// represent, such as crypto quantities with more than six decimals, are
+/// left out of the book and reported to the error handler.
+///
+/// Readers never take a lock: symbols are found through an open-addressed
+/// table of slot pointers that only grows, published through a plain atomic
+/// pointer, and each position is read under a sequence counter. So
+/// `position` and `portfolio` can run on any thread while fills and marks
+/// are applied. The portfolio totals add up positions read one at a time; a
+/// read during `seed` can mix positions from before and after it.
+class PositionBook {
+  public:
+    struct Options {
+        /// Mark positions to the quote midpoint when both sides are present.
+        bool mark_from_quotes{true};
+        /// Mark positions to the last trade price, including the account's own fills.
+        bool mark_from_trades{true};
+        /// Orders requested per `list_orders` page while seeding.
+        int page_size{500};
+        /// Completed orders remembered so a repeated fill event is not
+        /// counted twice. The oldest are forgotten first.
+        std::size_t closed_order_capacity{4096};
+        /// Times `seed` reads the orders and positions again when a fill
+        /// lands between its snapshots.
+        int seed_attempts{3};
+    };
+
+    struct PositionPnl {
+        std::string symbol;
+        /// Signed quantity; negative when short.
+        Money qty{};
+        Money avg_entry_price{};
+        Money mark_price{};
+        Money market_value{};
+        Money cost_basis{};
+        Money unrealized_pl{};
+        /// Realised since the book was seeded.
+        Money realized_pl{};
+    };
+
+    struct PortfolioPnl {
+        Money market_value{};
+        Money cost_basis{};
+        Money unrealized_pl{};
+        Money realized_pl{};
+    };
+
+    explicit PositionBook(TradingClient& client);
+    PositionBook(TradingClient& client, Options options);
+
+    using ErrorHandler = std::function<void(std::string const&)>;
+
+    PositionBook(PositionBook const&) = delete;
+    PositionBook& operator=(PositionBook const&) = delete;
+
+    /// Receives positions and fills the book had to leave out. Called
+    /// without the book's lock held.
+    void set_error_handler(ErrorHandler handler);
+
+    /// Replaces the book with the account's positions and records how much
+    /// of each open order has already filled, so later fill events only add
+    /// the new quantity. Attach the book to the streams first: fill events
+    /// that arrive while the snapshots are read are held and applied to the
+    /// new book. If a snapshot fails they are applied to the old one before
+    /// the error propagates.
+    void seed();
+
+    /// Applies the quantity an order filled since its previous update.
+    void apply(streaming::OrderUpdateMessage const& update);
+    void apply(streaming::QuoteMessage const& quote);
+    void apply(streaming::TradeMessage const& trade);
+
+    /// Message handler that applies fills, quotes and trades and then passes
+    /// every message on to `next`. It never throws on the book's account: a
+    /// message the book cannot apply is reported and still passed on.
+    [[nodiscard]] streaming::MessageHandler handler(streaming::MessageHandler next = {});
+    /// Installs `handler(next)` as the client's message handler.
+    void attach(streaming::WebSocketClient& client, streaming::MessageHandler next = {});
+
+    [[nodiscard]] std::optional<PositionPnl> position(std::string_view symbol) const;
+    /// Signed quantity held in `symbol`, zero when the book has none. Does
+    /// not allocate, for callers on the order path.
+    [[nodiscard]] Money quantity(std::string_view symbol) const;
+    /// Every symbol the book holds or has realised P&L on, sorted by symbol.
+    [[nodiscard]] std::vector<PositionPnl> positions() const;
+    [[nodiscard]] PortfolioPnl portfolio() const;
+
+  private:
+    struct StringHash {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view value) const noexcept {
+            return std::hash<std::string_view>{}(value);
+        }
+    };
+
+    template <typename Value>
+    using StringMap = std::unordered_map<std::string, Value, StringHash, std::equal_to<>>;
+
+    /// Micro-unit values of one position. `cost` is the signed cost of the
+    /// open quantity before the contract multiplier. A slot is `listed` while
+    /// the book holds the symbol; `seed` unlists symbols it no longer has.
+    struct Values {
+        std::int64_t qty{0};
+        std::int64_t cost{0};
+        std::int64_t realized{0};
+        std::int64_t mark{0};
+        bool listed{false};
+    };
+
+    /// One symbol's position, kept for the life of the book. Writers take the
+    /// odd sequence value; readers retry until they see the same even value
+    /// before and after.
+    struct Slot {
+        Slot(std::string symbol, std::int64_t multiplier);
+
+        [[nodiscard]] Values read() const noexcept;
+        std::uint32_t begin_write() noexcept;
+        void end_write(std::uint32_t version) noexcept;
+        void write(Values const& values) noexcept;
+        [[nodiscard]] PositionPnl pnl(Values const& values) const;
+
+        std::string const symbol;
+        std::int64_t const multiplier;
+        std::atomic<std::uint32_t> sequence{0};
+        std::atomic<std::int64_t> qty{0};
+        std::atomic<std::int64_t> cost{0};
+        std::atomic<std::int64_t> realized{0};
+        std::atomic<std::int64_t> mark{0};
+        std::atomic<bool> listed{false};
+    };
+
+    /// Slot pointers probed linearly from the symbol's hash, at most half
+    /// full. Entries are only added, so a reader still holding a table the
+    /// book has outgrown finds every symbol that table had.
+    struct Index {
+        explicit Index(std::size_t capacity);
+
+        [[nodiscard]] Slot* find(std::string_view symbol) const noexcept;
+        void insert(Slot* slot) noexcept;
+
+        std::size_t const mask;
+        std::unique_ptr<std::atomic<Slot*>[]> const buckets;
+    };
+
+    /// A position as `list_positions` reported it.
+    struct SeededPosition {
+        std::string symbol;
+        std::int64_t multiplier{1};
+        Values values{};
+    };
+
+    /// Quantity and notional an order had filled at its last update.
+    struct FillProgress {
+        std::int64_t qty{0};
+        std::int64_t notional{0};
+        bool closed{false};
+    };
+
+    [[nodiscard]] std::vector<SeededPosition> read_positions();
+    [[nodiscard]] StringMap<FillProgress> read_open_order_fills();
+    [[nodiscard]] std::size_t deferred_fill_count();
+    /// Applies the fill events held during `seed`. The first
+    /// `already_in_positions` only advance the fill progress: the positions
+    /// snapshot was read after they arrived.
+    void finish_seed_locked(std::size_t already_in_positions);
+    void apply_fill_locked(Order const& order, Money filled, Money average, bool count_in_positions);
+    void report_error(std::string const& message);
+    [[nodiscard]] Slot* find_slot(std::string_view symbol) const noexcept;
+    void mark(std::string_view symbol, Money price);
+    /// The slot for `symbol`, created unlisted if the book has never seen it.
+    Slot& slot_locked(std::string const& symbol, std::int64_t multiplier);
+    void forget_closed_locked();
+
+    TradingClient& client_;
+    Options options_;
+
+    std::mutex update_mutex_;
+    ErrorHandler error_handler_;
+    StringMap<FillProgress> fills_;
+    /// Ids of completed orders in `fills_`, oldest first.
+    std::deque<std::string> closed_ids_;
+    /// Set while `seed` reads its snapshots; fill events wait in `deferred_fills_`.
+    bool seeding_{false};
+    std::vector<Order> deferred_fills_;
+    /// Owns every slot; a deque keeps their addresses stable as symbols are added.
+    std::deque<Slot> slots_;
+    /// The published index last, preceded by the ones it replaced, which
+    /// readers may still hold. Each is twice the size of the one before, so
+    /// together they take less room than the next one will.
+    std::vector<std::unique_ptr<Index>> indexes_;
+    std::atomic<Index const*> index_;
+};
+
+} // namespace alpaca
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "alpaca/Money.hpp"
+#include "alpaca/PositionBook.hpp"
+#include "alpaca/Streaming.hpp"
+#include "alpaca/TradingClient.hpp"
+
+namespace alpaca {
+
+/// Checks applied by `PreTradeRisk`, in evaluation order.
+enum class RiskRule : std::uint8_t {
+    /// Order quantity above `RiskLimits::max_order_qty`.
+    FatFinger,
+    /// Order value above `RiskLimits::max_order_notional`.
+    MaxNotional,
+    /// Position the order would leave above `RiskLimits::max_position`.
+    MaxPosition,
+    /// Limit price too far through the latest quote.
+    PriceCollar,
+    /// Orders for one symbol arriving faster than its rate limit.
+    SymbolThrottle,
+    /// Orders for all symbols arriving faster than the account rate limit.
+    AccountThrottle,
+};
+
+inline constexpr std::size_t kRiskRuleCount = 6;
+
+/// Snake-case rule name, such as "price_collar".
+[[nodiscard]] std::string to_string(RiskRule rule);
+
+/// Limits for one symbol. Unset limits are not checked.
+struct RiskLimits {
+    /// Largest quantity one order may carry.
+    std::optional<Money> max_order_qty{};
+    /// Largest value one order may carry: its notional, or its quantity at
+    /// the limit price, or at the far side of the quote for market orders.
+    std::optional<Money> max_order_notional{};
+    /// Largest absolute position an order may leave. Orders that shrink the
+    /// position are always allowed.
+    std::optional<Money> max_position{};
+    /// How far a limit price may reach past the far side of the quote, in
+    /// basis points: buys up to the ask plus the collar, sells down to the
+    /// bid minus it.
+    std::optional<std::uint32_t> price_collar_bps{};
+    /// Sustained orders per second for the symbol. Zero leaves it unthrottled.
+    double max_orders_per_second{0};
+    /// Orders allowed back to back before the rate applies.
+    std::uint32_t burst{1};
+};
+
+/// Local risk checks run before an order goes on the wire, so obviously bad
+/// orders are refused in well under a microsecond instead of after a round
+/// trip to the API.
+///
+/// Limits are compiled into flat per-symbol arrays behind an immutable
+/// snapshot, and quotes and throttle state are plain atomics, so `check` can
+/// run on any thread without taking a lock. Positions come from an optional
+/// `PositionBook`; without one every position counts as flat. Open orders are
+/// not counted towards the position.
+///
+/// Each rule records how often it ran, how often it refused an order and how
+/// long it took, measured with `fast_utc_now`. Throttles run last so only an
+/// order that passes every other rule uses up rate, and an order the account
+/// throttle refuses gives back the symbol rate it took.
+class PreTradeRisk {
+  public:
+    struct Options {
+        /// Limits for symbols without their own `set_limits` entry.
+        RiskLimits default_limits{};
+        /// Sustained orders per second across all symbols. Zero leaves the
+        /// account unthrottled.
+        double max_orders_per_second{0};
+        std::uint32_t burst{1};
+    };
+
+    /// Outcome of one check. `rule` and `reason` are set when it is refused.
+    struct Decision {
+        bool accepted{true};
+        RiskRule rule{RiskRule::FatFinger};
+        std::string reason{};
+
+        explicit operator bool() const noexcept {
+            return accepted;
+        }
+    };
+
+    struct RuleStats {
+        RiskRule rule{RiskRule::FatFinger};
+        std::uint64_t evaluations{0};
+        std::uint64_t rejections{0};
+        std::chrono::nanoseconds total_time{0};
+        std::chrono::nanoseconds max_time{0};
+    };
+
+    struct Stats {
+        std::uint64_t checks{0};
+        std::uint64_t rejected{0};
+        /// One entry per rule, in `RiskRule` order.
+        std::vector<RuleStats> rules{};
+    };
+
+    PreTradeRisk();
+    explicit PreTradeRisk(Options options);
+    PreTradeRisk(PositionBook const& positions, Options options);
+
+    PreTradeRisk(PreTradeRisk const&) = delete;
+    PreTradeRisk& operator=(PreTradeRisk const&) = delete;
+
+    /// Replaces the limits for `symbol`. Its quote and throttle state are kept.
+    void set_limits(std::string const& symbol, RiskLimits const& limits);
+
+    /// Runs every configured rule against `request`. The first symbol seen
+    /// takes a short lock to add it to the tables; later checks are lock
+    /// free. Throws `InvalidArgumentException` for unparsable amounts.
+    [[nodiscard]] Decision check(NewOrderRequest const& request);
+
+    /// Submits `request` through `client` if `check` accepts it and throws
+    /// `RiskRejectedException` otherwise.
+    Order submit_order(TradingClient& client, NewOrderRequest const& request);
+
+    /// Records the latest quote for collars and market order values. Quotes
+    /// for symbols not yet checked are kept aside until the first check.
+    void apply(streaming::QuoteMessage const& quote);
+
+    /// Message handler that applies quotes and then passes every message on to `next`.
+    [[nodiscard]] streaming::MessageHandler handler(streaming::MessageHandler next = {});
+    /// Installs `handler(next)` as the client's message handler.
+    void attach(streaming::WebSocketClient& client, streaming::MessageHandler next = {});
+
+    [[nodiscard]] Stats stats() const;
+
+  private:
+    struct StringHash {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view value) const noexcept {
+            return std::hash<std::string_view>{}(value);
+        }
+    };
+
+    template <typename Value>
+    using StringMap = std::unordered_map<std::string, Value, StringHash, std::equal_to<>>;
+
+    /// Per-symbol state written while checks run. Prices are micro-units,
+    /// zero when that side has not been quoted.
+    struct Market {
+        std::atomic<std::int64_t> bid{0};
+        std::atomic<std::int64_t> ask{0};
+        /// Throttle's theoretical arrival time, in nanoseconds since the epoch.
+        std::atomic<std::int64_t> next_arrival{0};
+    };
+
+    /// Latest quote of a symbol not yet in the tables, in micro-units.
+    struct Quote {
+        std::int64_t bid{0};
+        std::int64_t ask{0};
+    };
+
+    /// Throttle parameters: one order every `interval_ns`, up to
+    /// `tolerance_ns` ahead of schedule. A zero interval disables it.
+    struct Rate {
+        std::int64_t interval_ns{0};
+        std::int64_t tolerance_ns{0};
+    };
+
+    /// Limits compiled into arrays indexed by symbol id. Unset limits hold
+    /// `kUnlimited`, or a negative collar.
+    struct Table {
+        StringMap<std::uint32_t> ids;
+        std::vector<std::int64_t> max_order_qty;
+        std::vector<std::int64_t> max_order_notional;
+        std::vector<std::int64_t> max_position;
+        std::vector<std::int64_t> collar_bps;
+        std::vector<Rate> rates;
+        std::vector<Market*> markets;
+    };
+
+    struct RuleCounters {
+        std::atomic<std::uint64_t> evaluations{0};
+        std::atomic<std::uint64_t> rejections{0};
+        std::atomic<std::uint64_t> total_ns{0};
+        std::atomic<std::uint64_t> max_ns{0};
+    };
+
+    /// Returns the snapshot holding `symbol` and its id, adding the symbol
+    /// with the default limits if it is new.
+    std::pair<std::shared_ptr<Table const>, std::uint32_t> resolve(std::string_view symbol);
+    /// Gives `symbol` an id and a `Market`, primed with any quote kept for it.
+    std::uint32_t add_symbol_locked(Table& table, std::string_view symbol);
+    static Rate make_rate(double per_second, std::uint32_t burst);
+    static void write_limits(Table& table, std::uint32_t id, RiskLimits const& limits);
+    static bool admit(std::atomic<std::int64_t>& next_arrival, Rate rate, std::int64_t now) noexcept;
+    void record(RiskRule rule, std::int64_t elapsed_ns, bool passed) noexcept;
+
+    PositionBook const* positions_{nullptr};
+    Options options_;
+    Rate account_rate_{};
+    std::atomic<std::int64_t> account_next_arrival_{0};
+
+    std::mutex table_mutex_;
+    /// Owns every `Market`; a deque keeps their addresses stable as symbols are added.
+    std::deque<Market> markets_;
+    StringMap<Quote> unresolved_quotes_;
+    std::atomic<std::shared_ptr<Table const>> table_;
+
+    std::atomic<std::uint64_t> checks_{0};
+    std::atomic<std::uint64_t> rejected_{0};
+    std::array<RuleCounters, kRiskRuleCount> counters_{};
+};
+
+} // namespace alpaca
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "alpaca/OrderTracker.hpp"
+#include "alpaca/TradingClient.hpp"
+#include "alpaca/models/Common.hpp"
+
+namespace alpaca {
+
+/// Limit order a quoting strategy wants resting in one slot.
+struct QuoteTarget {
+    /// Stable name of the slot, such as "AAPL-bid-1". Client order ids are
+    /// built from it, so keep it short.
+    std::string key;
+    std::string symbol;
+    OrderSide side{OrderSide::BUY};
+    std::string qty;
+    std::string limit_price;
+    TimeInForce time_in_force{TimeInForce::DAY};
+    bool extended_hours{false};
+};
+
+/// Moves the account's resting limit orders to a target set with the fewest
+/// requests, sent concurrently.
+///
+/// Each cycle diffs the targets against the `OrderTracker` view. A slot with
+/// no live order gets a new order. A changed price, quantity or time in force
+/// gets a replace. A slot dropped from the targets gets a cancel. A slot
+/// whose symbol or side changes is cancelled, and its new order follows once
+/// the cancel is confirmed. Slots whose last action is still pending at the
+/// venue are left alone.
+///
+/// Client order ids are `<prefix>-<session>-<key>-<generation>`. The
+/// generation only advances when an order is replaced or a closed slot
+/// reopens, so an action retried after a failure reuses its id and the API
+/// rejects a duplicate instead of placing it twice. Accepted orders are fed
+/// back into the tracker at once, so the next cycle sees them before the
+/// stream does.
+class Requoter {
+  public:
+    struct Options {
+        /// Requests in flight at once within a cycle.
+        std::size_t max_in_flight{16};
+        std::string client_order_id_prefix{"rq"};
+        /// Distinguishes ids from earlier runs. Empty picks one from the
+        /// clock and a random draw at construction.
+        std::string session{};
+    };
+
+    struct CycleReport {
+        std::size_t submitted{0};
+        std::size_t replaced{0};
+        std::size_t canceled{0};
+        std::size_t unchanged{0};
+        /// Slots skipped because their last action has not settled.
+        std::size_t pending{0};
+        std::size_t failed{0};
+        /// One "<key>: <message>" entry per failed request.
+        std::vector<std::string> errors{};
+        /// Time to diff the targets against the tracker.
+        std::chrono::nanoseconds diff_time{0};
+        /// Slowest single request of the cycle.
+        std::chrono::nanoseconds max_request_latency{0};
+        /// The whole cycle, diff included.
+        std::chrono::nanoseconds elapsed{0};
+    };
+
+    struct Stats {
+        std::uint64_t cycles{0};
+        std::uint64_t submitted{0};
+        std::uint64_t replaced{0};
+        std::uint64_t canceled{0};
+        std::uint64_t failed{0};
+        std::chrono::nanoseconds last_cycle{0};
+        std::chrono::nanoseconds max_cycle{0};
+        std::chrono::nanoseconds total_cycle{0};
+    };
+
+    Requoter(TradingClient& client, OrderTracker& tracker);
+    Requoter(TradingClient& client, OrderTracker& tracker, Options options);
+
+    /// Runs one cycle and returns once every request it sent has completed.
+    /// Keys must be unique. Cycles run one at a time.
+    CycleReport requote(std::span<QuoteTarget const> targets);
+
+    [[nodiscard]] Stats stats() const;
+
+  private:
+    struct StringHash {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view value) const noexcept {
+            return std::hash<std::string_view>{}(value);
+        }
+    };
+
+    struct Slot {
+        std::uint64_t generation{0};
+        std::string client_order_id;
+        /// Id of the order being replaced until its replacement shows up.
+        std::string replacing_client_order_id;
+        /// The last submission failed without a response, or as a duplicate
+        /// of an earlier one, so the order may exist without the tracker
+        /// having seen it yet.
+        bool uncertain{false};
+    };
+
+    enum class ActionKind {
+        Submit,
+        Replace,
+        Cancel
+    };
+
+    struct Action {
+        ActionKind kind{ActionKind::Submit};
+        std::string key;
+        QuoteTarget const* target{nullptr};
+        /// Order to replace or cancel. A cancel without one looks the order
+        /// up by `client_order_id` first.
+        std::string order_id;
+        std::string client_order_id;
+        /// Forget the slot once the lookup and cancel succeed.
+        bool drop_slot{false};
+    };
+
+    struct Outcome {
+        bool ok{false};
+        /// Failed without an HTTP response, or was refused because an order
+        /// with its client order id already exists.
+        bool uncertain{false};
+        std::string error{};
+        std::chrono::nanoseconds latency{0};
+    };
+
+    [[nodiscard]] std::string make_client_order_id(std::string_view key, std::uint64_t generation) const;
+    void plan_target(QuoteTarget const& target, Slot& slot, std::vector<Action>& actions, CycleReport& report);
+    void plan_removal(std::string const& key, Slot const& slot, std::vector<Action>& actions,
+                      std::vector<std::string>& dropped, CycleReport& report);
+    [[nodiscard]] Outcome run(Action const& action);
+
+    TradingClient& client_;
+    OrderTracker& tracker_;
+    Options options_;
+
+    std::mutex cycle_mutex_;
+    std::unordered_map<std::string, Slot, StringHash, std::equal_to<>> slots_;
+
+    mutable std::mutex stats_mutex_;
+    Stats stats_{};
+};
+
+} // namespace alpaca
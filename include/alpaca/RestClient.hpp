@@ -7,6 +7,7 @@
 #include <mutex>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -26,6 +27,12 @@ template <typename T> struct is_optional : std::false_type {};
 template <typename T> struct is_optional<std::optional<T>> : std::true_type {};
 
 template <typename T> inline constexpr bool is_optional_v = is_optional<T>::value;
+
+/// Response types with a `decode_json(std::string_view, T&)` overload, found
+/// by argument-dependent lookup, are decoded straight from the body text
+/// instead of through a Json value.
+template <typename T>
+concept has_direct_decoder = requires(std::string_view text, T& value) { decode_json(text, value); };
 } // namespace detail
 
 /// Lightweight REST client responsible for communicating with Alpaca endpoints.
@@ -38,6 +45,20 @@ class RestClient {
         std::optional<std::chrono::system_clock::time_point> reset{};
     };
 
+    /// Where the time went in one call made through a traced overload.
+    struct RequestTrace {
+        /// Attempts sent, including retries.
+        std::size_t attempts{0};
+        /// Time spent sleeping between attempts for backoff and `Retry-After`.
+        std::chrono::nanoseconds retry_wait{0};
+        /// `HttpClient::send` of the last attempt, end to end.
+        std::chrono::nanoseconds round_trip{0};
+        /// Stages of the last attempt, as measured by the HTTP client.
+        HttpTimings http{};
+        /// Turning the response body into the result type.
+        std::chrono::nanoseconds decode{0};
+    };
+
     using RetryClassifier =
     std::function<bool(HttpMethod method, std::optional<long> status_code, std::size_t attempt)>;
 
@@ -113,6 +134,20 @@ class RestClient {
         return request_json_async<T>(HttpMethod::POST, std::move(path), std::move(params), payload.dump());
     }
 
+    /// Performs a POST request with a body that is already serialised JSON and
+    /// returns the JSON response as \c T.
+    template <typename T>
+    T post_serialized(std::string const& path, std::string_view body, QueryParams const& params = {}) const {
+        return request_json<T>(HttpMethod::POST, path, params, std::string(body));
+    }
+
+    /// `post_serialized` that also fills `trace`, including when it throws.
+    template <typename T>
+    T post_serialized(std::string const& path, std::string_view body, RequestTrace& trace,
+                      QueryParams const& params = {}) const {
+        return request_json<T>(HttpMethod::POST, path, params, std::string(body), &trace);
+    }
+
     /// Performs a PUT request with a JSON payload and returns the response as
     /// \c T.
     template <typename T> T put(std::string const& path, Json const& payload, QueryParams const& params = {}) const {
@@ -131,6 +166,13 @@ class RestClient {
         return request_json<T>(HttpMethod::PATCH, path, params, payload.dump());
     }
 
+    /// Performs a PATCH request with a body that is already serialised JSON and
+    /// returns the response as \c T.
+    template <typename T>
+    T patch_serialized(std::string const& path, std::string_view body, QueryParams const& params = {}) const {
+        return request_json<T>(HttpMethod::PATCH, path, params, std::string(body));
+    }
+
     /// Performs a PATCH request asynchronously with a JSON payload and resolves
     /// with the response deserialized into \c T.
     template <typename T> std::future<T> patch_async(std::string path, Json payload, QueryParams params = {}) const {
@@ -201,9 +243,10 @@ class RestClient {
 
     [[nodiscard]] std::optional<std::string> request_raw(HttpMethod method, std::string const& path,
                                                          QueryParams const& params,
-                                                         std::optional<std::string> payload) const;
+                                                         std::optional<std::string> payload,
+                                                         RequestTrace* trace = nullptr) const;
     HttpResponse perform_request(HttpMethod method, std::string const& path, QueryParams const& params,
-                                 std::optional<std::string> payload) const;
+                                 std::optional<std::string> payload, RequestTrace* trace = nullptr) const;
     void apply_authentication(HttpRequest& request) const;
     [[nodiscard]] bool should_retry(HttpMethod method, std::optional<long> status_code, std::size_t attempt) const;
     [[nodiscard]] std::chrono::milliseconds next_backoff(std::chrono::milliseconds current) const;
@@ -230,9 +273,23 @@ class RestClient {
 
     template <typename T>
     T request_json(HttpMethod method, std::string const& path, QueryParams const& params,
-                   std::optional<std::string> payload) const {
-        std::optional<std::string> body = request_raw(method, path, params, std::move(payload));
+                   std::optional<std::string> payload, RequestTrace* trace = nullptr) const {
+        std::optional<std::string> body = request_raw(method, path, params, std::move(payload), trace);
+        if (trace == nullptr) {
+            return decode_body<T>(std::move(body));
+        }
+        auto const started = std::chrono::steady_clock::now();
+        if constexpr (std::is_void_v<T>) {
+            decode_body<T>(std::move(body));
+            trace->decode = std::chrono::steady_clock::now() - started;
+        } else {
+            T value = decode_body<T>(std::move(body));
+            trace->decode = std::chrono::steady_clock::now() - started;
+            return value;
+        }
+    }
 
+    template <typename T> T decode_body(std::optional<std::string> body) const {
         if (!body.has_value()) {
             if constexpr (std::is_void_v<T>) {
                 return;
@@ -250,17 +307,23 @@ class RestClient {
             }
         }
 
-        Json json = Json::parse(*body);
-
-        if constexpr (std::is_void_v<T>) {
-            return;
-        } else if constexpr (std::is_same_v<T, Json>) {
-            return json;
-        } else if constexpr (detail::is_optional_v<T>) {
-            using value_type = typename T::value_type;
-            return T{json.get<value_type>()};
+        if constexpr (detail::has_direct_decoder<T>) {
+            T value{};
+            decode_json(*body, value);
+            return value;
         } else {
-            return json.get<T>();
+            Json json = Json::parse(*body);
+
+            if constexpr (std::is_void_v<T>) {
+                return;
+            } else if constexpr (std::is_same_v<T, Json>) {
+                return json;
+            } else if constexpr (detail::is_optional_v<T>) {
+                using value_type = typename T::value_type;
+                return T{json.get<value_type>()};
+            } else {
+                return json.get<T>();
+            }
         }
     }
 };
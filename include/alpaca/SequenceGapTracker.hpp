@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace alpaca::streaming {
+
+/// Tracks the last sequence number seen per (channel, stream id) pair.
+///
+/// Each pair is interned into a dense slot the first time it is seen, after
+/// which lookups are heterogeneous (no string is built) and sequence numbers
+/// live in a flat array indexed by slot. The tracker is not internally
+/// synchronised; `WebSocketClient` only touches it from the dispatch path.
+class SequenceGapTracker {
+  public:
+    using Slot = std::uint32_t;
+
+    /// A forward jump in the sequence: `observed` arrived while `expected` was
+    /// the next number due.
+    struct Gap {
+        std::uint64_t expected{0};
+        std::uint64_t observed{0};
+    };
+
+    /// Resolves the pair to its slot, interning it on first use. An empty
+    /// `channel` tracks the stream id on its own.
+    Slot slot(std::string_view channel, std::string_view stream_id);
+
+    /// Records `sequence` for `slot` and reports a gap when it skips ahead of
+    /// the last recorded number. Stale or repeated numbers never move the
+    /// recorded position backwards.
+    std::optional<Gap> observe(Slot slot, std::uint64_t sequence) noexcept;
+
+    /// Raw event time of the latest payload recorded for the slot, empty when
+    /// none carried one.
+    [[nodiscard]] std::string const& last_time(Slot slot) const;
+    /// Records the raw event time of the slot's latest payload. The buffer is
+    /// reused, so steady-state calls do not allocate.
+    void set_last_time(Slot slot, std::string_view time);
+
+    /// Stream id the slot was interned with.
+    [[nodiscard]] std::string const& stream_id(Slot slot) const;
+    /// Combined "channel|stream id" key for the slot, or the bare stream id
+    /// when it was interned without a channel.
+    [[nodiscard]] std::string const& key(Slot slot) const;
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return entries_.size();
+    }
+
+    void clear();
+
+  private:
+    struct StringHash {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view value) const noexcept {
+            return std::hash<std::string_view>{}(value);
+        }
+    };
+
+    using SlotIndex = std::unordered_map<std::string, Slot, StringHash, std::equal_to<>>;
+
+    struct Channel {
+        std::string name;
+        SlotIndex streams;
+    };
+
+    struct Entry {
+        std::string stream_id;
+        std::string key;
+    };
+
+    struct Position {
+        std::uint64_t last{0};
+        bool seen{false};
+        std::string last_time{};
+    };
+
+    SlotIndex& streams_for(std::string_view channel);
+
+    std::vector<Channel> channels_{};
+    std::vector<Entry> entries_{};
+    std::vector<Position> positions_{};
+};
+
+} // namespace alpaca::streaming
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace alpaca::streaming {
+
+/// Point-in-time copy of a `LatencyHistogram`.
+struct HistogramSnapshot {
+    /// Per-bucket counts; see `LatencyHistogram::bucket_lower_bound` for the
+    /// value range each bucket covers.
+    std::vector<std::uint64_t> buckets{};
+    std::uint64_t count{0};
+    std::uint64_t sum_ns{0};
+    std::uint64_t min_ns{0};
+    std::uint64_t max_ns{0};
+
+    [[nodiscard]] std::chrono::nanoseconds mean() const;
+    /// Returns the value at the requested quantile (0.0 - 1.0), accurate to the
+    /// histogram's bucket resolution (about 6%).
+    [[nodiscard]] std::chrono::nanoseconds percentile(double quantile) const;
+};
+
+/// Fixed-size, log-linear (HDR-style) histogram of nanosecond durations.
+///
+/// Values are grouped by power of two with 16 linear sub-buckets each, so any
+/// value up to 2^64 ns is recorded with bounded relative error. Recording is a
+/// handful of relaxed atomic operations and never allocates or locks.
+class LatencyHistogram {
+  public:
+    static constexpr std::size_t kSubBucketBits = 4;
+    static constexpr std::size_t kSubBuckets = std::size_t{1} << kSubBucketBits;
+    static constexpr std::size_t kBucketCount = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+    void record(std::uint64_t value_ns) noexcept;
+    void record(std::chrono::nanoseconds value) noexcept {
+        record(value.count() > 0 ? static_cast<std::uint64_t>(value.count()) : 0);
+    }
+
+    [[nodiscard]] HistogramSnapshot snapshot() const;
+    /// Returns the counts accumulated so far and zeroes the histogram.
+    HistogramSnapshot take();
+
+    [[nodiscard]] static std::size_t bucket_index(std::uint64_t value_ns) noexcept;
+    [[nodiscard]] static std::uint64_t bucket_lower_bound(std::size_t index) noexcept;
+
+  private:
+    std::array<std::atomic<std::uint64_t>, kBucketCount> buckets_{};
+    std::atomic<std::uint64_t> count_{0};
+    std::atomic<std::uint64_t> sum_{0};
+    std::atomic<std::uint64_t> min_{std::numeric_limits<std::uint64_t>::max()};
+    std::atomic<std::uint64_t> max_{0};
+};
+
+/// Snapshot of the instrumentation maintained by `WebSocketClient`.
+struct StreamStatistics {
+    /// Event timestamp reported by the exchange to the moment the frame was read
+    /// from the socket.
+    HistogramSnapshot exchange_to_receive{};
+    /// Time a payload spent in the inbound queue before the dispatcher picked it up.
+    HistogramSnapshot receive_to_dispatch{};
+    /// Time spent inside the user message handler.
+    HistogramSnapshot handler_duration{};
+
+    std::uint64_t frames{0};
+    std::uint64_t messages{0};
+    /// Payload bytes received, after decompression.
+    std::uint64_t bytes{0};
+    /// Bytes received on the wire; lower than `bytes` when compression is on.
+    std::uint64_t wire_bytes_received{0};
+    /// Payload bytes sent, before compression.
+    std::uint64_t bytes_sent{0};
+    std::uint64_t wire_bytes_sent{0};
+    std::uint64_t dropped_messages{0};
+    std::uint64_t reconnects{0};
+    /// Time the dispatcher spent spinning for work in busy-poll mode.
+    std::uint64_t dispatcher_spin_ns{0};
+    /// Time the dispatcher spent decoding payloads and running handlers.
+    std::uint64_t dispatcher_work_ns{0};
+    /// Inline payloads that exceeded `DispatcherOptions::slow_handler_threshold`.
+    std::uint64_t slow_handlers{0};
+    /// Payloads replaced by a newer one for the same symbol before dispatch.
+    std::uint64_t conflated_messages{0};
+    /// Payloads skipped before decoding because the symbol filter rejected them.
+    std::uint64_t filtered_messages{0};
+};
+
+namespace detail {
+
+/// Lock-free counters and histograms updated on the streaming hot path.
+struct StreamInstrumentation {
+    LatencyHistogram exchange_to_receive{};
+    LatencyHistogram receive_to_dispatch{};
+    LatencyHistogram handler_duration{};
+    std::atomic<std::uint64_t> frames{0};
+    std::atomic<std::uint64_t> messages{0};
+    std::atomic<std::uint64_t> bytes{0};
+    std::atomic<std::uint64_t> wire_bytes_received{0};
+    std::atomic<std::uint64_t> bytes_sent{0};
+    std::atomic<std::uint64_t> wire_bytes_sent{0};
+    std::atomic<std::uint64_t> dropped_messages{0};
+    std::atomic<std::uint64_t> reconnects{0};
+    std::atomic<std::uint64_t> dispatcher_spin_ns{0};
+    std::atomic<std::uint64_t> dispatcher_work_ns{0};
+    std::atomic<std::uint64_t> slow_handlers{0};
+    std::atomic<std::uint64_t> conflated_messages{0};
+    std::atomic<std::uint64_t> filtered_messages{0};
+
+    [[nodiscard]] StreamStatistics snapshot() const;
+    StreamStatistics take();
+};
+
+} // namespace detail
+
+} // namespace alpaca::streaming
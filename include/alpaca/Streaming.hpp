@@ -32,6 +32,8 @@
 #include "alpaca/HttpHeaders.hpp"
 #include "alpaca/Json.hpp"
 #include "alpaca/Money.hpp"
+#include "alpaca/OutboundQueue.hpp"
+#include "alpaca/StreamStatistics.hpp"
 #include "alpaca/models/Account.hpp"
 #include "alpaca/models/Broker.hpp"
 #include "alpaca/models/Common.hpp"
@@ -50,6 +52,10 @@ enum class StreamFeed {
 };
 
 class BackfillCoordinator;
+class SubscriptionManager;
+class SymbolFilter;
+class SymbolWorkerPool;
+class TradeStreamMerger;
 
 /// Distinguishes the semantic type of a streaming payload delivered by Alpaca.
 enum class MessageCategory {
@@ -313,6 +319,85 @@ struct MarketSubscription {
     std::vector<std::string> news{};
 };
 
+/// Controls how market data subscription changes are turned into frames.
+struct SubscriptionBatching {
+    /// How long subscribe/unsubscribe changes are held before being sent, so a
+    /// burst of calls goes out as a few frames. Subscribing and unsubscribing the
+    /// same symbol within the window cancels out. Zero sends on every call.
+    std::chrono::milliseconds coalesce_window{std::chrono::milliseconds::zero()};
+    /// Upper bound on the serialised size of each subscription frame, including
+    /// the full replay sent after a reconnect. Zero disables splitting.
+    std::size_t max_frame_bytes{16 * 1024};
+};
+
+/// How the dispatcher thread waits for inbound payloads.
+enum class DispatchWaitStrategy {
+    /// Sleep on a condition variable that the socket thread signals for each
+    /// payload. Cheap on CPU, but every wake-up goes through the scheduler.
+    Block,
+    /// Spin on the inbound queue without ever sleeping. Removes the wake-up
+    /// latency at the cost of keeping one core fully busy, so pair it with
+    /// `DispatcherOptions::cpu_affinity` on an isolated core.
+    BusyPoll
+};
+
+/// Scheduling options for the thread that runs the message handler.
+struct DispatcherOptions {
+    DispatchWaitStrategy wait_strategy{DispatchWaitStrategy::Block};
+    /// CPU the dispatcher is pinned to, ideally one removed from the general
+    /// scheduler (for example with `isolcpus`). Unset leaves placement to the OS.
+    std::optional<unsigned> cpu_affinity{};
+    /// SCHED_FIFO priority (1-99) for the dispatcher. Unset keeps the default
+    /// time-sharing policy. Needs CAP_SYS_NICE; a refusal is reported to the
+    /// error handler and the dispatcher keeps running without it.
+    std::optional<int> realtime_priority{};
+    /// Decodes payloads and runs the message handler directly on the socket
+    /// thread, with no inbound queue and no dispatcher thread. Suits handlers
+    /// that do very little per message. A slow handler delays the next socket
+    /// read instead of filling a queue, so nothing is dropped; watch
+    /// `StreamStatistics::slow_handlers` instead. The wait strategy, affinity
+    /// and priority settings do not apply in this mode.
+    bool inline_dispatch{false};
+    /// Number of worker threads that run the message handler. Messages are
+    /// routed by symbol: one symbol's messages are handled in order and never
+    /// concurrently, while different symbols run in parallel. Decoding, gap
+    /// tracking and the backfill merge stay on the dispatching thread. Zero
+    /// calls the handler on the dispatching thread.
+    std::size_t worker_threads{0};
+    /// Inline payloads that take longer than this to decode and handle are
+    /// counted in `StreamStatistics::slow_handlers`. Zero disables the check.
+    std::chrono::microseconds slow_handler_threshold{std::chrono::microseconds{100}};
+};
+
+/// permessage-deflate (RFC 7692) parameters offered when the socket connects.
+/// Compression trades CPU on both ends for bandwidth; compare
+/// `StreamStatistics::bytes` with `wire_bytes_received` to see what it saves.
+struct CompressionOptions {
+    bool enabled{false};
+    /// Largest LZ77 window (8-15 bits) each side may use. Smaller windows use
+    /// less memory per connection and compress less.
+    std::uint8_t client_max_window_bits{15};
+    std::uint8_t server_max_window_bits{15};
+    /// Reset the compression context after every message instead of carrying
+    /// it across messages. Saves memory at a large cost in ratio for small,
+    /// repetitive market data frames.
+    bool client_no_context_takeover{false};
+    bool server_no_context_takeover{false};
+};
+
+/// Selects the market data payloads that may be conflated while they wait for
+/// the dispatcher. A conflated payload is replaced in place by a newer one for
+/// the same symbol, so a slow handler sees the latest value instead of a
+/// backlog. Payloads not listed here (trades, cancels, corrections, order
+/// updates, ...) are always delivered.
+struct ConflationPolicy {
+    bool quotes{true};
+    bool updated_bars{true};
+    /// Only full order book snapshots are conflated; an incremental update
+    /// queued behind a snapshot keeps that snapshot from being replaced.
+    bool orderbooks{true};
+};
+
 /// Callback invoked for every decoded streaming payload.
 using MessageHandler = std::function<void(StreamMessage const&, MessageCategory)>;
 
@@ -349,7 +434,9 @@ struct LatencyMonitor {
     /// is processed locally. Values less than or equal to zero disable
     /// monitoring.
     std::chrono::nanoseconds max_latency{std::chrono::nanoseconds::zero()};
-    /// Extracts the logical event timestamp from a raw websocket payload.
+    /// Extracts the logical event timestamp from a raw websocket payload. Leave
+    /// unset to reuse the timestamp already decoded into the typed message,
+    /// which avoids reading the payload a second time.
     std::function<std::optional<Timestamp>(Json const&)> timestamp_extractor;
     /// Produces a stable identifier (e.g. symbol) for reporting purposes.
     std::function<std::string(Json const&)> stream_identifier;
@@ -358,6 +445,34 @@ struct LatencyMonitor {
     std::function<void(std::string const&, std::chrono::nanoseconds, Json const&)> latency_handler;
 };
 
+/// Controls how trades replayed by automatic backfill are merged back into the
+/// live stream.
+struct BackfillMergePolicy {
+    /// Buffers live trades for a symbol while its backfill is in flight and
+    /// releases live and replayed trades as one ordered stream through the
+    /// message handler. Off by default: replays then only reach the
+    /// coordinator's replay handlers, as they did before merging existed.
+    bool enabled{false};
+    /// Number of trade ids remembered per symbol during a merge to drop
+    /// duplicates between live and replayed data. The filter is allocated on
+    /// the symbol's first gap.
+    std::size_t recent_id_capacity{4096};
+    /// Live trades buffered per symbol before a slow backfill is abandoned.
+    std::size_t max_buffered_messages{10000};
+    /// Live trades, across all symbols, for which a symbol keeps dropping
+    /// repeats of its merged trades before its filter is freed.
+    std::size_t dedupe_window{4096};
+};
+
+/// Counters describing the live/backfill merge stage.
+struct BackfillMergeStats {
+    std::uint64_t duplicates_dropped{0};
+    std::uint64_t live_buffered{0};
+    std::uint64_t replayed_delivered{0};
+    std::uint64_t merges_completed{0};
+    std::uint64_t merges_abandoned{0};
+};
+
 /// Configuration describing the exponential backoff strategy for reconnects.
 struct ReconnectPolicy {
     std::chrono::milliseconds initial_delay{std::chrono::milliseconds{500}};
@@ -515,6 +630,14 @@ class WebSocketClient {
     /// Unsubscribes from the provided channels asynchronously.
     std::future<void> unsubscribe_async(MarketSubscription subscription);
 
+    /// Configures coalescing and frame splitting for market data subscriptions.
+    void set_subscription_batching(SubscriptionBatching batching);
+    /// Sends any subscription changes still held by the coalescing window.
+    void flush_subscriptions();
+    /// Returns the current market data subscriptions, including changes that
+    /// have not been sent yet.
+    [[nodiscard]] MarketSubscription subscriptions() const;
+
     /// Subscribe to trading stream channels (e.g. "trade_updates",
     /// "account_updates").
     void listen(std::vector<std::string> const& streams);
@@ -524,6 +647,13 @@ class WebSocketClient {
 
     void send_raw(Json const& message);
 
+    /// Sends an already serialised frame. The frame is queued without taking
+    /// the connection lock and written by whichever sender finds the outbound
+    /// queue idle, so concurrent senders never serialise or block on each
+    /// other. While disconnected the bytes are buffered and flushed on open,
+    /// including frames queued just before the connection closed.
+    void send_text(std::string_view frame);
+
     /// Sends a raw JSON payload asynchronously.
     std::future<void> send_raw_async(Json message);
 
@@ -535,6 +665,10 @@ class WebSocketClient {
     void set_reconnect_policy(ReconnectPolicy policy);
     void set_ping_interval(std::chrono::seconds interval);
     void set_heartbeat_timeout(std::chrono::milliseconds timeout);
+    /// Sets the permessage-deflate offer used from the next connection attempt.
+    void set_compression_options(CompressionOptions options);
+    /// Whether the server accepted permessage-deflate on the current connection.
+    [[nodiscard]] bool compression_negotiated() const noexcept;
 
     /// Sets the maximum number of buffered outbound messages while disconnected.
     /// A value of 0 disables the limit.
@@ -543,6 +677,26 @@ class WebSocketClient {
     /// application processing. A value of 0 disables the limit, allowing the
     /// queue to grow without bound.
     void set_incoming_message_limit(std::size_t limit);
+    /// Drops market data for symbols the filter does not allow before the
+    /// payload is decoded or queued. The symbol is read straight from the raw
+    /// frame; payloads without an "S" field (control messages, news, trade
+    /// updates) always pass. Keep the pointer to update the set while the
+    /// stream runs.
+    void set_symbol_filter(std::shared_ptr<SymbolFilter> filter);
+    /// Removes the symbol filter so every payload is decoded again.
+    void clear_symbol_filter();
+    /// Enables conflation of the inbound queue. When the queue is full the
+    /// oldest conflatable payload is evicted first; lossless payloads are only
+    /// dropped once none is left.
+    void set_conflation_policy(ConflationPolicy policy);
+    /// Disables conflation. Payloads already conflated are still delivered.
+    void clear_conflation_policy();
+    /// Restarts the dispatcher thread with the given wait strategy, CPU
+    /// pinning and scheduling priority, or stops it when switching to inline
+    /// dispatch. Queued payloads and tasks are kept for the new dispatcher, or
+    /// handled on the calling thread before returning when switching to
+    /// inline dispatch. Must not be called from the message handler.
+    void set_dispatcher_options(DispatcherOptions options);
 
     /// Configures sequence gap detection and replay behaviour.
     void set_sequence_gap_policy(SequenceGapPolicy policy);
@@ -555,34 +709,99 @@ class WebSocketClient {
     void clear_latency_monitor();
 
     /// Enables automatic REST backfills when sequence gaps are observed.
-    void enable_automatic_backfill(std::shared_ptr<BackfillCoordinator> coordinator);
+    void enable_automatic_backfill(std::shared_ptr<BackfillCoordinator> coordinator,
+                                   BackfillMergePolicy merge_policy = {});
 
     /// Disables automatic backfills and restores the previous replay handler.
     void disable_automatic_backfill();
 
+    /// Returns counters for the live/backfill merge stage.
+    [[nodiscard]] BackfillMergeStats backfill_merge_stats() const;
+
+    /// Returns the latency histograms and traffic counters accumulated since
+    /// construction or the last `reset_stats()`. Safe to call from any thread;
+    /// never blocks the streaming threads.
+    [[nodiscard]] StreamStatistics stats() const;
+    /// Returns the statistics for the interval that just ended and starts a
+    /// new one.
+    StreamStatistics reset_stats();
+
   private:
     friend class WebSocketClientHarness;
 
+    struct MergeBridge;
+    struct SequenceTracking;
+
+    /// Payload waiting for the dispatcher along with when it was received.
+    struct InboundMessage {
+        Json payload;
+        Timestamp received_at{};
+        std::int64_t received_steady_ns{0};
+        /// Set on placeholders whose payload lives in `conflation_slots_`.
+        std::optional<std::uint32_t> conflation_slot{};
+    };
+
+    /// Latest payload for one conflation key while its placeholder is queued.
+    struct ConflationSlot {
+        InboundMessage latest;
+        std::string key;
+    };
+
     void authenticate();
-    void handle_payload(Json const& payload);
-    void handle_control_payload(Json const& payload, std::string const& type);
+    /// Raw payload and receive time of the message being delivered, when it
+    /// comes straight off the socket. Value-initialised (`{}`) for messages
+    /// that did not, such as replays released by the merge stage.
+    struct DeliveryContext {
+        Json const* payload;
+        Timestamp received_at;
+    };
+
+    void handle_payload(Json const& payload, Timestamp received_at = {});
+    void deliver(StreamMessage const& message, MessageCategory category, DeliveryContext const& context = {});
+    void handle_control_payload(Json const& payload, std::string const& type, DeliveryContext const& context = {});
     void replay_subscriptions();
+    std::vector<Json> take_subscription_frames_locked();
+    void send_frames(std::vector<Json> const& frames);
+    void drain_outbound();
+    bool park_outbound_frame(std::string& frame);
+    void subscription_flush_loop();
+    void stop_subscription_flusher();
     void schedule_reconnect();
     void start_socket();
     void start_socket_locked();
     std::chrono::milliseconds compute_backoff_delay(std::size_t attempt);
-    void enqueue_incoming_message(Json payload);
+    /// Parses a text frame read from the socket and queues its payloads.
+    /// `wire_size` is the frame's size on the wire, before decompression.
+    void handle_frame(std::string const& frame, std::size_t wire_size);
+    void enqueue_incoming_message(Json payload, Timestamp received_at);
+    void dispatch_inline(Json const& payload, Timestamp received_at);
+    bool conflate_locked(InboundMessage& inbound);
+    InboundMessage take_inbound_front_locked();
+    /// Runs the tasks and payloads a stopped dispatcher left behind, in the
+    /// order the dispatcher would have, and ends the dispatcher switch once
+    /// nothing is left.
+    void run_dispatcher_backlog();
+    void drop_oldest_inbound_locked();
+    void release_conflation_slot_locked(std::uint32_t slot);
+    void clear_inbound_locked();
     void dispatcher_loop();
     void start_dispatcher();
     void stop_dispatcher();
+    void wait_for_dispatcher_signal(std::uint64_t observed);
     void heartbeat_loop();
     void start_heartbeat();
     void stop_heartbeat();
     void handle_heartbeat_timeout();
     void record_activity();
     void evaluate_sequence_gap(Json const& payload);
-    void evaluate_latency(Json const& payload);
+    void evaluate_latency(Json const& payload, std::optional<Timestamp> event_time);
     void refresh_sequence_identifier_metadata_locked();
+    void publish_sequence_tracking_locked(bool reset_positions);
+    void dispatch_trade(TradeMessage message, DeliveryContext const& context);
+    void begin_trade_merge(std::string const& symbol, std::string_view delivered_through);
+    void complete_trade_merge(std::string const& symbol, std::vector<StockTrade> const& trades, bool succeeded);
+    void reset_trade_merge();
+    void post_dispatcher_task(std::function<void()> task);
 
     std::string url_;
     std::string key_;
@@ -596,7 +815,7 @@ class WebSocketClient {
     std::size_t reconnect_attempt_{0};
     std::thread reconnect_thread_{};
 
-    std::vector<Json> pending_messages_;
+    std::vector<std::string> pending_messages_;
     std::size_t pending_message_limit_{1024};
 
     MessageHandler message_handler_{};
@@ -605,15 +824,40 @@ class WebSocketClient {
     ErrorHandler error_handler_{};
     ix::SocketTLSOptions tls_options_{};
     bool custom_tls_options_{false};
+    CompressionOptions compression_options_{};
+    std::atomic<bool> compression_negotiated_{false};
 
     ix::WebSocket socket_{};
+    detail::OutboundQueue outbound_{};
 
     std::mutex dispatcher_mutex_;
     std::condition_variable dispatcher_cv_;
-    std::deque<Json> inbound_queue_;
+    std::deque<InboundMessage> inbound_queue_;
+    std::deque<std::function<void()>> dispatcher_tasks_;
     bool dispatcher_running_{false};
+    /// Set while `set_dispatcher_options` swaps dispatchers; tasks posted
+    /// meanwhile queue for whichever one takes over.
+    bool dispatcher_switching_{false};
     std::thread dispatcher_thread_{};
+    DispatcherOptions dispatcher_options_{};
+    /// Bumped under `dispatcher_mutex_` whenever the dispatcher has something
+    /// to do, so a busy-polling dispatcher can spin on it without the lock.
+    std::atomic<std::uint64_t> dispatcher_signal_{0};
+    std::atomic<bool> inline_dispatch_{false};
+    std::atomic<std::int64_t> slow_handler_threshold_ns_{0};
+    /// Serialises inline handlers with dispatcher tasks posted from other
+    /// threads. Recursive because a synchronous backfill coordinator posts its
+    /// task from inside the handler that requested the backfill.
+    std::recursive_mutex inline_dispatch_mutex_;
+    /// Handler workers when `DispatcherOptions::worker_threads` is set.
+    std::atomic<std::shared_ptr<SymbolWorkerPool>> worker_pool_{};
+    std::atomic<std::shared_ptr<SymbolFilter>> symbol_filter_{};
     std::size_t incoming_message_limit_{4096};
+    std::optional<ConflationPolicy> conflation_policy_{};
+    std::vector<ConflationSlot> conflation_slots_;
+    std::vector<std::uint32_t> free_conflation_slots_;
+    /// "<type>|<symbol>" to the slot still waiting in the queue for that key.
+    std::unordered_map<std::string, std::uint32_t> conflation_index_;
 
     std::mutex heartbeat_mutex_;
     std::condition_variable heartbeat_cv_;
@@ -622,32 +866,32 @@ class WebSocketClient {
     std::chrono::milliseconds heartbeat_timeout_{std::chrono::milliseconds::zero()};
     std::atomic<std::int64_t> last_message_time_ns_{0};
 
-    std::unordered_set<std::string> subscribed_trades_;
-    std::unordered_set<std::string> subscribed_quotes_;
-    std::unordered_set<std::string> subscribed_bars_;
-    std::unordered_set<std::string> subscribed_updated_bars_;
-    std::unordered_set<std::string> subscribed_daily_bars_;
-    std::unordered_set<std::string> subscribed_statuses_;
-    std::unordered_set<std::string> subscribed_orderbooks_;
-    std::unordered_set<std::string> subscribed_lulds_;
-    std::unordered_set<std::string> subscribed_auctions_;
-    std::unordered_set<std::string> subscribed_greeks_;
-    std::unordered_set<std::string> subscribed_underlyings_;
-    std::unordered_set<std::string> subscribed_trade_cancels_;
-    std::unordered_set<std::string> subscribed_trade_corrections_;
-    std::unordered_set<std::string> subscribed_imbalances_;
-    std::unordered_set<std::string> subscribed_news_;
+    std::unique_ptr<SubscriptionManager> subscriptions_;
+    SubscriptionBatching subscription_batching_{};
+    std::condition_variable subscription_cv_;
+    std::optional<std::chrono::steady_clock::time_point> subscription_flush_deadline_{};
+    bool subscription_flusher_running_{false};
+    std::thread subscription_flusher_{};
     std::unordered_set<std::string> listened_streams_;
 
     std::mutex sequence_mutex_;
     std::optional<SequenceGapPolicy> sequence_policy_{};
-    std::unordered_map<std::string, std::uint64_t> last_sequence_ids_{};
     bool sequence_identifier_uses_default_{false};
+    /// Immutable view of the gap policy read by the dispatch path without
+    /// taking `sequence_mutex_`; republished whenever the policy changes.
+    std::atomic<std::shared_ptr<SequenceTracking const>> sequence_tracking_{};
     std::shared_ptr<BackfillCoordinator> backfill_coordinator_{};
     std::function<void(std::string const&, std::uint64_t, std::uint64_t, Json const&)> backfill_passthrough_replay_{};
 
-    std::mutex latency_mutex_;
-    std::optional<LatencyMonitor> latency_monitor_{};
+    mutable std::mutex merge_mutex_;
+    std::unique_ptr<TradeStreamMerger> trade_merger_{};
+    std::shared_ptr<MergeBridge> merge_bridge_{};
+    /// Set while any symbol has a backfill in flight; live trades skip the
+    /// merger and `merge_mutex_` while it is clear.
+    std::atomic<bool> trade_merge_pending_{false};
+
+    std::atomic<std::shared_ptr<LatencyMonitor const>> latency_monitor_{};
+    detail::StreamInstrumentation instrumentation_{};
 
     ReconnectPolicy reconnect_policy_{};
     std::mt19937_64 rng_;
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "alpaca/Json.hpp"
+#include "alpaca/Streaming.hpp"
+
+namespace alpaca::streaming {
+
+/// Tracks market data subscriptions and the changes not yet sent upstream.
+///
+/// Subscribing to a symbol that has a pending unsubscribe (or the reverse)
+/// cancels the pending change instead of queueing a second one, so a burst of
+/// churn collapses into the net difference. Outgoing frames are split so that
+/// each stays under a byte limit. The manager is not internally synchronised.
+class SubscriptionManager {
+  public:
+    /// Number of market data channels carried by `MarketSubscription`.
+    static constexpr std::size_t kChannelCount = 15;
+
+    /// Records the requested subscriptions. Returns true when anything changed.
+    bool subscribe(MarketSubscription const& subscription);
+    /// Records the requested unsubscriptions. Returns true when anything changed.
+    bool unsubscribe(MarketSubscription const& subscription);
+
+    [[nodiscard]] bool has_pending() const noexcept;
+    /// Number of pending per-symbol changes across all channels.
+    [[nodiscard]] std::size_t pending_changes() const noexcept;
+
+    /// Drains the pending changes into "unsubscribe" then "subscribe" frames,
+    /// each at most `max_frame_bytes` when serialised (0 disables the limit).
+    std::vector<Json> take_pending_frames(std::size_t max_frame_bytes);
+
+    /// Builds "subscribe" frames covering every active subscription, as sent
+    /// after a reconnect, and drops the pending changes they supersede.
+    std::vector<Json> take_replay_frames(std::size_t max_frame_bytes);
+
+    /// Drops the pending changes, keeping the active set.
+    void clear_pending() noexcept;
+
+    /// Returns the active subscriptions, including changes not yet sent.
+    [[nodiscard]] MarketSubscription active() const;
+
+  private:
+    enum class Change {
+        Subscribe,
+        Unsubscribe
+    };
+
+    struct ChannelState {
+        std::unordered_set<std::string> active{};
+        std::unordered_map<std::string, Change> pending{};
+    };
+
+    static std::vector<Json> build_frames(char const* action,
+                                          std::array<std::vector<std::string>, kChannelCount> symbols,
+                                          std::size_t max_frame_bytes);
+
+    std::array<ChannelState, kChannelCount> channels_{};
+};
+
+} // namespace alpaca::streaming
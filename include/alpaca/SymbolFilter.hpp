@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace alpaca::streaming {
+
+/// Set of symbols whose market data should reach the message handler.
+///
+/// Symbols are interned into stable ids and membership is a bit per id. The
+/// ids and the bitmap are published together as an immutable snapshot, so
+/// `allows` is lock-free and may run on the socket thread while another thread
+/// updates the set. Symbols never interned are not allowed.
+class SymbolFilter {
+  public:
+    SymbolFilter();
+
+    /// Adds the symbols to the allowed set.
+    void allow(std::vector<std::string> const& symbols);
+    /// Removes the symbols from the allowed set.
+    void block(std::vector<std::string> const& symbols);
+    /// Replaces the allowed set.
+    void assign(std::vector<std::string> const& symbols);
+
+    [[nodiscard]] bool allows(std::string_view symbol) const;
+    /// Returns the allowed symbols, sorted.
+    [[nodiscard]] std::vector<std::string> allowed() const;
+
+  private:
+    struct StringHash {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view value) const noexcept {
+            return std::hash<std::string_view>{}(value);
+        }
+    };
+
+    struct Index {
+        std::unordered_map<std::string, std::uint32_t, StringHash, std::equal_to<>> ids;
+        std::vector<std::string> names;
+    };
+
+    struct State {
+        std::shared_ptr<Index const> index;
+        std::vector<std::uint64_t> bits;
+    };
+
+    /// Copies `state` with every symbol interned, sharing the index when no
+    /// symbol is new.
+    static State with_symbols(State const& state, std::vector<std::string> const& symbols);
+
+    std::mutex update_mutex_;
+    std::atomic<std::shared_ptr<State const>> state_;
+};
+
+namespace detail {
+
+/// One top-level object of a raw websocket frame.
+struct RawPayload {
+    std::string_view json;
+    /// Value of the object's "S" field. Unset when the field is missing, is not
+    /// a string, or contains escape sequences.
+    std::optional<std::string_view> symbol;
+};
+
+/// Splits a frame holding a JSON object, or an array of objects, into the
+/// objects' raw text without decoding them. Returns nullopt for anything else,
+/// including malformed frames, so the caller can fall back to a full parse.
+std::optional<std::vector<RawPayload>> split_raw_frame(std::string_view frame);
+
+} // namespace detail
+
+} // namespace alpaca::streaming
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace alpaca::streaming {
+
+/// Runs tasks on a fixed set of worker threads while keeping tasks that share
+/// a key strictly sequential.
+///
+/// Each key owns a lane: a FIFO of its tasks that at most one worker drains at
+/// a time. A lane with work is queued on the worker its key hashes to; a
+/// worker that runs out of lanes steals whole lanes from the others, so load
+/// balances across keys without ever reordering tasks within one. `post` may
+/// be called from any thread. Lanes with nothing queued are dropped whenever
+/// the number of lanes doubles, so short-lived keys do not accumulate.
+class SymbolWorkerPool {
+  public:
+    using Task = std::function<void()>;
+    using ErrorHandler = std::function<void(std::string const&)>;
+
+    /// Starts `worker_count` threads (at least one). Exceptions escaping a
+    /// task are reported to `on_error` and do not stop the lane.
+    explicit SymbolWorkerPool(std::size_t worker_count, ErrorHandler on_error = {});
+    /// Finishes every task already posted, then joins the workers.
+    ~SymbolWorkerPool();
+
+    SymbolWorkerPool(SymbolWorkerPool const&) = delete;
+    SymbolWorkerPool& operator=(SymbolWorkerPool const&) = delete;
+
+    void post(std::string_view key, Task task);
+
+    [[nodiscard]] std::size_t worker_count() const noexcept {
+        return workers_.size();
+    }
+
+    /// Number of lanes a worker has taken from another worker's queue.
+    [[nodiscard]] std::uint64_t steals() const noexcept {
+        return steals_.load(std::memory_order_relaxed);
+    }
+
+    /// Number of keys currently holding a lane.
+    [[nodiscard]] std::size_t lane_count() const;
+
+  private:
+    struct Lane {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        /// True while the lane sits in a ready queue or is being drained.
+        bool scheduled{false};
+        std::size_t home{0};
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<Lane*> ready;
+        bool poked{false};
+        std::atomic<bool> idle{false};
+        std::thread thread;
+    };
+
+    struct StringHash {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view value) const noexcept {
+            return std::hash<std::string_view>{}(value);
+        }
+    };
+
+    void run_worker(std::size_t index);
+    Lane* steal(std::size_t thief);
+    void drain(Lane& lane, std::size_t worker);
+    void make_ready(Lane& lane, std::size_t worker);
+    void evict_idle_lanes_locked();
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    mutable std::mutex lanes_mutex_;
+    /// Lane count at which `post` next sweeps out idle lanes.
+    std::size_t evict_at_;
+    std::unordered_map<std::string, std::unique_ptr<Lane>, StringHash, std::equal_to<>> lanes_;
+    ErrorHandler on_error_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<std::uint64_t> steals_{0};
+};
+
+} // namespace alpaca::streaming
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "alpaca/Streaming.hpp"
+#include "alpaca/models/MarketData.hpp"
+
+namespace alpaca::streaming {
+
+/// Reorders live and backfilled trades around sequence gaps so consumers
+/// observe a single ordered, duplicate-free stream per symbol.
+///
+/// While a backfill is in flight for a symbol, live trades are buffered. When
+/// the replay arrives both sets are interleaved by timestamp and trade id, and
+/// anything already delivered is dropped: replayed trades at or before the
+/// last trade delivered ahead of the gap, and repeats caught by a bounded
+/// filter of trade ids emitted during the merge. Symbols get that state on
+/// their first gap and keep it for a window of live trades after the merge
+/// settles, so late repeats of merged trades are still dropped; then it is
+/// released. Other live trades pass straight through. The merger is not
+/// internally synchronised.
+class TradeStreamMerger {
+  public:
+    struct Options {
+        /// Number of trade ids emitted during a merge remembered per symbol.
+        std::size_t recent_id_capacity{4096};
+        /// Live trades buffered per symbol before the backfill is abandoned and
+        /// the buffer released as-is.
+        std::size_t max_buffered_messages{10000};
+        /// Live trades, across all symbols, for which a settled symbol keeps
+        /// filtering repeats of its merged trades before its state is dropped.
+        std::size_t dedupe_window{4096};
+    };
+
+    using Stats = BackfillMergeStats;
+
+    using Emit = std::function<void(TradeMessage const&)>;
+
+    TradeStreamMerger();
+    explicit TradeStreamMerger(Options options);
+
+    /// Marks a backfill as in flight for `symbol`; live trades are held back
+    /// until the matching `complete_backfill` or `abandon_backfill`.
+    /// `delivered_through` is the numeric id of the last live trade delivered
+    /// before the gap, if known; replayed trades up to it are dropped. Only the
+    /// first of overlapping backfills sets it.
+    void begin_backfill(std::string const& symbol, std::string_view delivered_through = {});
+    [[nodiscard]] bool backfill_in_flight(std::string const& symbol) const;
+    /// Number of symbols with a backfill in flight.
+    [[nodiscard]] std::size_t active() const noexcept {
+        return active_;
+    }
+    /// Number of symbols holding merge state: a backfill in flight, or a
+    /// dedupe window still open after one.
+    [[nodiscard]] std::size_t tracked() const noexcept {
+        return symbols_.size();
+    }
+
+    /// Handles a live trade: buffered while a backfill is in flight, otherwise
+    /// emitted as-is. Once a slow backfill overflowed the buffer, live trades
+    /// are emitted unless they repeat a trade emitted during the merge.
+    void on_live(TradeMessage message, Emit const& emit);
+
+    /// Merges replayed trades with the buffered live trades and releases them
+    /// once no further backfills are outstanding for the symbol.
+    void complete_backfill(std::string const& symbol, std::vector<TradeMessage> replayed, Emit const& emit);
+
+    /// Gives up on an outstanding backfill, releasing buffered trades in order.
+    void abandon_backfill(std::string const& symbol, Emit const& emit);
+
+    /// Abandons every outstanding backfill, releasing all buffered trades.
+    void release_all(Emit const& emit);
+
+    [[nodiscard]] Stats stats() const noexcept {
+        return stats_;
+    }
+
+    [[nodiscard]] static TradeMessage to_message(std::string const& symbol, StockTrade const& trade);
+
+  private:
+    /// Fixed-size open-addressed table of trade id hashes. Each hash probes a
+    /// small bucket; a full bucket overwrites its oldest entry.
+    class RecentIds {
+      public:
+        explicit RecentIds(std::size_t capacity);
+
+        [[nodiscard]] bool contains(std::uint64_t id) const noexcept;
+        void insert(std::uint64_t id) noexcept;
+
+      private:
+        static constexpr std::size_t kBucketSize = 4;
+
+        [[nodiscard]] std::size_t bucket_of(std::uint64_t id) const noexcept;
+
+        std::vector<std::uint64_t> slots_{};
+        std::vector<std::uint8_t> next_victim_{};
+        std::size_t bucket_mask_{0};
+    };
+
+    struct SymbolState {
+        explicit SymbolState(std::size_t capacity) : recent(capacity) {
+        }
+
+        RecentIds recent;
+        std::size_t outstanding{0};
+        /// The buffer hit its limit; live trades flow until the replays land.
+        bool overflowed{false};
+        /// The current merge was already counted as abandoned.
+        bool abandoned{false};
+        /// Value of `live_seen_` at which a settled symbol is dropped.
+        std::uint64_t retire_at{0};
+        std::string delivered_through{};
+        std::vector<TradeMessage> buffered{};
+    };
+
+    SymbolState& state_for(std::string const& symbol);
+    /// Releases a merge that has nothing outstanding and opens its dedupe window.
+    void settle(std::string const& symbol, SymbolState& state, Emit const& emit);
+    /// Counts the current merge of `state` as abandoned, once.
+    void count_abandoned(SymbolState& state) noexcept;
+    /// Drops settled symbols whose dedupe window has passed.
+    void retire_expired();
+    void release(SymbolState& state, Emit const& emit);
+    void emit_if_new(SymbolState& state, TradeMessage const& message, Emit const& emit);
+
+    Options options_;
+    std::unordered_map<std::string, SymbolState> symbols_{};
+    /// Settled symbols in the order their dedupe windows close. Entries whose
+    /// symbol merged again since are skipped.
+    std::deque<std::pair<std::uint64_t, std::string>> retiring_{};
+    std::uint64_t live_seen_{0};
+    std::size_t active_{0};
+    Stats stats_{};
+};
+
+} // namespace alpaca::streaming
@@ -1,12 +1,18 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
+#include <future>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "alpaca/Configuration.hpp"
 #include "alpaca/HttpClient.hpp"
+#include "alpaca/OrderTemplate.hpp"
 #include "alpaca/RestClient.hpp"
 #include "alpaca/models/Account.hpp"
 #include "alpaca/models/AccountActivity.hpp"
@@ -23,9 +29,28 @@
 
 namespace alpaca {
 
+class OrderLatencyTracer;
+
+namespace streaming {
+class SymbolWorkerPool;
+} // namespace streaming
+
 /// High-level trading surface exposing account/order/watchlist operations.
 class TradingClient {
   public:
+    /// How order submission recovers from a request that failed in transit, such as a timeout or a dropped
+    /// connection, where the order may or may not have reached the API.
+    struct OrderRetryOptions {
+        /// Submissions of one order, the first included.
+        std::size_t max_attempts{3};
+        /// Pause before each resubmission.
+        std::chrono::milliseconds retry_delay{10};
+        /// Looks the order up on a worker thread the client keeps while each resubmission is in flight, instead
+        /// of only after a resubmission fails. Saves a round-trip when an earlier attempt placed the order, at
+        /// the cost of one lookup per resubmission.
+        bool concurrent_probe{false};
+    };
+
     TradingClient(Configuration const& config, HttpClientPtr http_client = nullptr,
                   RestClient::Options options = RestClient::default_options());
     TradingClient(Configuration const& config, RestClient::Options options);
@@ -33,6 +58,7 @@ class TradingClient {
                   HttpClientPtr http_client = nullptr, RestClient::Options options = RestClient::default_options());
     TradingClient(Environment const& environment, std::string api_key_id, std::string api_secret_key,
                   RestClient::Options options);
+    ~TradingClient();
 
     [[nodiscard]] Account get_account();
     [[nodiscard]] AccountConfiguration get_account_configuration();
@@ -55,7 +81,27 @@ class TradingClient {
     void cancel_order(std::string const& order_id);
     [[nodiscard]] BulkCancelOrdersResponse cancel_all_orders();
     [[nodiscard]] Order submit_order(NewOrderRequest const& request);
+    /// Submits one order from a template, formatting only its varying fields.
+    [[nodiscard]] Order submit_order(OrderTemplate const& order_template, OrderTemplate::Fields const& fields);
+    /// Submits a basket, keeping up to `max_in_flight` requests outstanding
+    /// instead of waiting for each round-trip in turn. Requests pause while
+    /// the last rate limit status reports no requests left before its reset.
+    /// One order failing does not stop the others; every outcome is in the
+    /// response and, as it completes, passed to `on_result`. An exception
+    /// from `on_result` stops the basket instead and is returned in the
+    /// response with the orders already sent.
+    [[nodiscard]] BasketSubmissionResponse submit_orders(std::span<NewOrderRequest const> requests,
+                                                         SubmitOrdersOptions const& options = {});
     [[nodiscard]] Order replace_order(std::string const& order_id, ReplaceOrderRequest const& request);
+    /// Times the stages of every order submitted through this client into
+    /// `tracer`. Set it before submitting; `nullptr` turns tracing off.
+    void set_latency_tracer(std::shared_ptr<OrderLatencyTracer> tracer);
+    /// Lets order submission retry after a transport failure. Orders without a client order id get a
+    /// generated one; a retry resubmits under the same id, which the API will not accept twice, while
+    /// `get_order_by_client_order_id` probes for an order that an earlier attempt placed. The probe follows a
+    /// failed resubmission on the calling thread unless `concurrent_probe` is set, and always runs once before
+    /// the last failure is rethrown. Set it before submitting; `std::nullopt` turns retries off.
+    void set_order_retry(std::optional<OrderRetryOptions> options);
 
     [[nodiscard]] std::vector<OptionOrder> list_option_orders(ListOptionOrdersRequest const& request = {});
     [[nodiscard]] OptionOrder get_option_order(std::string const& order_id);
@@ -111,7 +157,26 @@ class TradingClient {
     void delete_watchlist_by_name(std::string const& name);
 
   private:
+    /// Posts `request`, first giving it a generated client order id when retries are on.
+    [[nodiscard]] Order post_request(NewOrderRequest const& request, std::chrono::steady_clock::time_point started,
+                                     std::chrono::nanoseconds paced);
+    /// Posts an order body serialised since `started`, tracing it when a
+    /// tracer is set. `paced` is time already spent waiting before the call.
+    [[nodiscard]] Order post_order(std::string_view body, std::string_view symbol, std::string_view client_order_id,
+                                   std::chrono::steady_clock::time_point started, std::chrono::nanoseconds paced);
+    /// Sends an order body, reconciling by client order id after transport failures when retries are on.
+    [[nodiscard]] Order send_order(std::string_view body, std::string_view client_order_id,
+                                   RestClient::RequestTrace* trace);
+    /// The order with `client_order_id`, or nothing when it is not found or the lookup fails.
+    [[nodiscard]] std::optional<Order> find_order(std::string const& client_order_id);
+    /// Starts `find_order` on the probe worker, or returns an invalid future when probes are sequential.
+    [[nodiscard]] std::future<std::optional<Order>> start_probe(std::string const& client_order_id);
+
     RestClient rest_client_;
+    std::shared_ptr<OrderLatencyTracer> latency_tracer_;
+    std::optional<OrderRetryOptions> order_retry_;
+    /// Runs concurrent probes; declared last so it finishes them before the rest of the client goes away.
+    std::unique_ptr<streaming::SymbolWorkerPool> probe_worker_;
 };
 
 } // namespace alpaca
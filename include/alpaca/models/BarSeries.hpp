@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "alpaca/Json.hpp"
+#include "alpaca/Money.hpp"
+#include "alpaca/models/Common.hpp"
+#include "alpaca/models/MarketData.hpp"
+
+namespace alpaca {
+
+/// Column-oriented (structure-of-arrays) container for OHLCV bars.
+///
+/// Each field lives in its own contiguous column so analytics can stream over a single series without touching the
+/// rest of the bar. Price columns hold `Money` micro-units (`Money::kScale`) as raw `std::int64_t` values.
+class BarSeries {
+  public:
+    BarSeries() = default;
+    explicit BarSeries(std::vector<StockBar> const& bars);
+
+    [[nodiscard]] static BarSeries from_bars(std::vector<StockBar> const& bars);
+    [[nodiscard]] std::vector<StockBar> to_bars() const;
+
+    void reserve(std::size_t capacity);
+    void clear() noexcept;
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return timestamps_.size();
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return timestamps_.empty();
+    }
+
+    [[nodiscard]] std::size_t capacity() const noexcept {
+        return timestamps_.capacity();
+    }
+
+    void push_back(StockBar const& bar);
+    void append(std::vector<StockBar> const& bars);
+
+    /// Decodes a JSON array of bar objects straight into the columns without materialising `StockBar` values.
+    void append_json(Json const& bars);
+
+    /// Appends every bar yielded by a range, e.g. `MarketDataClient::stock_bars_range`.
+    template <typename Range> void append_range(Range&& range) {
+        for (auto const& bar : range) {
+            push_back(bar);
+        }
+    }
+
+    /// Rebuilds the bar stored at `index`. Throws `std::out_of_range` when the index is invalid.
+    [[nodiscard]] StockBar at(std::size_t index) const;
+
+    [[nodiscard]] std::span<Timestamp const> timestamps() const noexcept {
+        return timestamps_;
+    }
+
+    [[nodiscard]] std::span<std::int64_t const> opens() const noexcept {
+        return opens_;
+    }
+
+    [[nodiscard]] std::span<std::int64_t const> highs() const noexcept {
+        return highs_;
+    }
+
+    [[nodiscard]] std::span<std::int64_t const> lows() const noexcept {
+        return lows_;
+    }
+
+    [[nodiscard]] std::span<std::int64_t const> closes() const noexcept {
+        return closes_;
+    }
+
+    [[nodiscard]] std::span<std::uint64_t const> volumes() const noexcept {
+        return volumes_;
+    }
+
+    [[nodiscard]] std::span<std::uint64_t const> trade_counts() const noexcept {
+        return trade_counts_;
+    }
+
+    /// VWAP column in micro-units; entries are zero where `has_vwap()` is zero.
+    [[nodiscard]] std::span<std::int64_t const> vwaps() const noexcept {
+        return vwaps_;
+    }
+
+    [[nodiscard]] std::span<std::uint8_t const> has_vwap() const noexcept {
+        return has_vwap_;
+    }
+
+  private:
+    std::vector<Timestamp> timestamps_{};
+    std::vector<std::int64_t> opens_{};
+    std::vector<std::int64_t> highs_{};
+    std::vector<std::int64_t> lows_{};
+    std::vector<std::int64_t> closes_{};
+    std::vector<std::uint64_t> volumes_{};
+    std::vector<std::uint64_t> trade_counts_{};
+    std::vector<std::int64_t> vwaps_{};
+    std::vector<std::uint8_t> has_vwap_{};
+};
+
+void from_json(Json const& j, BarSeries& series);
+
+} // namespace alpaca
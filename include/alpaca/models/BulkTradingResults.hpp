@@ -1,8 +1,15 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <string>
 #include <vector>
 
 #include "alpaca/models/Common.hpp"
+#include "alpaca/models/Order.hpp"
 #include "alpaca/models/Position.hpp"
 
 namespace alpaca {
@@ -19,4 +26,47 @@ struct BulkClosePositionsResponse {
     std::vector<ClosePositionResponse> failed;
 };
 
+/// Outcome of one order in a basket sent with `TradingClient::submit_orders`.
+struct BasketOrderResult {
+    /// Position of the request in the basket.
+    std::size_t index{0};
+    /// The accepted order; empty when the submission failed.
+    std::optional<Order> order{};
+    /// The exception the submission raised, for rethrowing, and its message.
+    std::exception_ptr error{};
+    std::string error_message{};
+    /// From sending the request to decoding its response, retries included.
+    std::chrono::nanoseconds latency{0};
+};
+
+/// Controls how `TradingClient::submit_orders` pipelines a basket.
+struct SubmitOrdersOptions {
+    /// Requests kept in flight at once. Give the HTTP client at least this
+    /// many pooled connections, or the extra requests queue for a handle.
+    std::size_t max_in_flight{8};
+    /// Longest pause when the rate limit window reports no requests left.
+    std::chrono::milliseconds max_rate_limit_wait{std::chrono::seconds{60}};
+    /// Called as each order completes, in completion order, from the thread
+    /// that sent it. Calls never overlap. If it throws, no further orders are
+    /// sent and the exception is returned in the response.
+    std::function<void(BasketOrderResult const&)> on_result{};
+};
+
+/// Summarizes a basket submitted with `TradingClient::submit_orders`.
+struct BasketSubmissionResponse {
+    /// One result per request, in basket order.
+    std::vector<BasketOrderResult> results;
+    std::size_t succeeded{0};
+    std::size_t failed{0};
+    /// Orders never sent because `on_result` threw; their results hold
+    /// neither an order nor an error.
+    std::size_t not_sent{0};
+    /// What `on_result` threw, if it did.
+    std::exception_ptr callback_error{};
+    /// From the first request sent to the last response decoded.
+    std::chrono::nanoseconds elapsed{0};
+    /// Total time requests waited for the rate limit window to reset.
+    std::chrono::nanoseconds rate_limit_wait{0};
+};
+
 } // namespace alpaca
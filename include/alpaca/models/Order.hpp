@@ -1,10 +1,13 @@
 #pragma once
 
+#include <new>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "alpaca/Json.hpp"
+#include "alpaca/Money.hpp"
 #include "alpaca/RestClient.hpp"
 #include "alpaca/models/Common.hpp"
 #include "alpaca/models/OrderStatus.hpp"
@@ -117,6 +120,29 @@ struct Order {
     std::optional<std::string> quote_id{};
     std::optional<std::string> settlement_date{};
     std::vector<Order> legs;
+
+    /// Fixed-point views of the decimal fields. Each returns nullopt when the
+    /// field is absent and throws InvalidArgumentException when the value has
+    /// more than six fractional digits or is not a decimal. Crypto quantities
+    /// carry up to nine, so code that must not throw, such as a stream
+    /// handler, uses the `std::nothrow` overloads: they also return nullopt
+    /// for a value `Money` cannot represent.
+    [[nodiscard]] std::optional<Money> qty_amount() const;
+    [[nodiscard]] std::optional<Money> qty_amount(std::nothrow_t) const noexcept;
+    [[nodiscard]] std::optional<Money> notional_amount() const;
+    [[nodiscard]] std::optional<Money> notional_amount(std::nothrow_t) const noexcept;
+    [[nodiscard]] std::optional<Money> filled_qty_amount() const;
+    [[nodiscard]] std::optional<Money> filled_qty_amount(std::nothrow_t) const noexcept;
+    [[nodiscard]] std::optional<Money> filled_avg_price_amount() const;
+    [[nodiscard]] std::optional<Money> filled_avg_price_amount(std::nothrow_t) const noexcept;
+    [[nodiscard]] std::optional<Money> limit_price_amount() const;
+    [[nodiscard]] std::optional<Money> limit_price_amount(std::nothrow_t) const noexcept;
+    [[nodiscard]] std::optional<Money> stop_price_amount() const;
+    [[nodiscard]] std::optional<Money> stop_price_amount(std::nothrow_t) const noexcept;
+    [[nodiscard]] std::optional<Money> trail_price_amount() const;
+    [[nodiscard]] std::optional<Money> trail_price_amount(std::nothrow_t) const noexcept;
+    [[nodiscard]] std::optional<Money> high_water_mark_amount() const;
+    [[nodiscard]] std::optional<Money> high_water_mark_amount(std::nothrow_t) const noexcept;
 };
 
 /// Filters available for the list orders endpoint.
@@ -185,6 +211,12 @@ void to_json(Json& j, NewOrderRequest const& request);
 void to_json(Json& j, NewCryptoOrderRequest const& request);
 void to_json(Json& j, NewOtcOrderRequest const& request);
 void from_json(Json const& j, Order& order);
+/// Decode an order, or an array of orders, straight from the response text in
+/// one pass without building a Json value. RestClient picks these up for
+/// `Order` responses. Results match `from_json`, except that a null string
+/// field reads as empty instead of throwing.
+void decode_json(std::string_view text, Order& order);
+void decode_json(std::string_view text, std::vector<Order>& orders);
 void to_json(Json& j, ReplaceOrderRequest const& request);
 void to_json(Json& j, ReplaceCryptoOrderRequest const& request);
 void to_json(Json& j, ReplaceOtcOrderRequest const& request);
@@ -32,4 +32,8 @@ std::string to_string(OrderStatus status);
 /// Parses an API order status string into the strongly typed enum.
 OrderStatus order_status_from_string(std::string const& value);
 
+/// Whether an order in this status can no longer fill, change or be
+/// cancelled: filled, canceled, expired, replaced or rejected.
+[[nodiscard]] bool is_terminal(OrderStatus status) noexcept;
+
 } // namespace alpaca
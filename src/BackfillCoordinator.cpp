@@ -1,10 +1,15 @@
 #include "alpaca/BackfillCoordinator.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <exception>
+#include <iterator>
 #include <limits>
+#include <map>
 #include <utility>
 
+#include "alpaca/Exceptions.hpp"
 #include "alpaca/MarketDataClient.hpp"
 #include "alpaca/Streaming.hpp"
 
@@ -88,10 +93,96 @@ std::optional<Timestamp> extract_timestamp_from_payload(Json const& payload) {
     return std::nullopt;
 }
 
-void append_optional_limit(std::optional<int>& target, int limit) {
+int add_limits(int lhs, int rhs) {
+    auto const sum = static_cast<std::int64_t>(lhs) + static_cast<std::int64_t>(rhs);
+    return static_cast<int>(std::min<std::int64_t>(sum, std::numeric_limits<int>::max()));
+}
+
+/// Largest page the multi-symbol market data endpoints return.
+constexpr int kMaxPageLimit = 10000;
+
+/// Spans the union of every job's window and requests all of the batch's symbols in one call. The summed job limits
+/// only size the pages; `collect_pages` decides when every job has what it asked for.
+template <typename Request, typename Job> void apply_batch_window(Request& request, std::vector<Job> const& batch) {
+    int limit = 0;
+    request.symbols.clear();
+    request.symbols.reserve(batch.size());
+    for (auto const& job : batch) {
+        request.symbols.push_back(job.symbol);
+        request.start = request.start.has_value() ? std::min(*request.start, job.start) : job.start;
+        request.end = request.end.has_value() ? std::max(*request.end, job.end) : job.end;
+        limit = add_limits(limit, job.limit);
+    }
     if (limit > 0) {
-        target = limit;
+        request.limit = std::min(limit, kMaxPageLimit);
+    }
+}
+
+/// Whether `collected` already holds everything `job` asked for: its own limit of records inside its window, or a
+/// record past the end of the window, after which the time-sorted response has nothing more for it.
+template <typename Item, typename Job>
+bool job_covered(std::map<std::string, std::vector<Item>> const& collected, Job const& job) {
+    auto const it = collected.find(job.symbol);
+    if (it == collected.end()) {
+        return false;
+    }
+    std::size_t in_window = 0;
+    for (auto const& item : it->second) {
+        if (item.timestamp > job.end) {
+            return true;
+        }
+        if (item.timestamp >= job.start) {
+            ++in_window;
+        }
+    }
+    return job.limit > 0 && in_window >= static_cast<std::size_t>(job.limit);
+}
+
+/// Follows `next_page_token` until every job in the batch is covered. The response is grouped by symbol, so a busy
+/// symbol can fill several pages of the widened window before the next symbol's records appear.
+template <typename Item, typename Request, typename Job, typename Fetch>
+std::map<std::string, std::vector<Item>> collect_pages(Request request, std::vector<Job> const& batch,
+                                                       std::atomic<std::uint64_t>& issued, Fetch&& fetch) {
+    std::map<std::string, std::vector<Item>> collected;
+    while (true) {
+        issued.fetch_add(1, std::memory_order_relaxed);
+        auto [page, next_page_token] = fetch(request);
+        for (auto& [symbol, records] : page) {
+            auto& target = collected[symbol];
+            if (target.empty()) {
+                target = std::move(records);
+            } else {
+                target.insert(target.end(), std::make_move_iterator(records.begin()),
+                              std::make_move_iterator(records.end()));
+            }
+        }
+        bool const covered = std::all_of(batch.begin(), batch.end(), [&collected](Job const& job) {
+            return job_covered(collected, job);
+        });
+        if (!next_page_token.has_value() || covered) {
+            break;
+        }
+        request.page_token = std::move(next_page_token);
     }
+    return collected;
+}
+
+/// Extracts one symbol's records restricted to its own window, ordered by timestamp.
+template <typename Item, typename Job>
+std::vector<Item> records_for_job(std::map<std::string, std::vector<Item>> const& collected, Job const& job) {
+    std::vector<Item> records;
+    auto const it = collected.find(job.symbol);
+    if (it == collected.end()) {
+        return records;
+    }
+    records.reserve(it->second.size());
+    std::copy_if(it->second.begin(), it->second.end(), std::back_inserter(records), [&job](Item const& item) {
+        return item.timestamp >= job.start && item.timestamp <= job.end;
+    });
+    std::stable_sort(records.begin(), records.end(), [](Item const& lhs, Item const& rhs) {
+        return lhs.timestamp < rhs.timestamp;
+    });
+    return records;
 }
 
 } // namespace
@@ -107,6 +198,33 @@ BackfillCoordinator::BackfillCoordinator(MarketDataClient& market_data_client, S
     }
 }
 
+BackfillCoordinator::~BackfillCoordinator() {
+    std::vector<std::thread> workers;
+    std::vector<ReplayJob> dropped;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        dropped.assign(std::make_move_iterator(queue_.begin()), std::make_move_iterator(queue_.end()));
+        queue_.clear();
+        workers.swap(workers_);
+    }
+    queue_cv_.notify_all();
+    idle_cv_.notify_all();
+    for (auto& worker : workers) {
+        if (worker.get_id() == std::this_thread::get_id()) {
+            // The worker would go on running against a destroyed coordinator.
+            std::terminate();
+        }
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    // Queued jobs never ran; their observers still expect exactly one notification.
+    for (auto& job : dropped) {
+        notify_trade_failure(std::vector<ReplayJob>{std::move(job)});
+    }
+}
+
 void BackfillCoordinator::set_trade_replay_handler(TradeReplayHandler handler) {
     std::lock_guard<std::mutex> lock(mutex_);
     trade_handler_ = std::move(handler);
@@ -117,6 +235,16 @@ void BackfillCoordinator::set_bar_replay_handler(BarReplayHandler handler) {
     bar_handler_ = std::move(handler);
 }
 
+void BackfillCoordinator::set_error_handler(ErrorHandler handler) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    error_handler_ = std::move(handler);
+}
+
+void BackfillCoordinator::set_trade_replay_observer(TradeReplayObserver observer) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    trade_observer_ = std::move(observer);
+}
+
 void BackfillCoordinator::record_payload(std::string const& stream_id, Json const& payload) {
     auto const timestamp = extract_timestamp(payload);
     if (!timestamp.has_value()) {
@@ -141,9 +269,10 @@ void BackfillCoordinator::record_payload(std::string const& stream_id, Json cons
     }
 }
 
-void BackfillCoordinator::request_backfill(std::string const& stream_id, std::uint64_t from_sequence,
-                                           std::uint64_t to_sequence, Json const& payload) {
-    if (!market_data_client_ || from_sequence > to_sequence) {
+void BackfillCoordinator::record_gap(std::string const& stream_id, Json const& payload,
+                                     std::string_view previous_time) {
+    auto const timestamp = extract_timestamp(payload);
+    if (!timestamp.has_value()) {
         return;
     }
 
@@ -152,9 +281,33 @@ void BackfillCoordinator::request_backfill(std::string const& stream_id, std::ui
         return;
     }
 
+    std::optional<Timestamp> previous{};
+    if (!previous_time.empty()) {
+        previous = parse_timestamp(previous_time);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto const kind_suffix = *payload_kind == PayloadKind::Trade ? std::string{"trade"} : std::string{"bar"};
+    auto& state = states_[make_state_key(stream_id, kind_suffix)];
+    state.previous_timestamp = previous;
+    state.last_timestamp = *timestamp;
+}
+
+BackfillCoordinator::Scheduling BackfillCoordinator::request_backfill(std::string const& stream_id,
+                                                                     std::uint64_t from_sequence,
+                                                                     std::uint64_t to_sequence, Json const& payload) {
+    if (!market_data_client_ || from_sequence > to_sequence) {
+        return Scheduling::Skipped;
+    }
+
+    auto const payload_kind = classify_payload(payload);
+    if (!payload_kind.has_value()) {
+        return Scheduling::Skipped;
+    }
+
     auto const observed_timestamp = extract_timestamp(payload);
     if (!observed_timestamp.has_value()) {
-        return;
+        return Scheduling::Skipped;
     }
 
     auto const kind_suffix = *payload_kind == PayloadKind::Trade ? std::string{"trade"} : std::string{"bar"};
@@ -162,12 +315,16 @@ void BackfillCoordinator::request_backfill(std::string const& stream_id, std::ui
     auto const symbol = extract_symbol_from_stream_id(stream_id);
 
     StreamState state_copy{};
-    TradeReplayHandler trade_handler_copy{};
-    BarReplayHandler bar_handler_copy{};
+    std::optional<std::pair<std::uint64_t, std::uint64_t>> previous_range{};
     bool skip_request = false;
     {
         std::lock_guard<std::mutex> lock(mutex_);
         auto& state = states_[state_key];
+        if (state.last_requested_range.has_value() && from_sequence > state.last_requested_range->second) {
+            // The stream moved past the last replayed range without `record_payload` seeing it.
+            state.last_requested_range.reset();
+        }
+        previous_range = state.last_requested_range;
         if (state.last_requested_range.has_value() && from_sequence >= state.last_requested_range->first &&
             to_sequence <= state.last_requested_range->second) {
             skip_request = true;
@@ -180,12 +337,15 @@ void BackfillCoordinator::request_backfill(std::string const& stream_id, std::ui
             state.last_requested_range = range;
         }
         state_copy = state;
-        trade_handler_copy = trade_handler_;
-        bar_handler_copy = bar_handler_;
     }
 
     if (skip_request) {
-        return;
+        return Scheduling::Skipped;
+    }
+
+    bool const enabled = *payload_kind == PayloadKind::Trade ? options_.request_trades : options_.request_bars;
+    if (!enabled) {
+        return Scheduling::Skipped;
     }
 
     std::optional<Timestamp> start_timestamp = state_copy.previous_timestamp;
@@ -204,18 +364,177 @@ void BackfillCoordinator::request_backfill(std::string const& stream_id, std::ui
 
     auto const span = to_sequence - from_sequence + 1;
     auto const capped = std::min<std::uint64_t>(span, static_cast<std::uint64_t>(std::numeric_limits<int>::max()));
-    auto const limit = static_cast<int>(capped);
 
-    switch (*payload_kind) {
-    case PayloadKind::Trade:
-        if (options_.request_trades) {
-            replay_trades(symbol, start, end, limit, trade_handler_copy);
+    ReplayJob job{*payload_kind, symbol, state_key, start, end, static_cast<int>(capped)};
+
+    if (options_.worker_threads == 0) {
+        std::vector<ReplayJob> batch{std::move(job)};
+        std::size_t notified = 0;
+        try {
+            execute_batch(batch, notified);
+        } catch (...) {
+            notify_trade_failure(batch, notified);
+            throw;
+        }
+        return Scheduling::Scheduled;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return Scheduling::Skipped;
+        }
+        auto pending = std::find_if(queue_.begin(), queue_.end(), [&job](ReplayJob const& queued) {
+            return queued.state_key == job.state_key;
+        });
+        if (pending != queue_.end()) {
+            // A replay for this stream has not started yet; widen it instead of issuing a second request.
+            pending->start = std::min(pending->start, job.start);
+            pending->end = std::max(pending->end, job.end);
+            pending->limit = add_limits(pending->limit, job.limit);
+            return Scheduling::Merged;
+        }
+        if (queue_.size() >= options_.max_queued_requests) {
+            dropped_requests_.fetch_add(1, std::memory_order_relaxed);
+            states_[state_key].last_requested_range = previous_range;
+            return Scheduling::Skipped;
+        }
+        queue_.push_back(std::move(job));
+        if (workers_.empty()) {
+            workers_.reserve(options_.worker_threads);
+            for (std::size_t i = 0; i < options_.worker_threads; ++i) {
+                workers_.emplace_back([this]() {
+                    worker_loop();
+                });
+            }
+        }
+    }
+    queue_cv_.notify_one();
+    return Scheduling::Scheduled;
+}
+
+void BackfillCoordinator::wait_for_idle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [this]() {
+        return queue_.empty() && active_workers_ == 0;
+    });
+}
+
+std::size_t BackfillCoordinator::pending_requests() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+}
+
+std::uint64_t BackfillCoordinator::dropped_requests() const {
+    return dropped_requests_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t BackfillCoordinator::issued_requests() const {
+    return issued_requests_.load(std::memory_order_relaxed);
+}
+
+void BackfillCoordinator::worker_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        queue_cv_.wait(lock, [this]() {
+            return stopping_ || !queue_.empty();
+        });
+        if (stopping_) {
+            return;
+        }
+        if (options_.coalesce_window.count() > 0) {
+            queue_cv_.wait_for(lock, options_.coalesce_window, [this]() {
+                return stopping_ || queue_.size() >= options_.max_symbols_per_request;
+            });
+            if (stopping_) {
+                return;
+            }
+            if (queue_.empty()) {
+                continue;
+            }
         }
+
+        auto batch = take_batch_locked();
+        ++active_workers_;
+        lock.unlock();
+        std::size_t notified = 0;
+        try {
+            execute_batch(batch, notified);
+        } catch (...) {
+            // Jobs the replay already reported to the observer keep that outcome.
+            notify_trade_failure(batch, notified);
+            ErrorHandler handler;
+            {
+                std::lock_guard<std::mutex> handler_lock(mutex_);
+                handler = error_handler_;
+            }
+            if (handler) {
+                handler(std::current_exception());
+            }
+        }
+        lock.lock();
+        --active_workers_;
+        if (queue_.empty() && active_workers_ == 0) {
+            idle_cv_.notify_all();
+        }
+    }
+}
+
+std::vector<BackfillCoordinator::ReplayJob> BackfillCoordinator::take_batch_locked() {
+    std::vector<ReplayJob> batch;
+    batch.push_back(std::move(queue_.front()));
+    queue_.pop_front();
+
+    std::size_t const max_symbols = std::max<std::size_t>(options_.max_symbols_per_request, 1);
+    auto const kind = batch.front().kind;
+    for (auto it = queue_.begin(); it != queue_.end() && batch.size() < max_symbols;) {
+        if (it->kind == kind) {
+            batch.push_back(std::move(*it));
+            it = queue_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return batch;
+}
+
+void BackfillCoordinator::notify_trade_failure(std::vector<ReplayJob> const& batch, std::size_t notified) {
+    if (batch.size() <= notified || batch.front().kind != PayloadKind::Trade) {
+        return;
+    }
+    TradeReplayObserver observer;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        observer = trade_observer_;
+    }
+    if (!observer) {
+        return;
+    }
+    static std::vector<StockTrade> const empty_trades;
+    for (auto job = batch.begin() + static_cast<std::ptrdiff_t>(notified); job != batch.end(); ++job) {
+        observer(job->symbol, empty_trades, false);
+    }
+}
+
+void BackfillCoordinator::execute_batch(std::vector<ReplayJob> const& batch, std::size_t& notified) {
+    if (batch.empty()) {
+        return;
+    }
+
+    TradeReplayHandler trade_handler;
+    BarReplayHandler bar_handler;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        trade_handler = trade_handler_;
+        bar_handler = bar_handler_;
+    }
+
+    switch (batch.front().kind) {
+    case PayloadKind::Trade:
+        replay_trades(batch, trade_handler, notified);
         break;
     case PayloadKind::Bar:
-        if (options_.request_bars) {
-            replay_bars(symbol, start, end, limit, bar_handler_copy);
-        }
+        replay_bars(batch, bar_handler);
         break;
     }
 }
@@ -246,146 +565,140 @@ std::optional<BackfillCoordinator::PayloadKind> BackfillCoordinator::classify_pa
     return std::nullopt;
 }
 
-void BackfillCoordinator::replay_trades(std::string const& symbol, Timestamp start, Timestamp end, int limit,
-                                        TradeReplayHandler const& handler) {
+void BackfillCoordinator::replay_trades(std::vector<ReplayJob> const& batch, TradeReplayHandler const& handler,
+                                        std::size_t& notified) {
     if (!market_data_client_) {
         return;
     }
 
+    MultiTradesRequest request;
+    apply_batch_window(request, batch);
+    request.sort = SortDirection::ASC;
+    if (feed_ == StreamFeed::Crypto) {
+        request.feed = options_.crypto_feed;
+    }
+
+    auto const pages = [&](auto fetch_page) {
+        return collect_pages<StockTrade>(request, batch, issued_requests_, [&](MultiTradesRequest const& page) {
+            auto response = fetch_page(page);
+            return std::make_pair(std::move(response.trades), std::move(response.next_page_token));
+        });
+    };
+    std::map<std::string, std::vector<StockTrade>> trades;
     switch (feed_) {
-    case StreamFeed::MarketData: {
-        MultiStockTradesRequest request;
-        request.symbols = {symbol};
-        request.start = start;
-        request.end = end;
-        request.sort = SortDirection::ASC;
-        append_optional_limit(request.limit, limit);
-        auto const response = market_data_client_->get_stock_trades(request);
-        if (handler) {
-            auto it = response.trades.find(symbol);
-            if (it != response.trades.end()) {
-                handler(symbol, it->second);
-            } else {
-                static std::vector<StockTrade> const empty_trades;
-                handler(symbol, empty_trades);
-            }
-        }
+    case StreamFeed::MarketData:
+        trades = pages([this](MultiTradesRequest const& page) {
+            return market_data_client_->get_stock_trades(page);
+        });
         break;
-    }
-    case StreamFeed::Options: {
-        MultiOptionTradesRequest request;
-        request.symbols = {symbol};
-        request.start = start;
-        request.end = end;
-        request.sort = SortDirection::ASC;
-        append_optional_limit(request.limit, limit);
-        auto const response = market_data_client_->get_option_trades(request);
-        if (handler) {
-            auto it = response.trades.find(symbol);
-            if (it != response.trades.end()) {
-                handler(symbol, it->second);
-            } else {
-                static std::vector<OptionTrade> const empty_trades;
-                handler(symbol, empty_trades);
-            }
-        }
+    case StreamFeed::Options:
+        trades = pages([this](MultiTradesRequest const& page) {
+            return market_data_client_->get_option_trades(page);
+        });
         break;
-    }
-    case StreamFeed::Crypto: {
-        MultiCryptoTradesRequest request;
-        request.symbols = {symbol};
-        request.start = start;
-        request.end = end;
-        request.sort = SortDirection::ASC;
-        append_optional_limit(request.limit, limit);
-        request.feed = options_.crypto_feed;
-        auto const response = market_data_client_->get_crypto_trades(request);
-        if (handler) {
-            auto it = response.trades.find(symbol);
-            if (it != response.trades.end()) {
-                handler(symbol, it->second);
-            } else {
-                static std::vector<CryptoTrade> const empty_trades;
-                handler(symbol, empty_trades);
-            }
-        }
+    case StreamFeed::Crypto:
+        trades = pages([this](MultiTradesRequest const& page) {
+            return market_data_client_->get_crypto_trades(page);
+        });
         break;
-    }
     case StreamFeed::Trading:
         break;
     }
+
+    TradeReplayObserver observer;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        observer = trade_observer_;
+    }
+    std::vector<std::string> missing;
+    for (auto const& job : batch) {
+        auto const records = records_for_job(trades, job);
+        if (records.empty()) {
+            missing.push_back(job.symbol);
+        } else if (handler) {
+            handler(job.symbol, records);
+        }
+        // Counted before the call so an observer that throws is not told again that the job failed.
+        ++notified;
+        if (observer) {
+            observer(job.symbol, records, !records.empty());
+        }
+    }
+    report_missing(missing);
 }
 
-void BackfillCoordinator::replay_bars(std::string const& symbol, Timestamp start, Timestamp end, int limit,
-                                      BarReplayHandler const& handler) {
+void BackfillCoordinator::replay_bars(std::vector<ReplayJob> const& batch, BarReplayHandler const& handler) {
     if (!market_data_client_) {
         return;
     }
 
+    MultiBarsRequest request;
+    apply_batch_window(request, batch);
+    request.sort = SortDirection::ASC;
+    request.timeframe = options_.bar_timeframe;
+    if (feed_ == StreamFeed::Crypto) {
+        request.feed = options_.crypto_feed;
+    }
+
+    auto const pages = [&](auto fetch_page) {
+        return collect_pages<StockBar>(request, batch, issued_requests_, [&](MultiBarsRequest const& page) {
+            auto response = fetch_page(page);
+            return std::make_pair(std::move(response.bars), std::move(response.next_page_token));
+        });
+    };
+    std::map<std::string, std::vector<StockBar>> bars;
     switch (feed_) {
-    case StreamFeed::MarketData: {
-        MultiStockBarsRequest request;
-        request.symbols = {symbol};
-        request.start = start;
-        request.end = end;
-        request.sort = SortDirection::ASC;
-        append_optional_limit(request.limit, limit);
-        request.timeframe = options_.bar_timeframe;
-        auto const response = market_data_client_->get_stock_aggregates(request);
-        if (handler) {
-            auto it = response.bars.find(symbol);
-            if (it != response.bars.end()) {
-                handler(symbol, it->second);
-            } else {
-                static std::vector<StockBar> const empty_bars;
-                handler(symbol, empty_bars);
-            }
-        }
+    case StreamFeed::MarketData:
+        bars = pages([this](MultiBarsRequest const& page) {
+            return market_data_client_->get_stock_aggregates(page);
+        });
         break;
-    }
-    case StreamFeed::Options: {
-        MultiOptionBarsRequest request;
-        request.symbols = {symbol};
-        request.start = start;
-        request.end = end;
-        request.sort = SortDirection::ASC;
-        append_optional_limit(request.limit, limit);
-        request.timeframe = options_.bar_timeframe;
-        auto const response = market_data_client_->get_option_aggregates(request);
-        if (handler) {
-            auto it = response.bars.find(symbol);
-            if (it != response.bars.end()) {
-                handler(symbol, it->second);
-            } else {
-                static std::vector<OptionBar> const empty_bars;
-                handler(symbol, empty_bars);
-            }
-        }
+    case StreamFeed::Options:
+        bars = pages([this](MultiBarsRequest const& page) {
+            return market_data_client_->get_option_aggregates(page);
+        });
+        break;
+    case StreamFeed::Crypto:
+        bars = pages([this](MultiBarsRequest const& page) {
+            return market_data_client_->get_crypto_aggregates(page);
+        });
         break;
+    case StreamFeed::Trading:
+        return;
     }
-    case StreamFeed::Crypto: {
-        MultiCryptoBarsRequest request;
-        request.symbols = {symbol};
-        request.start = start;
-        request.end = end;
-        request.sort = SortDirection::ASC;
-        append_optional_limit(request.limit, limit);
-        request.timeframe = options_.bar_timeframe;
-        request.feed = options_.crypto_feed;
-        auto const response = market_data_client_->get_crypto_aggregates(request);
-        if (handler) {
-            auto it = response.bars.find(symbol);
-            if (it != response.bars.end()) {
-                handler(symbol, it->second);
-            } else {
-                static std::vector<CryptoBar> const empty_bars;
-                handler(symbol, empty_bars);
-            }
+
+    std::vector<std::string> missing;
+    for (auto const& job : batch) {
+        auto const records = records_for_job(bars, job);
+        if (records.empty()) {
+            missing.push_back(job.symbol);
+        } else if (handler) {
+            handler(job.symbol, records);
         }
-        break;
     }
-    case StreamFeed::Trading:
-        break;
+    report_missing(missing);
+}
+
+void BackfillCoordinator::report_missing(std::vector<std::string> const& symbols) {
+    if (symbols.empty()) {
+        return;
+    }
+    ErrorHandler handler;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        handler = error_handler_;
+    }
+    if (!handler) {
+        return;
+    }
+    std::string message = "Backfill returned no records for " + symbols.front();
+    for (std::size_t i = 1; i < symbols.size(); ++i) {
+        message.append(", ").append(symbols[i]);
+    }
+    try {
+        throw StreamingException(ErrorCode::BackfillIncomplete, std::move(message));
+    } catch (...) {
+        handler(std::current_exception());
     }
 }
 
@@ -0,0 +1,166 @@
+#include "alpaca/Chrono.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define ALPACA_HAS_TSC 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace alpaca {
+namespace {
+
+std::int64_t system_ns() noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch())
+    .count();
+}
+
+#ifdef ALPACA_HAS_TSC
+std::uint64_t read_ticks() noexcept {
+    return __rdtsc();
+}
+
+/// The counter only tracks wall time when it ticks at a constant rate across
+/// frequency changes and sleep states (CPUID 0x80000007, EDX bit 8).
+bool has_invariant_tsc() noexcept {
+#if defined(_MSC_VER)
+    int registers[4]{};
+    __cpuid(registers, 0x80000000);
+    if (static_cast<unsigned>(registers[0]) < 0x80000007U) {
+        return false;
+    }
+    __cpuid(registers, 0x80000007);
+    return (static_cast<unsigned>(registers[3]) & (1U << 8)) != 0;
+#else
+    unsigned eax = 0;
+    unsigned ebx = 0;
+    unsigned ecx = 0;
+    unsigned edx = 0;
+    if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) == 0) {
+        return false;
+    }
+    return (edx & (1U << 8)) != 0;
+#endif
+}
+#endif
+
+/// Maps timestamp counter ticks onto system clock nanoseconds.
+///
+/// The mapping is an anchor (ticks, ns) plus a rate. Readers extrapolate from
+/// the anchor; whichever reader first finds it more than a second old samples
+/// the system clock, refines the rate over the whole baseline and publishes a
+/// new anchor. The anchor is published through a sequence lock so readers
+/// never block.
+class TscClock {
+  public:
+    TscClock() noexcept {
+#ifdef ALPACA_HAS_TSC
+        if (!has_invariant_tsc()) {
+            return;
+        }
+        origin_ns_ = system_ns();
+        origin_ticks_ = read_ticks();
+        auto anchor_ns = origin_ns_;
+        auto anchor_ticks = origin_ticks_;
+        constexpr std::int64_t kCalibrationNs = 2'000'000;
+        while (anchor_ns - origin_ns_ < kCalibrationNs) {
+            anchor_ticks = read_ticks();
+            anchor_ns = system_ns();
+        }
+        if (anchor_ticks <= origin_ticks_) {
+            return;
+        }
+        auto const ns_per_tick =
+        static_cast<double>(anchor_ns - origin_ns_) / static_cast<double>(anchor_ticks - origin_ticks_);
+        anchor_ticks_.store(anchor_ticks, std::memory_order_relaxed);
+        anchor_ns_.store(anchor_ns, std::memory_order_relaxed);
+        ns_per_tick_.store(ns_per_tick, std::memory_order_relaxed);
+        reanchor_interval_ticks_ = static_cast<std::uint64_t>(1e9 / ns_per_tick);
+        usable_ = true;
+#endif
+    }
+
+    std::int64_t now_ns() noexcept {
+#ifdef ALPACA_HAS_TSC
+        if (!usable_) {
+            return system_ns();
+        }
+        auto const ticks = read_ticks();
+        std::uint64_t anchor_ticks = 0;
+        std::int64_t anchor_ns = 0;
+        double ns_per_tick = 0.0;
+        std::uint32_t version = 0;
+        do {
+            version = sequence_.load(std::memory_order_acquire);
+            anchor_ticks = anchor_ticks_.load(std::memory_order_relaxed);
+            anchor_ns = anchor_ns_.load(std::memory_order_relaxed);
+            ns_per_tick = ns_per_tick_.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+        } while ((version & 1U) != 0 || version != sequence_.load(std::memory_order_relaxed));
+
+        // Ticks read on another core can trail the anchor slightly; the unsigned difference then wraps and
+        // takes the re-anchoring path, which is always correct.
+        auto const elapsed_ticks = ticks - anchor_ticks;
+        if (elapsed_ticks >= reanchor_interval_ticks_) {
+            return reanchor();
+        }
+        return anchor_ns + static_cast<std::int64_t>(static_cast<double>(elapsed_ticks) * ns_per_tick);
+#else
+        return system_ns();
+#endif
+    }
+
+  private:
+#ifdef ALPACA_HAS_TSC
+    std::int64_t reanchor() noexcept {
+        auto version = sequence_.load(std::memory_order_relaxed);
+        if ((version & 1U) != 0 ||
+            !sequence_.compare_exchange_strong(version, version + 1, std::memory_order_acquire)) {
+            return system_ns();
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        auto const ticks = read_ticks();
+        auto const ns = system_ns();
+        if (ticks > origin_ticks_ && ns > origin_ns_) {
+            ns_per_tick_.store(static_cast<double>(ns - origin_ns_) / static_cast<double>(ticks - origin_ticks_),
+                               std::memory_order_relaxed);
+        }
+        anchor_ticks_.store(ticks, std::memory_order_relaxed);
+        anchor_ns_.store(ns, std::memory_order_relaxed);
+        sequence_.store(version + 2, std::memory_order_release);
+        return ns;
+    }
+#endif
+
+    bool usable_{false};
+    std::uint64_t origin_ticks_{0};
+    std::int64_t origin_ns_{0};
+    std::uint64_t reanchor_interval_ticks_{0};
+    std::atomic<std::uint32_t> sequence_{0};
+    std::atomic<std::uint64_t> anchor_ticks_{0};
+    std::atomic<std::int64_t> anchor_ns_{0};
+    std::atomic<double> ns_per_tick_{0.0};
+};
+
+TscClock& tsc_clock() noexcept {
+    static TscClock clock;
+    return clock;
+}
+
+} // namespace
+
+Timestamp fast_utc_now() noexcept {
+    return Timestamp{std::chrono::nanoseconds{tsc_clock().now_ns()}};
+}
+
+void calibrate_fast_clock() noexcept {
+    static_cast<void>(tsc_clock());
+}
+
+} // namespace alpaca
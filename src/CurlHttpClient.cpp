@@ -4,6 +4,8 @@
 
 #include <curl/curl.h>
 
+#include <algorithm>
+#include <chrono>
 #include <condition_variable>
 #include <cstdlib>
 #include <memory>
@@ -66,6 +68,29 @@ size_t write_header(char* buffer, size_t size, size_t nitems, void* userdata) {
     return size * nitems;
 }
 
+std::chrono::nanoseconds transfer_time(CURL* handle, CURLINFO info) {
+    curl_off_t microseconds = 0;
+    if (curl_easy_getinfo(handle, info, &microseconds) != CURLE_OK) {
+        return std::chrono::nanoseconds{0};
+    }
+    return std::chrono::microseconds{microseconds};
+}
+
+/// Splits the transfer using libcurl's cumulative timers, all measured from the start of `curl_easy_perform`.
+void fill_transfer_timings(CURL* handle, HttpTimings& timings) {
+#if LIBCURL_VERSION_NUM >= 0x080a00
+    auto const sent = transfer_time(handle, CURLINFO_POSTTRANSFER_TIME_T);
+#else
+    // Older libcurl has no timer for the last byte sent; the upload is counted towards the first byte.
+    auto const sent = transfer_time(handle, CURLINFO_PRETRANSFER_TIME_T);
+#endif
+    auto const first_byte = std::max(transfer_time(handle, CURLINFO_STARTTRANSFER_TIME_T), sent);
+    auto const total = std::max(transfer_time(handle, CURLINFO_TOTAL_TIME_T), first_byte);
+    timings.send = sent;
+    timings.first_byte = first_byte - sent;
+    timings.body = total - first_byte;
+}
+
 class CurlSlistDeleter {
   public:
     void operator()(curl_slist* list) const {
@@ -189,7 +214,10 @@ CurlHttpClient::~CurlHttpClient() {
 HttpResponse CurlHttpClient::send(HttpRequest const& request) {
     ensure_curl_global_init();
 
+    HttpTimings timings;
+    auto const waiting = std::chrono::steady_clock::now();
     auto lease = impl_->acquire_handle();
+    timings.connection_wait = std::chrono::steady_clock::now() - waiting;
     CURL* handle = lease.get();
     if (!handle) {
         throw CurlException(ErrorCode::CurlHandleNotInitialized, "CURL handle is not initialized", "acquire_handle");
@@ -280,8 +308,9 @@ HttpResponse CurlHttpClient::send(HttpRequest const& request) {
     }
 
     curl_easy_setopt(handle, CURLOPT_HTTPHEADER, nullptr);
+    fill_transfer_timings(handle, timings);
 
-    return HttpResponse{status_code, std::move(response_body), std::move(response_headers)};
+    return HttpResponse{status_code, std::move(response_body), std::move(response_headers), timings};
 }
 
 HttpClientPtr create_default_http_client() {
@@ -0,0 +1,489 @@
+#include "alpaca/Indicators.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "alpaca/Exceptions.hpp"
+
+namespace alpaca::indicators {
+namespace {
+constexpr double kMicroScale = static_cast<double>(Money::kScale);
+
+void validate_period(std::size_t period) {
+    if (period == 0) {
+        throw InvalidArgumentException("period", "indicator period must be greater than zero");
+    }
+}
+
+double rsi_from_averages(double average_gain, double average_loss) {
+    if (average_loss == 0.0) {
+        return average_gain == 0.0 ? 50.0 : 100.0;
+    }
+    return 100.0 - 100.0 / (1.0 + average_gain / average_loss);
+}
+
+double typical_price(std::int64_t high, std::int64_t low, std::int64_t close) {
+    return static_cast<double>(high + low + close) / (3.0 * kMicroScale);
+}
+
+/// Welford's update for adding the `count`-th value to a running mean and sum of squared deviations.
+void welford_add(double& mean, double& m2, double value, double count) {
+    double const delta = value - mean;
+    mean += delta / count;
+    m2 += delta * (value - mean);
+}
+
+/// Welford's update for sliding a full window of `count` values: `expired` leaves and `value` enters.
+void welford_replace(double& mean, double& m2, double expired, double value, double count) {
+    double const previous_mean = mean;
+    mean += (value - expired) / count;
+    m2 += (value - expired) * (value - mean + expired - previous_mean);
+}
+
+std::int64_t true_range(std::int64_t high, std::int64_t low, std::int64_t previous_close) {
+    std::int64_t const range = high - low;
+    std::int64_t const up = high > previous_close ? high - previous_close : previous_close - high;
+    std::int64_t const down = low > previous_close ? low - previous_close : previous_close - low;
+    return std::max(range, std::max(up, down));
+}
+} // namespace
+
+std::vector<double> to_prices(std::span<std::int64_t const> micro_units) {
+    std::vector<double> prices(micro_units.size());
+    for (std::size_t i = 0; i < micro_units.size(); ++i) {
+        prices[i] = static_cast<double>(micro_units[i]) / kMicroScale;
+    }
+    return prices;
+}
+
+std::vector<double> sma(std::span<double const> values, std::size_t period) {
+    validate_period(period);
+    std::vector<double> out(values.size(), kWarmup);
+    if (values.size() < period) {
+        return out;
+    }
+    double sum = 0.0;
+    for (std::size_t i = 0; i < period; ++i) {
+        sum += values[i];
+    }
+    double const count = static_cast<double>(period);
+    out[period - 1] = sum / count;
+    for (std::size_t i = period; i < values.size(); ++i) {
+        if ((i + 1) % period == 0) {
+            // Start again from the window so the rounding of each slide does not accumulate.
+            sum = 0.0;
+            for (std::size_t j = i + 1 - period; j <= i; ++j) {
+                sum += values[j];
+            }
+        } else {
+            sum += values[i] - values[i - period];
+        }
+        out[i] = sum / count;
+    }
+    return out;
+}
+
+std::vector<double> sma(std::span<std::int64_t const> micro_units, std::size_t period) {
+    validate_period(period);
+    std::vector<double> out(micro_units.size(), kWarmup);
+    if (micro_units.size() < period) {
+        return out;
+    }
+    std::int64_t sum = 0;
+    for (std::size_t i = 0; i < period; ++i) {
+        sum += micro_units[i];
+    }
+    double const divisor = static_cast<double>(period) * kMicroScale;
+    out[period - 1] = static_cast<double>(sum) / divisor;
+    for (std::size_t i = period; i < micro_units.size(); ++i) {
+        sum += micro_units[i] - micro_units[i - period];
+        out[i] = static_cast<double>(sum) / divisor;
+    }
+    return out;
+}
+
+std::vector<double> ema(std::span<double const> values, std::size_t period) {
+    validate_period(period);
+    std::vector<double> out(values.size(), kWarmup);
+    if (values.size() < period) {
+        return out;
+    }
+    double const alpha = 2.0 / (static_cast<double>(period) + 1.0);
+    double seed = 0.0;
+    for (std::size_t i = 0; i < period; ++i) {
+        seed += values[i];
+    }
+    double value = seed / static_cast<double>(period);
+    out[period - 1] = value;
+    for (std::size_t i = period; i < values.size(); ++i) {
+        value += alpha * (values[i] - value);
+        out[i] = value;
+    }
+    return out;
+}
+
+std::vector<double> ema(std::span<std::int64_t const> micro_units, std::size_t period) {
+    auto const prices = to_prices(micro_units);
+    return ema(std::span<double const>(prices), period);
+}
+
+std::vector<double> rolling_stddev(std::span<double const> values, std::size_t period) {
+    validate_period(period);
+    std::vector<double> out(values.size(), kWarmup);
+    if (values.size() < period) {
+        return out;
+    }
+    double mean = 0.0;
+    double m2 = 0.0;
+    for (std::size_t i = 0; i < period; ++i) {
+        welford_add(mean, m2, values[i], static_cast<double>(i + 1));
+    }
+    double const count = static_cast<double>(period);
+    out[period - 1] = std::sqrt(std::max(0.0, m2 / count));
+    for (std::size_t i = period; i < values.size(); ++i) {
+        welford_replace(mean, m2, values[i - period], values[i], count);
+        out[i] = std::sqrt(std::max(0.0, m2 / count));
+    }
+    return out;
+}
+
+std::vector<double> rolling_stddev(std::span<std::int64_t const> micro_units, std::size_t period) {
+    auto const prices = to_prices(micro_units);
+    return rolling_stddev(std::span<double const>(prices), period);
+}
+
+std::vector<double> rsi(std::span<double const> values, std::size_t period) {
+    validate_period(period);
+    std::vector<double> out(values.size(), kWarmup);
+    if (values.size() <= period) {
+        return out;
+    }
+
+    // Gains and losses are independent per element; only Wilder's recurrence carries state.
+    std::size_t const changes = values.size() - 1;
+    std::vector<double> gains(changes);
+    std::vector<double> losses(changes);
+    for (std::size_t i = 0; i < changes; ++i) {
+        double const delta = values[i + 1] - values[i];
+        gains[i] = std::max(delta, 0.0);
+        losses[i] = std::max(-delta, 0.0);
+    }
+
+    double gain_sum = 0.0;
+    double loss_sum = 0.0;
+    for (std::size_t i = 0; i < period; ++i) {
+        gain_sum += gains[i];
+        loss_sum += losses[i];
+    }
+    double const count = static_cast<double>(period);
+    double average_gain = gain_sum / count;
+    double average_loss = loss_sum / count;
+    out[period] = rsi_from_averages(average_gain, average_loss);
+    for (std::size_t i = period; i < changes; ++i) {
+        average_gain = (average_gain * (count - 1.0) + gains[i]) / count;
+        average_loss = (average_loss * (count - 1.0) + losses[i]) / count;
+        out[i + 1] = rsi_from_averages(average_gain, average_loss);
+    }
+    return out;
+}
+
+std::vector<double> rsi(std::span<std::int64_t const> micro_units, std::size_t period) {
+    auto const prices = to_prices(micro_units);
+    return rsi(std::span<double const>(prices), period);
+}
+
+std::vector<double> vwap(BarSeries const& series) {
+    auto const highs = series.highs();
+    auto const lows = series.lows();
+    auto const closes = series.closes();
+    auto const volumes = series.volumes();
+
+    std::vector<double> out(series.size(), kWarmup);
+    double price_volume = 0.0;
+    double volume = 0.0;
+    for (std::size_t i = 0; i < series.size(); ++i) {
+        double const bar_volume = static_cast<double>(volumes[i]);
+        price_volume += typical_price(highs[i], lows[i], closes[i]) * bar_volume;
+        volume += bar_volume;
+        out[i] = volume > 0.0 ? price_volume / volume : kWarmup;
+    }
+    return out;
+}
+
+std::vector<double> atr(BarSeries const& series, std::size_t period) {
+    validate_period(period);
+    auto const highs = series.highs();
+    auto const lows = series.lows();
+    auto const closes = series.closes();
+
+    std::vector<double> out(series.size(), kWarmup);
+    if (series.size() < period) {
+        return out;
+    }
+
+    std::vector<double> ranges(series.size());
+    ranges[0] = static_cast<double>(highs[0] - lows[0]) / kMicroScale;
+    for (std::size_t i = 1; i < series.size(); ++i) {
+        ranges[i] = static_cast<double>(true_range(highs[i], lows[i], closes[i - 1])) / kMicroScale;
+    }
+
+    double const count = static_cast<double>(period);
+    double seed = 0.0;
+    for (std::size_t i = 0; i < period; ++i) {
+        seed += ranges[i];
+    }
+    double value = seed / count;
+    out[period - 1] = value;
+    for (std::size_t i = period; i < series.size(); ++i) {
+        value = (value * (count - 1.0) + ranges[i]) / count;
+        out[i] = value;
+    }
+    return out;
+}
+
+SimpleMovingAverage::SimpleMovingAverage(std::size_t period) : period_(period) {
+    validate_period(period_);
+}
+
+std::optional<double> SimpleMovingAverage::update(double value) {
+    use_input(Input::Double);
+    if (count_ == period_) {
+        sum_ += value - window_[head_];
+    } else {
+        sum_ += value;
+    }
+    window_[head_] = value;
+    if (advance() && count_ == period_) {
+        // Matches the batch kernel, which starts again from the window every `period` values.
+        sum_ = 0.0;
+        for (double const held : window_) {
+            sum_ += held;
+        }
+    }
+    return this->value();
+}
+
+std::optional<double> SimpleMovingAverage::update(Money value) {
+    use_input(Input::Micro);
+    std::int64_t const micro_units = value.raw();
+    if (count_ == period_) {
+        micro_sum_ += micro_units - micro_window_[head_];
+    } else {
+        micro_sum_ += micro_units;
+    }
+    micro_window_[head_] = micro_units;
+    advance();
+    return this->value();
+}
+
+void SimpleMovingAverage::use_input(Input input) {
+    if (input_ == input) {
+        return;
+    }
+    if (input_ != Input::None) {
+        throw InvalidArgumentException("value", "moving average takes either double or Money values until reset");
+    }
+    input_ = input;
+    if (input == Input::Double) {
+        window_.assign(period_, 0.0);
+    } else {
+        micro_window_.assign(period_, 0);
+    }
+}
+
+bool SimpleMovingAverage::advance() noexcept {
+    if (count_ < period_) {
+        ++count_;
+    }
+    if (++head_ == period_) {
+        head_ = 0;
+        return true;
+    }
+    return false;
+}
+
+std::optional<double> SimpleMovingAverage::value() const {
+    if (count_ < period_) {
+        return std::nullopt;
+    }
+    if (input_ == Input::Micro) {
+        return static_cast<double>(micro_sum_) / (static_cast<double>(period_) * kMicroScale);
+    }
+    return sum_ / static_cast<double>(period_);
+}
+
+void SimpleMovingAverage::reset() {
+    input_ = Input::None;
+    window_.clear();
+    micro_window_.clear();
+    head_ = 0;
+    count_ = 0;
+    sum_ = 0.0;
+    micro_sum_ = 0;
+}
+
+ExponentialMovingAverage::ExponentialMovingAverage(std::size_t period)
+  : period_(period), alpha_(2.0 / (static_cast<double>(period) + 1.0)) {
+    validate_period(period_);
+}
+
+std::optional<double> ExponentialMovingAverage::update(double value) {
+    if (count_ < period_) {
+        seed_sum_ += value;
+        ++count_;
+        if (count_ == period_) {
+            value_ = seed_sum_ / static_cast<double>(period_);
+        }
+    } else {
+        value_ += alpha_ * (value - value_);
+    }
+    return this->value();
+}
+
+std::optional<double> ExponentialMovingAverage::value() const {
+    if (count_ < period_) {
+        return std::nullopt;
+    }
+    return value_;
+}
+
+void ExponentialMovingAverage::reset() {
+    count_ = 0;
+    seed_sum_ = 0.0;
+    value_ = 0.0;
+}
+
+RollingStdDev::RollingStdDev(std::size_t period) : period_(period) {
+    validate_period(period_);
+    window_.assign(period_, 0.0);
+}
+
+std::optional<double> RollingStdDev::update(double value) {
+    if (count_ == period_) {
+        welford_replace(mean_, m2_, window_[head_], value, static_cast<double>(period_));
+    } else {
+        ++count_;
+        welford_add(mean_, m2_, value, static_cast<double>(count_));
+    }
+    window_[head_] = value;
+    head_ = (head_ + 1) % period_;
+    return this->value();
+}
+
+std::optional<double> RollingStdDev::value() const {
+    if (count_ < period_) {
+        return std::nullopt;
+    }
+    return std::sqrt(std::max(0.0, m2_ / static_cast<double>(period_)));
+}
+
+void RollingStdDev::reset() {
+    std::fill(window_.begin(), window_.end(), 0.0);
+    head_ = 0;
+    count_ = 0;
+    mean_ = 0.0;
+    m2_ = 0.0;
+}
+
+RelativeStrengthIndex::RelativeStrengthIndex(std::size_t period) : period_(period) {
+    validate_period(period_);
+}
+
+std::optional<double> RelativeStrengthIndex::update(double value) {
+    if (count_ == 0) {
+        previous_ = value;
+        ++count_;
+        return std::nullopt;
+    }
+    double const delta = value - previous_;
+    previous_ = value;
+    double const gain = std::max(delta, 0.0);
+    double const loss = std::max(-delta, 0.0);
+    double const count = static_cast<double>(period_);
+    if (count_ <= period_) {
+        // Accumulate the seed sums in the averages until the first `period` changes have been observed.
+        average_gain_ += gain;
+        average_loss_ += loss;
+        ++count_;
+        if (count_ == period_ + 1) {
+            average_gain_ /= count;
+            average_loss_ /= count;
+        }
+    } else {
+        average_gain_ = (average_gain_ * (count - 1.0) + gain) / count;
+        average_loss_ = (average_loss_ * (count - 1.0) + loss) / count;
+    }
+    return this->value();
+}
+
+std::optional<double> RelativeStrengthIndex::value() const {
+    if (count_ <= period_) {
+        return std::nullopt;
+    }
+    return rsi_from_averages(average_gain_, average_loss_);
+}
+
+void RelativeStrengthIndex::reset() {
+    count_ = 0;
+    previous_ = 0.0;
+    average_gain_ = 0.0;
+    average_loss_ = 0.0;
+}
+
+std::optional<double> VolumeWeightedAveragePrice::update(StockBar const& bar) {
+    double const volume = static_cast<double>(bar.volume);
+    price_volume_ += typical_price(bar.high.raw(), bar.low.raw(), bar.close.raw()) * volume;
+    volume_ += volume;
+    return value();
+}
+
+std::optional<double> VolumeWeightedAveragePrice::value() const {
+    if (volume_ <= 0.0) {
+        return std::nullopt;
+    }
+    return price_volume_ / volume_;
+}
+
+void VolumeWeightedAveragePrice::reset() {
+    price_volume_ = 0.0;
+    volume_ = 0.0;
+}
+
+AverageTrueRange::AverageTrueRange(std::size_t period) : period_(period) {
+    validate_period(period_);
+}
+
+std::optional<double> AverageTrueRange::update(StockBar const& bar) {
+    std::int64_t const high = bar.high.raw();
+    std::int64_t const low = bar.low.raw();
+    std::int64_t const range = count_ == 0 ? high - low : true_range(high, low, previous_close_);
+    previous_close_ = bar.close.raw();
+
+    double const tr = static_cast<double>(range) / kMicroScale;
+    double const count = static_cast<double>(period_);
+    if (count_ < period_) {
+        value_ += tr;
+        ++count_;
+        if (count_ == period_) {
+            value_ /= count;
+        }
+    } else {
+        value_ = (value_ * (count - 1.0) + tr) / count;
+    }
+    return value();
+}
+
+std::optional<double> AverageTrueRange::value() const {
+    if (count_ < period_) {
+        return std::nullopt;
+    }
+    return value_;
+}
+
+void AverageTrueRange::reset() {
+    count_ = 0;
+    previous_close_ = 0;
+    value_ = 0.0;
+}
+
+} // namespace alpaca::indicators
@@ -4,6 +4,7 @@
 #include <cctype>
 #include <optional>
 #include <string_view>
+#include <thread>
 #include <type_traits>
 #include <utility>
 
@@ -316,12 +317,46 @@ StockBars MarketDataClient::get_stock_bars(std::string const& symbol, StockBarsR
 
 std::vector<StockBar> MarketDataClient::get_all_stock_bars(std::string const& symbol, StockBarsRequest request) const {
     std::vector<StockBar> all_bars;
+    if (request.limit.has_value() && *request.limit > 0) {
+        all_bars.reserve(static_cast<std::size_t>(*request.limit));
+    }
     for (auto const& bar : stock_bars_range(symbol, std::move(request))) {
         all_bars.push_back(bar);
     }
     return all_bars;
 }
 
+BarSeries MarketDataClient::get_stock_bar_series(std::string const& symbol, StockBarsRequest request) const {
+    BarSeries series;
+    if (request.limit.has_value() && *request.limit > 0) {
+        series.reserve(static_cast<std::size_t>(*request.limit));
+    }
+    while (true) {
+        auto effective = prepare_stock_request(request, stock_data_plan_, stock_data_feed_);
+        Json page;
+        try {
+            page = v2_client_.get<Json>("stocks/" + symbol + "/bars", effective.to_query_params());
+        } catch (Exception const& ex) {
+            if (auto retry = ex.retry_after()) {
+                std::this_thread::sleep_for(*retry);
+                continue;
+            }
+            throw;
+        }
+        if (page.contains("bars")) {
+            series.append_json(page.at("bars"));
+        }
+        auto next = page.contains("next_page_token") && !page.at("next_page_token").is_null()
+                    ? std::optional<std::string>(page.at("next_page_token").get<std::string>())
+                    : std::nullopt;
+        if (!next.has_value()) {
+            break;
+        }
+        request.page_token = std::move(next);
+    }
+    return series;
+}
+
 StockSnapshot MarketDataClient::get_stock_snapshot(std::string const& symbol) const {
     QueryParams params{
         {"feed", stock_data_feed_}
@@ -0,0 +1,208 @@
+#include "alpaca/OrderLatencyTracer.hpp"
+
+#include <algorithm>
+#include <utility>
+#include <variant>
+
+#include "alpaca/models/OrderStatus.hpp"
+
+namespace alpaca {
+
+namespace {
+Json optional_nanoseconds(std::optional<std::chrono::nanoseconds> const& value) {
+    return value ? Json(value->count()) : Json(nullptr);
+}
+} // namespace
+
+std::string to_string(OrderStage stage) {
+    switch (stage) {
+    case OrderStage::Serialize:
+        return "serialize";
+    case OrderStage::RateLimitWait:
+        return "rate_limit_wait";
+    case OrderStage::ConnectionAcquire:
+        return "connection_acquire";
+    case OrderStage::Send:
+        return "send";
+    case OrderStage::FirstByte:
+        return "first_byte";
+    case OrderStage::BodyComplete:
+        return "body_complete";
+    case OrderStage::Decode:
+        return "decode";
+    case OrderStage::Response:
+        return "response";
+    case OrderStage::Accepted:
+        return "accepted";
+    case OrderStage::Filled:
+        return "filled";
+    }
+    return "unknown";
+}
+
+void to_json(Json& j, OrderTrace const& trace) {
+    j = Json{
+        {"client_order_id",       trace.client_order_id                   },
+        {"order_id",              trace.order_id                          },
+        {"symbol",                trace.symbol                            },
+        {"started_at",            format_timestamp(trace.started_at)      },
+        {"serialize_ns",          trace.serialize.count()                 },
+        {"rate_limit_wait_ns",    trace.rate_limit_wait.count()           },
+        {"connection_acquire_ns", trace.connection_acquire.count()        },
+        {"send_ns",               trace.send.count()                      },
+        {"first_byte_ns",         trace.first_byte.count()                },
+        {"body_complete_ns",      trace.body_complete.count()             },
+        {"decode_ns",             trace.decode.count()                    },
+        {"response_ns",           trace.response.count()                  },
+        {"accepted_ns",           optional_nanoseconds(trace.accepted)    },
+        {"filled_ns",             optional_nanoseconds(trace.filled)      },
+        {"attempts",              trace.attempts                          },
+        {"error",                 trace.error                             }
+    };
+}
+
+OrderLatencyTracer::OrderLatencyTracer() : OrderLatencyTracer(Options{}) {}
+
+OrderLatencyTracer::OrderLatencyTracer(Options options) : options_(options) {}
+
+void OrderLatencyTracer::record_stage(OrderStage stage, std::chrono::nanoseconds value) noexcept {
+    histograms_[static_cast<std::size_t>(stage)].record(value);
+}
+
+void OrderLatencyTracer::record(OrderTrace trace, Clock::time_point started) {
+    record_stage(OrderStage::Serialize, trace.serialize);
+    record_stage(OrderStage::RateLimitWait, trace.rate_limit_wait);
+    if (trace.attempts > 0) {
+        record_stage(OrderStage::ConnectionAcquire, trace.connection_acquire);
+        record_stage(OrderStage::Send, trace.send);
+        record_stage(OrderStage::FirstByte, trace.first_byte);
+        record_stage(OrderStage::BodyComplete, trace.body_complete);
+    }
+    if (trace.error.empty()) {
+        record_stage(OrderStage::Decode, trace.decode);
+        record_stage(OrderStage::Response, trace.response);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto const client_order_id = trace.client_order_id;
+    bool const awaiting_events = trace.error.empty() && !client_order_id.empty();
+    Pending pending{started, first_sequence_ + recent_.size(), false};
+    recent_.push_back(std::move(trace));
+    while (recent_.size() > options_.recent_capacity) {
+        recent_.pop_front();
+        ++first_sequence_;
+    }
+    if (!awaiting_events) {
+        return;
+    }
+
+    if (auto const it = early_.find(client_order_id); it != early_.end()) {
+        auto const early = it->second;
+        early_.erase(it);
+        if (early.accepted) {
+            static_cast<void>(resolve_locked(pending, false, *early.accepted));
+        }
+        if (early.filled && resolve_locked(pending, true, *early.filled)) {
+            return;
+        }
+    }
+    remember_pending_locked(client_order_id, pending);
+}
+
+bool OrderLatencyTracer::resolve_locked(Pending& pending, bool fill, Clock::time_point at) {
+    auto const elapsed = std::max(std::chrono::nanoseconds{0}, at - pending.started);
+    OrderTrace* trace = nullptr;
+    if (pending.sequence >= first_sequence_ && pending.sequence - first_sequence_ < recent_.size()) {
+        trace = &recent_[pending.sequence - first_sequence_];
+    }
+    if (!fill) {
+        if (!pending.accepted) {
+            pending.accepted = true;
+            record_stage(OrderStage::Accepted, elapsed);
+            if (trace != nullptr) {
+                trace->accepted = elapsed;
+            }
+        }
+        return false;
+    }
+    record_stage(OrderStage::Filled, elapsed);
+    if (trace != nullptr) {
+        trace->filled = elapsed;
+    }
+    return true;
+}
+
+void OrderLatencyTracer::remember_pending_locked(std::string const& client_order_id, Pending pending) {
+    pending_.insert_or_assign(client_order_id, pending);
+    pending_order_.push_back(client_order_id);
+    while (pending_order_.size() > options_.pending_capacity) {
+        pending_.erase(pending_order_.front());
+        pending_order_.pop_front();
+    }
+}
+
+void OrderLatencyTracer::remember_early_locked(std::string const& client_order_id, bool fill, Clock::time_point at) {
+    auto [it, inserted] = early_.try_emplace(client_order_id);
+    auto& slot = fill ? it->second.filled : it->second.accepted;
+    if (!slot) {
+        slot = at;
+    }
+    if (inserted) {
+        early_order_.push_back(client_order_id);
+        while (early_order_.size() > options_.pending_capacity) {
+            early_.erase(early_order_.front());
+            early_order_.pop_front();
+        }
+    }
+}
+
+void OrderLatencyTracer::apply(streaming::OrderUpdateMessage const& update) {
+    bool const fill = update.event == "fill" || update.event == "partial_fill";
+    bool const accepted = update.event == "new";
+    bool const closed = is_terminal(update.order.status);
+    auto const& client_order_id = update.order.client_order_id;
+    if ((!fill && !accepted && !closed) || client_order_id.empty()) {
+        return;
+    }
+    auto const at = Clock::now();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto const it = pending_.find(client_order_id);
+    if (it == pending_.end()) {
+        if (fill || accepted) {
+            remember_early_locked(client_order_id, fill, at);
+        }
+        return;
+    }
+    bool const done = (fill || accepted) && resolve_locked(it->second, fill, at);
+    if (done || closed) {
+        pending_.erase(it);
+    }
+}
+
+streaming::MessageHandler OrderLatencyTracer::handler(streaming::MessageHandler next) {
+    return [this, next = std::move(next)](streaming::StreamMessage const& message,
+                                          streaming::MessageCategory category) {
+        if (auto const* update = std::get_if<streaming::OrderUpdateMessage>(&message)) {
+            apply(*update);
+        }
+        if (next) {
+            next(message, category);
+        }
+    };
+}
+
+void OrderLatencyTracer::attach(streaming::WebSocketClient& client, streaming::MessageHandler next) {
+    client.set_message_handler(handler(std::move(next)));
+}
+
+streaming::HistogramSnapshot OrderLatencyTracer::histogram(OrderStage stage) const {
+    return histograms_[static_cast<std::size_t>(stage)].snapshot();
+}
+
+std::vector<OrderTrace> OrderLatencyTracer::recent() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return {recent_.begin(), recent_.end()};
+}
+
+} // namespace alpaca
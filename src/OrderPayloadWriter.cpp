@@ -0,0 +1,231 @@
+#include "alpaca/OrderPayloadWriter.hpp"
+
+#include <charconv>
+#include <iterator>
+#include <optional>
+#include <vector>
+
+#include "alpaca/Json.hpp"
+#include "alpaca/internal/JsonWriter.hpp"
+
+namespace alpaca {
+namespace {
+/// Large enough for a bracket order with long client order ids; the buffer grows if a payload needs more.
+constexpr std::size_t kInitialBufferCapacity = 512;
+} // namespace
+
+namespace detail {
+
+std::string& payload_buffer() {
+    thread_local std::string buffer = []() {
+        std::string initial;
+        initial.reserve(kInitialBufferCapacity);
+        return initial;
+    }();
+    buffer.clear();
+    return buffer;
+}
+
+void append_string(std::string& out, std::string_view value) {
+    for (char const ch : value) {
+        if (static_cast<unsigned char>(ch) >= 0x80) {
+            // Non-ASCII text is rare in order fields; let the Json serialiser validate the UTF-8 so invalid input
+            // fails exactly as it did before.
+            out.append(Json(std::string(value)).dump());
+            return;
+        }
+    }
+
+    static constexpr char kHex[] = "0123456789abcdef";
+    out.push_back('"');
+    std::size_t run_start = 0;
+    for (std::size_t i = 0; i < value.size(); ++i) {
+        auto const ch = static_cast<unsigned char>(value[i]);
+        if (ch >= 0x20 && ch != '"' && ch != '\\') {
+            continue;
+        }
+        out.append(value.data() + run_start, i - run_start);
+        run_start = i + 1;
+        switch (ch) {
+        case '"':
+            out.append("\\\"");
+            break;
+        case '\\':
+            out.append("\\\\");
+            break;
+        case '\b':
+            out.append("\\b");
+            break;
+        case '\f':
+            out.append("\\f");
+            break;
+        case '\n':
+            out.append("\\n");
+            break;
+        case '\r':
+            out.append("\\r");
+            break;
+        case '\t':
+            out.append("\\t");
+            break;
+        default:
+            out.append("\\u00");
+            out.push_back(kHex[ch >> 4]);
+            out.push_back(kHex[ch & 0x0F]);
+            break;
+        }
+    }
+    out.append(value.data() + run_start, value.size() - run_start);
+    out.push_back('"');
+}
+
+void append_key(std::string& out, bool& first, std::string_view key) {
+    if (!first) {
+        out.push_back(',');
+    }
+    first = false;
+    out.push_back('"');
+    out.append(key);
+    out.append("\":");
+}
+
+void append_member(std::string& out, bool& first, std::string_view key, std::string_view value) {
+    append_key(out, first, key);
+    append_string(out, value);
+}
+
+void append_optional_member(std::string& out, bool& first, std::string_view key,
+                            std::optional<std::string> const& value) {
+    if (value.has_value()) {
+        append_member(out, first, key, *value);
+    }
+}
+
+void append_member(std::string& out, bool& first, std::string_view key, bool value) {
+    append_key(out, first, key);
+    out.append(value ? "true" : "false");
+}
+
+void append_member(std::string& out, bool& first, std::string_view key, int value) {
+    append_key(out, first, key);
+    char digits[16];
+    auto const result = std::to_chars(std::begin(digits), std::end(digits), value);
+    out.append(digits, result.ptr);
+}
+
+void append_legs(std::string& out, bool& first, std::vector<OptionLeg> const& legs) {
+    append_key(out, first, "legs");
+    out.push_back('[');
+    for (std::size_t i = 0; i < legs.size(); ++i) {
+        if (i > 0) {
+            out.push_back(',');
+        }
+        auto const& leg = legs[i];
+        bool leg_first = true;
+        out.push_back('{');
+        append_member(out, leg_first, "position_intent", to_string(leg.intent));
+        append_member(out, leg_first, "ratio", leg.ratio);
+        append_member(out, leg_first, "side", to_string(leg.side));
+        append_member(out, leg_first, "symbol", leg.symbol);
+        out.push_back('}');
+    }
+    out.push_back(']');
+}
+
+void append_stop_loss(std::string& out, bool& first, StopLossParams const& stop_loss) {
+    append_key(out, first, "stop_loss");
+    if (!stop_loss.stop_price.has_value() && !stop_loss.limit_price.has_value()) {
+        // An empty Json value serialises as null rather than as an empty object.
+        out.append("null");
+        return;
+    }
+    bool inner_first = true;
+    out.push_back('{');
+    append_optional_member(out, inner_first, "limit_price", stop_loss.limit_price);
+    append_optional_member(out, inner_first, "stop_price", stop_loss.stop_price);
+    out.push_back('}');
+}
+
+void append_take_profit(std::string& out, bool& first, TakeProfitParams const& take_profit) {
+    append_key(out, first, "take_profit");
+    bool inner_first = true;
+    out.push_back('{');
+    append_member(out, inner_first, "limit_price", take_profit.limit_price);
+    out.push_back('}');
+}
+
+} // namespace detail
+
+// Json objects keep their keys sorted, so the members below are written in lexicographic key order.
+
+void append_order_payload(std::string& out, NewOrderRequest const& request) {
+    using namespace detail;
+    bool first = true;
+    out.push_back('{');
+    append_optional_member(out, first, "client_order_id", request.client_order_id);
+    if (request.extended_hours) {
+        append_member(out, first, "extended_hours", true);
+    }
+    append_optional_member(out, first, "high_water_mark", request.high_water_mark);
+    if (!request.legs.empty()) {
+        append_legs(out, first, request.legs);
+    }
+    append_optional_member(out, first, "limit_price", request.limit_price);
+    append_optional_member(out, first, "notional", request.notional);
+    if (request.order_class.has_value()) {
+        append_member(out, first, "order_class", to_string(*request.order_class));
+    }
+    if (request.position_intent.has_value()) {
+        append_member(out, first, "position_intent", to_string(*request.position_intent));
+    }
+    append_optional_member(out, first, "qty", request.quantity);
+    append_member(out, first, "side", to_string(request.side));
+    if (request.stop_loss.has_value()) {
+        append_stop_loss(out, first, *request.stop_loss);
+    }
+    append_optional_member(out, first, "stop_price", request.stop_price);
+    append_member(out, first, "symbol", request.symbol);
+    if (request.take_profit.has_value()) {
+        append_take_profit(out, first, *request.take_profit);
+    }
+    append_member(out, first, "time_in_force", to_string(request.time_in_force));
+    append_optional_member(out, first, "trail_percent", request.trail_percent);
+    append_optional_member(out, first, "trail_price", request.trail_price);
+    append_member(out, first, "type", to_string(request.type));
+    out.push_back('}');
+}
+
+void append_order_payload(std::string& out, ReplaceOrderRequest const& request) {
+    using namespace detail;
+    auto const start = out.size();
+    bool first = true;
+    out.push_back('{');
+    append_optional_member(out, first, "client_order_id", request.client_order_id);
+    if (request.extended_hours.has_value()) {
+        append_member(out, first, "extended_hours", *request.extended_hours);
+    }
+    append_optional_member(out, first, "limit_price", request.limit_price);
+    append_optional_member(out, first, "qty", request.quantity);
+    append_optional_member(out, first, "stop_price", request.stop_price);
+    append_optional_member(out, first, "time_in_force", request.time_in_force);
+    if (first) {
+        out.resize(start);
+        out.append("null");
+        return;
+    }
+    out.push_back('}');
+}
+
+std::string_view format_order_payload(NewOrderRequest const& request) {
+    auto& buffer = detail::payload_buffer();
+    append_order_payload(buffer, request);
+    return buffer;
+}
+
+std::string_view format_order_payload(ReplaceOrderRequest const& request) {
+    auto& buffer = detail::payload_buffer();
+    append_order_payload(buffer, request);
+    return buffer;
+}
+
+} // namespace alpaca
@@ -0,0 +1,123 @@
+#include "alpaca/OrderTemplate.hpp"
+
+#include <utility>
+
+#include "alpaca/Exceptions.hpp"
+#include "alpaca/internal/JsonWriter.hpp"
+
+namespace alpaca {
+
+namespace {
+/// Appends a fragment of `,"key":value` members, dropping the leading comma
+/// when it opens the object.
+void append_fragment(std::string& out, bool& first, std::string const& fragment) {
+    if (fragment.empty()) {
+        return;
+    }
+    out.append(fragment, first ? 1 : 0);
+    first = false;
+}
+} // namespace
+
+OrderTemplate::OrderTemplate(NewOrderRequest request) : request_(std::move(request)) {
+    request_.quantity.reset();
+    request_.limit_price.reset();
+    request_.client_order_id.reset();
+
+    if (request_.symbol.empty()) {
+        throw InvalidArgumentException("symbol", "Order templates require a symbol");
+    }
+    if ((request_.type == OrderType::STOP || request_.type == OrderType::STOP_LIMIT) && !request_.stop_price) {
+        throw InvalidArgumentException("stop_price", "Stop orders require a stop price");
+    }
+    if (request_.type == OrderType::TRAILING_STOP && !request_.trail_price && !request_.trail_percent) {
+        throw InvalidArgumentException("trail_price", "Trailing stop orders require a trail price or percent");
+    }
+    if (request_.order_class == OrderClass::BRACKET && (!request_.take_profit || !request_.stop_loss)) {
+        throw InvalidArgumentException("order_class", "Bracket orders require take profit and stop loss legs");
+    }
+    if ((request_.order_class == OrderClass::ONE_CANCELS_OTHER ||
+         request_.order_class == OrderClass::ONE_TRIGGERS_OTHER) &&
+        !request_.take_profit && !request_.stop_loss) {
+        throw InvalidArgumentException("order_class", "OCO and OTO orders require a take profit or stop loss leg");
+    }
+    for (auto const& leg : request_.legs) {
+        if (leg.symbol.empty() || leg.ratio <= 0) {
+            throw InvalidArgumentException("legs", "Order legs require a symbol and a positive ratio");
+        }
+    }
+    limit_priced_ = request_.type == OrderType::LIMIT || request_.type == OrderType::STOP_LIMIT;
+    notional_sized_ = request_.notional.has_value();
+
+    // Every fragment is written as if a member came before it; the leading comma is dropped when none does.
+    using namespace detail;
+    bool first = false;
+    if (request_.extended_hours) {
+        append_member(after_client_order_id_, first, "extended_hours", true);
+    }
+    append_optional_member(after_client_order_id_, first, "high_water_mark", request_.high_water_mark);
+    if (!request_.legs.empty()) {
+        append_legs(after_client_order_id_, first, request_.legs);
+    }
+
+    append_optional_member(after_limit_price_, first, "notional", request_.notional);
+    if (request_.order_class.has_value()) {
+        append_member(after_limit_price_, first, "order_class", to_string(*request_.order_class));
+    }
+    if (request_.position_intent.has_value()) {
+        append_member(after_limit_price_, first, "position_intent", to_string(*request_.position_intent));
+    }
+
+    append_member(after_qty_, first, "side", to_string(request_.side));
+    if (request_.stop_loss.has_value()) {
+        append_stop_loss(after_qty_, first, *request_.stop_loss);
+    }
+    append_optional_member(after_qty_, first, "stop_price", request_.stop_price);
+    append_member(after_qty_, first, "symbol", request_.symbol);
+    if (request_.take_profit.has_value()) {
+        append_take_profit(after_qty_, first, *request_.take_profit);
+    }
+    append_member(after_qty_, first, "time_in_force", to_string(request_.time_in_force));
+    append_optional_member(after_qty_, first, "trail_percent", request_.trail_percent);
+    append_optional_member(after_qty_, first, "trail_price", request_.trail_price);
+    append_member(after_qty_, first, "type", to_string(request_.type));
+}
+
+void OrderTemplate::validate(Fields const& fields) const {
+    if (fields.qty.empty() != notional_sized_) {
+        throw InvalidArgumentException(
+            "qty", notional_sized_ ? "Notional order templates take no quantity" : "Orders require a quantity");
+    }
+    if (fields.limit_price.empty() == limit_priced_) {
+        throw InvalidArgumentException("limit_price", limit_priced_ ? "Limit orders require a limit price"
+                                                                    : "Only limit orders take a limit price");
+    }
+}
+
+void OrderTemplate::append(std::string& out, Fields const& fields) const {
+    validate(fields);
+    using namespace detail;
+    bool first = true;
+    out.push_back('{');
+    if (!fields.client_order_id.empty()) {
+        append_member(out, first, "client_order_id", fields.client_order_id);
+    }
+    append_fragment(out, first, after_client_order_id_);
+    if (!fields.limit_price.empty()) {
+        append_member(out, first, "limit_price", fields.limit_price);
+    }
+    append_fragment(out, first, after_limit_price_);
+    if (!fields.qty.empty()) {
+        append_member(out, first, "qty", fields.qty);
+    }
+    append_fragment(out, first, after_qty_);
+    out.push_back('}');
+}
+
+std::string_view OrderTemplate::format(Fields const& fields) const {
+    auto& buffer = detail::payload_buffer();
+    append(buffer, fields);
+    return buffer;
+}
+
+} // namespace alpaca
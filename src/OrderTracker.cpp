@@ -0,0 +1,318 @@
+#include "alpaca/OrderTracker.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <unordered_set>
+#include <utility>
+#include <variant>
+
+#if defined(__linux__)
+#include <pthread.h>
+#endif
+
+namespace alpaca {
+
+namespace {
+/// Whether `incoming` is older than `stored` and must not replace it.
+bool is_stale(Order const& stored, Order const& incoming) {
+    if (is_terminal(stored.status) && !is_terminal(incoming.status)) {
+        return true;
+    }
+    if (stored.updated_at && incoming.updated_at && *incoming.updated_at < *stored.updated_at) {
+        return true;
+    }
+    // A quantity Money cannot represent gives no ordering; fall back to the checks above.
+    auto const stored_filled = stored.filled_qty_amount(std::nothrow);
+    auto const incoming_filled = incoming.filled_qty_amount(std::nothrow);
+    return stored_filled && incoming_filled && *incoming_filled < *stored_filled;
+}
+} // namespace
+
+std::vector<Order> list_open_orders(TradingClient& client, int page_size) {
+    ListOrdersRequest request;
+    request.status = OrderStatusFilter::OPEN;
+    request.limit = page_size;
+    request.direction = SortDirection::DESC;
+    request.nested = true;
+
+    std::vector<Order> orders;
+    std::unordered_set<std::string> seen;
+    while (true) {
+        auto page = client.list_orders(request);
+        std::optional<Timestamp> oldest;
+        bool added = false;
+        for (auto& order : page) {
+            if (!oldest || order.created_at < *oldest) {
+                oldest = order.created_at;
+            }
+            if (seen.insert(order.id).second) {
+                orders.push_back(std::move(order));
+                added = true;
+            }
+        }
+        if (!added || !oldest || static_cast<int>(page.size()) < page_size) {
+            break;
+        }
+        request.until = oldest;
+    }
+    return orders;
+}
+
+OrderTracker::OrderTracker(TradingClient& client) : OrderTracker(client, Options{}) {}
+
+OrderTracker::OrderTracker(TradingClient& client, Options options) : client_(client), options_(options) {}
+
+OrderTracker::~OrderTracker() {
+    stop_reconciliation();
+}
+
+void OrderTracker::seed() {
+    auto orders = list_open_orders(client_, options_.page_size);
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto const& order : orders) {
+        merge_locked(order);
+    }
+}
+
+void OrderTracker::reconcile() {
+    auto snapshot = list_open_orders(client_, options_.page_size);
+
+    std::vector<std::string> missing;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::unordered_set<std::string_view> listed;
+        for (auto const& order : snapshot) {
+            merge_locked(order);
+            listed.insert(order.id);
+            for (auto const& leg : order.legs) {
+                listed.insert(leg.id);
+            }
+        }
+        for (auto const& [id, order] : orders_) {
+            if (!is_terminal(order.status) && !listed.contains(id)) {
+                missing.push_back(id);
+            }
+        }
+    }
+
+    // Orders that closed without their terminal event reaching us: ask for each one outside the lock.
+    std::vector<Order> refreshed;
+    refreshed.reserve(missing.size());
+    for (auto const& id : missing) {
+        try {
+            refreshed.push_back(client_.get_order(id));
+        } catch (std::exception const& ex) {
+            // One bad lookup must not hold back the rest; the order stays open and is retried next pass.
+            report_error("order reconciliation could not refresh " + id + ": " + ex.what());
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto const& order : refreshed) {
+        merge_locked(order);
+    }
+    stats_.reconciled_orders += refreshed.size();
+    ++stats_.reconciliations;
+}
+
+void OrderTracker::start_reconciliation() {
+    std::lock_guard<std::mutex> lock(reconcile_mutex_);
+    if (reconcile_thread_.joinable()) {
+        return;
+    }
+    reconcile_stop_ = false;
+    reconcile_thread_ = std::thread([this]() {
+#if defined(__linux__)
+        pthread_setname_np(pthread_self(), "alpaca-reconcile");
+#endif
+        run_reconciliation();
+    });
+}
+
+void OrderTracker::stop_reconciliation() {
+    std::thread thread;
+    {
+        std::lock_guard<std::mutex> lock(reconcile_mutex_);
+        reconcile_stop_ = true;
+        thread = std::move(reconcile_thread_);
+    }
+    reconcile_cv_.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+void OrderTracker::run_reconciliation() {
+    std::unique_lock<std::mutex> lock(reconcile_mutex_);
+    while (!reconcile_cv_.wait_for(lock, options_.reconcile_interval, [this]() { return reconcile_stop_; })) {
+        lock.unlock();
+        try {
+            reconcile();
+        } catch (std::exception const& ex) {
+            report_error(std::string("order reconciliation failed: ") + ex.what());
+        }
+        lock.lock();
+    }
+}
+
+void OrderTracker::report_error(std::string const& message) {
+    ErrorHandler handler;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        handler = error_handler_;
+    }
+    if (handler) {
+        handler(message);
+    }
+}
+
+void OrderTracker::set_error_handler(ErrorHandler handler) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    error_handler_ = std::move(handler);
+}
+
+void OrderTracker::apply(streaming::OrderUpdateMessage const& update) {
+    apply(update.order);
+}
+
+void OrderTracker::apply(Order const& order) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    merge_locked(order);
+}
+
+bool OrderTracker::merge_locked(Order const& order) {
+    for (auto const& leg : order.legs) {
+        merge_locked(leg);
+    }
+
+    auto it = orders_.find(order.id);
+    if (it == orders_.end()) {
+        it = orders_.emplace(order.id, order).first;
+        if (is_terminal(order.status)) {
+            closed_ids_.push_back(order.id);
+        } else {
+            ++open_count_;
+        }
+    } else {
+        if (is_stale(it->second, order)) {
+            ++stats_.stale_updates;
+            return false;
+        }
+        bool const was_open = !is_terminal(it->second.status);
+        bool const is_open = !is_terminal(order.status);
+        if (it->second.client_order_id != order.client_order_id) {
+            auto const previous = ids_by_client_order_id_.find(it->second.client_order_id);
+            if (previous != ids_by_client_order_id_.end() && previous->second == order.id) {
+                ids_by_client_order_id_.erase(previous);
+            }
+        }
+        it->second = order;
+        if (was_open && !is_open) {
+            --open_count_;
+            closed_ids_.push_back(order.id);
+        }
+    }
+    if (!order.client_order_id.empty()) {
+        ids_by_client_order_id_.insert_or_assign(order.client_order_id, order.id);
+    }
+    ++stats_.applied_updates;
+    forget_closed_locked();
+    return true;
+}
+
+void OrderTracker::forget_closed_locked() {
+    while (closed_ids_.size() > options_.closed_order_capacity) {
+        auto const id = std::move(closed_ids_.front());
+        closed_ids_.pop_front();
+        auto const it = orders_.find(id);
+        if (it == orders_.end()) {
+            continue;
+        }
+        auto const client = ids_by_client_order_id_.find(it->second.client_order_id);
+        if (client != ids_by_client_order_id_.end() && client->second == id) {
+            ids_by_client_order_id_.erase(client);
+        }
+        orders_.erase(it);
+    }
+}
+
+streaming::MessageHandler OrderTracker::handler(streaming::MessageHandler next) {
+    return [this, next = std::move(next)](streaming::StreamMessage const& message,
+                                          streaming::MessageCategory category) {
+        if (auto const* update = std::get_if<streaming::OrderUpdateMessage>(&message)) {
+            apply(*update);
+        }
+        if (next) {
+            next(message, category);
+        }
+    };
+}
+
+void OrderTracker::attach(streaming::WebSocketClient& client, streaming::MessageHandler next) {
+    client.set_message_handler(handler(std::move(next)));
+}
+
+std::optional<Order> OrderTracker::find(std::string_view order_id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto const it = orders_.find(order_id);
+    if (it == orders_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+std::optional<Order> OrderTracker::find_by_client_order_id(std::string_view client_order_id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto const id = ids_by_client_order_id_.find(client_order_id);
+    if (id == ids_by_client_order_id_.end()) {
+        return std::nullopt;
+    }
+    auto const it = orders_.find(id->second);
+    if (it == orders_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+std::vector<Order> OrderTracker::open_orders() const {
+    std::vector<Order> result;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        result.reserve(open_count_);
+        for (auto const& [id, order] : orders_) {
+            if (!is_terminal(order.status)) {
+                result.push_back(order);
+            }
+        }
+    }
+    std::sort(result.begin(), result.end(),
+              [](Order const& lhs, Order const& rhs) { return lhs.created_at < rhs.created_at; });
+    return result;
+}
+
+std::vector<Order> OrderTracker::open_orders(std::string_view symbol) const {
+    std::vector<Order> result;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto const& [id, order] : orders_) {
+            if (!is_terminal(order.status) && order.symbol == symbol) {
+                result.push_back(order);
+            }
+        }
+    }
+    std::sort(result.begin(), result.end(),
+              [](Order const& lhs, Order const& rhs) { return lhs.created_at < rhs.created_at; });
+    return result;
+}
+
+std::size_t OrderTracker::open_order_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return open_count_;
+}
+
+OrderTracker::Stats OrderTracker::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+} // namespace alpaca
@@ -0,0 +1,39 @@
+#include "alpaca/OutboundQueue.hpp"
+
+#include <utility>
+
+namespace alpaca::streaming::detail {
+
+OutboundQueue::OutboundQueue() : head_(new Node{}), tail_(head_.load()) {
+}
+
+OutboundQueue::~OutboundQueue() {
+    while (pop().has_value()) {
+    }
+    delete tail_;
+}
+
+void OutboundQueue::push(std::string frame) {
+    auto* node = new Node{};
+    node->frame = std::move(frame);
+    // Counted before linking so the consumer's decrement can never run ahead of it.
+    size_.fetch_add(1);
+    auto* previous = head_.exchange(node, std::memory_order_acq_rel);
+    previous->next.store(node, std::memory_order_release);
+}
+
+std::optional<std::string> OutboundQueue::pop() {
+    auto* next = tail_->next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+        // Either empty, or a producer has swapped the head but not linked it yet; that producer drains after
+        // pushing, so the frame is not stranded.
+        return std::nullopt;
+    }
+    auto frame = std::move(next->frame);
+    delete tail_;
+    tail_ = next;
+    size_.fetch_sub(1);
+    return frame;
+}
+
+} // namespace alpaca::streaming::detail
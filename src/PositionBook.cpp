@@ -0,0 +1,488 @@
+#include "alpaca/PositionBook.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+#include <utility>
+#include <variant>
+
+#include "alpaca/OrderTracker.hpp"
+
+namespace alpaca {
+
+namespace {
+constexpr std::int64_t kOptionMultiplier = 100;
+constexpr std::size_t kInitialIndexCapacity = 64;
+
+/// Divides rounding half away from zero.
+std::int64_t divide_rounded(__int128 numerator, __int128 denominator) {
+    if (denominator < 0) {
+        numerator = -numerator;
+        denominator = -denominator;
+    }
+    __int128 const half = denominator / 2;
+    return static_cast<std::int64_t>(numerator >= 0 ? (numerator + half) / denominator
+                                                    : (numerator - half) / denominator);
+}
+
+/// Product of two micro-unit values, in micro-units.
+std::int64_t multiply(std::int64_t lhs, std::int64_t rhs) {
+    return divide_rounded(static_cast<__int128>(lhs) * rhs, Money::kScale);
+}
+
+/// Quotient of two micro-unit values, in micro-units.
+std::int64_t divide(std::int64_t lhs, std::int64_t rhs) {
+    return divide_rounded(static_cast<__int128>(lhs) * Money::kScale, rhs);
+}
+
+std::int64_t parse_raw(std::string const& text) {
+    return text.empty() ? 0 : Money(text).raw();
+}
+
+std::int64_t contract_multiplier(std::optional<std::string> const& text) {
+    if (!text || text->empty()) {
+        return kOptionMultiplier;
+    }
+    return Money(*text).raw() / Money::kScale;
+}
+
+std::int64_t multiplier_for(std::string_view asset_class) {
+    return asset_class == "us_option" ? kOptionMultiplier : 1;
+}
+} // namespace
+
+PositionBook::Slot::Slot(std::string name, std::int64_t units) : symbol(std::move(name)), multiplier(units) {}
+
+PositionBook::Values PositionBook::Slot::read() const noexcept {
+    Values values;
+    std::uint32_t version = 0;
+    do {
+        version = sequence.load(std::memory_order_acquire);
+        values.qty = qty.load(std::memory_order_relaxed);
+        values.cost = cost.load(std::memory_order_relaxed);
+        values.realized = realized.load(std::memory_order_relaxed);
+        values.mark = mark.load(std::memory_order_relaxed);
+        values.listed = listed.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((version & 1U) != 0 || version != sequence.load(std::memory_order_relaxed));
+    return values;
+}
+
+std::uint32_t PositionBook::Slot::begin_write() noexcept {
+    // Fills and marks arrive on different socket threads; the section they guard is a handful of stores.
+    auto version = sequence.load(std::memory_order_relaxed);
+    while ((version & 1U) != 0 ||
+           !sequence.compare_exchange_weak(version, version + 1, std::memory_order_acquire)) {
+        std::this_thread::yield();
+        version = sequence.load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    return version;
+}
+
+void PositionBook::Slot::end_write(std::uint32_t version) noexcept {
+    sequence.store(version + 2, std::memory_order_release);
+}
+
+void PositionBook::Slot::write(Values const& values) noexcept {
+    auto const version = begin_write();
+    qty.store(values.qty, std::memory_order_relaxed);
+    cost.store(values.cost, std::memory_order_relaxed);
+    realized.store(values.realized, std::memory_order_relaxed);
+    mark.store(values.mark, std::memory_order_relaxed);
+    listed.store(values.listed, std::memory_order_relaxed);
+    end_write(version);
+}
+
+PositionBook::PositionPnl PositionBook::Slot::pnl(Values const& values) const {
+    PositionPnl result;
+    result.symbol = symbol;
+    result.qty = Money::from_raw(values.qty);
+    result.avg_entry_price = Money::from_raw(values.qty == 0 ? 0 : divide(values.cost, values.qty));
+    result.mark_price = Money::from_raw(values.mark);
+    result.market_value = Money::from_raw(multiply(values.qty, values.mark) * multiplier);
+    result.cost_basis = Money::from_raw(values.cost * multiplier);
+    result.unrealized_pl = result.market_value - result.cost_basis;
+    result.realized_pl = Money::from_raw(values.realized);
+    return result;
+}
+
+PositionBook::PositionBook(TradingClient& client) : PositionBook(client, Options{}) {}
+
+PositionBook::Index::Index(std::size_t capacity)
+    : mask(capacity - 1), buckets(std::make_unique<std::atomic<Slot*>[]>(capacity)) {}
+
+PositionBook::Slot* PositionBook::Index::find(std::string_view symbol) const noexcept {
+    for (auto i = std::hash<std::string_view>{}(symbol) & mask;; i = (i + 1) & mask) {
+        auto* const slot = buckets[i].load(std::memory_order_acquire);
+        if (slot == nullptr || slot->symbol == symbol) {
+            return slot;
+        }
+    }
+}
+
+void PositionBook::Index::insert(Slot* slot) noexcept {
+    auto i = std::hash<std::string_view>{}(slot->symbol) & mask;
+    while (buckets[i].load(std::memory_order_relaxed) != nullptr) {
+        i = (i + 1) & mask;
+    }
+    buckets[i].store(slot, std::memory_order_release);
+}
+
+PositionBook::PositionBook(TradingClient& client, Options options) : client_(client), options_(options) {
+    static_assert(std::atomic<Index const*>::is_always_lock_free, "readers find slots without taking a lock");
+    indexes_.push_back(std::make_unique<Index>(kInitialIndexCapacity));
+    index_.store(indexes_.back().get(), std::memory_order_release);
+}
+
+void PositionBook::seed() {
+    {
+        std::lock_guard<std::mutex> lock(update_mutex_);
+        seeding_ = true;
+    }
+    auto const same_progress = [](StringMap<FillProgress> const& lhs, StringMap<FillProgress> const& rhs) {
+        return lhs.size() == rhs.size() && std::all_of(lhs.begin(), lhs.end(), [&rhs](auto const& entry) {
+                   auto const it = rhs.find(entry.first);
+                   return it != rhs.end() && it->second.qty == entry.second.qty;
+               });
+    };
+
+    std::vector<SeededPosition> positions;
+    StringMap<FillProgress> fills;
+    std::size_t already_in_positions = 0;
+    try {
+        for (int attempt = 1;; ++attempt) {
+            // A fill between the positions and the orders snapshots would be counted twice or not at all, so the
+            // orders are read on both sides of the positions until no fill landed in between.
+            already_in_positions = deferred_fill_count();
+            auto const before = read_open_order_fills();
+            positions = read_positions();
+            fills = read_open_order_fills();
+            if (attempt >= options_.seed_attempts ||
+                (same_progress(before, fills) && deferred_fill_count() == already_in_positions)) {
+                break;
+            }
+        }
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(update_mutex_);
+        finish_seed_locked(0);
+        throw;
+    }
+
+    std::lock_guard<std::mutex> lock(update_mutex_);
+    fills_ = std::move(fills);
+    closed_ids_.clear();
+    for (auto& slot : slots_) {
+        if (slot.listed.load(std::memory_order_relaxed)) {
+            slot.write(Values{});
+        }
+    }
+    for (auto& position : positions) {
+        position.values.listed = true;
+        slot_locked(position.symbol, position.multiplier).write(position.values);
+    }
+    finish_seed_locked(already_in_positions);
+}
+
+std::vector<PositionBook::SeededPosition> PositionBook::read_positions() {
+    auto const positions = client_.list_positions();
+    auto const option_positions = client_.list_option_positions();
+
+    std::vector<SeededPosition> seeded;
+    seeded.reserve(positions.size() + option_positions.size());
+    auto const add = [this, &seeded](std::string const& symbol, std::int64_t multiplier, std::string const& qty,
+                                    std::string const& cost_basis, std::string const& current_price) {
+        // The API's cost basis already includes the multiplier; the book keeps it per unit.
+        Values values;
+        try {
+            values.qty = parse_raw(qty);
+            values.cost = parse_raw(cost_basis) / multiplier;
+            values.mark = parse_raw(current_price);
+        } catch (std::exception const& ex) {
+            report_error("position book left out the " + symbol + " position: " + ex.what());
+            return;
+        }
+        seeded.push_back(SeededPosition{symbol, multiplier, values});
+    };
+    for (auto const& position : positions) {
+        add(position.symbol, multiplier_for(position.asset_class), position.qty, position.cost_basis,
+            position.current_price);
+    }
+    for (auto const& position : option_positions) {
+        add(position.symbol, contract_multiplier(position.contract_multiplier), position.qty, position.cost_basis,
+            position.current_price);
+    }
+    return seeded;
+}
+
+PositionBook::StringMap<PositionBook::FillProgress> PositionBook::read_open_order_fills() {
+    StringMap<FillProgress> fills;
+    auto const record = [this, &fills](Order const& order) {
+        auto const qty = order.filled_qty_amount(std::nothrow);
+        auto const price = order.filled_avg_price_amount(std::nothrow);
+        if ((order.filled_qty && !qty) || (order.filled_avg_price && !price)) {
+            report_error("position book cannot represent the fills of order " + order.id + " in " + order.symbol);
+            return;
+        }
+        if (qty && qty->raw() != 0) {
+            fills[order.id] = FillProgress{qty->raw(), price ? multiply(qty->raw(), price->raw()) : 0};
+        }
+    };
+    for (auto const& order : list_open_orders(client_, options_.page_size)) {
+        record(order);
+        for (auto const& leg : order.legs) {
+            record(leg);
+        }
+    }
+    return fills;
+}
+
+std::size_t PositionBook::deferred_fill_count() {
+    std::lock_guard<std::mutex> lock(update_mutex_);
+    return deferred_fills_.size();
+}
+
+void PositionBook::finish_seed_locked(std::size_t already_in_positions) {
+    seeding_ = false;
+    for (std::size_t i = 0; i < deferred_fills_.size(); ++i) {
+        Order const& order = deferred_fills_[i];
+        apply_fill_locked(order, *order.filled_qty_amount(std::nothrow), *order.filled_avg_price_amount(std::nothrow),
+                          i >= already_in_positions);
+    }
+    deferred_fills_.clear();
+}
+
+void PositionBook::apply(streaming::OrderUpdateMessage const& update) {
+    Order const& order = update.order;
+    auto const filled = order.filled_qty_amount(std::nothrow);
+    auto const average = order.filled_avg_price_amount(std::nothrow);
+    if (!filled || !average) {
+        if ((order.filled_qty && !filled) || (order.filled_avg_price && !average)) {
+            report_error("position book left out a fill of order " + order.id + " in " + order.symbol +
+                         ": its amounts have more than six decimals");
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(update_mutex_);
+    if (seeding_) {
+        deferred_fills_.push_back(order);
+        return;
+    }
+    apply_fill_locked(order, *filled, *average, true);
+}
+
+void PositionBook::set_error_handler(ErrorHandler handler) {
+    std::lock_guard<std::mutex> lock(update_mutex_);
+    error_handler_ = std::move(handler);
+}
+
+void PositionBook::report_error(std::string const& message) {
+    ErrorHandler handler;
+    {
+        std::lock_guard<std::mutex> lock(update_mutex_);
+        handler = error_handler_;
+    }
+    if (handler) {
+        handler(message);
+    }
+}
+
+void PositionBook::apply_fill_locked(Order const& order, Money filled, Money average, bool count_in_positions) {
+    auto [it, inserted] = fills_.try_emplace(order.id);
+    FillProgress& progress = it->second;
+    std::int64_t const delta_qty = filled.raw() - progress.qty;
+    if (delta_qty <= 0 && inserted) {
+        fills_.erase(it);
+        return;
+    }
+    std::int64_t const previous_notional = progress.notional;
+    if (delta_qty > 0) {
+        progress.qty = filled.raw();
+        progress.notional = multiply(filled.raw(), average.raw());
+    }
+    if (is_terminal(order.status) && !progress.closed) {
+        progress.closed = true;
+        closed_ids_.push_back(order.id);
+    }
+    std::int64_t const notional = progress.notional;
+    forget_closed_locked();
+    if (delta_qty <= 0 || !count_in_positions) {
+        // A repeated or out-of-order event adds nothing, and neither does one the seeded positions already hold.
+        return;
+    }
+    std::int64_t const price = divide(notional - previous_notional, delta_qty);
+
+    Slot& slot = slot_locked(order.symbol, multiplier_for(order.asset_class));
+    std::int64_t const signed_qty = order.side == OrderSide::BUY ? delta_qty : -delta_qty;
+
+    auto const version = slot.begin_write();
+    std::int64_t qty = slot.qty.load(std::memory_order_relaxed);
+    std::int64_t cost = slot.cost.load(std::memory_order_relaxed);
+    std::int64_t realized = slot.realized.load(std::memory_order_relaxed);
+    bool const listed = slot.listed.load(std::memory_order_relaxed);
+    if (qty == 0 || (qty > 0) == (signed_qty > 0)) {
+        cost += multiply(signed_qty, price);
+        qty += signed_qty;
+    } else {
+        // Reduce the open quantity at its average cost and realise the difference; any excess opens the other side.
+        std::int64_t const closing = std::min(std::abs(signed_qty), std::abs(qty));
+        std::int64_t const direction = qty > 0 ? 1 : -1;
+        std::int64_t const closing_cost = divide_rounded(static_cast<__int128>(cost) * closing, std::abs(qty));
+        realized += (multiply(closing * direction, price) - closing_cost) * slot.multiplier;
+        cost -= closing_cost;
+        qty -= closing * direction;
+        std::int64_t const opening = signed_qty + closing * direction;
+        if (opening != 0) {
+            qty = opening;
+            cost = multiply(opening, price);
+        }
+    }
+    slot.qty.store(qty, std::memory_order_relaxed);
+    slot.cost.store(qty == 0 ? 0 : cost, std::memory_order_relaxed);
+    slot.realized.store(realized, std::memory_order_relaxed);
+    if (options_.mark_from_trades || !listed) {
+        slot.mark.store(price, std::memory_order_relaxed);
+    }
+    slot.listed.store(true, std::memory_order_relaxed);
+    slot.end_write(version);
+}
+
+void PositionBook::apply(streaming::QuoteMessage const& quote) {
+    if (!options_.mark_from_quotes || quote.bid_price.raw() <= 0 || quote.ask_price.raw() <= 0) {
+        return;
+    }
+    mark(quote.symbol, Money::from_raw(divide_rounded(static_cast<__int128>(quote.bid_price.raw()) +
+                                                          quote.ask_price.raw(),
+                                                      2)));
+}
+
+void PositionBook::apply(streaming::TradeMessage const& trade) {
+    if (!options_.mark_from_trades || trade.price.raw() <= 0) {
+        return;
+    }
+    mark(trade.symbol, trade.price);
+}
+
+void PositionBook::mark(std::string_view symbol, Money price) {
+    auto* const slot = find_slot(symbol);
+    if (slot == nullptr) {
+        return;
+    }
+    auto const version = slot->begin_write();
+    slot->mark.store(price.raw(), std::memory_order_relaxed);
+    slot->end_write(version);
+}
+
+PositionBook::Slot& PositionBook::slot_locked(std::string const& symbol, std::int64_t multiplier) {
+    auto& index = *indexes_.back();
+    if (auto* const slot = index.find(symbol)) {
+        return *slot;
+    }
+    auto& slot = slots_.emplace_back(symbol, multiplier);
+    if (slots_.size() * 2 > index.mask + 1) {
+        // Readers may still be probing the old table, so it stays until the book goes.
+        auto grown = std::make_unique<Index>((index.mask + 1) * 2);
+        for (auto& existing : slots_) {
+            grown->insert(&existing);
+        }
+        index_.store(grown.get(), std::memory_order_release);
+        indexes_.push_back(std::move(grown));
+    } else {
+        index.insert(&slot);
+    }
+    return slot;
+}
+
+void PositionBook::forget_closed_locked() {
+    while (closed_ids_.size() > options_.closed_order_capacity) {
+        fills_.erase(closed_ids_.front());
+        closed_ids_.pop_front();
+    }
+}
+
+PositionBook::Slot* PositionBook::find_slot(std::string_view symbol) const noexcept {
+    return index_.load(std::memory_order_acquire)->find(symbol);
+}
+
+streaming::MessageHandler PositionBook::handler(streaming::MessageHandler next) {
+    return [this, next = std::move(next)](streaming::StreamMessage const& message,
+                                          streaming::MessageCategory category) {
+        try {
+            if (auto const* quote = std::get_if<streaming::QuoteMessage>(&message)) {
+                apply(*quote);
+            } else if (auto const* trade = std::get_if<streaming::TradeMessage>(&message)) {
+                apply(*trade);
+            } else if (auto const* update = std::get_if<streaming::OrderUpdateMessage>(&message)) {
+                apply(*update);
+            }
+        } catch (std::exception const& ex) {
+            // Handlers chained behind the book still see the message.
+            report_error(std::string("position book could not apply a stream message: ") + ex.what());
+        }
+        if (next) {
+            next(message, category);
+        }
+    };
+}
+
+void PositionBook::attach(streaming::WebSocketClient& client, streaming::MessageHandler next) {
+    client.set_message_handler(handler(std::move(next)));
+}
+
+std::optional<PositionBook::PositionPnl> PositionBook::position(std::string_view symbol) const {
+    auto const* slot = find_slot(symbol);
+    if (slot == nullptr) {
+        return std::nullopt;
+    }
+    auto const values = slot->read();
+    if (!values.listed) {
+        return std::nullopt;
+    }
+    return slot->pnl(values);
+}
+
+Money PositionBook::quantity(std::string_view symbol) const {
+    auto const* slot = find_slot(symbol);
+    return slot != nullptr ? Money::from_raw(slot->qty.load(std::memory_order_acquire)) : Money{};
+}
+
+std::vector<PositionBook::PositionPnl> PositionBook::positions() const {
+    auto const& index = *index_.load(std::memory_order_acquire);
+    std::vector<PositionPnl> result;
+    for (std::size_t i = 0; i <= index.mask; ++i) {
+        auto const* slot = index.buckets[i].load(std::memory_order_acquire);
+        if (slot == nullptr) {
+            continue;
+        }
+        if (auto const values = slot->read(); values.listed) {
+            result.push_back(slot->pnl(values));
+        }
+    }
+    std::sort(result.begin(), result.end(),
+              [](PositionPnl const& lhs, PositionPnl const& rhs) { return lhs.symbol < rhs.symbol; });
+    return result;
+}
+
+PositionBook::PortfolioPnl PositionBook::portfolio() const {
+    auto const& index = *index_.load(std::memory_order_acquire);
+    PortfolioPnl total;
+    for (std::size_t i = 0; i <= index.mask; ++i) {
+        auto const* slot = index.buckets[i].load(std::memory_order_acquire);
+        if (slot == nullptr) {
+            continue;
+        }
+        auto const values = slot->read();
+        if (!values.listed) {
+            continue;
+        }
+        auto const pnl = slot->pnl(values);
+        total.market_value += pnl.market_value;
+        total.cost_basis += pnl.cost_basis;
+        total.unrealized_pl += pnl.unrealized_pl;
+        total.realized_pl += pnl.realized_pl;
+    }
+    return total;
+}
+
+} // namespace alpaca
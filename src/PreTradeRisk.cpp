@@ -0,0 +1,351 @@
+#include "alpaca/PreTradeRisk.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <utility>
+#include <variant>
+
+#include "alpaca/Chrono.hpp"
+#include "alpaca/Exceptions.hpp"
+
+namespace alpaca {
+
+namespace {
+constexpr std::int64_t kUnlimited = std::numeric_limits<std::int64_t>::max();
+constexpr std::int64_t kBasisPoints = 10'000;
+
+std::int64_t clamp_raw(__int128 value) {
+    constexpr __int128 kMax = std::numeric_limits<std::int64_t>::max();
+    return static_cast<std::int64_t>(std::clamp(value, -kMax, kMax));
+}
+
+/// Product of two micro-unit values, in micro-units, saturating.
+std::int64_t multiply(std::int64_t lhs, std::int64_t rhs) {
+    return clamp_raw(static_cast<__int128>(lhs) * rhs / Money::kScale);
+}
+
+/// Quotient of two micro-unit values, in micro-units.
+std::int64_t divide(std::int64_t lhs, std::int64_t rhs) {
+    return clamp_raw(static_cast<__int128>(lhs) * Money::kScale / rhs);
+}
+
+/// `price` moved by `bps` basis points, saturating.
+std::int64_t shift_bps(std::int64_t price, std::int64_t bps) {
+    return clamp_raw(static_cast<__int128>(price) * (kBasisPoints + bps) / kBasisPoints);
+}
+
+std::int64_t parse_raw(std::optional<std::string> const& text) {
+    return text ? Money(*text).raw() : 0;
+}
+
+/// Micro-units as a plain decimal without trailing zeros, such as "187.5".
+std::string format_raw(std::int64_t raw) {
+    auto const magnitude = raw < 0 ? 0 - static_cast<std::uint64_t>(raw) : static_cast<std::uint64_t>(raw);
+    auto text = std::to_string(magnitude / Money::kScale);
+    if (auto fraction = magnitude % Money::kScale; fraction != 0) {
+        auto digits = std::to_string(fraction + Money::kScale).substr(1);
+        digits.erase(digits.find_last_not_of('0') + 1);
+        text.append(1, '.').append(digits);
+    }
+    return raw < 0 ? "-" + text : text;
+}
+
+std::int64_t to_raw(std::optional<Money> const& limit) {
+    return limit ? limit->raw() : kUnlimited;
+}
+
+std::int64_t nanoseconds_since_epoch(Timestamp timestamp) {
+    return timestamp.time_since_epoch().count();
+}
+} // namespace
+
+std::string to_string(RiskRule rule) {
+    switch (rule) {
+    case RiskRule::FatFinger:
+        return "fat_finger";
+    case RiskRule::MaxNotional:
+        return "max_notional";
+    case RiskRule::MaxPosition:
+        return "max_position";
+    case RiskRule::PriceCollar:
+        return "price_collar";
+    case RiskRule::SymbolThrottle:
+        return "symbol_throttle";
+    case RiskRule::AccountThrottle:
+        return "account_throttle";
+    }
+    return "unknown";
+}
+
+PreTradeRisk::PreTradeRisk() : PreTradeRisk(Options{}) {}
+
+PreTradeRisk::PreTradeRisk(Options options) : options_(std::move(options)), table_(std::make_shared<Table const>()) {
+    if (options_.max_orders_per_second < 0 || options_.default_limits.max_orders_per_second < 0) {
+        throw InvalidArgumentException("max_orders_per_second", "Order rate limits cannot be negative");
+    }
+    account_rate_ = make_rate(options_.max_orders_per_second, options_.burst);
+    // Checks are timed with the fast clock; keep its calibration out of the first order.
+    calibrate_fast_clock();
+}
+
+PreTradeRisk::PreTradeRisk(PositionBook const& positions, Options options) : PreTradeRisk(std::move(options)) {
+    positions_ = &positions;
+}
+
+PreTradeRisk::Rate PreTradeRisk::make_rate(double per_second, std::uint32_t burst) {
+    Rate rate;
+    if (per_second > 0) {
+        rate.interval_ns = std::max<std::int64_t>(1, std::llround(1e9 / per_second));
+        rate.tolerance_ns = rate.interval_ns * (std::max<std::uint32_t>(burst, 1) - 1);
+    }
+    return rate;
+}
+
+void PreTradeRisk::write_limits(Table& table, std::uint32_t id, RiskLimits const& limits) {
+    if (id == table.max_order_qty.size()) {
+        table.max_order_qty.push_back(kUnlimited);
+        table.max_order_notional.push_back(kUnlimited);
+        table.max_position.push_back(kUnlimited);
+        table.collar_bps.push_back(-1);
+        table.rates.emplace_back();
+    }
+    table.max_order_qty[id] = to_raw(limits.max_order_qty);
+    table.max_order_notional[id] = to_raw(limits.max_order_notional);
+    table.max_position[id] = to_raw(limits.max_position);
+    table.collar_bps[id] = limits.price_collar_bps ? static_cast<std::int64_t>(*limits.price_collar_bps) : -1;
+    table.rates[id] = make_rate(limits.max_orders_per_second, limits.burst);
+}
+
+void PreTradeRisk::set_limits(std::string const& symbol, RiskLimits const& limits) {
+    if (limits.max_orders_per_second < 0) {
+        throw InvalidArgumentException("max_orders_per_second", "Order rate limits cannot be negative");
+    }
+    std::lock_guard<std::mutex> lock(table_mutex_);
+    auto next = std::make_shared<Table>(*table_.load());
+    auto const it = next->ids.find(symbol);
+    auto const id = it != next->ids.end() ? it->second : add_symbol_locked(*next, symbol);
+    write_limits(*next, id, limits);
+    table_.store(std::move(next));
+}
+
+std::pair<std::shared_ptr<PreTradeRisk::Table const>, std::uint32_t> PreTradeRisk::resolve(std::string_view symbol) {
+    auto table = table_.load();
+    if (auto const it = table->ids.find(symbol); it != table->ids.end()) {
+        return {std::move(table), it->second};
+    }
+
+    std::lock_guard<std::mutex> lock(table_mutex_);
+    table = table_.load();
+    if (auto const it = table->ids.find(symbol); it != table->ids.end()) {
+        return {std::move(table), it->second};
+    }
+    auto next = std::make_shared<Table>(*table);
+    auto const id = add_symbol_locked(*next, symbol);
+    write_limits(*next, id, options_.default_limits);
+    std::shared_ptr<Table const> published = std::move(next);
+    table_.store(published);
+    return {std::move(published), id};
+}
+
+std::uint32_t PreTradeRisk::add_symbol_locked(Table& table, std::string_view symbol) {
+    auto const id = static_cast<std::uint32_t>(table.markets.size());
+    table.ids.emplace(std::string(symbol), id);
+    auto& market = markets_.emplace_back();
+    if (auto const it = unresolved_quotes_.find(symbol); it != unresolved_quotes_.end()) {
+        market.bid.store(it->second.bid, std::memory_order_relaxed);
+        market.ask.store(it->second.ask, std::memory_order_relaxed);
+        unresolved_quotes_.erase(it);
+    }
+    table.markets.push_back(&market);
+    return id;
+}
+
+bool PreTradeRisk::admit(std::atomic<std::int64_t>& next_arrival, Rate rate, std::int64_t now) noexcept {
+    // Generic cell rate algorithm: one atomic per throttle, no buckets to refill.
+    auto current = next_arrival.load(std::memory_order_relaxed);
+    while (true) {
+        auto const start = std::max(current, now);
+        if (start - now > rate.tolerance_ns) {
+            return false;
+        }
+        if (next_arrival.compare_exchange_weak(current, start + rate.interval_ns, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+}
+
+void PreTradeRisk::record(RiskRule rule, std::int64_t elapsed_ns, bool passed) noexcept {
+    auto& counters = counters_[static_cast<std::size_t>(rule)];
+    auto const elapsed = static_cast<std::uint64_t>(std::max<std::int64_t>(elapsed_ns, 0));
+    counters.evaluations.fetch_add(1, std::memory_order_relaxed);
+    counters.total_ns.fetch_add(elapsed, std::memory_order_relaxed);
+    auto longest = counters.max_ns.load(std::memory_order_relaxed);
+    while (elapsed > longest &&
+           !counters.max_ns.compare_exchange_weak(longest, elapsed, std::memory_order_relaxed)) {
+    }
+    if (!passed) {
+        counters.rejections.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+PreTradeRisk::Decision PreTradeRisk::check(NewOrderRequest const& request) {
+    checks_.fetch_add(1, std::memory_order_relaxed);
+    auto const [table, id] = resolve(request.symbol);
+    auto& market = *table->markets[id];
+    bool const buy = request.side == OrderSide::BUY;
+
+    auto const qty = parse_raw(request.quantity);
+    auto const notional = parse_raw(request.notional);
+    auto const limit_price = parse_raw(request.limit_price);
+    bool const limit_order = request.type == OrderType::LIMIT || request.type == OrderType::STOP_LIMIT;
+    auto const far_touch = (buy ? market.ask : market.bid).load(std::memory_order_relaxed);
+    auto const price = limit_order && limit_price > 0 ? limit_price : far_touch;
+    // Notional orders are sized at the price they would execute at, when there is one.
+    auto const order_qty = request.quantity ? qty : (notional > 0 && price > 0 ? divide(notional, price) : -1);
+    auto const order_notional = request.notional ? notional : (price > 0 ? multiply(qty, price) : -1);
+
+    Decision decision;
+    auto started = nanoseconds_since_epoch(fast_utc_now());
+    auto const evaluate = [&](RiskRule rule, bool passed, auto const& describe) {
+        auto const now = nanoseconds_since_epoch(fast_utc_now());
+        record(rule, now - started, passed);
+        started = now;
+        if (!passed) {
+            decision.accepted = false;
+            decision.rule = rule;
+            decision.reason = describe();
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return passed;
+    };
+
+    if (auto const limit = table->max_order_qty[id]; limit != kUnlimited) {
+        bool const passed = order_qty >= 0 && order_qty <= limit;
+        if (!evaluate(RiskRule::FatFinger, passed, [&]() {
+                return order_qty < 0 ? std::string("No quote to size the order against its quantity limit")
+                                     : "Order quantity " + format_raw(order_qty) + " exceeds the limit of " +
+                                           format_raw(limit);
+            })) {
+            return decision;
+        }
+    }
+    if (auto const limit = table->max_order_notional[id]; limit != kUnlimited) {
+        bool const passed = order_notional >= 0 && order_notional <= limit;
+        if (!evaluate(RiskRule::MaxNotional, passed, [&]() {
+                return order_notional < 0 ? std::string("No quote to value the order against its notional limit")
+                                          : "Order notional " + format_raw(order_notional) +
+                                                " exceeds the limit of " + format_raw(limit);
+            })) {
+            return decision;
+        }
+    }
+    if (auto const limit = table->max_position[id]; limit != kUnlimited) {
+        auto const current = positions_ != nullptr ? positions_->quantity(request.symbol).raw() : 0;
+        auto const after = current + (buy ? order_qty : -order_qty);
+        bool const passed = order_qty >= 0 && (std::llabs(after) <= limit || std::llabs(after) < std::llabs(current));
+        if (!evaluate(RiskRule::MaxPosition, passed, [&]() {
+                return order_qty < 0 ? std::string("No quote to size the order against its position limit")
+                                     : "Position would reach " + format_raw(after) + " against the limit of " +
+                                           format_raw(limit);
+            })) {
+            return decision;
+        }
+    }
+    if (auto const collar = table->collar_bps[id]; collar >= 0 && limit_order) {
+        auto const bound = far_touch > 0 ? shift_bps(far_touch, buy ? collar : -collar) : 0;
+        bool const passed = far_touch > 0 && (buy ? limit_price <= bound : limit_price >= bound);
+        if (!evaluate(RiskRule::PriceCollar, passed, [&]() {
+                return far_touch <= 0 ? "No " + std::string(buy ? "ask" : "bid") + " quote to collar the limit price"
+                                      : "Limit price " + format_raw(limit_price) + " is past the collar at " +
+                                            format_raw(bound);
+            })) {
+            return decision;
+        }
+    }
+    auto const symbol_rate = table->rates[id];
+    if (symbol_rate.interval_ns > 0) {
+        bool const passed = admit(market.next_arrival, symbol_rate, started);
+        if (!evaluate(RiskRule::SymbolThrottle, passed,
+                      [&]() { return "Order rate limit reached for " + request.symbol; })) {
+            return decision;
+        }
+    }
+    if (account_rate_.interval_ns > 0) {
+        bool const passed = admit(account_next_arrival_, account_rate_, started);
+        if (!evaluate(RiskRule::AccountThrottle, passed,
+                      []() { return std::string("Account order rate limit reached"); }) &&
+            symbol_rate.interval_ns > 0) {
+            // Hand the symbol's slot back: moving its arrival time back one interval undoes the admission, even if
+            // later orders have been admitted behind it.
+            market.next_arrival.fetch_sub(symbol_rate.interval_ns, std::memory_order_relaxed);
+        }
+    }
+    return decision;
+}
+
+Order PreTradeRisk::submit_order(TradingClient& client, NewOrderRequest const& request) {
+    auto decision = check(request);
+    if (!decision) {
+        throw RiskRejectedException(to_string(decision.rule), request.symbol, std::move(decision.reason));
+    }
+    return client.submit_order(request);
+}
+
+void PreTradeRisk::apply(streaming::QuoteMessage const& quote) {
+    auto const store = [&quote](Market& market) {
+        market.bid.store(quote.bid_price.raw(), std::memory_order_relaxed);
+        market.ask.store(quote.ask_price.raw(), std::memory_order_relaxed);
+    };
+    auto table = table_.load();
+    if (auto const it = table->ids.find(quote.symbol); it != table->ids.end()) {
+        store(*table->markets[it->second]);
+        return;
+    }
+
+    // A symbol no order has named yet stays out of the tables, so a wide quote feed does not copy them per symbol.
+    std::lock_guard<std::mutex> lock(table_mutex_);
+    table = table_.load();
+    if (auto const it = table->ids.find(quote.symbol); it != table->ids.end()) {
+        store(*table->markets[it->second]);
+        return;
+    }
+    unresolved_quotes_.insert_or_assign(quote.symbol, Quote{quote.bid_price.raw(), quote.ask_price.raw()});
+}
+
+streaming::MessageHandler PreTradeRisk::handler(streaming::MessageHandler next) {
+    return [this, next = std::move(next)](streaming::StreamMessage const& message,
+                                          streaming::MessageCategory category) {
+        if (auto const* quote = std::get_if<streaming::QuoteMessage>(&message)) {
+            apply(*quote);
+        }
+        if (next) {
+            next(message, category);
+        }
+    };
+}
+
+void PreTradeRisk::attach(streaming::WebSocketClient& client, streaming::MessageHandler next) {
+    client.set_message_handler(handler(std::move(next)));
+}
+
+PreTradeRisk::Stats PreTradeRisk::stats() const {
+    Stats stats;
+    stats.checks = checks_.load(std::memory_order_relaxed);
+    stats.rejected = rejected_.load(std::memory_order_relaxed);
+    stats.rules.reserve(kRiskRuleCount);
+    for (std::size_t i = 0; i < kRiskRuleCount; ++i) {
+        auto const& counters = counters_[i];
+        RuleStats rule;
+        rule.rule = static_cast<RiskRule>(i);
+        rule.evaluations = counters.evaluations.load(std::memory_order_relaxed);
+        rule.rejections = counters.rejections.load(std::memory_order_relaxed);
+        rule.total_time = std::chrono::nanoseconds(counters.total_ns.load(std::memory_order_relaxed));
+        rule.max_time = std::chrono::nanoseconds(counters.max_ns.load(std::memory_order_relaxed));
+        stats.rules.push_back(rule);
+    }
+    return stats;
+}
+
+} // namespace alpaca
@@ -0,0 +1,318 @@
+#include "alpaca/Requoter.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <optional>
+#include <random>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+
+#include "alpaca/Exceptions.hpp"
+#include "alpaca/Money.hpp"
+#include "alpaca/internal/BoundedParallel.hpp"
+
+namespace alpaca {
+
+namespace {
+/// Whether two decimal strings hold the same amount, so "10" matches "10.0".
+bool same_amount(std::optional<std::string> const& live, std::string const& target) {
+    if (!live) {
+        return target.empty();
+    }
+    try {
+        return Money(*live) == Money(target);
+    } catch (std::exception const&) {
+        return *live == target;
+    }
+}
+
+/// Whether the API refused a submission because an order with its client order id already exists.
+bool is_duplicate_client_order_id(Exception const& ex) {
+    return ex.status_code() == 422 && (ex.body().find("40010001") != std::string::npos ||
+                                       std::string_view(ex.what()).find("client_order_id must be unique") !=
+                                       std::string_view::npos);
+}
+
+bool is_settling(OrderStatus status) {
+    return status == OrderStatus::PENDING_CANCEL || status == OrderStatus::PENDING_REPLACE;
+}
+
+void append_base36(std::string& out, std::uint64_t value) {
+    constexpr char kDigits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+    auto const start = out.size();
+    do {
+        out.insert(out.begin() + static_cast<std::ptrdiff_t>(start), kDigits[value % 36]);
+        value /= 36;
+    } while (value > 0);
+}
+
+/// The clock's seconds plus random bits, so two processes started within
+/// the same second do not share ids.
+std::string clock_session() {
+    auto const seconds =
+        std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    std::string session;
+    append_base36(session, static_cast<std::uint64_t>(seconds));
+    session.append(1, 'r');
+    append_base36(session, std::random_device{}());
+    return session;
+}
+} // namespace
+
+Requoter::Requoter(TradingClient& client, OrderTracker& tracker) : Requoter(client, tracker, Options{}) {}
+
+Requoter::Requoter(TradingClient& client, OrderTracker& tracker, Options options)
+    : client_(client), tracker_(tracker), options_(std::move(options)) {
+    if (options_.session.empty()) {
+        options_.session = clock_session();
+    }
+}
+
+std::string Requoter::make_client_order_id(std::string_view key, std::uint64_t generation) const {
+    std::string id;
+    id.reserve(options_.client_order_id_prefix.size() + options_.session.size() + key.size() + 24);
+    id.append(options_.client_order_id_prefix).append(1, '-').append(options_.session).append(1, '-');
+    id.append(key).append(1, '-').append(std::to_string(generation));
+    return id;
+}
+
+void Requoter::plan_target(QuoteTarget const& target, Slot& slot, std::vector<Action>& actions,
+                           CycleReport& report) {
+    auto const submit = [&]() {
+        actions.push_back(Action{ActionKind::Submit, target.key, &target, {}, slot.client_order_id});
+    };
+    auto const advance = [&]() {
+        ++slot.generation;
+        slot.client_order_id = make_client_order_id(target.key, slot.generation);
+    };
+
+    auto const live = slot.client_order_id.empty() ? std::nullopt
+                                                    : tracker_.find_by_client_order_id(slot.client_order_id);
+    if (!live && !slot.replacing_client_order_id.empty()) {
+        // The replacement has not shown up: retry it under the same id while the original is still open.
+        auto const original = tracker_.find_by_client_order_id(slot.replacing_client_order_id);
+        if (original && !is_terminal(original->status)) {
+            if (is_settling(original->status)) {
+                ++report.pending;
+                return;
+            }
+            actions.push_back(
+                Action{ActionKind::Replace, target.key, &target, original->id, slot.client_order_id});
+            return;
+        }
+        if (original && original->status == OrderStatus::REPLACED) {
+            ++report.pending;
+            return;
+        }
+    }
+    slot.replacing_client_order_id.clear();
+
+    if (!live) {
+        // Never placed, or placed by a request whose outcome is unknown: send it again under the same id.
+        if (slot.client_order_id.empty()) {
+            advance();
+        }
+        submit();
+        return;
+    }
+    if (is_terminal(live->status)) {
+        advance();
+        submit();
+        return;
+    }
+    if (is_settling(live->status)) {
+        ++report.pending;
+        return;
+    }
+    if (live->symbol != target.symbol || live->side != target.side) {
+        actions.push_back(Action{ActionKind::Cancel, target.key, &target, live->id, slot.client_order_id});
+        return;
+    }
+    if (same_amount(live->qty, target.qty) && same_amount(live->limit_price, target.limit_price) &&
+        live->time_in_force == target.time_in_force && live->extended_hours == target.extended_hours) {
+        ++report.unchanged;
+        return;
+    }
+    slot.replacing_client_order_id = slot.client_order_id;
+    advance();
+    actions.push_back(Action{ActionKind::Replace, target.key, &target, live->id, slot.client_order_id});
+}
+
+void Requoter::plan_removal(std::string const& key, Slot const& slot, std::vector<Action>& actions,
+                            std::vector<std::string>& dropped, CycleReport& report) {
+    bool open = false;
+    for (auto const* client_order_id : {&slot.client_order_id, &slot.replacing_client_order_id}) {
+        if (client_order_id->empty()) {
+            continue;
+        }
+        auto const live = tracker_.find_by_client_order_id(*client_order_id);
+        if (!live || is_terminal(live->status)) {
+            continue;
+        }
+        open = true;
+        if (live->status == OrderStatus::PENDING_CANCEL) {
+            ++report.pending;
+        } else {
+            actions.push_back(Action{ActionKind::Cancel, key, nullptr, live->id, *client_order_id});
+        }
+    }
+    if (open) {
+        return;
+    }
+    if (slot.uncertain) {
+        // The order may exist without the tracker knowing it; look it up before letting the slot go.
+        actions.push_back(Action{ActionKind::Cancel, key, nullptr, {}, slot.client_order_id, true});
+        return;
+    }
+    dropped.push_back(key);
+}
+
+Requoter::Outcome Requoter::run(Action const& action) {
+    Outcome outcome;
+    auto const started = std::chrono::steady_clock::now();
+    try {
+        switch (action.kind) {
+        case ActionKind::Submit: {
+            NewOrderRequest request;
+            request.symbol = action.target->symbol;
+            request.side = action.target->side;
+            request.type = OrderType::LIMIT;
+            request.time_in_force = action.target->time_in_force;
+            request.quantity = action.target->qty;
+            request.limit_price = action.target->limit_price;
+            request.extended_hours = action.target->extended_hours;
+            request.client_order_id = action.client_order_id;
+            tracker_.apply(client_.submit_order(request));
+            break;
+        }
+        case ActionKind::Replace: {
+            ReplaceOrderRequest request;
+            request.quantity = action.target->qty;
+            request.limit_price = action.target->limit_price;
+            request.time_in_force = to_string(action.target->time_in_force);
+            request.extended_hours = action.target->extended_hours;
+            request.client_order_id = action.client_order_id;
+            tracker_.apply(client_.replace_order(action.order_id, request));
+            break;
+        }
+        case ActionKind::Cancel: {
+            auto order_id = action.order_id;
+            if (order_id.empty()) {
+                try {
+                    auto const order = client_.get_order_by_client_order_id(action.client_order_id);
+                    tracker_.apply(order);
+                    if (!is_terminal(order.status)) {
+                        order_id = order.id;
+                    }
+                } catch (NotFoundException const&) {
+                }
+            }
+            if (!order_id.empty()) {
+                client_.cancel_order(order_id);
+                // Until the stream confirms, mark it so the next cycle does not cancel it again.
+                if (auto order = tracker_.find(order_id); order && !is_terminal(order->status)) {
+                    order->status = OrderStatus::PENDING_CANCEL;
+                    tracker_.apply(*order);
+                }
+            }
+            break;
+        }
+        }
+        outcome.ok = true;
+    } catch (Exception const& ex) {
+        // A duplicate id proves an earlier attempt placed the order, which the tracker may not have seen yet.
+        outcome.uncertain = !ex.status_code_opt().has_value() || is_duplicate_client_order_id(ex);
+        outcome.error = ex.what();
+    } catch (std::exception const& ex) {
+        outcome.uncertain = true;
+        outcome.error = ex.what();
+    }
+    outcome.latency = std::chrono::steady_clock::now() - started;
+    return outcome;
+}
+
+Requoter::CycleReport Requoter::requote(std::span<QuoteTarget const> targets) {
+    std::lock_guard<std::mutex> lock(cycle_mutex_);
+    auto const started = std::chrono::steady_clock::now();
+    CycleReport report;
+
+    std::unordered_set<std::string_view> keys;
+    keys.reserve(targets.size());
+    for (auto const& target : targets) {
+        if (!keys.insert(target.key).second) {
+            throw InvalidArgumentException("targets", "Duplicate quote target key: " + target.key);
+        }
+    }
+
+    std::vector<Action> actions;
+    actions.reserve(targets.size());
+    for (auto const& target : targets) {
+        auto it = slots_.find(target.key);
+        if (it == slots_.end()) {
+            it = slots_.emplace(target.key, Slot{}).first;
+        }
+        plan_target(target, it->second, actions, report);
+    }
+    std::vector<std::string> dropped;
+    for (auto const& [key, slot] : slots_) {
+        if (!keys.contains(key)) {
+            plan_removal(key, slot, actions, dropped, report);
+        }
+    }
+    for (auto const& key : dropped) {
+        slots_.erase(key);
+    }
+    report.diff_time = std::chrono::steady_clock::now() - started;
+
+    std::vector<Outcome> outcomes(actions.size());
+    detail::run_bounded(actions.size(), options_.max_in_flight, "alpaca-requote",
+                        [this, &actions, &outcomes](std::size_t index) { outcomes[index] = run(actions[index]); });
+
+    for (std::size_t i = 0; i < actions.size(); ++i) {
+        auto const& action = actions[i];
+        auto const& outcome = outcomes[i];
+        report.max_request_latency = std::max(report.max_request_latency, outcome.latency);
+        if (action.kind == ActionKind::Submit) {
+            slots_[action.key].uncertain = !outcome.ok && outcome.uncertain;
+        }
+        if (!outcome.ok) {
+            ++report.failed;
+            report.errors.push_back(action.key + ": " + outcome.error);
+            continue;
+        }
+        switch (action.kind) {
+        case ActionKind::Submit:
+            ++report.submitted;
+            break;
+        case ActionKind::Replace:
+            ++report.replaced;
+            break;
+        case ActionKind::Cancel:
+            ++report.canceled;
+            if (action.drop_slot) {
+                slots_.erase(action.key);
+            }
+            break;
+        }
+    }
+    report.elapsed = std::chrono::steady_clock::now() - started;
+
+    std::lock_guard<std::mutex> stats_lock(stats_mutex_);
+    ++stats_.cycles;
+    stats_.submitted += report.submitted;
+    stats_.replaced += report.replaced;
+    stats_.canceled += report.canceled;
+    stats_.failed += report.failed;
+    stats_.last_cycle = report.elapsed;
+    stats_.max_cycle = std::max(stats_.max_cycle, report.elapsed);
+    stats_.total_cycle += report.elapsed;
+    return report;
+}
+
+Requoter::Stats Requoter::stats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return stats_;
+}
+
+} // namespace alpaca
@@ -305,7 +305,7 @@ std::string RestClient::encode_query(QueryParams const& params) {
 }
 
 HttpResponse RestClient::perform_request(HttpMethod method, std::string const& path, QueryParams const& params,
-                                         std::optional<std::string> payload) const {
+                                         std::optional<std::string> payload, RequestTrace* trace) const {
     std::string url = build_url(base_url_, path, params);
 
     HttpRequest request;
@@ -330,9 +330,14 @@ HttpResponse RestClient::perform_request(HttpMethod method, std::string const& p
         }
 
         HttpResponse response;
+        auto const sent = trace != nullptr ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
         try {
             response = http_client_->send(attempt_request);
         } catch (std::exception const&) {
+            if (trace != nullptr) {
+                ++trace->attempts;
+                trace->round_trip = std::chrono::steady_clock::now() - sent;
+            }
             if (!should_retry(method, std::nullopt, attempt)) {
                 throw;
             }
@@ -341,11 +346,20 @@ HttpResponse RestClient::perform_request(HttpMethod method, std::string const& p
             auto const delay = compute_retry_delay(std::nullopt, backoff);
             if (delay.count() > 0) {
                 std::this_thread::sleep_for(delay);
+                if (trace != nullptr) {
+                    trace->retry_wait += delay;
+                }
             }
             backoff = next_backoff(backoff);
             continue;
         }
 
+        if (trace != nullptr) {
+            ++trace->attempts;
+            trace->round_trip = std::chrono::steady_clock::now() - sent;
+            trace->http = response.timings;
+        }
+
         auto rate_limit_status = extract_rate_limit(response.headers);
         {
             std::lock_guard<std::mutex> lock(rate_limit_mutex_);
@@ -392,6 +406,9 @@ HttpResponse RestClient::perform_request(HttpMethod method, std::string const& p
         auto const delay = compute_retry_delay(retry_after, backoff);
         if (delay.count() > 0) {
             std::this_thread::sleep_for(delay);
+            if (trace != nullptr) {
+                trace->retry_wait += delay;
+            }
         }
         backoff = next_backoff(backoff);
     }
@@ -408,9 +425,9 @@ void RestClient::set_rate_limit_handler(RateLimitHandler handler) {
 }
 
 std::optional<std::string> RestClient::request_raw(HttpMethod method, std::string const& path,
-                                                   QueryParams const& params,
-                                                   std::optional<std::string> payload) const {
-    HttpResponse response = perform_request(method, path, params, std::move(payload));
+                                                   QueryParams const& params, std::optional<std::string> payload,
+                                                   RequestTrace* trace) const {
+    HttpResponse response = perform_request(method, path, params, std::move(payload), trace);
 
     if (response.body.empty()) {
         return std::nullopt;
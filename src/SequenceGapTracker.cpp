@@ -0,0 +1,78 @@
+#include "alpaca/SequenceGapTracker.hpp"
+
+#include <utility>
+
+namespace alpaca::streaming {
+
+SequenceGapTracker::Slot SequenceGapTracker::slot(std::string_view channel, std::string_view stream_id) {
+    auto& streams = streams_for(channel);
+    if (auto const it = streams.find(stream_id); it != streams.end()) {
+        return it->second;
+    }
+
+    auto const slot = static_cast<Slot>(entries_.size());
+    Entry entry{std::string{stream_id}, {}};
+    if (channel.empty()) {
+        entry.key = entry.stream_id;
+    } else {
+        entry.key.reserve(channel.size() + 1 + stream_id.size());
+        entry.key.append(channel).append(1, '|').append(stream_id);
+    }
+    entries_.push_back(std::move(entry));
+    positions_.emplace_back();
+    streams.emplace(std::string{stream_id}, slot);
+    return slot;
+}
+
+std::optional<SequenceGapTracker::Gap> SequenceGapTracker::observe(Slot slot, std::uint64_t sequence) noexcept {
+    auto& position = positions_[slot];
+    if (!position.seen) {
+        position.seen = true;
+        position.last = sequence;
+        return std::nullopt;
+    }
+
+    auto const previous = position.last;
+    if (sequence > previous) {
+        position.last = sequence;
+    }
+    if (sequence > previous + 1) {
+        return Gap{previous + 1, sequence};
+    }
+    return std::nullopt;
+}
+
+std::string const& SequenceGapTracker::last_time(Slot slot) const {
+    return positions_.at(slot).last_time;
+}
+
+void SequenceGapTracker::set_last_time(Slot slot, std::string_view time) {
+    positions_.at(slot).last_time.assign(time);
+}
+
+std::string const& SequenceGapTracker::stream_id(Slot slot) const {
+    return entries_.at(slot).stream_id;
+}
+
+std::string const& SequenceGapTracker::key(Slot slot) const {
+    return entries_.at(slot).key;
+}
+
+void SequenceGapTracker::clear() {
+    channels_.clear();
+    entries_.clear();
+    positions_.clear();
+}
+
+SequenceGapTracker::SlotIndex& SequenceGapTracker::streams_for(std::string_view channel) {
+    // Feeds carry a handful of channels, so a linear scan beats hashing the name.
+    for (auto& entry : channels_) {
+        if (entry.name == channel) {
+            return entry.streams;
+        }
+    }
+    channels_.push_back(Channel{std::string{channel}, {}});
+    return channels_.back().streams;
+}
+
+} // namespace alpaca::streaming
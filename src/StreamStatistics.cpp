@@ -0,0 +1,142 @@
+#include "alpaca/StreamStatistics.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace alpaca::streaming {
+
+std::chrono::nanoseconds HistogramSnapshot::mean() const {
+    if (count == 0) {
+        return std::chrono::nanoseconds::zero();
+    }
+    return std::chrono::nanoseconds{static_cast<std::int64_t>(sum_ns / count)};
+}
+
+std::chrono::nanoseconds HistogramSnapshot::percentile(double quantile) const {
+    if (count == 0 || buckets.empty()) {
+        return std::chrono::nanoseconds::zero();
+    }
+    quantile = std::clamp(quantile, 0.0, 1.0);
+    auto const rank = static_cast<std::uint64_t>(std::ceil(quantile * static_cast<double>(count)));
+    auto const target = std::max<std::uint64_t>(rank, 1);
+    std::uint64_t seen = 0;
+    for (std::size_t index = 0; index < buckets.size(); ++index) {
+        seen += buckets[index];
+        if (seen >= target) {
+            auto const value = std::clamp(LatencyHistogram::bucket_lower_bound(index), min_ns, max_ns);
+            return std::chrono::nanoseconds{static_cast<std::int64_t>(value)};
+        }
+    }
+    return std::chrono::nanoseconds{static_cast<std::int64_t>(max_ns)};
+}
+
+std::size_t LatencyHistogram::bucket_index(std::uint64_t value_ns) noexcept {
+    if (value_ns < kSubBuckets) {
+        return static_cast<std::size_t>(value_ns);
+    }
+    auto const magnitude = static_cast<std::size_t>(std::bit_width(value_ns)) - 1;
+    auto const shift = magnitude - kSubBucketBits;
+    auto const sub_bucket = static_cast<std::size_t>((value_ns >> shift) & (kSubBuckets - 1));
+    return (shift + 1) * kSubBuckets + sub_bucket;
+}
+
+std::uint64_t LatencyHistogram::bucket_lower_bound(std::size_t index) noexcept {
+    if (index < kSubBuckets) {
+        return index;
+    }
+    auto const shift = index / kSubBuckets - 1;
+    auto const sub_bucket = static_cast<std::uint64_t>(index % kSubBuckets);
+    return (kSubBuckets + sub_bucket) << shift;
+}
+
+void LatencyHistogram::record(std::uint64_t value_ns) noexcept {
+    buckets_[bucket_index(value_ns)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value_ns, std::memory_order_relaxed);
+
+    auto current_min = min_.load(std::memory_order_relaxed);
+    while (value_ns < current_min &&
+           !min_.compare_exchange_weak(current_min, value_ns, std::memory_order_relaxed)) {
+    }
+    auto current_max = max_.load(std::memory_order_relaxed);
+    while (value_ns > current_max &&
+           !max_.compare_exchange_weak(current_max, value_ns, std::memory_order_relaxed)) {
+    }
+}
+
+HistogramSnapshot LatencyHistogram::snapshot() const {
+    HistogramSnapshot snapshot;
+    snapshot.buckets.resize(kBucketCount);
+    for (std::size_t index = 0; index < kBucketCount; ++index) {
+        snapshot.buckets[index] = buckets_[index].load(std::memory_order_relaxed);
+    }
+    snapshot.count = count_.load(std::memory_order_relaxed);
+    snapshot.sum_ns = sum_.load(std::memory_order_relaxed);
+    snapshot.max_ns = max_.load(std::memory_order_relaxed);
+    auto const min = min_.load(std::memory_order_relaxed);
+    snapshot.min_ns = snapshot.count == 0 ? 0 : min;
+    return snapshot;
+}
+
+HistogramSnapshot LatencyHistogram::take() {
+    HistogramSnapshot snapshot;
+    snapshot.buckets.resize(kBucketCount);
+    for (std::size_t index = 0; index < kBucketCount; ++index) {
+        snapshot.buckets[index] = buckets_[index].exchange(0, std::memory_order_relaxed);
+    }
+    snapshot.count = count_.exchange(0, std::memory_order_relaxed);
+    snapshot.sum_ns = sum_.exchange(0, std::memory_order_relaxed);
+    snapshot.max_ns = max_.exchange(0, std::memory_order_relaxed);
+    auto const min = min_.exchange(std::numeric_limits<std::uint64_t>::max(), std::memory_order_relaxed);
+    snapshot.min_ns = snapshot.count == 0 ? 0 : min;
+    return snapshot;
+}
+
+namespace detail {
+
+StreamStatistics StreamInstrumentation::snapshot() const {
+    StreamStatistics stats;
+    stats.exchange_to_receive = exchange_to_receive.snapshot();
+    stats.receive_to_dispatch = receive_to_dispatch.snapshot();
+    stats.handler_duration = handler_duration.snapshot();
+    stats.frames = frames.load(std::memory_order_relaxed);
+    stats.messages = messages.load(std::memory_order_relaxed);
+    stats.bytes = bytes.load(std::memory_order_relaxed);
+    stats.wire_bytes_received = wire_bytes_received.load(std::memory_order_relaxed);
+    stats.bytes_sent = bytes_sent.load(std::memory_order_relaxed);
+    stats.wire_bytes_sent = wire_bytes_sent.load(std::memory_order_relaxed);
+    stats.dropped_messages = dropped_messages.load(std::memory_order_relaxed);
+    stats.reconnects = reconnects.load(std::memory_order_relaxed);
+    stats.dispatcher_spin_ns = dispatcher_spin_ns.load(std::memory_order_relaxed);
+    stats.dispatcher_work_ns = dispatcher_work_ns.load(std::memory_order_relaxed);
+    stats.slow_handlers = slow_handlers.load(std::memory_order_relaxed);
+    stats.conflated_messages = conflated_messages.load(std::memory_order_relaxed);
+    stats.filtered_messages = filtered_messages.load(std::memory_order_relaxed);
+    return stats;
+}
+
+StreamStatistics StreamInstrumentation::take() {
+    StreamStatistics stats;
+    stats.exchange_to_receive = exchange_to_receive.take();
+    stats.receive_to_dispatch = receive_to_dispatch.take();
+    stats.handler_duration = handler_duration.take();
+    stats.frames = frames.exchange(0, std::memory_order_relaxed);
+    stats.messages = messages.exchange(0, std::memory_order_relaxed);
+    stats.bytes = bytes.exchange(0, std::memory_order_relaxed);
+    stats.wire_bytes_received = wire_bytes_received.exchange(0, std::memory_order_relaxed);
+    stats.bytes_sent = bytes_sent.exchange(0, std::memory_order_relaxed);
+    stats.wire_bytes_sent = wire_bytes_sent.exchange(0, std::memory_order_relaxed);
+    stats.dropped_messages = dropped_messages.exchange(0, std::memory_order_relaxed);
+    stats.reconnects = reconnects.exchange(0, std::memory_order_relaxed);
+    stats.dispatcher_spin_ns = dispatcher_spin_ns.exchange(0, std::memory_order_relaxed);
+    stats.dispatcher_work_ns = dispatcher_work_ns.exchange(0, std::memory_order_relaxed);
+    stats.slow_handlers = slow_handlers.exchange(0, std::memory_order_relaxed);
+    stats.conflated_messages = conflated_messages.exchange(0, std::memory_order_relaxed);
+    stats.filtered_messages = filtered_messages.exchange(0, std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace detail
+
+} // namespace alpaca::streaming
@@ -4,17 +4,30 @@
 #include <cctype>
 #include <chrono>
 #include <cmath>
+#include <concepts>
 #include <cstddef>
 #include <cstdint>
 #include <future>
 #include <limits>
 #include <random>
+#include <system_error>
 #include <thread>
 #include <utility>
 #include <vector>
 
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 #include "alpaca/BackfillCoordinator.hpp"
+#include "alpaca/Chrono.hpp"
 #include "alpaca/Exceptions.hpp"
+#include "alpaca/SequenceGapTracker.hpp"
+#include "alpaca/SubscriptionManager.hpp"
+#include "alpaca/SymbolFilter.hpp"
+#include "alpaca/SymbolWorkerPool.hpp"
+#include "alpaca/TradeStreamMerger.hpp"
 #include "alpaca/models/Account.hpp"
 #include "alpaca/models/Common.hpp"
 
@@ -26,6 +39,98 @@ std::int64_t steady_now_ns() {
     .count();
 }
 
+/// Tells the core a spin-wait is in progress, easing pressure on the sibling hyperthread.
+inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#else
+    std::this_thread::yield();
+#endif
+}
+
+/// Names the calling thread as shown by debuggers and `top -H`. Linux keeps the first 15 characters.
+void name_current_thread(char const* name) {
+#if defined(__linux__)
+    pthread_setname_np(pthread_self(), name);
+#else
+    static_cast<void>(name);
+#endif
+}
+
+/// Applies the CPU pinning and real-time priority requested for the dispatcher to the calling thread. Returns one
+/// message per setting the OS refused.
+std::vector<std::string> apply_dispatcher_placement(DispatcherOptions const& options) {
+    std::vector<std::string> failures;
+#if defined(__linux__)
+    if (options.cpu_affinity) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(*options.cpu_affinity, &cpus);
+        if (int const rc = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus); rc != 0) {
+            failures.push_back("Failed to pin dispatcher to CPU " + std::to_string(*options.cpu_affinity) + ": " +
+                               std::generic_category().message(rc));
+        }
+    }
+    if (options.realtime_priority) {
+        sched_param param{};
+        param.sched_priority = *options.realtime_priority;
+        if (int const rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param); rc != 0) {
+            failures.push_back("Failed to set SCHED_FIFO priority " + std::to_string(*options.realtime_priority) +
+                               " for dispatcher: " + std::generic_category().message(rc));
+        }
+    }
+#else
+    if (options.cpu_affinity || options.realtime_priority) {
+        failures.emplace_back("Dispatcher CPU pinning and real-time priority are only supported on Linux");
+    }
+#endif
+    return failures;
+}
+
+/// Returns the exchange event time carried by a decoded message, if any.
+std::optional<Timestamp> event_timestamp(StreamMessage const& message) {
+    return std::visit(
+    [](auto const& typed) -> std::optional<Timestamp> {
+        if constexpr (requires {
+                          { typed.timestamp } -> std::convertible_to<Timestamp>;
+                      }) {
+            if (typed.timestamp != Timestamp{}) {
+                return typed.timestamp;
+            }
+        }
+        return std::nullopt;
+    },
+    message);
+}
+
+/// Whether the handshake response accepted the permessage-deflate extension.
+template <typename Headers> bool offers_permessage_deflate(Headers const& headers) {
+    for (auto const& [name, value] : headers) {
+        if (name.size() == 24 && std::equal(name.begin(), name.end(), "sec-websocket-extensions", [](char lhs, char rhs) {
+                return std::tolower(static_cast<unsigned char>(lhs)) == rhs;
+            })) {
+            return value.find("permessage-deflate") != std::string::npos;
+        }
+    }
+    return false;
+}
+
+/// Symbol a decoded message belongs to; handler workers keep each symbol's messages in order.
+std::string_view routing_key(StreamMessage const& message) {
+    return std::visit(
+    [](auto const& typed) -> std::string_view {
+        if constexpr (requires {
+                          { typed.symbol } -> std::convertible_to<std::string_view>;
+                      }) {
+            return typed.symbol;
+        }
+        return {};
+    },
+    message);
+}
+
 Timestamp parse_timestamp_field_or_default(Json const& j, char const* key) {
     if (!j.contains(key)) {
         return {};
@@ -44,25 +149,19 @@ std::vector<std::string> parse_conditions(Json const& j, char const* key) {
     return j.at(key).get<std::vector<std::string>>();
 }
 
-std::optional<std::string> parse_string_field(Json const& payload, char const* key) {
-    if (!payload.contains(key) || payload.at(key).is_null()) {
-        return std::nullopt;
-    }
-    auto const& field = payload.at(key);
-    if (field.is_string()) {
-        return field.get<std::string>();
+/// The symbol `default_stream_identifier` returns, read in place.
+std::string_view default_stream_identifier_view(Json const& payload) {
+    for (char const* key : {"S", "symbol"}) {
+        auto const it = payload.find(key);
+        if (it != payload.end() && it->is_string()) {
+            return it->get_ref<std::string const&>();
+        }
     }
-    return std::nullopt;
+    return {};
 }
 
 std::string default_stream_identifier(Json const& payload) {
-    if (payload.contains("S") && payload.at("S").is_string()) {
-        return payload.at("S").get<std::string>();
-    }
-    if (payload.contains("symbol") && payload.at("symbol").is_string()) {
-        return payload.at("symbol").get<std::string>();
-    }
-    return {};
+    return std::string(default_stream_identifier_view(payload));
 }
 
 std::string to_lower_ascii(std::string value) {
@@ -72,22 +171,34 @@ std::string to_lower_ascii(std::string value) {
     return value;
 }
 
-std::string extract_message_channel(Json const& payload) {
-    if (auto type = parse_string_field(payload, "T")) {
-        return to_lower_ascii(*type);
-    }
-    if (auto event = parse_string_field(payload, "ev")) {
-        return to_lower_ascii(*event);
-    }
-    if (auto stream = parse_string_field(payload, "stream")) {
-        return to_lower_ascii(*stream);
-    }
-    if (auto event = parse_string_field(payload, "event")) {
-        return to_lower_ascii(*event);
+/// The message type or event name as sent, read in place.
+std::string_view raw_message_channel(Json const& payload) {
+    for (char const* key : {"T", "ev", "stream", "event"}) {
+        auto const it = payload.find(key);
+        if (it != payload.end() && it->is_string()) {
+            return it->get_ref<std::string const&>();
+        }
     }
     return {};
 }
 
+std::string extract_message_channel(Json const& payload) {
+    return to_lower_ascii(std::string(raw_message_channel(payload)));
+}
+
+/// `extract_message_channel` for the per-message path: Alpaca sends channels in lowercase, so only a channel with
+/// uppercase letters is copied into `lowered`.
+std::string_view message_channel(Json const& payload, std::string& lowered) {
+    auto const channel = raw_message_channel(payload);
+    if (std::none_of(channel.begin(), channel.end(), [](unsigned char ch) {
+            return std::isupper(ch) != 0;
+        })) {
+        return channel;
+    }
+    lowered = to_lower_ascii(std::string(channel));
+    return lowered;
+}
+
 std::optional<std::uint64_t> extract_sequence_value(Json const& payload, char const* key) {
     if (!payload.contains(key) || payload.at(key).is_null()) {
         return std::nullopt;
@@ -110,6 +221,17 @@ std::optional<std::uint64_t> extract_sequence_value(Json const& payload, char co
     return std::nullopt;
 }
 
+/// Event time of a market data payload as sent, without parsing it.
+std::string_view raw_event_time(Json const& payload) {
+    for (char const* key : {"t", "timestamp"}) {
+        auto const it = payload.find(key);
+        if (it != payload.end() && it->is_string()) {
+            return it->get_ref<std::string const&>();
+        }
+    }
+    return {};
+}
+
 std::optional<std::uint64_t> default_sequence_extractor(Json const& payload) {
     if (auto seq = extract_sequence_value(payload, "i")) {
         return seq;
@@ -607,7 +729,10 @@ WebSocketClient::WebSocketClient(std::string url, std::string key, std::string s
         tls_options_.caFile = "SYSTEM";
     }
 
+    subscriptions_ = std::make_unique<SubscriptionManager>();
     last_message_time_ns_.store(steady_now_ns());
+    // Received messages are stamped with the fast clock; calibrate it here rather than on the first one.
+    calibrate_fast_clock();
     start_dispatcher();
     start_heartbeat();
 
@@ -615,6 +740,7 @@ WebSocketClient::WebSocketClient(std::string url, std::string key, std::string s
     socket_.setPingInterval(static_cast<uint32_t>(ping_interval_.count()));
     socket_.setOnMessageCallback([this](ix::WebSocketMessagePtr const& msg) {
         if (msg->type == ix::WebSocketMessageType::Open) {
+            compression_negotiated_.store(offers_permessage_deflate(msg->openInfo.headers), std::memory_order_relaxed);
             {
                 std::lock_guard<std::mutex> lock(connection_mutex_);
                 connected_ = true;
@@ -628,13 +754,13 @@ WebSocketClient::WebSocketClient(std::string url, std::string key, std::string s
             authenticate();
             replay_subscriptions();
 
-            std::vector<Json> pending;
+            std::vector<std::string> pending;
             {
                 std::lock_guard<std::mutex> lock(connection_mutex_);
                 pending.swap(pending_messages_);
             }
-            for (auto const& payload : pending) {
-                send_raw(payload);
+            for (auto const& frame : pending) {
+                send_text(frame);
             }
 
             if (open_handler_) {
@@ -667,7 +793,9 @@ WebSocketClient::WebSocketClient(std::string url, std::string key, std::string s
                 should_retry = should_reconnect_ && !manual_disconnect_;
             }
             if (error_handler_) {
-                error_handler_(msg->errorInfo.reason);
+                error_handler_(msg->errorInfo.decompressionError ? "websocket frame decompression failed: " +
+                                                                   msg->errorInfo.reason
+                                                                 : msg->errorInfo.reason);
             }
             if (should_retry) {
                 schedule_reconnect();
@@ -679,25 +807,23 @@ WebSocketClient::WebSocketClient(std::string url, std::string key, std::string s
             return;
         }
 
-        try {
-            auto payload = Json::parse(msg->str);
-            record_activity();
-            if (payload.is_array()) {
-                for (auto const& entry : payload) {
-                    enqueue_incoming_message(entry);
-                }
-            } else {
-                enqueue_incoming_message(payload);
-            }
-        } catch (std::exception const& ex) {
-            if (error_handler_) {
-                error_handler_(ex.what());
-            }
-        }
+        handle_frame(msg->str, msg->wireSize);
     });
 }
 
+/// Shared handle through which coordinator worker threads reach the client.
+/// Detached under its mutex when the client stops merging or is destroyed.
+struct WebSocketClient::MergeBridge {
+    std::mutex mutex;
+    WebSocketClient* client{nullptr};
+};
+
 WebSocketClient::~WebSocketClient() {
+    stop_subscription_flusher();
+    if (merge_bridge_) {
+        std::lock_guard<std::mutex> lock(merge_bridge_->mutex);
+        merge_bridge_->client = nullptr;
+    }
     disconnect();
     std::thread thread_to_join;
     {
@@ -712,6 +838,7 @@ WebSocketClient::~WebSocketClient() {
 
     stop_heartbeat();
     stop_dispatcher();
+    worker_pool_.store(nullptr);
 }
 
 void WebSocketClient::connect() {
@@ -751,7 +878,7 @@ void WebSocketClient::disconnect() {
     }
     {
         std::lock_guard<std::mutex> lock(dispatcher_mutex_);
-        inbound_queue_.clear();
+        clear_inbound_locked();
     }
 }
 
@@ -762,147 +889,15 @@ std::future<void> WebSocketClient::disconnect_async() {
 }
 
 void WebSocketClient::subscribe(MarketSubscription const& subscription) {
-    MarketSubscription diff;
-    bool is_connected = false;
+    std::vector<Json> frames;
     {
         std::lock_guard<std::mutex> lock(connection_mutex_);
-        for (auto const& symbol : subscription.trades) {
-            if (subscribed_trades_.insert(symbol).second) {
-                diff.trades.push_back(symbol);
-            }
-        }
-        for (auto const& symbol : subscription.quotes) {
-            if (subscribed_quotes_.insert(symbol).second) {
-                diff.quotes.push_back(symbol);
-            }
-        }
-        for (auto const& symbol : subscription.bars) {
-            if (subscribed_bars_.insert(symbol).second) {
-                diff.bars.push_back(symbol);
-            }
-        }
-        for (auto const& symbol : subscription.updated_bars) {
-            if (subscribed_updated_bars_.insert(symbol).second) {
-                diff.updated_bars.push_back(symbol);
-            }
-        }
-        for (auto const& symbol : subscription.daily_bars) {
-            if (subscribed_daily_bars_.insert(symbol).second) {
-                diff.daily_bars.push_back(symbol);
-            }
-        }
-        for (auto const& symbol : subscription.statuses) {
-            if (subscribed_statuses_.insert(symbol).second) {
-                diff.statuses.push_back(symbol);
-            }
-        }
-        for (auto const& symbol : subscription.orderbooks) {
-            if (subscribed_orderbooks_.insert(symbol).second) {
-                diff.orderbooks.push_back(symbol);
-            }
-        }
-        for (auto const& symbol : subscription.lulds) {
-            if (subscribed_lulds_.insert(symbol).second) {
-                diff.lulds.push_back(symbol);
-            }
-        }
-        for (auto const& symbol : subscription.auctions) {
-            if (subscribed_auctions_.insert(symbol).second) {
-                diff.auctions.push_back(symbol);
-            }
-        }
-        for (auto const& symbol : subscription.greeks) {
-            if (subscribed_greeks_.insert(symbol).second) {
-                diff.greeks.push_back(symbol);
-            }
-        }
-        for (auto const& symbol : subscription.underlyings) {
-            if (subscribed_underlyings_.insert(symbol).second) {
-                diff.underlyings.push_back(symbol);
-            }
-        }
-        for (auto const& symbol : subscription.trade_cancels) {
-            if (subscribed_trade_cancels_.insert(symbol).second) {
-                diff.trade_cancels.push_back(symbol);
-            }
-        }
-        for (auto const& symbol : subscription.trade_corrections) {
-            if (subscribed_trade_corrections_.insert(symbol).second) {
-                diff.trade_corrections.push_back(symbol);
-            }
-        }
-        for (auto const& symbol : subscription.imbalances) {
-            if (subscribed_imbalances_.insert(symbol).second) {
-                diff.imbalances.push_back(symbol);
-            }
-        }
-        for (auto const& symbol : subscription.news) {
-            if (subscribed_news_.insert(symbol).second) {
-                diff.news.push_back(symbol);
-            }
+        if (!subscriptions_->subscribe(subscription)) {
+            return;
         }
-        is_connected = connected_.load();
-    }
-
-    if (diff.trades.empty() && diff.quotes.empty() && diff.bars.empty() && diff.updated_bars.empty() &&
-        diff.daily_bars.empty() && diff.statuses.empty() && diff.orderbooks.empty() && diff.lulds.empty() &&
-        diff.auctions.empty() && diff.greeks.empty() && diff.underlyings.empty() && diff.trade_cancels.empty() &&
-        diff.trade_corrections.empty() && diff.imbalances.empty() && diff.news.empty()) {
-        return;
-    }
-
-    if (!is_connected) {
-        return;
-    }
-
-    Json message;
-    message["action"] = "subscribe";
-    if (!diff.trades.empty()) {
-        message["trades"] = diff.trades;
-    }
-    if (!diff.quotes.empty()) {
-        message["quotes"] = diff.quotes;
-    }
-    if (!diff.bars.empty()) {
-        message["bars"] = diff.bars;
-    }
-    if (!diff.updated_bars.empty()) {
-        message["updatedBars"] = diff.updated_bars;
-    }
-    if (!diff.daily_bars.empty()) {
-        message["dailyBars"] = diff.daily_bars;
-    }
-    if (!diff.statuses.empty()) {
-        message["statuses"] = diff.statuses;
-    }
-    if (!diff.orderbooks.empty()) {
-        message["orderbooks"] = diff.orderbooks;
-    }
-    if (!diff.lulds.empty()) {
-        message["lulds"] = diff.lulds;
-    }
-    if (!diff.auctions.empty()) {
-        message["auctions"] = diff.auctions;
-    }
-    if (!diff.greeks.empty()) {
-        message["greeks"] = diff.greeks;
-    }
-    if (!diff.underlyings.empty()) {
-        message["underlyings"] = diff.underlyings;
-    }
-    if (!diff.trade_cancels.empty()) {
-        message["cancelErrors"] = diff.trade_cancels;
-    }
-    if (!diff.trade_corrections.empty()) {
-        message["corrections"] = diff.trade_corrections;
-    }
-    if (!diff.imbalances.empty()) {
-        message["imbalances"] = diff.imbalances;
-    }
-    if (!diff.news.empty()) {
-        message["news"] = diff.news;
+        frames = take_subscription_frames_locked();
     }
-    send_raw(message);
+    send_frames(frames);
 }
 
 std::future<void> WebSocketClient::subscribe_async(MarketSubscription subscription) {
@@ -912,153 +907,122 @@ std::future<void> WebSocketClient::subscribe_async(MarketSubscription subscripti
 }
 
 void WebSocketClient::unsubscribe(MarketSubscription const& subscription) {
-    MarketSubscription diff;
-    bool is_connected = false;
+    std::vector<Json> frames;
     {
         std::lock_guard<std::mutex> lock(connection_mutex_);
-        for (auto const& symbol : subscription.trades) {
-            if (subscribed_trades_.erase(symbol) > 0) {
-                diff.trades.push_back(symbol);
-            }
-        }
-        for (auto const& symbol : subscription.quotes) {
-            if (subscribed_quotes_.erase(symbol) > 0) {
-                diff.quotes.push_back(symbol);
-            }
-        }
-        for (auto const& symbol : subscription.bars) {
-            if (subscribed_bars_.erase(symbol) > 0) {
-                diff.bars.push_back(symbol);
-            }
-        }
-        for (auto const& symbol : subscription.updated_bars) {
-            if (subscribed_updated_bars_.erase(symbol) > 0) {
-                diff.updated_bars.push_back(symbol);
-            }
-        }
-        for (auto const& symbol : subscription.daily_bars) {
-            if (subscribed_daily_bars_.erase(symbol) > 0) {
-                diff.daily_bars.push_back(symbol);
-            }
-        }
-        for (auto const& symbol : subscription.statuses) {
-            if (subscribed_statuses_.erase(symbol) > 0) {
-                diff.statuses.push_back(symbol);
-            }
-        }
-        for (auto const& symbol : subscription.orderbooks) {
-            if (subscribed_orderbooks_.erase(symbol) > 0) {
-                diff.orderbooks.push_back(symbol);
-            }
-        }
-        for (auto const& symbol : subscription.lulds) {
-            if (subscribed_lulds_.erase(symbol) > 0) {
-                diff.lulds.push_back(symbol);
-            }
-        }
-        for (auto const& symbol : subscription.auctions) {
-            if (subscribed_auctions_.erase(symbol) > 0) {
-                diff.auctions.push_back(symbol);
-            }
-        }
-        for (auto const& symbol : subscription.greeks) {
-            if (subscribed_greeks_.erase(symbol) > 0) {
-                diff.greeks.push_back(symbol);
-            }
-        }
-        for (auto const& symbol : subscription.underlyings) {
-            if (subscribed_underlyings_.erase(symbol) > 0) {
-                diff.underlyings.push_back(symbol);
-            }
-        }
-        for (auto const& symbol : subscription.trade_cancels) {
-            if (subscribed_trade_cancels_.erase(symbol) > 0) {
-                diff.trade_cancels.push_back(symbol);
-            }
-        }
-        for (auto const& symbol : subscription.trade_corrections) {
-            if (subscribed_trade_corrections_.erase(symbol) > 0) {
-                diff.trade_corrections.push_back(symbol);
-            }
-        }
-        for (auto const& symbol : subscription.imbalances) {
-            if (subscribed_imbalances_.erase(symbol) > 0) {
-                diff.imbalances.push_back(symbol);
-            }
-        }
-        for (auto const& symbol : subscription.news) {
-            if (subscribed_news_.erase(symbol) > 0) {
-                diff.news.push_back(symbol);
-            }
+        if (!subscriptions_->unsubscribe(subscription)) {
+            return;
         }
-        is_connected = connected_.load();
+        frames = take_subscription_frames_locked();
     }
+    send_frames(frames);
+}
 
-    if (diff.trades.empty() && diff.quotes.empty() && diff.bars.empty() && diff.updated_bars.empty() &&
-        diff.daily_bars.empty() && diff.statuses.empty() && diff.orderbooks.empty() && diff.lulds.empty() &&
-        diff.auctions.empty() && diff.greeks.empty() && diff.underlyings.empty() && diff.trade_cancels.empty() &&
-        diff.trade_corrections.empty() && diff.imbalances.empty() && diff.news.empty()) {
-        return;
-    }
+std::future<void> WebSocketClient::unsubscribe_async(MarketSubscription subscription) {
+    return std::async(std::launch::async, [this, subscription = std::move(subscription)]() mutable {
+        this->unsubscribe(subscription);
+    });
+}
 
-    if (!is_connected) {
-        return;
+void WebSocketClient::set_subscription_batching(SubscriptionBatching batching) {
+    {
+        std::lock_guard<std::mutex> lock(connection_mutex_);
+        subscription_batching_ = batching;
     }
+    subscription_cv_.notify_all();
+    flush_subscriptions();
+}
 
-    Json message;
-    message["action"] = "unsubscribe";
-    if (!diff.trades.empty()) {
-        message["trades"] = diff.trades;
-    }
-    if (!diff.quotes.empty()) {
-        message["quotes"] = diff.quotes;
-    }
-    if (!diff.bars.empty()) {
-        message["bars"] = diff.bars;
-    }
-    if (!diff.updated_bars.empty()) {
-        message["updatedBars"] = diff.updated_bars;
-    }
-    if (!diff.daily_bars.empty()) {
-        message["dailyBars"] = diff.daily_bars;
-    }
-    if (!diff.statuses.empty()) {
-        message["statuses"] = diff.statuses;
-    }
-    if (!diff.orderbooks.empty()) {
-        message["orderbooks"] = diff.orderbooks;
-    }
-    if (!diff.lulds.empty()) {
-        message["lulds"] = diff.lulds;
-    }
-    if (!diff.auctions.empty()) {
-        message["auctions"] = diff.auctions;
+void WebSocketClient::flush_subscriptions() {
+    std::vector<Json> frames;
+    {
+        std::lock_guard<std::mutex> lock(connection_mutex_);
+        subscription_flush_deadline_.reset();
+        if (connected_.load()) {
+            frames = subscriptions_->take_pending_frames(subscription_batching_.max_frame_bytes);
+        } else {
+            subscriptions_->clear_pending();
+        }
     }
-    if (!diff.greeks.empty()) {
-        message["greeks"] = diff.greeks;
+    subscription_cv_.notify_all();
+    send_frames(frames);
+}
+
+MarketSubscription WebSocketClient::subscriptions() const {
+    std::lock_guard<std::mutex> lock(connection_mutex_);
+    return subscriptions_->active();
+}
+
+std::vector<Json> WebSocketClient::take_subscription_frames_locked() {
+    if (!connected_.load()) {
+        // Nothing to tell the server yet; the full set is replayed once the socket opens.
+        subscriptions_->clear_pending();
+        return {};
     }
-    if (!diff.underlyings.empty()) {
-        message["underlyings"] = diff.underlyings;
+    if (subscription_batching_.coalesce_window <= std::chrono::milliseconds::zero()) {
+        return subscriptions_->take_pending_frames(subscription_batching_.max_frame_bytes);
     }
-    if (!diff.trade_cancels.empty()) {
-        message["cancelErrors"] = diff.trade_cancels;
+    if (!subscription_flush_deadline_) {
+        subscription_flush_deadline_ = std::chrono::steady_clock::now() + subscription_batching_.coalesce_window;
     }
-    if (!diff.trade_corrections.empty()) {
-        message["corrections"] = diff.trade_corrections;
+    if (!subscription_flusher_running_) {
+        if (subscription_flusher_.joinable()) {
+            subscription_flusher_.join();
+        }
+        subscription_flusher_running_ = true;
+        subscription_flusher_ = std::thread([this]() {
+            name_current_thread("alpaca-subflush");
+            subscription_flush_loop();
+        });
     }
-    if (!diff.imbalances.empty()) {
-        message["imbalances"] = diff.imbalances;
+    subscription_cv_.notify_all();
+    return {};
+}
+
+void WebSocketClient::send_frames(std::vector<Json> const& frames) {
+    for (auto const& frame : frames) {
+        send_raw(frame);
     }
-    if (!diff.news.empty()) {
-        message["news"] = diff.news;
+}
+
+void WebSocketClient::subscription_flush_loop() {
+    std::unique_lock<std::mutex> lock(connection_mutex_);
+    while (subscription_flusher_running_) {
+        if (!subscription_flush_deadline_) {
+            subscription_cv_.wait(lock, [this]() {
+                return !subscription_flusher_running_ || subscription_flush_deadline_.has_value();
+            });
+            continue;
+        }
+        auto const deadline = *subscription_flush_deadline_;
+        if (std::chrono::steady_clock::now() < deadline) {
+            subscription_cv_.wait_until(lock, deadline);
+            continue;
+        }
+        subscription_flush_deadline_.reset();
+        std::vector<Json> frames;
+        if (connected_.load()) {
+            frames = subscriptions_->take_pending_frames(subscription_batching_.max_frame_bytes);
+        } else {
+            subscriptions_->clear_pending();
+        }
+        lock.unlock();
+        send_frames(frames);
+        lock.lock();
     }
-    send_raw(message);
 }
 
-std::future<void> WebSocketClient::unsubscribe_async(MarketSubscription subscription) {
-    return std::async(std::launch::async, [this, subscription = std::move(subscription)]() mutable {
-        this->unsubscribe(subscription);
-    });
+void WebSocketClient::stop_subscription_flusher() {
+    std::thread flusher;
+    {
+        std::lock_guard<std::mutex> lock(connection_mutex_);
+        subscription_flusher_running_ = false;
+        flusher = std::move(subscription_flusher_);
+    }
+    subscription_cv_.notify_all();
+    if (flusher.joinable()) {
+        flusher.join();
+    }
 }
 
 void WebSocketClient::listen(std::vector<std::string> const& streams) {
@@ -1096,32 +1060,75 @@ std::future<void> WebSocketClient::listen_async(std::vector<std::string> streams
 }
 
 void WebSocketClient::send_raw(Json const& message) {
-    std::lock_guard<std::mutex> lock(connection_mutex_);
-    if (!connected_) {
-        if (pending_message_limit_ > 0 && pending_messages_.size() >= pending_message_limit_) {
-            if (error_handler_) {
-                error_handler_("websocket send queue limit reached; rejecting message");
+    send_text(message.dump());
+}
+
+void WebSocketClient::send_text(std::string_view frame) {
+    if (!connected_.load()) {
+        std::unique_lock<std::mutex> lock(connection_mutex_);
+        if (!connected_.load()) {
+            if (pending_message_limit_ > 0 && pending_messages_.size() >= pending_message_limit_) {
+                lock.unlock();
+                if (error_handler_) {
+                    error_handler_("websocket send queue limit reached; rejecting message");
+                }
+                throw WebSocketQueueLimitException(pending_message_limit_);
             }
-            throw WebSocketQueueLimitException(pending_message_limit_);
-        }
-        pending_messages_.push_back(message);
-        if (test_hooks_.on_send_raw) {
-            test_hooks_.on_send_raw(message);
+            pending_messages_.emplace_back(frame);
+            lock.unlock();
+            if (test_hooks_.on_send_raw) {
+                test_hooks_.on_send_raw(Json::parse(frame, nullptr, false));
+            }
+            return;
         }
-        return;
     }
-    auto const payload = message.dump();
-    auto const info = socket_.sendText(payload);
-    if (!info.success && error_handler_) {
-        if (info.compressionError) {
-            error_handler_("websocket send failed due to compression error");
-        } else {
-            error_handler_("websocket send failed");
+    outbound_.push(std::string{frame});
+    drain_outbound();
+    if (test_hooks_.on_send_raw) {
+        test_hooks_.on_send_raw(Json::parse(frame, nullptr, false));
+    }
+}
+
+void WebSocketClient::drain_outbound() {
+    while (outbound_.try_acquire_consumer()) {
+        while (auto frame = outbound_.pop()) {
+            // The connection can close between a sender's check and this write; keep the frame for the next one.
+            if (!connected_.load() && park_outbound_frame(*frame)) {
+                continue;
+            }
+            auto const info = socket_.sendText(*frame);
+            instrumentation_.bytes_sent.fetch_add(info.payloadSize, std::memory_order_relaxed);
+            instrumentation_.wire_bytes_sent.fetch_add(info.wireSize, std::memory_order_relaxed);
+            if (!info.success && error_handler_) {
+                if (info.compressionError) {
+                    error_handler_("websocket send failed due to compression error");
+                } else {
+                    error_handler_("websocket send failed");
+                }
+            }
+        }
+        outbound_.release_consumer();
+        // A sender that lost the race for the consumer role relies on this re-check to get its frame written.
+        if (outbound_.empty()) {
+            return;
         }
     }
-    if (test_hooks_.on_send_raw) {
-        test_hooks_.on_send_raw(message);
+}
+
+bool WebSocketClient::park_outbound_frame(std::string& frame) {
+    std::unique_lock<std::mutex> lock(connection_mutex_);
+    if (connected_.load()) {
+        return false;
+    }
+    if (pending_message_limit_ > 0 && pending_messages_.size() >= pending_message_limit_) {
+        lock.unlock();
+        if (error_handler_) {
+            error_handler_("websocket send queue limit reached; dropping message queued before disconnect");
+        }
+        return true;
     }
+    pending_messages_.push_back(std::move(frame));
+    return true;
 }
 
 std::future<void> WebSocketClient::send_raw_async(Json message) {
@@ -1151,6 +1158,24 @@ void WebSocketClient::set_tls_options(ix::SocketTLSOptions options) {
     custom_tls_options_ = true;
 }
 
+void WebSocketClient::set_compression_options(CompressionOptions options) {
+    auto const valid_window = [](std::uint8_t bits) {
+        return bits >= 8 && bits <= 15;
+    };
+    if (!valid_window(options.client_max_window_bits)) {
+        throw InvalidArgumentException("client_max_window_bits", "deflate window bits must be between 8 and 15");
+    }
+    if (!valid_window(options.server_max_window_bits)) {
+        throw InvalidArgumentException("server_max_window_bits", "deflate window bits must be between 8 and 15");
+    }
+    std::lock_guard<std::mutex> lock(connection_mutex_);
+    compression_options_ = options;
+}
+
+bool WebSocketClient::compression_negotiated() const noexcept {
+    return compression_negotiated_.load(std::memory_order_relaxed);
+}
+
 void WebSocketClient::set_reconnect_policy(ReconnectPolicy policy) {
     std::lock_guard<std::mutex> lock(connection_mutex_);
     reconnect_policy_ = std::move(policy);
@@ -1192,43 +1217,138 @@ void WebSocketClient::set_incoming_message_limit(std::size_t limit) {
     if (incoming_message_limit_ > 0 && inbound_queue_.size() > incoming_message_limit_) {
         auto const overflow = inbound_queue_.size() - incoming_message_limit_;
         for (std::size_t i = 0; i < overflow; ++i) {
-            inbound_queue_.pop_front();
+            drop_oldest_inbound_locked();
         }
+        instrumentation_.dropped_messages.fetch_add(overflow, std::memory_order_relaxed);
+    }
+}
+
+void WebSocketClient::set_symbol_filter(std::shared_ptr<SymbolFilter> filter) {
+    symbol_filter_.store(std::move(filter), std::memory_order_release);
+}
+
+void WebSocketClient::clear_symbol_filter() {
+    symbol_filter_.store(nullptr, std::memory_order_release);
+}
+
+void WebSocketClient::set_conflation_policy(ConflationPolicy policy) {
+    std::lock_guard<std::mutex> lock(dispatcher_mutex_);
+    conflation_policy_ = policy;
+    conflation_index_.clear();
+}
+
+void WebSocketClient::clear_conflation_policy() {
+    std::lock_guard<std::mutex> lock(dispatcher_mutex_);
+    conflation_policy_.reset();
+    conflation_index_.clear();
+}
+
+void WebSocketClient::set_dispatcher_options(DispatcherOptions options) {
+    if (options.realtime_priority && (*options.realtime_priority < 1 || *options.realtime_priority > 99)) {
+        throw InvalidArgumentException("realtime_priority", "SCHED_FIFO priority must be between 1 and 99");
+    }
+    // Tasks queue from here until the switch is over, even while no dispatcher runs: a task posted by the
+    // dispatcher being joined would otherwise wait for the inline lock, and one posted from another thread
+    // would run ahead of the backlog. The dispatcher is joined before the inline lock is taken for that reason.
+    {
+        std::lock_guard<std::mutex> lock(dispatcher_mutex_);
+        dispatcher_switching_ = true;
+    }
+    stop_dispatcher();
+    {
+        std::lock_guard<std::mutex> lock(dispatcher_mutex_);
+        dispatcher_options_ = options;
+    }
+    std::shared_ptr<SymbolWorkerPool> pool;
+    if (options.worker_threads > 0) {
+        pool = std::make_shared<SymbolWorkerPool>(options.worker_threads, [this](std::string const& message) {
+            if (error_handler_) {
+                error_handler_(message);
+            }
+        });
+    }
+    // Replacing the pool finishes the handlers already queued on the previous one.
+    worker_pool_.store(std::move(pool), std::memory_order_release);
+    slow_handler_threshold_ns_.store(std::chrono::duration_cast<std::chrono::nanoseconds>(options.slow_handler_threshold)
+                                     .count(),
+                                     std::memory_order_relaxed);
+    // Waits out a payload being handled in line, and keeps the next ones waiting until the backlog is handed over.
+    std::lock_guard<std::recursive_mutex> inline_lock(inline_dispatch_mutex_);
+    inline_dispatch_.store(options.inline_dispatch, std::memory_order_release);
+    if (!options.inline_dispatch) {
+        start_dispatcher();
+        std::lock_guard<std::mutex> lock(dispatcher_mutex_);
+        dispatcher_switching_ = false;
+        return;
     }
+    run_dispatcher_backlog();
 }
 
 void WebSocketClient::set_sequence_gap_policy(SequenceGapPolicy policy) {
     std::lock_guard<std::mutex> lock(sequence_mutex_);
     sequence_policy_ = std::move(policy);
     refresh_sequence_identifier_metadata_locked();
-    last_sequence_ids_.clear();
+    publish_sequence_tracking_locked(true);
 }
 
 void WebSocketClient::clear_sequence_gap_policy() {
-    std::lock_guard<std::mutex> lock(sequence_mutex_);
-    sequence_policy_.reset();
-    last_sequence_ids_.clear();
-    sequence_identifier_uses_default_ = false;
-    backfill_coordinator_.reset();
-    backfill_passthrough_replay_ = {};
+    {
+        std::lock_guard<std::mutex> lock(sequence_mutex_);
+        sequence_policy_.reset();
+        sequence_identifier_uses_default_ = false;
+        backfill_coordinator_.reset();
+        backfill_passthrough_replay_ = {};
+        publish_sequence_tracking_locked(true);
+    }
+    reset_trade_merge();
 }
 
 void WebSocketClient::set_latency_monitor(LatencyMonitor monitor) {
-    std::lock_guard<std::mutex> lock(latency_mutex_);
-    latency_monitor_ = std::move(monitor);
+    latency_monitor_.store(std::make_shared<LatencyMonitor const>(std::move(monitor)), std::memory_order_release);
 }
 
 void WebSocketClient::clear_latency_monitor() {
-    std::lock_guard<std::mutex> lock(latency_mutex_);
-    latency_monitor_.reset();
+    latency_monitor_.store(nullptr, std::memory_order_release);
 }
 
-void WebSocketClient::enable_automatic_backfill(std::shared_ptr<BackfillCoordinator> coordinator) {
+void WebSocketClient::enable_automatic_backfill(std::shared_ptr<BackfillCoordinator> coordinator,
+                                                BackfillMergePolicy merge_policy) {
     if (!coordinator) {
         throw InvalidArgumentException("backfill_coordinator", "backfill coordinator must not be null",
                                        ErrorCode::NullBackfillCoordinator);
     }
 
+    reset_trade_merge();
+    if (merge_policy.enabled) {
+        auto bridge = std::make_shared<MergeBridge>();
+        bridge->client = this;
+        {
+            std::lock_guard<std::mutex> merge_lock(merge_mutex_);
+            TradeStreamMerger::Options merger_options;
+            merger_options.recent_id_capacity = merge_policy.recent_id_capacity;
+            merger_options.max_buffered_messages = merge_policy.max_buffered_messages;
+            merger_options.dedupe_window = merge_policy.dedupe_window;
+            trade_merger_ = std::make_unique<TradeStreamMerger>(merger_options);
+            merge_bridge_ = bridge;
+        }
+        std::weak_ptr<MergeBridge> weak_bridge = bridge;
+        coordinator->set_trade_replay_observer(
+        [weak_bridge](std::string const& symbol, std::vector<StockTrade> const& trades, bool succeeded) {
+            auto locked = weak_bridge.lock();
+            if (!locked) {
+                return;
+            }
+            std::lock_guard<std::mutex> bridge_lock(locked->mutex);
+            if (locked->client == nullptr) {
+                return;
+            }
+            auto* client = locked->client;
+            client->post_dispatcher_task([client, symbol, trades, succeeded]() {
+                client->complete_trade_merge(symbol, trades, succeeded);
+            });
+        });
+    }
+
     std::lock_guard<std::mutex> lock(sequence_mutex_);
 
     if (backfill_coordinator_) {
@@ -1240,13 +1360,14 @@ void WebSocketClient::enable_automatic_backfill(std::shared_ptr<BackfillCoordina
 
     backfill_coordinator_ = std::move(coordinator);
 
+    bool reset_positions = false;
     if (!sequence_policy_) {
         SequenceGapPolicy policy{};
         policy.stream_identifier = default_stream_identifier;
         policy.sequence_extractor = default_sequence_extractor;
         sequence_policy_ = std::move(policy);
-        last_sequence_ids_.clear();
         sequence_identifier_uses_default_ = true;
+        reset_positions = true;
     } else {
         bool updated_identifier = false;
         if (!sequence_policy_->stream_identifier) {
@@ -1257,33 +1378,209 @@ void WebSocketClient::enable_automatic_backfill(std::shared_ptr<BackfillCoordina
             sequence_policy_->sequence_extractor = default_sequence_extractor;
             updated_identifier = true;
         }
-        if (updated_identifier) {
-            last_sequence_ids_.clear();
-        }
+        reset_positions = updated_identifier;
         refresh_sequence_identifier_metadata_locked();
     }
 
     backfill_passthrough_replay_ = sequence_policy_->replay_request;
     std::weak_ptr<BackfillCoordinator> weak = backfill_coordinator_;
     sequence_policy_->replay_request =
-    [weak, passthrough = backfill_passthrough_replay_](std::string const& stream_id, std::uint64_t from_seq,
-                                                       std::uint64_t to_seq, Json const& payload) {
+    [this, weak, passthrough = backfill_passthrough_replay_, merge = merge_policy.enabled](
+    std::string const& stream_id, std::uint64_t from_seq, std::uint64_t to_seq, Json const& payload) {
         if (auto locked = weak.lock()) {
-            locked->request_backfill(stream_id, from_seq, to_seq, payload);
+            std::string symbol;
+            if (merge && extract_message_channel(payload) == "t" && payload.contains("S") &&
+                payload.at("S").is_string()) {
+                symbol = payload.at("S").get<std::string>();
+                // When trade ids carry the sequence, everything up to the gap has been delivered already.
+                std::string delivered_through;
+                if (from_seq > 0 && extract_sequence_value(payload, "i") == to_seq + 1) {
+                    delivered_through = std::to_string(from_seq - 1);
+                }
+                begin_trade_merge(symbol, delivered_through);
+            }
+            auto const scheduling = locked->request_backfill(stream_id, from_seq, to_seq, payload);
+            // Only a newly scheduled replay notifies the observer; a gap folded into a queued replay or one
+            // that was skipped must not leave its merge outstanding.
+            if (!symbol.empty() && scheduling != BackfillCoordinator::Scheduling::Scheduled) {
+                complete_trade_merge(symbol, {}, false);
+            }
         }
         if (passthrough) {
             passthrough(stream_id, from_seq, to_seq, payload);
         }
     };
+    publish_sequence_tracking_locked(reset_positions);
 }
 
 void WebSocketClient::disable_automatic_backfill() {
-    std::lock_guard<std::mutex> lock(sequence_mutex_);
-    if (sequence_policy_) {
-        sequence_policy_->replay_request = backfill_passthrough_replay_;
+    {
+        std::lock_guard<std::mutex> lock(sequence_mutex_);
+        if (sequence_policy_) {
+            sequence_policy_->replay_request = backfill_passthrough_replay_;
+        }
+        backfill_coordinator_.reset();
+        backfill_passthrough_replay_ = {};
+        publish_sequence_tracking_locked(false);
+    }
+    reset_trade_merge();
+}
+
+BackfillMergeStats WebSocketClient::backfill_merge_stats() const {
+    std::lock_guard<std::mutex> lock(merge_mutex_);
+    if (!trade_merger_) {
+        return {};
     }
-    backfill_coordinator_.reset();
-    backfill_passthrough_replay_ = {};
+    return trade_merger_->stats();
+}
+
+StreamStatistics WebSocketClient::stats() const {
+    return instrumentation_.snapshot();
+}
+
+StreamStatistics WebSocketClient::reset_stats() {
+    return instrumentation_.take();
+}
+
+void WebSocketClient::dispatch_trade(TradeMessage message, DeliveryContext const& context) {
+    if (!trade_merge_pending_.load(std::memory_order_acquire)) {
+        deliver(std::move(message), MessageCategory::Trade, context);
+        return;
+    }
+    auto const live_id = message.id;
+    auto const live_timestamp = message.timestamp;
+    std::vector<TradeMessage> ready;
+    {
+        std::lock_guard<std::mutex> lock(merge_mutex_);
+        if (trade_merger_) {
+            trade_merger_->on_live(std::move(message), [&ready](TradeMessage const& merged) {
+                ready.push_back(merged);
+            });
+            trade_merge_pending_.store(trade_merger_->active() > 0, std::memory_order_release);
+        } else {
+            ready.push_back(std::move(message));
+        }
+    }
+    for (auto const& trade : ready) {
+        // Trades released from the merge buffer did not arrive with this payload.
+        bool const is_live = trade.id == live_id && trade.timestamp == live_timestamp;
+        deliver(trade, MessageCategory::Trade, is_live ? context : DeliveryContext{});
+    }
+}
+
+void WebSocketClient::begin_trade_merge(std::string const& symbol, std::string_view delivered_through) {
+    std::lock_guard<std::mutex> lock(merge_mutex_);
+    if (trade_merger_) {
+        trade_merger_->begin_backfill(symbol, delivered_through);
+        trade_merge_pending_.store(true, std::memory_order_release);
+    }
+}
+
+void WebSocketClient::complete_trade_merge(std::string const& symbol, std::vector<StockTrade> const& trades,
+                                           bool succeeded) {
+    std::vector<TradeMessage> ready;
+    {
+        std::lock_guard<std::mutex> lock(merge_mutex_);
+        if (!trade_merger_) {
+            return;
+        }
+        auto collect = [&ready](TradeMessage const& merged) {
+            ready.push_back(merged);
+        };
+        if (succeeded) {
+            std::vector<TradeMessage> replayed;
+            replayed.reserve(trades.size());
+            for (auto const& trade : trades) {
+                replayed.push_back(TradeStreamMerger::to_message(symbol, trade));
+            }
+            trade_merger_->complete_backfill(symbol, std::move(replayed), collect);
+        } else {
+            trade_merger_->abandon_backfill(symbol, collect);
+        }
+        trade_merge_pending_.store(trade_merger_->active() > 0, std::memory_order_release);
+    }
+    if (!message_handler_) {
+        return;
+    }
+    for (auto const& trade : ready) {
+        deliver(trade, MessageCategory::Trade);
+    }
+}
+
+void WebSocketClient::reset_trade_merge() {
+    std::shared_ptr<MergeBridge> bridge;
+    std::unique_ptr<TradeStreamMerger> merger;
+    {
+        std::lock_guard<std::mutex> lock(merge_mutex_);
+        bridge = std::move(merge_bridge_);
+        merger = std::move(trade_merger_);
+        trade_merge_pending_.store(false, std::memory_order_release);
+    }
+    if (bridge) {
+        std::lock_guard<std::mutex> lock(bridge->mutex);
+        bridge->client = nullptr;
+    }
+    if (!merger) {
+        return;
+    }
+    std::vector<TradeMessage> ready;
+    merger->release_all([&ready](TradeMessage const& merged) {
+        ready.push_back(merged);
+    });
+    if (ready.empty()) {
+        return;
+    }
+    // Called from the user's thread; hand the released trades to the dispatcher so they are delivered in line
+    // with live traffic rather than alongside it.
+    post_dispatcher_task([this, ready = std::move(ready)]() {
+        if (!message_handler_) {
+            return;
+        }
+        for (auto const& trade : ready) {
+            deliver(trade, MessageCategory::Trade);
+        }
+    });
+}
+
+void WebSocketClient::post_dispatcher_task(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(dispatcher_mutex_);
+        if (dispatcher_running_ || dispatcher_switching_) {
+            dispatcher_tasks_.push_back(std::move(task));
+            dispatcher_signal_.fetch_add(1, std::memory_order_release);
+            dispatcher_cv_.notify_one();
+            return;
+        }
+    }
+    std::lock_guard<std::recursive_mutex> lock(inline_dispatch_mutex_);
+    task();
+}
+
+/// Snapshot of the gap policy consumed by `evaluate_sequence_gap`. The tracker
+/// is shared between snapshots so that policy tweaks keep sequence positions.
+struct WebSocketClient::SequenceTracking {
+    SequenceGapPolicy policy;
+    bool qualify_with_channel{false};
+    std::shared_ptr<BackfillCoordinator> coordinator;
+    std::shared_ptr<SequenceGapTracker> tracker;
+};
+
+void WebSocketClient::publish_sequence_tracking_locked(bool reset_positions) {
+    if (!sequence_policy_) {
+        sequence_tracking_.store(nullptr, std::memory_order_release);
+        return;
+    }
+    auto tracking = std::make_shared<SequenceTracking>();
+    tracking->policy = *sequence_policy_;
+    tracking->qualify_with_channel = sequence_identifier_uses_default_;
+    tracking->coordinator = backfill_coordinator_;
+    auto const current = sequence_tracking_.load(std::memory_order_acquire);
+    if (current && !reset_positions) {
+        tracking->tracker = current->tracker;
+    } else {
+        tracking->tracker = std::make_shared<SequenceGapTracker>();
+    }
+    sequence_tracking_.store(std::move(tracking), std::memory_order_release);
 }
 
 void WebSocketClient::refresh_sequence_identifier_metadata_locked() {
@@ -1322,85 +1619,91 @@ void WebSocketClient::authenticate() {
     }
 }
 
-void WebSocketClient::handle_payload(Json const& payload) {
+void WebSocketClient::handle_payload(Json const& payload, Timestamp received_at) {
+    if (received_at == Timestamp{}) {
+        received_at = fast_utc_now();
+    }
+    instrumentation_.messages.fetch_add(1, std::memory_order_relaxed);
     evaluate_sequence_gap(payload);
-    evaluate_latency(payload);
 
     if (!message_handler_) {
+        evaluate_latency(payload, std::nullopt);
         return;
     }
 
+    DeliveryContext const context{&payload, received_at};
+
     if (payload.contains("T")) {
         auto type = payload.at("T").get<std::string>();
         std::transform(type.begin(), type.end(), type.begin(), [](unsigned char ch) {
             return static_cast<char>(std::tolower(ch));
         });
         if (type == "t") {
-            message_handler_(build_trade_message(payload), MessageCategory::Trade);
+            dispatch_trade(std::get<TradeMessage>(build_trade_message(payload)), context);
             return;
         }
         if (type == "q") {
-            message_handler_(build_quote_message(payload), MessageCategory::Quote);
+            deliver(build_quote_message(payload), MessageCategory::Quote, context);
             return;
         }
         if (type == "b") {
-            message_handler_(build_bar_message(payload), MessageCategory::Bar);
+            deliver(build_bar_message(payload), MessageCategory::Bar, context);
             return;
         }
         if (type == "u") {
             if (payload.contains("uS") || payload.contains("underlying_symbol")) {
-                message_handler_(build_underlying_message(payload), MessageCategory::Underlying);
+                deliver(build_underlying_message(payload), MessageCategory::Underlying, context);
             } else {
-                message_handler_(build_updated_bar_message(payload), MessageCategory::UpdatedBar);
+                deliver(build_updated_bar_message(payload), MessageCategory::UpdatedBar, context);
             }
             return;
         }
         if (type == "d") {
-            message_handler_(build_daily_bar_message(payload), MessageCategory::DailyBar);
+            deliver(build_daily_bar_message(payload), MessageCategory::DailyBar, context);
             return;
         }
         if (type == "o") {
-            message_handler_(build_order_book_message(payload), MessageCategory::OrderBook);
+            deliver(build_order_book_message(payload), MessageCategory::OrderBook, context);
             return;
         }
         if (type == "l") {
-            message_handler_(build_luld_message(payload), MessageCategory::Luld);
+            deliver(build_luld_message(payload), MessageCategory::Luld, context);
             return;
         }
         if (type == "a") {
-            message_handler_(build_auction_message(payload), MessageCategory::Auction);
+            deliver(build_auction_message(payload), MessageCategory::Auction, context);
             return;
         }
         if (type == "g") {
-            message_handler_(build_greeks_message(payload), MessageCategory::Greeks);
+            deliver(build_greeks_message(payload), MessageCategory::Greeks, context);
             return;
         }
         if (type == "x") {
-            message_handler_(build_trade_cancel_message(payload), MessageCategory::TradeCancel);
+            deliver(build_trade_cancel_message(payload), MessageCategory::TradeCancel, context);
             return;
         }
         if (type == "c") {
-            message_handler_(build_trade_correction_message(payload), MessageCategory::TradeCorrection);
+            deliver(build_trade_correction_message(payload), MessageCategory::TradeCorrection, context);
             return;
         }
         if (type == "i") {
-            message_handler_(build_imbalance_message(payload), MessageCategory::Imbalance);
+            deliver(build_imbalance_message(payload), MessageCategory::Imbalance, context);
             return;
         }
         if (type == "n") {
-            message_handler_(build_news_message(payload), MessageCategory::News);
+            deliver(build_news_message(payload), MessageCategory::News, context);
             return;
         }
         if (type == "s") {
-            message_handler_(build_status_message(payload), MessageCategory::Status);
+            deliver(build_status_message(payload), MessageCategory::Status, context);
             return;
         }
         if (type == "error") {
-            message_handler_(build_error_message(payload), MessageCategory::Error);
+            deliver(build_error_message(payload), MessageCategory::Error, context);
             return;
         }
         if (type == "success" || type == "subscription" || type == "cancel" || type == "control" || type == "ping") {
-            handle_control_payload(payload, type);
+            handle_control_payload(payload, type, context);
             return;
         }
     }
@@ -1409,17 +1712,17 @@ void WebSocketClient::handle_payload(Json const& payload) {
         auto const stream = payload.at("stream").get<std::string>();
         if (stream == "trade_updates") {
             if (payload.contains("data")) {
-                message_handler_(build_order_update(payload.at("data")), MessageCategory::OrderUpdate);
+                deliver(build_order_update(payload.at("data")), MessageCategory::OrderUpdate, context);
             }
             return;
         }
         if (stream == "account_updates") {
             if (payload.contains("data")) {
-                message_handler_(build_account_update(payload.at("data")), MessageCategory::AccountUpdate);
+                deliver(build_account_update(payload.at("data")), MessageCategory::AccountUpdate, context);
             }
             return;
         }
-        handle_control_payload(payload, stream);
+        handle_control_payload(payload, stream, context);
         return;
     }
 
@@ -1427,26 +1730,49 @@ void WebSocketClient::handle_payload(Json const& payload) {
         auto const event = payload.at("event").get<std::string>();
         if (event == "trade_updates") {
             if (payload.contains("data")) {
-                message_handler_(build_order_update(payload.at("data")), MessageCategory::OrderUpdate);
+                deliver(build_order_update(payload.at("data")), MessageCategory::OrderUpdate, context);
             }
             return;
         }
         if (event == "account_updates") {
             if (payload.contains("data")) {
-                message_handler_(build_account_update(payload.at("data")), MessageCategory::AccountUpdate);
+                deliver(build_account_update(payload.at("data")), MessageCategory::AccountUpdate, context);
             }
             return;
         }
         if (event == "error") {
-            message_handler_(build_error_message(payload), MessageCategory::Error);
+            deliver(build_error_message(payload), MessageCategory::Error, context);
             return;
         }
     }
 
-    message_handler_(build_error_message(payload.dump()), MessageCategory::Unknown);
+    deliver(build_error_message(payload.dump()), MessageCategory::Unknown, context);
+}
+
+void WebSocketClient::deliver(StreamMessage const& message, MessageCategory category,
+                              DeliveryContext const& context) {
+    if (context.payload) {
+        auto const event_time = event_timestamp(message);
+        if (event_time) {
+            instrumentation_.exchange_to_receive.record(context.received_at - *event_time);
+        }
+        evaluate_latency(*context.payload, event_time);
+    }
+    if (auto const pool = worker_pool_.load(std::memory_order_acquire)) {
+        pool->post(routing_key(message), [this, message, category]() {
+            auto const started_ns = steady_now_ns();
+            message_handler_(message, category);
+            instrumentation_.handler_duration.record(static_cast<std::uint64_t>(steady_now_ns() - started_ns));
+        });
+        return;
+    }
+    auto const started_ns = steady_now_ns();
+    message_handler_(message, category);
+    instrumentation_.handler_duration.record(static_cast<std::uint64_t>(steady_now_ns() - started_ns));
 }
 
-void WebSocketClient::handle_control_payload(Json const& payload, std::string const& type) {
+void WebSocketClient::handle_control_payload(Json const& payload, std::string const& type,
+                                             DeliveryContext const& context) {
     if (type == "ping") {
         Json response;
         response["action"] = "pong";
@@ -1454,7 +1780,7 @@ void WebSocketClient::handle_control_payload(Json const& payload, std::string co
     }
 
     if (message_handler_) {
-        message_handler_(build_control_message(payload, type), MessageCategory::Control);
+        deliver(build_control_message(payload, type), MessageCategory::Control, context);
     }
 }
 
@@ -1462,82 +1788,16 @@ void WebSocketClient::replay_subscriptions() {
     if (test_hooks_.on_replay_subscriptions) {
         test_hooks_.on_replay_subscriptions();
     }
-    MarketSubscription snapshot;
+    std::vector<Json> frames;
     std::vector<std::string> streams;
     {
         std::lock_guard<std::mutex> lock(connection_mutex_);
-        snapshot.trades.assign(subscribed_trades_.begin(), subscribed_trades_.end());
-        snapshot.quotes.assign(subscribed_quotes_.begin(), subscribed_quotes_.end());
-        snapshot.bars.assign(subscribed_bars_.begin(), subscribed_bars_.end());
-        snapshot.updated_bars.assign(subscribed_updated_bars_.begin(), subscribed_updated_bars_.end());
-        snapshot.daily_bars.assign(subscribed_daily_bars_.begin(), subscribed_daily_bars_.end());
-        snapshot.statuses.assign(subscribed_statuses_.begin(), subscribed_statuses_.end());
-        snapshot.orderbooks.assign(subscribed_orderbooks_.begin(), subscribed_orderbooks_.end());
-        snapshot.lulds.assign(subscribed_lulds_.begin(), subscribed_lulds_.end());
-        snapshot.auctions.assign(subscribed_auctions_.begin(), subscribed_auctions_.end());
-        snapshot.greeks.assign(subscribed_greeks_.begin(), subscribed_greeks_.end());
-        snapshot.underlyings.assign(subscribed_underlyings_.begin(), subscribed_underlyings_.end());
-        snapshot.trade_cancels.assign(subscribed_trade_cancels_.begin(), subscribed_trade_cancels_.end());
-        snapshot.trade_corrections.assign(subscribed_trade_corrections_.begin(), subscribed_trade_corrections_.end());
-        snapshot.imbalances.assign(subscribed_imbalances_.begin(), subscribed_imbalances_.end());
-        snapshot.news.assign(subscribed_news_.begin(), subscribed_news_.end());
+        frames = subscriptions_->take_replay_frames(subscription_batching_.max_frame_bytes);
+        subscription_flush_deadline_.reset();
         streams.assign(listened_streams_.begin(), listened_streams_.end());
     }
 
-    if (!snapshot.trades.empty() || !snapshot.quotes.empty() || !snapshot.bars.empty() ||
-        !snapshot.updated_bars.empty() || !snapshot.daily_bars.empty() || !snapshot.statuses.empty() ||
-        !snapshot.orderbooks.empty() || !snapshot.lulds.empty() || !snapshot.auctions.empty() ||
-        !snapshot.greeks.empty() || !snapshot.underlyings.empty() || !snapshot.trade_cancels.empty() ||
-        !snapshot.trade_corrections.empty() || !snapshot.imbalances.empty() || !snapshot.news.empty()) {
-        Json message;
-        message["action"] = "subscribe";
-        if (!snapshot.trades.empty()) {
-            message["trades"] = snapshot.trades;
-        }
-        if (!snapshot.quotes.empty()) {
-            message["quotes"] = snapshot.quotes;
-        }
-        if (!snapshot.bars.empty()) {
-            message["bars"] = snapshot.bars;
-        }
-        if (!snapshot.updated_bars.empty()) {
-            message["updatedBars"] = snapshot.updated_bars;
-        }
-        if (!snapshot.daily_bars.empty()) {
-            message["dailyBars"] = snapshot.daily_bars;
-        }
-        if (!snapshot.statuses.empty()) {
-            message["statuses"] = snapshot.statuses;
-        }
-        if (!snapshot.orderbooks.empty()) {
-            message["orderbooks"] = snapshot.orderbooks;
-        }
-        if (!snapshot.lulds.empty()) {
-            message["lulds"] = snapshot.lulds;
-        }
-        if (!snapshot.auctions.empty()) {
-            message["auctions"] = snapshot.auctions;
-        }
-        if (!snapshot.greeks.empty()) {
-            message["greeks"] = snapshot.greeks;
-        }
-        if (!snapshot.underlyings.empty()) {
-            message["underlyings"] = snapshot.underlyings;
-        }
-        if (!snapshot.trade_cancels.empty()) {
-            message["cancelErrors"] = snapshot.trade_cancels;
-        }
-        if (!snapshot.trade_corrections.empty()) {
-            message["corrections"] = snapshot.trade_corrections;
-        }
-        if (!snapshot.imbalances.empty()) {
-            message["imbalances"] = snapshot.imbalances;
-        }
-        if (!snapshot.news.empty()) {
-            message["news"] = snapshot.news;
-        }
-        send_raw(message);
-    }
+    send_frames(frames);
 
     if (!streams.empty()) {
         Json message;
@@ -1598,11 +1858,13 @@ void WebSocketClient::schedule_reconnect() {
         previous_thread.join();
     }
 
+    instrumentation_.reconnects.fetch_add(1, std::memory_order_relaxed);
     auto const delay = compute_backoff_delay(attempt);
     if (test_hooks_.on_schedule_reconnect) {
         test_hooks_.on_schedule_reconnect();
     }
     std::thread worker([this, delay]() {
+        name_current_thread("alpaca-reconnect");
         std::this_thread::sleep_for(delay);
         std::lock_guard<std::mutex> lock(connection_mutex_);
         if (!should_reconnect_ || manual_disconnect_) {
@@ -1636,20 +1898,72 @@ void WebSocketClient::start_socket_locked() {
 
     socket_.setUrl(url_);
     socket_.setTLSOptions(tls_options_);
+    socket_.setPerMessageDeflateOptions(ix::WebSocketPerMessageDeflateOptions(
+    compression_options_.enabled, compression_options_.client_no_context_takeover,
+    compression_options_.server_no_context_takeover, compression_options_.client_max_window_bits,
+    compression_options_.server_max_window_bits));
     socket_.setPingInterval(static_cast<uint32_t>(ping_interval_.count()));
     socket_.start();
 }
 
-void WebSocketClient::enqueue_incoming_message(Json payload) {
+void WebSocketClient::handle_frame(std::string const& frame, std::size_t wire_size) {
+    auto const received_at = fast_utc_now();
+    instrumentation_.frames.fetch_add(1, std::memory_order_relaxed);
+    instrumentation_.bytes.fetch_add(frame.size(), std::memory_order_relaxed);
+    instrumentation_.wire_bytes_received.fetch_add(wire_size, std::memory_order_relaxed);
+    try {
+        if (auto const filter = symbol_filter_.load(std::memory_order_acquire)) {
+            if (auto const payloads = detail::split_raw_frame(frame)) {
+                record_activity();
+                for (auto const& raw : *payloads) {
+                    if (raw.symbol && !filter->allows(*raw.symbol)) {
+                        instrumentation_.filtered_messages.fetch_add(1, std::memory_order_relaxed);
+                        continue;
+                    }
+                    enqueue_incoming_message(Json::parse(raw.json), received_at);
+                }
+                return;
+            }
+        }
+        auto payload = Json::parse(frame);
+        record_activity();
+        if (payload.is_array()) {
+            for (auto const& entry : payload) {
+                enqueue_incoming_message(entry, received_at);
+            }
+        } else {
+            enqueue_incoming_message(payload, received_at);
+        }
+    } catch (std::exception const& ex) {
+        if (error_handler_) {
+            error_handler_(ex.what());
+        }
+    }
+}
+
+void WebSocketClient::enqueue_incoming_message(Json payload, Timestamp received_at) {
+    if (inline_dispatch_.load(std::memory_order_acquire)) {
+        dispatch_inline(payload, received_at);
+        return;
+    }
+    // A dispatcher that is not running is being restarted by `set_dispatcher_options`; the payload waits in the
+    // queue for it so it is not handled ahead of the ones already there.
     std::unique_lock<std::mutex> lock(dispatcher_mutex_);
-    if (!dispatcher_running_) {
+    if (!dispatcher_switching_ && inline_dispatch_.load(std::memory_order_acquire)) {
+        // The switch to inline dispatch finished after the check above, and nothing will drain the queue now.
         lock.unlock();
-        handle_payload(payload);
+        dispatch_inline(payload, received_at);
+        return;
+    }
+    InboundMessage inbound{std::move(payload), received_at, steady_now_ns()};
+    if (conflation_policy_ && conflate_locked(inbound)) {
+        // Replaced the payload already waiting for this key; the dispatcher has been signalled for it.
         return;
     }
 
     if (incoming_message_limit_ > 0 && inbound_queue_.size() >= incoming_message_limit_) {
-        inbound_queue_.pop_front();
+        drop_oldest_inbound_locked();
+        instrumentation_.dropped_messages.fetch_add(1, std::memory_order_relaxed);
         if (error_handler_) {
             auto handler = error_handler_;
             lock.unlock();
@@ -1657,34 +1971,235 @@ void WebSocketClient::enqueue_incoming_message(Json payload) {
             lock.lock();
         }
     }
-    inbound_queue_.push_back(std::move(payload));
+    inbound_queue_.push_back(std::move(inbound));
+    dispatcher_signal_.fetch_add(1, std::memory_order_release);
+    bool const blocking = dispatcher_options_.wait_strategy == DispatchWaitStrategy::Block;
     lock.unlock();
-    dispatcher_cv_.notify_one();
+    if (blocking) {
+        dispatcher_cv_.notify_one();
+    }
+}
+
+bool WebSocketClient::conflate_locked(InboundMessage& inbound) {
+    auto const& payload = inbound.payload;
+    if (!payload.is_object() || !payload.contains("T") || !payload.at("T").is_string() || !payload.contains("S") ||
+        !payload.at("S").is_string()) {
+        return false;
+    }
+    auto const& type = payload.at("T").get_ref<std::string const&>();
+    auto const& policy = *conflation_policy_;
+    bool conflatable = false;
+    if (type == "q") {
+        conflatable = policy.quotes;
+    } else if (type == "u") {
+        conflatable = policy.updated_bars;
+    } else if (type == "o") {
+        auto const is_snapshot = [&payload](char const* field) {
+            return payload.contains(field) && payload.at(field).is_boolean() && payload.at(field).get<bool>();
+        };
+        conflatable = policy.orderbooks && (is_snapshot("r") || is_snapshot("reset"));
+    } else {
+        return false;
+    }
+
+    std::string key;
+    key.reserve(type.size() + 1 + payload.at("S").get_ref<std::string const&>().size());
+    key.append(type).append(1, '|').append(payload.at("S").get_ref<std::string const&>());
+    if (!conflatable) {
+        // An incremental book update must be applied after the snapshot queued ahead of it, so that snapshot can no
+        // longer be replaced by a later one.
+        conflation_index_.erase(key);
+        return false;
+    }
+
+    if (auto const it = conflation_index_.find(key); it != conflation_index_.end()) {
+        conflation_slots_[it->second].latest = std::move(inbound);
+        instrumentation_.conflated_messages.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // First payload for the key: park it in a slot and let the caller queue a placeholder in its place.
+    std::uint32_t slot = 0;
+    if (free_conflation_slots_.empty()) {
+        slot = static_cast<std::uint32_t>(conflation_slots_.size());
+        conflation_slots_.emplace_back();
+    } else {
+        slot = free_conflation_slots_.back();
+        free_conflation_slots_.pop_back();
+    }
+    conflation_slots_[slot].latest = std::move(inbound);
+    conflation_slots_[slot].key = key;
+    conflation_index_.emplace(std::move(key), slot);
+    inbound = InboundMessage{};
+    inbound.conflation_slot = slot;
+    return false;
+}
+
+WebSocketClient::InboundMessage WebSocketClient::take_inbound_front_locked() {
+    auto inbound = std::move(inbound_queue_.front());
+    inbound_queue_.pop_front();
+    if (!inbound.conflation_slot) {
+        return inbound;
+    }
+    auto const slot = *inbound.conflation_slot;
+    auto latest = std::move(conflation_slots_[slot].latest);
+    release_conflation_slot_locked(slot);
+    return latest;
+}
+
+void WebSocketClient::drop_oldest_inbound_locked() {
+    auto const conflated = std::find_if(inbound_queue_.begin(), inbound_queue_.end(), [](InboundMessage const& entry) {
+        return entry.conflation_slot.has_value();
+    });
+    if (conflated == inbound_queue_.end()) {
+        static_cast<void>(take_inbound_front_locked());
+        return;
+    }
+    release_conflation_slot_locked(*conflated->conflation_slot);
+    inbound_queue_.erase(conflated);
+}
+
+void WebSocketClient::release_conflation_slot_locked(std::uint32_t slot) {
+    auto& entry = conflation_slots_[slot];
+    if (auto const it = conflation_index_.find(entry.key); it != conflation_index_.end() && it->second == slot) {
+        conflation_index_.erase(it);
+    }
+    entry.latest = InboundMessage{};
+    entry.key.clear();
+    free_conflation_slots_.push_back(slot);
+}
+
+void WebSocketClient::clear_inbound_locked() {
+    inbound_queue_.clear();
+    conflation_slots_.clear();
+    free_conflation_slots_.clear();
+    conflation_index_.clear();
+}
+
+void WebSocketClient::dispatch_inline(Json const& payload, Timestamp received_at) {
+    std::lock_guard<std::recursive_mutex> lock(inline_dispatch_mutex_);
+    auto const started_ns = steady_now_ns();
+    try {
+        handle_payload(payload, received_at);
+    } catch (std::exception const& ex) {
+        if (error_handler_) {
+            error_handler_(ex.what());
+        }
+    }
+    auto const elapsed_ns = std::max<std::int64_t>(steady_now_ns() - started_ns, 0);
+    instrumentation_.dispatcher_work_ns.fetch_add(static_cast<std::uint64_t>(elapsed_ns), std::memory_order_relaxed);
+    auto const threshold_ns = slow_handler_threshold_ns_.load(std::memory_order_relaxed);
+    if (threshold_ns > 0 && elapsed_ns > threshold_ns) {
+        instrumentation_.slow_handlers.fetch_add(1, std::memory_order_relaxed);
+    }
 }
 
 void WebSocketClient::dispatcher_loop() {
+    name_current_thread("alpaca-dispatch");
     std::unique_lock<std::mutex> lock(dispatcher_mutex_);
+    auto const options = dispatcher_options_;
+    lock.unlock();
+    for (auto const& failure : apply_dispatcher_placement(options)) {
+        if (error_handler_) {
+            error_handler_(failure);
+        }
+    }
+    bool const busy_poll = options.wait_strategy == DispatchWaitStrategy::BusyPoll;
+    lock.lock();
+
     while (dispatcher_running_) {
-        dispatcher_cv_.wait(lock, [this]() {
-            return !dispatcher_running_ || !inbound_queue_.empty();
-        });
+        if (busy_poll) {
+            if (inbound_queue_.empty() && dispatcher_tasks_.empty()) {
+                auto const observed = dispatcher_signal_.load(std::memory_order_acquire);
+                lock.unlock();
+                wait_for_dispatcher_signal(observed);
+                lock.lock();
+                continue;
+            }
+        } else {
+            dispatcher_cv_.wait(lock, [this]() {
+                return !dispatcher_running_ || !inbound_queue_.empty() || !dispatcher_tasks_.empty();
+            });
+        }
         if (!dispatcher_running_) {
             break;
         }
-        auto payload = std::move(inbound_queue_.front());
-        inbound_queue_.pop_front();
+        if (!dispatcher_tasks_.empty()) {
+            auto task = std::move(dispatcher_tasks_.front());
+            dispatcher_tasks_.pop_front();
+            lock.unlock();
+            auto const started_ns = steady_now_ns();
+            try {
+                task();
+            } catch (std::exception const& ex) {
+                if (error_handler_) {
+                    error_handler_(ex.what());
+                }
+            }
+            instrumentation_.dispatcher_work_ns.fetch_add(
+            static_cast<std::uint64_t>(std::max<std::int64_t>(steady_now_ns() - started_ns, 0)),
+            std::memory_order_relaxed);
+            lock.lock();
+            continue;
+        }
+        auto inbound = take_inbound_front_locked();
         lock.unlock();
+        auto const started_ns = steady_now_ns();
+        instrumentation_.receive_to_dispatch.record(
+        static_cast<std::uint64_t>(std::max<std::int64_t>(started_ns - inbound.received_steady_ns, 0)));
         try {
-            handle_payload(payload);
+            handle_payload(inbound.payload, inbound.received_at);
         } catch (std::exception const& ex) {
             if (error_handler_) {
                 error_handler_(ex.what());
             }
         }
+        instrumentation_.dispatcher_work_ns.fetch_add(
+        static_cast<std::uint64_t>(std::max<std::int64_t>(steady_now_ns() - started_ns, 0)), std::memory_order_relaxed);
         lock.lock();
     }
 }
 
+void WebSocketClient::run_dispatcher_backlog() {
+    while (true) {
+        std::function<void()> task;
+        std::optional<InboundMessage> inbound;
+        {
+            std::lock_guard<std::mutex> lock(dispatcher_mutex_);
+            if (!dispatcher_tasks_.empty()) {
+                task = std::move(dispatcher_tasks_.front());
+                dispatcher_tasks_.pop_front();
+            } else if (!inbound_queue_.empty()) {
+                inbound = take_inbound_front_locked();
+            } else {
+                dispatcher_switching_ = false;
+                return;
+            }
+        }
+        if (!task) {
+            dispatch_inline(inbound->payload, inbound->received_at);
+            continue;
+        }
+        std::lock_guard<std::recursive_mutex> lock(inline_dispatch_mutex_);
+        try {
+            task();
+        } catch (std::exception const& ex) {
+            if (error_handler_) {
+                error_handler_(ex.what());
+            }
+        }
+    }
+}
+
+void WebSocketClient::wait_for_dispatcher_signal(std::uint64_t observed) {
+    auto const started_ns = steady_now_ns();
+    while (dispatcher_signal_.load(std::memory_order_acquire) == observed) {
+        cpu_relax();
+    }
+    instrumentation_.dispatcher_spin_ns.fetch_add(
+    static_cast<std::uint64_t>(std::max<std::int64_t>(steady_now_ns() - started_ns, 0)), std::memory_order_relaxed);
+}
+
 void WebSocketClient::start_dispatcher() {
     std::lock_guard<std::mutex> lock(dispatcher_mutex_);
     if (dispatcher_running_) {
@@ -1703,6 +2218,7 @@ void WebSocketClient::stop_dispatcher() {
             return;
         }
         dispatcher_running_ = false;
+        dispatcher_signal_.fetch_add(1, std::memory_order_release);
     }
     dispatcher_cv_.notify_all();
     if (dispatcher_thread_.joinable()) {
@@ -1749,6 +2265,7 @@ void WebSocketClient::start_heartbeat() {
     }
     heartbeat_running_ = true;
     heartbeat_thread_ = std::thread([this]() {
+        name_current_thread("alpaca-heartbeat");
         heartbeat_loop();
     });
 }
@@ -1798,106 +2315,69 @@ void WebSocketClient::record_activity() {
 }
 
 void WebSocketClient::evaluate_sequence_gap(Json const& payload) {
-    std::function<void(std::string const&, std::uint64_t, std::uint64_t, Json const&)> gap_handler;
-    std::function<void(std::string const&, std::uint64_t, std::uint64_t, Json const&)> replay_handler;
-    std::string stream_id;
-    std::string tracking_id;
-    std::uint64_t expected = 0;
-    std::uint64_t observed = 0;
-    bool gap_detected = false;
-
-    {
-        std::lock_guard<std::mutex> lock(sequence_mutex_);
-        if (!sequence_policy_) {
-            return;
-        }
-
-        if (sequence_policy_->stream_identifier) {
-            stream_id = sequence_policy_->stream_identifier(payload);
-        }
-        if (stream_id.empty()) {
-            return;
-        }
-
-        tracking_id = stream_id;
-        if (sequence_identifier_uses_default_) {
-            auto channel = extract_message_channel(payload);
-            if (!channel.empty()) {
-                if (!tracking_id.empty()) {
-                    tracking_id = channel + "|" + tracking_id;
-                } else {
-                    tracking_id = channel;
-                }
-            }
-        }
+    auto const tracking = sequence_tracking_.load(std::memory_order_acquire);
+    if (!tracking || !tracking->policy.stream_identifier) {
+        return;
+    }
+    auto const& policy = tracking->policy;
 
-        if (backfill_coordinator_) {
-            backfill_coordinator_->record_payload(tracking_id, payload);
-        }
+    // Channels qualify the default identifier, which is read in place; only a custom identifier builds a string.
+    std::string custom_id;
+    std::string_view stream_id;
+    if (tracking->qualify_with_channel) {
+        stream_id = default_stream_identifier_view(payload);
+    } else {
+        custom_id = policy.stream_identifier(payload);
+        stream_id = custom_id;
+    }
+    if (stream_id.empty()) {
+        return;
+    }
 
-        if (!sequence_policy_->sequence_extractor) {
-            return;
-        }
-        auto seq = sequence_policy_->sequence_extractor(payload);
-        if (!seq.has_value()) {
-            return;
-        }
+    auto& tracker = *tracking->tracker;
+    std::string lowered;
+    auto const slot = tracking->qualify_with_channel ? tracker.slot(message_channel(payload, lowered), stream_id)
+                                                     : tracker.slot({}, stream_id);
 
-        auto const current = *seq;
-        auto const it = last_sequence_ids_.find(tracking_id);
-        if (it == last_sequence_ids_.end()) {
-            last_sequence_ids_.emplace(tracking_id, current);
-            return;
+    std::optional<SequenceGapTracker::Gap> gap;
+    if (policy.sequence_extractor) {
+        if (auto const sequence = policy.sequence_extractor(payload)) {
+            gap = tracker.observe(slot, *sequence);
         }
-
-        auto const previous = it->second;
-        expected = previous + 1;
-        observed = current;
-        if (observed > expected) {
-            gap_detected = true;
-        }
-        if (observed > previous) {
-            it->second = observed;
-        }
-
-        gap_handler = sequence_policy_->gap_handler;
-        replay_handler = sequence_policy_->replay_request;
     }
-
-    if (gap_detected) {
-        if (gap_handler) {
-            gap_handler(stream_id, expected, observed, payload);
-        }
-        if (replay_handler && observed > expected) {
-            replay_handler(stream_id, expected, observed - 1, payload);
+    // The coordinator only needs event times when a gap fires; the slot keeps the latest one until then.
+    if (tracking->coordinator) {
+        if (gap) {
+            tracking->coordinator->record_gap(tracker.key(slot), payload, tracker.last_time(slot));
         }
+        tracker.set_last_time(slot, raw_event_time(payload));
     }
-}
-
-void WebSocketClient::evaluate_latency(Json const& payload) {
-    std::optional<LatencyMonitor> monitor;
-    {
-        std::lock_guard<std::mutex> lock(latency_mutex_);
-        if (!latency_monitor_) {
-            return;
-        }
-        monitor = latency_monitor_;
+    if (!gap) {
+        return;
+    }
+    std::string const gap_stream_id(stream_id);
+    if (policy.gap_handler) {
+        policy.gap_handler(gap_stream_id, gap->expected, gap->observed, payload);
     }
+    if (policy.replay_request) {
+        policy.replay_request(gap_stream_id, gap->expected, gap->observed - 1, payload);
+    }
+}
 
-    if (!monitor->latency_handler || monitor->max_latency <= std::chrono::nanoseconds::zero()) {
+void WebSocketClient::evaluate_latency(Json const& payload, std::optional<Timestamp> event_time) {
+    auto const monitor = latency_monitor_.load(std::memory_order_acquire);
+    if (!monitor || !monitor->latency_handler || monitor->max_latency <= std::chrono::nanoseconds::zero()) {
         return;
     }
 
-    if (!monitor->timestamp_extractor) {
-        return;
+    if (monitor->timestamp_extractor) {
+        event_time = monitor->timestamp_extractor(payload);
     }
-    auto event_ts = monitor->timestamp_extractor(payload);
-    if (!event_ts.has_value()) {
+    if (!event_time.has_value()) {
         return;
     }
 
-    auto now = std::chrono::time_point_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now());
-    auto latency = now - *event_ts;
+    auto const latency = fast_utc_now() - *event_time;
     if (latency <= monitor->max_latency) {
         return;
     }
@@ -0,0 +1,187 @@
+#include "alpaca/SubscriptionManager.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace alpaca::streaming {
+
+namespace {
+struct ChannelSpec {
+    std::vector<std::string> MarketSubscription::*symbols;
+    char const* wire_name;
+};
+
+constexpr std::array<ChannelSpec, SubscriptionManager::kChannelCount> kChannels{{
+    {&MarketSubscription::trades, "trades"},
+    {&MarketSubscription::quotes, "quotes"},
+    {&MarketSubscription::bars, "bars"},
+    {&MarketSubscription::updated_bars, "updatedBars"},
+    {&MarketSubscription::daily_bars, "dailyBars"},
+    {&MarketSubscription::statuses, "statuses"},
+    {&MarketSubscription::orderbooks, "orderbooks"},
+    {&MarketSubscription::lulds, "lulds"},
+    {&MarketSubscription::auctions, "auctions"},
+    {&MarketSubscription::greeks, "greeks"},
+    {&MarketSubscription::underlyings, "underlyings"},
+    {&MarketSubscription::trade_cancels, "cancelErrors"},
+    {&MarketSubscription::trade_corrections, "corrections"},
+    {&MarketSubscription::imbalances, "imbalances"},
+    {&MarketSubscription::news, "news"},
+}};
+
+/// Upper bound on the serialised size of `value` as a JSON string, quotes included.
+std::size_t encoded_length(std::string const& value) {
+    std::size_t length = 2;
+    for (unsigned char const ch : value) {
+        if (ch == '"' || ch == '\\') {
+            length += 2;
+        } else if (ch < 0x20) {
+            length += 6;
+        } else {
+            length += 1;
+        }
+    }
+    return length;
+}
+} // namespace
+
+bool SubscriptionManager::subscribe(MarketSubscription const& subscription) {
+    bool changed = false;
+    for (std::size_t index = 0; index < kChannelCount; ++index) {
+        auto& channel = channels_[index];
+        for (auto const& symbol : subscription.*kChannels[index].symbols) {
+            if (!channel.active.insert(symbol).second) {
+                continue;
+            }
+            changed = true;
+            auto const it = channel.pending.find(symbol);
+            if (it != channel.pending.end() && it->second == Change::Unsubscribe) {
+                channel.pending.erase(it);
+            } else {
+                channel.pending[symbol] = Change::Subscribe;
+            }
+        }
+    }
+    return changed;
+}
+
+bool SubscriptionManager::unsubscribe(MarketSubscription const& subscription) {
+    bool changed = false;
+    for (std::size_t index = 0; index < kChannelCount; ++index) {
+        auto& channel = channels_[index];
+        for (auto const& symbol : subscription.*kChannels[index].symbols) {
+            if (channel.active.erase(symbol) == 0) {
+                continue;
+            }
+            changed = true;
+            auto const it = channel.pending.find(symbol);
+            if (it != channel.pending.end() && it->second == Change::Subscribe) {
+                channel.pending.erase(it);
+            } else {
+                channel.pending[symbol] = Change::Unsubscribe;
+            }
+        }
+    }
+    return changed;
+}
+
+bool SubscriptionManager::has_pending() const noexcept {
+    return std::any_of(channels_.begin(), channels_.end(), [](ChannelState const& channel) {
+        return !channel.pending.empty();
+    });
+}
+
+std::size_t SubscriptionManager::pending_changes() const noexcept {
+    std::size_t total = 0;
+    for (auto const& channel : channels_) {
+        total += channel.pending.size();
+    }
+    return total;
+}
+
+std::vector<Json> SubscriptionManager::take_pending_frames(std::size_t max_frame_bytes) {
+    std::array<std::vector<std::string>, kChannelCount> added{};
+    std::array<std::vector<std::string>, kChannelCount> removed{};
+    for (std::size_t index = 0; index < kChannelCount; ++index) {
+        for (auto& [symbol, change] : channels_[index].pending) {
+            (change == Change::Subscribe ? added : removed)[index].push_back(symbol);
+        }
+        channels_[index].pending.clear();
+    }
+
+    auto frames = build_frames("unsubscribe", std::move(removed), max_frame_bytes);
+    auto subscribe_frames = build_frames("subscribe", std::move(added), max_frame_bytes);
+    frames.insert(frames.end(), std::make_move_iterator(subscribe_frames.begin()),
+                  std::make_move_iterator(subscribe_frames.end()));
+    return frames;
+}
+
+std::vector<Json> SubscriptionManager::take_replay_frames(std::size_t max_frame_bytes) {
+    std::array<std::vector<std::string>, kChannelCount> symbols{};
+    for (std::size_t index = 0; index < kChannelCount; ++index) {
+        symbols[index].assign(channels_[index].active.begin(), channels_[index].active.end());
+    }
+    clear_pending();
+    return build_frames("subscribe", std::move(symbols), max_frame_bytes);
+}
+
+void SubscriptionManager::clear_pending() noexcept {
+    for (auto& channel : channels_) {
+        channel.pending.clear();
+    }
+}
+
+MarketSubscription SubscriptionManager::active() const {
+    MarketSubscription subscription;
+    for (std::size_t index = 0; index < kChannelCount; ++index) {
+        auto& symbols = subscription.*kChannels[index].symbols;
+        symbols.assign(channels_[index].active.begin(), channels_[index].active.end());
+        std::sort(symbols.begin(), symbols.end());
+    }
+    return subscription;
+}
+
+std::vector<Json> SubscriptionManager::build_frames(char const* action,
+                                                    std::array<std::vector<std::string>, kChannelCount> symbols,
+                                                    std::size_t max_frame_bytes) {
+    // Sizes are tracked as the frame grows rather than by re-serialising it. Each array is charged one separator more
+    // than it needs, which keeps the estimate a strict upper bound.
+    std::size_t const empty_frame_bytes = std::strlen(action) + 13; // {"action":"<action>"}
+    std::vector<Json> frames;
+    Json frame;
+    std::size_t frame_bytes = 0;
+    bool frame_has_symbols = false;
+    auto start_frame = [&]() {
+        frame = Json::object();
+        frame["action"] = action;
+        frame_bytes = empty_frame_bytes;
+        frame_has_symbols = false;
+    };
+    start_frame();
+
+    for (std::size_t index = 0; index < kChannelCount; ++index) {
+        auto& sorted = symbols[index];
+        std::sort(sorted.begin(), sorted.end());
+        auto const* key = kChannels[index].wire_name;
+        std::size_t const key_bytes = std::strlen(key) + 6; // ,"<key>":[]
+        for (auto& symbol : sorted) {
+            std::size_t const symbol_bytes = encoded_length(symbol) + 1;
+            std::size_t needed = symbol_bytes + (frame.contains(key) ? 0 : key_bytes);
+            if (max_frame_bytes > 0 && frame_has_symbols && frame_bytes + needed > max_frame_bytes) {
+                frames.push_back(std::move(frame));
+                start_frame();
+                needed = symbol_bytes + key_bytes;
+            }
+            frame[key].push_back(std::move(symbol));
+            frame_bytes += needed;
+            frame_has_symbols = true;
+        }
+    }
+    if (frame_has_symbols) {
+        frames.push_back(std::move(frame));
+    }
+    return frames;
+}
+
+} // namespace alpaca::streaming
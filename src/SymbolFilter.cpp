@@ -0,0 +1,203 @@
+#include "alpaca/SymbolFilter.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace alpaca::streaming {
+
+namespace {
+
+bool is_space(char ch) noexcept {
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+}
+
+std::size_t skip_space(std::string_view text, std::size_t pos) noexcept {
+    while (pos < text.size() && is_space(text[pos])) {
+        ++pos;
+    }
+    return pos;
+}
+
+/// Returns the index of the quote closing the string that opens at `open`, or npos. Sets `escaped` when the string
+/// contains a backslash.
+std::size_t string_end(std::string_view text, std::size_t open, bool& escaped) noexcept {
+    escaped = false;
+    for (std::size_t pos = open + 1; pos < text.size(); ++pos) {
+        if (text[pos] == '\\') {
+            escaped = true;
+            ++pos;
+        } else if (text[pos] == '"') {
+            return pos;
+        }
+    }
+    return std::string_view::npos;
+}
+
+} // namespace
+
+SymbolFilter::SymbolFilter() {
+    State initial;
+    initial.index = std::make_shared<Index const>();
+    state_.store(std::make_shared<State const>(std::move(initial)));
+}
+
+SymbolFilter::State SymbolFilter::with_symbols(State const& state, std::vector<std::string> const& symbols) {
+    State next;
+    next.bits = state.bits;
+    std::shared_ptr<Index> grown;
+    for (auto const& symbol : symbols) {
+        auto const& index = grown ? *grown : *state.index;
+        if (index.ids.find(symbol) != index.ids.end()) {
+            continue;
+        }
+        if (!grown) {
+            grown = std::make_shared<Index>(*state.index);
+        }
+        auto const id = static_cast<std::uint32_t>(grown->names.size());
+        grown->ids.emplace(symbol, id);
+        grown->names.push_back(symbol);
+    }
+    next.index = grown ? std::shared_ptr<Index const>(std::move(grown)) : state.index;
+    next.bits.resize((next.index->names.size() + 63) / 64, 0);
+    return next;
+}
+
+void SymbolFilter::allow(std::vector<std::string> const& symbols) {
+    std::lock_guard<std::mutex> lock(update_mutex_);
+    auto next = with_symbols(*state_.load(), symbols);
+    for (auto const& symbol : symbols) {
+        auto const id = next.index->ids.find(symbol)->second;
+        next.bits[id / 64] |= std::uint64_t{1} << (id % 64);
+    }
+    state_.store(std::make_shared<State const>(std::move(next)));
+}
+
+void SymbolFilter::block(std::vector<std::string> const& symbols) {
+    std::lock_guard<std::mutex> lock(update_mutex_);
+    auto const current = state_.load();
+    State next{current->index, current->bits};
+    for (auto const& symbol : symbols) {
+        auto const it = next.index->ids.find(symbol);
+        if (it != next.index->ids.end()) {
+            next.bits[it->second / 64] &= ~(std::uint64_t{1} << (it->second % 64));
+        }
+    }
+    state_.store(std::make_shared<State const>(std::move(next)));
+}
+
+void SymbolFilter::assign(std::vector<std::string> const& symbols) {
+    std::lock_guard<std::mutex> lock(update_mutex_);
+    auto next = with_symbols(*state_.load(), symbols);
+    std::fill(next.bits.begin(), next.bits.end(), 0);
+    for (auto const& symbol : symbols) {
+        auto const id = next.index->ids.find(symbol)->second;
+        next.bits[id / 64] |= std::uint64_t{1} << (id % 64);
+    }
+    state_.store(std::make_shared<State const>(std::move(next)));
+}
+
+bool SymbolFilter::allows(std::string_view symbol) const {
+    auto const state = state_.load(std::memory_order_acquire);
+    auto const it = state->index->ids.find(symbol);
+    if (it == state->index->ids.end()) {
+        return false;
+    }
+    return (state->bits[it->second / 64] >> (it->second % 64)) & 1U;
+}
+
+std::vector<std::string> SymbolFilter::allowed() const {
+    auto const state = state_.load(std::memory_order_acquire);
+    std::vector<std::string> symbols;
+    for (std::size_t id = 0; id < state->index->names.size(); ++id) {
+        if ((state->bits[id / 64] >> (id % 64)) & 1U) {
+            symbols.push_back(state->index->names[id]);
+        }
+    }
+    std::sort(symbols.begin(), symbols.end());
+    return symbols;
+}
+
+namespace detail {
+
+std::optional<std::vector<RawPayload>> split_raw_frame(std::string_view frame) {
+    std::vector<RawPayload> payloads;
+    std::size_t pos = skip_space(frame, 0);
+    if (pos == frame.size()) {
+        return std::nullopt;
+    }
+    bool const is_array = frame[pos] == '[';
+    if (is_array) {
+        pos = skip_space(frame, pos + 1);
+        if (pos < frame.size() && frame[pos] == ']') {
+            return payloads;
+        }
+    }
+
+    while (true) {
+        if (pos >= frame.size() || frame[pos] != '{') {
+            return std::nullopt;
+        }
+        std::size_t const start = pos;
+        std::optional<std::string_view> symbol;
+        int depth = 0;
+        bool expect_key = false;
+        for (; pos < frame.size(); ++pos) {
+            char const ch = frame[pos];
+            if (ch == '"') {
+                bool escaped = false;
+                auto const end = string_end(frame, pos, escaped);
+                if (end == std::string_view::npos) {
+                    return std::nullopt;
+                }
+                if (depth == 1 && expect_key) {
+                    expect_key = false;
+                    if (!escaped && frame.substr(pos + 1, end - pos - 1) == "S") {
+                        auto value = skip_space(frame, end + 1);
+                        if (value < frame.size() && frame[value] == ':') {
+                            value = skip_space(frame, value + 1);
+                            bool value_escaped = false;
+                            auto const value_end = value < frame.size() && frame[value] == '"'
+                                                   ? string_end(frame, value, value_escaped)
+                                                   : std::string_view::npos;
+                            if (value_end != std::string_view::npos && !value_escaped) {
+                                symbol = frame.substr(value + 1, value_end - value - 1);
+                            }
+                        }
+                    }
+                }
+                pos = end;
+            } else if (ch == '{' || ch == '[') {
+                ++depth;
+                expect_key = depth == 1;
+            } else if (ch == '}' || ch == ']') {
+                if (--depth == 0) {
+                    ++pos;
+                    break;
+                }
+            } else if (ch == ',' && depth == 1) {
+                expect_key = true;
+            }
+        }
+        if (depth != 0) {
+            return std::nullopt;
+        }
+        payloads.push_back(RawPayload{frame.substr(start, pos - start), symbol});
+
+        pos = skip_space(frame, pos);
+        if (!is_array) {
+            return pos == frame.size() ? std::optional{std::move(payloads)} : std::nullopt;
+        }
+        if (pos < frame.size() && frame[pos] == ',') {
+            pos = skip_space(frame, pos + 1);
+            continue;
+        }
+        if (pos < frame.size() && frame[pos] == ']' && skip_space(frame, pos + 1) == frame.size()) {
+            return payloads;
+        }
+        return std::nullopt;
+    }
+}
+
+} // namespace detail
+
+} // namespace alpaca::streaming
@@ -0,0 +1,208 @@
+#include "alpaca/SymbolWorkerPool.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+#if defined(__linux__)
+#include <pthread.h>
+#endif
+
+namespace alpaca::streaming {
+
+namespace {
+/// Tasks a worker runs from one lane before moving it behind the other ready lanes.
+constexpr std::size_t kLaneBatch = 32;
+/// Fewest lanes kept before idle ones are swept out.
+constexpr std::size_t kMinEvictAt = 1024;
+} // namespace
+
+SymbolWorkerPool::SymbolWorkerPool(std::size_t worker_count, ErrorHandler on_error)
+  : evict_at_(kMinEvictAt), on_error_(std::move(on_error)) {
+    worker_count = std::max<std::size_t>(worker_count, 1);
+    workers_.reserve(worker_count);
+    for (std::size_t i = 0; i < worker_count; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (std::size_t i = 0; i < worker_count; ++i) {
+        workers_[i]->thread = std::thread([this, i]() {
+#if defined(__linux__)
+            pthread_setname_np(pthread_self(), "alpaca-worker");
+#endif
+            run_worker(i);
+        });
+    }
+}
+
+SymbolWorkerPool::~SymbolWorkerPool() {
+    stopping_.store(true);
+    for (auto& worker : workers_) {
+        {
+            std::lock_guard<std::mutex> lock(worker->mutex);
+        }
+        worker->cv.notify_all();
+    }
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+void SymbolWorkerPool::post(std::string_view key, Task task) {
+    Lane* lane = nullptr;
+    {
+        // Held until the lane is scheduled: an evicted lane is one that is neither scheduled nor being posted to.
+        std::lock_guard<std::mutex> lanes_lock(lanes_mutex_);
+        auto it = lanes_.find(key);
+        if (it == lanes_.end()) {
+            if (lanes_.size() >= evict_at_) {
+                evict_idle_lanes_locked();
+            }
+            auto fresh = std::make_unique<Lane>();
+            fresh->home = StringHash{}(key) % workers_.size();
+            it = lanes_.emplace(std::string(key), std::move(fresh)).first;
+        }
+        lane = it->second.get();
+        std::lock_guard<std::mutex> lock(lane->mutex);
+        lane->tasks.push_back(std::move(task));
+        if (lane->scheduled) {
+            return;
+        }
+        lane->scheduled = true;
+    }
+    make_ready(*lane, lane->home);
+}
+
+std::size_t SymbolWorkerPool::lane_count() const {
+    std::lock_guard<std::mutex> lock(lanes_mutex_);
+    return lanes_.size();
+}
+
+void SymbolWorkerPool::evict_idle_lanes_locked() {
+    // Unscheduled lanes are empty and no worker holds them, so they can go.
+    std::erase_if(lanes_, [](auto const& entry) {
+        std::lock_guard<std::mutex> lock(entry.second->mutex);
+        return !entry.second->scheduled;
+    });
+    evict_at_ = std::max(kMinEvictAt, lanes_.size() * 2);
+}
+
+void SymbolWorkerPool::run_worker(std::size_t index) {
+    auto& self = *workers_[index];
+    while (true) {
+        Lane* lane = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(self.mutex);
+            if (!self.ready.empty()) {
+                lane = self.ready.front();
+                self.ready.pop_front();
+            }
+        }
+        if (lane == nullptr) {
+            lane = steal(index);
+        }
+        if (lane != nullptr) {
+            drain(*lane, index);
+            continue;
+        }
+
+        // Advertise idleness before the last steal attempt: a lane queued after it is seen by `make_ready`, which then
+        // pokes this worker.
+        self.idle.store(true);
+        lane = steal(index);
+        if (lane != nullptr) {
+            self.idle.store(false);
+            drain(*lane, index);
+            continue;
+        }
+        {
+            std::unique_lock<std::mutex> lock(self.mutex);
+            if (stopping_.load() && self.ready.empty()) {
+                self.idle.store(false);
+                return;
+            }
+            self.cv.wait(lock, [this, &self]() {
+                return stopping_.load() || self.poked || !self.ready.empty();
+            });
+            self.poked = false;
+        }
+        self.idle.store(false);
+    }
+}
+
+SymbolWorkerPool::Lane* SymbolWorkerPool::steal(std::size_t thief) {
+    for (std::size_t offset = 1; offset < workers_.size(); ++offset) {
+        auto& victim = *workers_[(thief + offset) % workers_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.ready.empty()) {
+            // Take from the back: the victim works from the front, so the two rarely want the same lane.
+            auto* lane = victim.ready.back();
+            victim.ready.pop_back();
+            steals_.fetch_add(1, std::memory_order_relaxed);
+            return lane;
+        }
+    }
+    return nullptr;
+}
+
+void SymbolWorkerPool::drain(Lane& lane, std::size_t worker) {
+    for (std::size_t ran = 0; ran < kLaneBatch; ++ran) {
+        Task task;
+        {
+            std::lock_guard<std::mutex> lock(lane.mutex);
+            if (lane.tasks.empty()) {
+                lane.scheduled = false;
+                return;
+            }
+            task = std::move(lane.tasks.front());
+            lane.tasks.pop_front();
+        }
+        try {
+            task();
+        } catch (std::exception const& ex) {
+            if (on_error_) {
+                on_error_(ex.what());
+            }
+        } catch (...) {
+            if (on_error_) {
+                on_error_("unknown error");
+            }
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(lane.mutex);
+        if (lane.tasks.empty()) {
+            lane.scheduled = false;
+            return;
+        }
+    }
+    // Still busy: queue it behind the other ready lanes so one hot key cannot starve the rest.
+    make_ready(lane, worker);
+}
+
+void SymbolWorkerPool::make_ready(Lane& lane, std::size_t worker) {
+    auto& target = *workers_[worker];
+    {
+        std::lock_guard<std::mutex> lock(target.mutex);
+        target.ready.push_back(&lane);
+    }
+    target.cv.notify_one();
+    if (target.idle.load()) {
+        return;
+    }
+    // The target is busy; wake an idle worker so it can steal the lane.
+    for (auto& other : workers_) {
+        if (other.get() == &target || !other->idle.load()) {
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(other->mutex);
+            other->poked = true;
+        }
+        other->cv.notify_one();
+        return;
+    }
+}
+
+} // namespace alpaca::streaming
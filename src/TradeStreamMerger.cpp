@@ -0,0 +1,256 @@
+#include "alpaca/TradeStreamMerger.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <string_view>
+#include <utility>
+
+namespace alpaca::streaming {
+
+namespace {
+std::uint64_t hash_trade_id(std::string const& id) {
+    auto const hash = static_cast<std::uint64_t>(std::hash<std::string_view>{}(id));
+    // Zero marks an empty slot.
+    return hash == 0 ? 1 : hash;
+}
+
+/// Orders trades by timestamp, breaking ties with the trade id. Numeric ids
+/// compare by length first so "9" sorts before "10".
+bool trade_precedes(TradeMessage const& lhs, TradeMessage const& rhs) {
+    if (lhs.timestamp != rhs.timestamp) {
+        return lhs.timestamp < rhs.timestamp;
+    }
+    if (lhs.id.size() != rhs.id.size()) {
+        return lhs.id.size() < rhs.id.size();
+    }
+    return lhs.id < rhs.id;
+}
+
+bool is_numeric_id(std::string_view id) {
+    return !id.empty() && std::all_of(id.begin(), id.end(), [](char c) {
+        return c >= '0' && c <= '9';
+    });
+}
+
+/// True when both ids are numeric and `id` does not come after `watermark`.
+bool id_at_or_before(std::string_view id, std::string_view watermark) {
+    if (!is_numeric_id(id) || !is_numeric_id(watermark)) {
+        return false;
+    }
+    if (id.size() != watermark.size()) {
+        return id.size() < watermark.size();
+    }
+    return id <= watermark;
+}
+} // namespace
+
+TradeStreamMerger::RecentIds::RecentIds(std::size_t capacity) {
+    // Twice the requested capacity keeps buckets sparse enough that an id is rarely evicted early.
+    auto const buckets = std::bit_ceil(std::max<std::size_t>(capacity * 2 / kBucketSize, 1));
+    slots_.assign(buckets * kBucketSize, 0);
+    next_victim_.assign(buckets, 0);
+    bucket_mask_ = buckets - 1;
+}
+
+std::size_t TradeStreamMerger::RecentIds::bucket_of(std::uint64_t id) const noexcept {
+    return static_cast<std::size_t>(id ^ (id >> 32)) & bucket_mask_;
+}
+
+bool TradeStreamMerger::RecentIds::contains(std::uint64_t id) const noexcept {
+    auto const first = bucket_of(id) * kBucketSize;
+    for (std::size_t i = first; i < first + kBucketSize; ++i) {
+        if (slots_[i] == id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void TradeStreamMerger::RecentIds::insert(std::uint64_t id) noexcept {
+    auto const bucket = bucket_of(id);
+    auto const first = bucket * kBucketSize;
+    for (std::size_t i = first; i < first + kBucketSize; ++i) {
+        if (slots_[i] == 0 || slots_[i] == id) {
+            slots_[i] = id;
+            return;
+        }
+    }
+    auto& victim = next_victim_[bucket];
+    slots_[first + victim] = id;
+    victim = static_cast<std::uint8_t>((victim + 1) % kBucketSize);
+}
+
+TradeStreamMerger::TradeStreamMerger() : TradeStreamMerger(Options{}) {
+}
+
+TradeStreamMerger::TradeStreamMerger(Options options) : options_(options) {
+}
+
+void TradeStreamMerger::begin_backfill(std::string const& symbol, std::string_view delivered_through) {
+    auto& state = state_for(symbol);
+    if (state.outstanding == 0) {
+        state.delivered_through.assign(delivered_through);
+        state.abandoned = false;
+        ++active_;
+    }
+    ++state.outstanding;
+    // A fresh gap holds live trades back again even if an earlier replay overflowed the buffer.
+    state.overflowed = false;
+}
+
+bool TradeStreamMerger::backfill_in_flight(std::string const& symbol) const {
+    auto const it = symbols_.find(symbol);
+    return it != symbols_.end() && it->second.outstanding > 0;
+}
+
+void TradeStreamMerger::on_live(TradeMessage message, Emit const& emit) {
+    ++live_seen_;
+    if (!retiring_.empty()) {
+        retire_expired();
+    }
+    auto const it = symbols_.find(message.symbol);
+    if (it == symbols_.end() || it->second.outstanding == 0) {
+        if (it != symbols_.end() && !message.id.empty() && it->second.recent.contains(hash_trade_id(message.id))) {
+            // A late live copy of a trade the settled merge already emitted.
+            ++stats_.duplicates_dropped;
+            return;
+        }
+        if (emit) {
+            emit(message);
+        }
+        return;
+    }
+
+    auto& state = it->second;
+    if (state.overflowed) {
+        emit_if_new(state, message, emit);
+        return;
+    }
+    state.buffered.push_back(std::move(message));
+    ++stats_.live_buffered;
+    if (options_.max_buffered_messages > 0 && state.buffered.size() >= options_.max_buffered_messages) {
+        // The replay is taking too long; stop holding live data back. The late replay is still merged and
+        // the id filter suppresses whatever overlaps with what was already released.
+        state.overflowed = true;
+        count_abandoned(state);
+        release(state, emit);
+    }
+}
+
+void TradeStreamMerger::complete_backfill(std::string const& symbol, std::vector<TradeMessage> replayed,
+                                          Emit const& emit) {
+    auto& state = state_for(symbol);
+    stats_.replayed_delivered += replayed.size();
+    state.buffered.reserve(state.buffered.size() + replayed.size());
+    for (auto& message : replayed) {
+        if (id_at_or_before(message.id, state.delivered_through)) {
+            ++stats_.duplicates_dropped;
+            continue;
+        }
+        state.buffered.push_back(std::move(message));
+    }
+    if (state.outstanding == 0) {
+        // Nothing is held back for the symbol any more, for example after `release_all`.
+        release(state, emit);
+        if (state.retire_at <= live_seen_) {
+            // Arrived after the dedupe window closed, or no window was ever opened.
+            symbols_.erase(symbol);
+        }
+    } else if (--state.outstanding == 0) {
+        if (!state.abandoned) {
+            ++stats_.merges_completed;
+        }
+        settle(symbol, state, emit);
+        retire_expired();
+    } else if (state.overflowed) {
+        release(state, emit);
+    }
+}
+
+void TradeStreamMerger::abandon_backfill(std::string const& symbol, Emit const& emit) {
+    auto const it = symbols_.find(symbol);
+    if (it == symbols_.end() || it->second.outstanding == 0) {
+        return;
+    }
+    if (--it->second.outstanding == 0) {
+        count_abandoned(it->second);
+        settle(symbol, it->second, emit);
+        retire_expired();
+    }
+}
+
+void TradeStreamMerger::release_all(Emit const& emit) {
+    for (auto& [symbol, state] : symbols_) {
+        if (state.outstanding > 0) {
+            state.outstanding = 0;
+            count_abandoned(state);
+            settle(symbol, state, emit);
+        }
+    }
+    retire_expired();
+}
+
+TradeMessage TradeStreamMerger::to_message(std::string const& symbol, StockTrade const& trade) {
+    return TradeMessage{symbol,     trade.id,        trade.exchange,   trade.price,
+                        trade.size, trade.timestamp, trade.conditions, trade.tape};
+}
+
+TradeStreamMerger::SymbolState& TradeStreamMerger::state_for(std::string const& symbol) {
+    auto it = symbols_.find(symbol);
+    if (it == symbols_.end()) {
+        it = symbols_.emplace(symbol, SymbolState{options_.recent_id_capacity}).first;
+    }
+    return it->second;
+}
+
+void TradeStreamMerger::settle(std::string const& symbol, SymbolState& state, Emit const& emit) {
+    --active_;
+    state.overflowed = false;
+    state.delivered_through.clear();
+    release(state, emit);
+    state.retire_at = live_seen_ + options_.dedupe_window;
+    retiring_.emplace_back(state.retire_at, symbol);
+}
+
+void TradeStreamMerger::count_abandoned(SymbolState& state) noexcept {
+    // An overflowed merge that later completes or is given up on is still one abandoned merge.
+    if (!state.abandoned) {
+        state.abandoned = true;
+        ++stats_.merges_abandoned;
+    }
+}
+
+void TradeStreamMerger::retire_expired() {
+    while (!retiring_.empty() && retiring_.front().first <= live_seen_) {
+        auto const it = symbols_.find(retiring_.front().second);
+        if (it != symbols_.end() && it->second.outstanding == 0 && it->second.retire_at == retiring_.front().first) {
+            symbols_.erase(it);
+        }
+        retiring_.pop_front();
+    }
+}
+
+void TradeStreamMerger::release(SymbolState& state, Emit const& emit) {
+    std::vector<TradeMessage> pending;
+    pending.swap(state.buffered);
+    std::stable_sort(pending.begin(), pending.end(), trade_precedes);
+    for (auto const& message : pending) {
+        emit_if_new(state, message, emit);
+    }
+}
+
+void TradeStreamMerger::emit_if_new(SymbolState& state, TradeMessage const& message, Emit const& emit) {
+    if (!message.id.empty()) {
+        auto const id = hash_trade_id(message.id);
+        if (state.recent.contains(id)) {
+            ++stats_.duplicates_dropped;
+            return;
+        }
+        state.recent.insert(id);
+    }
+    if (emit) {
+        emit(message);
+    }
+}
+
+} // namespace alpaca::streaming
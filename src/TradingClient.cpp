@@ -1,13 +1,26 @@
 #include "alpaca/TradingClient.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <random>
+#include <sstream>
 #include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
 
+#include "alpaca/Chrono.hpp"
+#include "alpaca/Exceptions.hpp"
 #include "alpaca/HttpClientFactory.hpp"
 #include "alpaca/Json.hpp"
+#include "alpaca/OrderLatencyTracer.hpp"
+#include "alpaca/OrderPayloadWriter.hpp"
+#include "alpaca/SymbolWorkerPool.hpp"
+#include "alpaca/internal/BoundedParallel.hpp"
 
 namespace alpaca {
 namespace {
@@ -16,6 +29,39 @@ Json symbol_payload(std::string const& symbol) {
         {"symbol", symbol}
     };
 }
+
+/// How long to hold a request back because the last rate limit status left no room for it beside the
+/// `in_flight` requests already sent. Zero once the window has reset.
+std::chrono::nanoseconds rate_limit_delay(RestClient const& rest_client, std::size_t in_flight,
+                                          std::chrono::milliseconds max_wait) {
+    auto const status = rest_client.last_rate_limit_status();
+    if (!status || !status->remaining || !status->reset ||
+        *status->remaining > static_cast<long>(in_flight)) {
+        return std::chrono::nanoseconds{0};
+    }
+    auto const until_reset = *status->reset - std::chrono::system_clock::now();
+    if (until_reset <= std::chrono::system_clock::duration::zero()) {
+        return std::chrono::nanoseconds{0};
+    }
+    return std::min<std::chrono::nanoseconds>(until_reset, max_wait);
+}
+
+/// Client order id for an order submitted without one: a random per-process prefix and a counter.
+std::string generate_client_order_id() {
+    static std::string const prefix = []() {
+        std::mt19937_64 generator{std::random_device{}()};
+        std::ostringstream out;
+        out << "alpaca-cpp-" << std::hex << generator() << '-';
+        return out.str();
+    }();
+    static std::atomic<std::uint64_t> counter{0};
+    return prefix + std::to_string(counter.fetch_add(1, std::memory_order_relaxed));
+}
+
+/// A submission that failed in transit, which may or may not have reached the API.
+bool is_transport_failure(CurlException const& ex) {
+    return ex.code() == ErrorCode::CurlPerformFailure;
+}
 } // namespace
 
 TradingClient::TradingClient(Configuration const& config, HttpClientPtr http_client, RestClient::Options options)
@@ -37,6 +83,8 @@ TradingClient::TradingClient(Environment const& environment, std::string api_key
   : TradingClient(environment, std::move(api_key_id), std::move(api_secret_key), nullptr, std::move(options)) {
 }
 
+TradingClient::~TradingClient() = default;
+
 Account TradingClient::get_account() {
     return rest_client_.get<Account>("/v2/account");
 }
@@ -237,11 +285,237 @@ BulkCancelOrdersResponse TradingClient::cancel_all_orders() {
 }
 
 Order TradingClient::submit_order(NewOrderRequest const& request) {
-    return rest_client_.post<Order>("/v2/orders", to_json_payload(request));
+    auto const started = latency_tracer_ ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+    return post_request(request, started, std::chrono::nanoseconds{0});
+}
+
+Order TradingClient::submit_order(OrderTemplate const& order_template, OrderTemplate::Fields const& fields) {
+    if (order_retry_ && fields.client_order_id.empty()) {
+        std::string const client_order_id = generate_client_order_id();
+        auto identified = fields;
+        identified.client_order_id = client_order_id;
+        return submit_order(order_template, identified);
+    }
+    auto const started = latency_tracer_ ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+    return post_order(order_template.format(fields), order_template.request().symbol, fields.client_order_id,
+                      started, std::chrono::nanoseconds{0});
+}
+
+Order TradingClient::post_request(NewOrderRequest const& request, std::chrono::steady_clock::time_point started,
+                                  std::chrono::nanoseconds paced) {
+    if (order_retry_ && !request.client_order_id) {
+        auto identified = request;
+        identified.client_order_id = generate_client_order_id();
+        return post_request(identified, started, paced);
+    }
+    return post_order(format_order_payload(request), request.symbol, request.client_order_id.value_or(""), started,
+                      paced);
+}
+
+Order TradingClient::post_order(std::string_view body, std::string_view symbol, std::string_view client_order_id,
+                                std::chrono::steady_clock::time_point started, std::chrono::nanoseconds paced) {
+    if (!latency_tracer_) {
+        return send_order(body, client_order_id, nullptr);
+    }
+    auto const serialized = std::chrono::steady_clock::now();
+    OrderTrace trace;
+    trace.client_order_id = client_order_id;
+    trace.symbol = symbol;
+    trace.started_at = utc_now() - std::chrono::duration_cast<std::chrono::nanoseconds>(serialized - started) - paced;
+    trace.serialize = serialized - started;
+
+    RestClient::RequestTrace request_trace;
+    auto const finish = [&]() {
+        trace.rate_limit_wait = paced + request_trace.retry_wait;
+        trace.connection_acquire = request_trace.http.connection_wait;
+        trace.send = request_trace.http.send;
+        trace.first_byte = request_trace.http.first_byte;
+        trace.body_complete = request_trace.http.body;
+        trace.decode = request_trace.decode;
+        trace.attempts = request_trace.attempts;
+        trace.response = std::chrono::steady_clock::now() - started + paced;
+        latency_tracer_->record(std::move(trace), started - paced);
+    };
+    try {
+        auto order = send_order(body, client_order_id, &request_trace);
+        trace.order_id = order.id;
+        if (trace.client_order_id.empty()) {
+            trace.client_order_id = order.client_order_id;
+        }
+        finish();
+        return order;
+    } catch (std::exception const& ex) {
+        trace.error = ex.what();
+        finish();
+        throw;
+    }
+}
+
+Order TradingClient::send_order(std::string_view body, std::string_view client_order_id,
+                                RestClient::RequestTrace* trace) {
+    auto const post = [&](std::string_view payload) {
+        return trace != nullptr ? rest_client_.post_serialized<Order>("/v2/orders", payload, *trace)
+                                : rest_client_.post_serialized<Order>("/v2/orders", payload);
+    };
+    if (!order_retry_ || client_order_id.empty()) {
+        return post(body);
+    }
+
+    std::exception_ptr failure;
+    try {
+        return post(body);
+    } catch (CurlException const& ex) {
+        if (!is_transport_failure(ex)) {
+            throw;
+        }
+        failure = std::current_exception();
+    }
+
+    // The API rejects a second order with the same client order id, so resubmitting cannot duplicate the
+    // order. By default only a resubmission that fails needs a lookup to find the order an earlier attempt
+    // placed; a concurrent probe overlaps that lookup with the resubmission instead.
+    std::string const payload(body);
+    std::string const id(client_order_id);
+    // Whether a lookup has run since the last attempt was sent.
+    bool looked_up = false;
+    for (std::size_t attempt = 1; attempt < order_retry_->max_attempts; ++attempt) {
+        if (order_retry_->retry_delay.count() > 0) {
+            std::this_thread::sleep_for(order_retry_->retry_delay);
+            if (trace != nullptr) {
+                trace->retry_wait += order_retry_->retry_delay;
+            }
+        }
+        auto probe = start_probe(id);
+        looked_up = !probe.valid();
+        try {
+            return post(payload);
+        } catch (CurlException const& ex) {
+            if (!is_transport_failure(ex)) {
+                throw;
+            }
+            failure = std::current_exception();
+        } catch (Exception const&) {
+            // Usually the duplicate client order id rejection. A probe sent alongside may have run before the
+            // earlier order became visible, so look again if it found nothing.
+            auto existing = probe.valid() ? probe.get() : std::nullopt;
+            if (!existing) {
+                existing = find_order(id);
+            }
+            if (existing) {
+                return std::move(*existing);
+            }
+            throw;
+        }
+        if (auto existing = probe.valid() ? probe.get() : find_order(id)) {
+            return std::move(*existing);
+        }
+    }
+    // A concurrent probe cannot see an order placed by the resubmission it overlapped, and a single attempt
+    // has no resubmission at all, so look once more before giving up.
+    if (!looked_up) {
+        if (auto existing = find_order(id)) {
+            return std::move(*existing);
+        }
+    }
+    std::rethrow_exception(failure);
+}
+
+std::optional<Order> TradingClient::find_order(std::string const& client_order_id) {
+    try {
+        return get_order_by_client_order_id(client_order_id);
+    } catch (std::exception const&) {
+        return std::nullopt;
+    }
+}
+
+std::future<std::optional<Order>> TradingClient::start_probe(std::string const& client_order_id) {
+    if (!probe_worker_) {
+        return {};
+    }
+    // The submission thread drops the future when its resubmission succeeds; the probe still finishes on
+    // the worker without holding it up.
+    auto result = std::make_shared<std::promise<std::optional<Order>>>();
+    auto future = result->get_future();
+    probe_worker_->post("probe", [this, result, client_order_id] { result->set_value(find_order(client_order_id)); });
+    return future;
+}
+
+void TradingClient::set_order_retry(std::optional<OrderRetryOptions> options) {
+    order_retry_ = std::move(options);
+    if (order_retry_ && order_retry_->concurrent_probe) {
+        if (!probe_worker_) {
+            probe_worker_ = std::make_unique<streaming::SymbolWorkerPool>(1);
+        }
+    } else {
+        probe_worker_.reset();
+    }
+}
+
+void TradingClient::set_latency_tracer(std::shared_ptr<OrderLatencyTracer> tracer) {
+    latency_tracer_ = std::move(tracer);
+}
+
+BasketSubmissionResponse TradingClient::submit_orders(std::span<NewOrderRequest const> requests,
+                                                      SubmitOrdersOptions const& options) {
+    BasketSubmissionResponse response;
+    response.results.resize(requests.size());
+    if (requests.empty()) {
+        return response;
+    }
+
+    std::atomic<std::size_t> in_flight{0};
+    std::atomic<bool> stopped{false};
+    std::mutex result_mutex;
+
+    auto const started = std::chrono::steady_clock::now();
+    detail::run_bounded(requests.size(), options.max_in_flight, "alpaca-basket", [&](std::size_t index) {
+        if (stopped.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(result_mutex);
+            response.results[index].index = index;
+            ++response.not_sent;
+            return;
+        }
+        auto const delay = rate_limit_delay(rest_client_, in_flight.load(), options.max_rate_limit_wait);
+        if (delay > std::chrono::nanoseconds{0}) {
+            std::this_thread::sleep_for(delay);
+        }
+
+        BasketOrderResult result;
+        result.index = index;
+        in_flight.fetch_add(1);
+        auto const sent = std::chrono::steady_clock::now();
+        try {
+            result.order = post_request(requests[index], sent, delay);
+        } catch (std::exception const& ex) {
+            result.error = std::current_exception();
+            result.error_message = ex.what();
+        } catch (...) {
+            result.error = std::current_exception();
+            result.error_message = "unknown error";
+        }
+        result.latency = std::chrono::steady_clock::now() - sent;
+        in_flight.fetch_sub(1);
+
+        std::lock_guard<std::mutex> lock(result_mutex);
+        response.rate_limit_wait += delay;
+        ++(result.order ? response.succeeded : response.failed);
+        if (options.on_result && !response.callback_error) {
+            try {
+                options.on_result(result);
+            } catch (...) {
+                // Orders already in flight still complete and are recorded; nothing new is sent.
+                response.callback_error = std::current_exception();
+                stopped.store(true, std::memory_order_release);
+            }
+        }
+        response.results[index] = std::move(result);
+    });
+    response.elapsed = std::chrono::steady_clock::now() - started;
+    return response;
 }
 
 Order TradingClient::replace_order(std::string const& order_id, ReplaceOrderRequest const& request) {
-    return rest_client_.patch<Order>("/v2/orders/" + order_id, to_json_payload(request));
+    return rest_client_.patch_serialized<Order>("/v2/orders/" + order_id, format_order_payload(request));
 }
 
 std::vector<OptionOrder> TradingClient::list_option_orders(ListOptionOrdersRequest const& request) {
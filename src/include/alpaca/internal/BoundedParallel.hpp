@@ -0,0 +1,57 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#endif
+
+namespace alpaca::detail {
+
+/// Calls `task(i)` for every `i` below `count` with at most `concurrency`
+/// calls running at once, and returns when all have finished. The calling
+/// thread takes part; the others are started for this call and named
+/// `thread_name`. If the system refuses to start more threads, the calls run
+/// on those already started. `task` must not throw.
+template <typename Task>
+void run_bounded(std::size_t count, std::size_t concurrency, char const* thread_name, Task const& task) {
+    if (count == 0) {
+        return;
+    }
+    std::atomic<std::size_t> next{0};
+    auto const drain = [&next, count, &task]() {
+        for (auto index = next.fetch_add(1); index < count; index = next.fetch_add(1)) {
+            task(index);
+        }
+    };
+
+    auto const thread_count = std::clamp<std::size_t>(concurrency, 1, count);
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count - 1);
+    for (std::size_t i = 1; i < thread_count; ++i) {
+        try {
+            threads.emplace_back([&drain, thread_name]() {
+#if defined(__linux__)
+                pthread_setname_np(pthread_self(), thread_name);
+#else
+                static_cast<void>(thread_name);
+#endif
+                drain();
+            });
+        } catch (std::system_error const&) {
+            // Out of threads: the ones already started, and this one, share the work instead.
+            break;
+        }
+    }
+    drain();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+} // namespace alpaca::detail
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "alpaca/models/Common.hpp"
+#include "alpaca/models/Order.hpp"
+
+namespace alpaca::detail {
+
+/// Order payload writers shared by `OrderPayloadWriter` and `OrderTemplate`.
+/// Each member writer emits `"key":value`, preceded by a comma unless
+/// `first` is set, and clears `first`.
+
+/// Buffer owned by the calling thread, cleared and reused by every payload
+/// formatted on it.
+[[nodiscard]] std::string& payload_buffer();
+
+/// Appends `value` as a JSON string escaped the way `Json::dump` escapes it.
+void append_string(std::string& out, std::string_view value);
+void append_key(std::string& out, bool& first, std::string_view key);
+void append_member(std::string& out, bool& first, std::string_view key, std::string_view value);
+void append_optional_member(std::string& out, bool& first, std::string_view key,
+                            std::optional<std::string> const& value);
+void append_member(std::string& out, bool& first, std::string_view key, bool value);
+void append_member(std::string& out, bool& first, std::string_view key, int value);
+void append_legs(std::string& out, bool& first, std::vector<OptionLeg> const& legs);
+void append_stop_loss(std::string& out, bool& first, StopLossParams const& stop_loss);
+void append_take_profit(std::string& out, bool& first, TakeProfitParams const& take_profit);
+
+} // namespace alpaca::detail
@@ -0,0 +1,123 @@
+#include "alpaca/models/BarSeries.hpp"
+
+#include <stdexcept>
+#include <string>
+
+namespace alpaca {
+
+BarSeries::BarSeries(std::vector<StockBar> const& bars) {
+    append(bars);
+}
+
+BarSeries BarSeries::from_bars(std::vector<StockBar> const& bars) {
+    return BarSeries(bars);
+}
+
+std::vector<StockBar> BarSeries::to_bars() const {
+    std::vector<StockBar> bars;
+    bars.reserve(size());
+    for (std::size_t index = 0; index < size(); ++index) {
+        bars.push_back(at(index));
+    }
+    return bars;
+}
+
+void BarSeries::reserve(std::size_t capacity) {
+    timestamps_.reserve(capacity);
+    opens_.reserve(capacity);
+    highs_.reserve(capacity);
+    lows_.reserve(capacity);
+    closes_.reserve(capacity);
+    volumes_.reserve(capacity);
+    trade_counts_.reserve(capacity);
+    vwaps_.reserve(capacity);
+    has_vwap_.reserve(capacity);
+}
+
+void BarSeries::clear() noexcept {
+    timestamps_.clear();
+    opens_.clear();
+    highs_.clear();
+    lows_.clear();
+    closes_.clear();
+    volumes_.clear();
+    trade_counts_.clear();
+    vwaps_.clear();
+    has_vwap_.clear();
+}
+
+void BarSeries::push_back(StockBar const& bar) {
+    timestamps_.push_back(bar.timestamp);
+    opens_.push_back(bar.open.raw());
+    highs_.push_back(bar.high.raw());
+    lows_.push_back(bar.low.raw());
+    closes_.push_back(bar.close.raw());
+    volumes_.push_back(bar.volume);
+    trade_counts_.push_back(bar.trade_count);
+    vwaps_.push_back(bar.vwap.has_value() ? bar.vwap->raw() : 0);
+    has_vwap_.push_back(bar.vwap.has_value() ? 1 : 0);
+}
+
+void BarSeries::append(std::vector<StockBar> const& bars) {
+    reserve(size() + bars.size());
+    for (auto const& bar : bars) {
+        push_back(bar);
+    }
+}
+
+void BarSeries::append_json(Json const& bars) {
+    if (bars.is_null()) {
+        return;
+    }
+    if (!bars.is_array()) {
+        throw InvalidArgumentException("bars", "Bar series JSON must be an array");
+    }
+    reserve(size() + bars.size());
+    for (auto const& j : bars) {
+        // Decode the whole row before touching the columns so a malformed bar cannot leave them misaligned.
+        Timestamp const timestamp = parse_timestamp(j.at("t").get<std::string>());
+        std::int64_t const open = j.at("o").get<Money>().raw();
+        std::int64_t const high = j.at("h").get<Money>().raw();
+        std::int64_t const low = j.at("l").get<Money>().raw();
+        std::int64_t const close = j.at("c").get<Money>().raw();
+        std::uint64_t const volume = j.at("v").get<std::uint64_t>();
+        std::uint64_t const trade_count = j.contains("n") ? j.at("n").get<std::uint64_t>() : 0;
+        bool const vwap_present = j.contains("vw") && !j.at("vw").is_null();
+        std::int64_t const vwap = vwap_present ? j.at("vw").get<Money>().raw() : 0;
+
+        timestamps_.push_back(timestamp);
+        opens_.push_back(open);
+        highs_.push_back(high);
+        lows_.push_back(low);
+        closes_.push_back(close);
+        volumes_.push_back(volume);
+        trade_counts_.push_back(trade_count);
+        vwaps_.push_back(vwap);
+        has_vwap_.push_back(vwap_present ? 1 : 0);
+    }
+}
+
+StockBar BarSeries::at(std::size_t index) const {
+    if (index >= size()) {
+        throw std::out_of_range("BarSeries index " + std::to_string(index) + " out of range");
+    }
+    StockBar bar;
+    bar.timestamp = timestamps_[index];
+    bar.open = Money::from_raw(opens_[index]);
+    bar.high = Money::from_raw(highs_[index]);
+    bar.low = Money::from_raw(lows_[index]);
+    bar.close = Money::from_raw(closes_[index]);
+    bar.volume = volumes_[index];
+    bar.trade_count = trade_counts_[index];
+    if (has_vwap_[index] != 0) {
+        bar.vwap = Money::from_raw(vwaps_[index]);
+    }
+    return bar;
+}
+
+void from_json(Json const& j, BarSeries& series) {
+    series.clear();
+    series.append_json(j);
+}
+
+} // namespace alpaca
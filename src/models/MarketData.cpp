@@ -563,7 +563,7 @@ template <typename Orderbooks> void parse_orderbooks(Json const& j, Orderbooks&
         return;
     }
     for (auto const& [symbol, value] : j.at("orderbooks").items()) {
-        OrderbookSnapshot snapshot = value.get<OrderbookSnapshot>();
+        OrderbookSnapshot snapshot = value.template get<OrderbookSnapshot>();
         snapshot.symbol = symbol;
         response.orderbooks.emplace(symbol, std::move(snapshot));
     }
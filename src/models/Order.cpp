@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cctype>
+#include <exception>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -184,6 +185,21 @@ template <typename Request> Json build_replace_order_payload(Request const& requ
     return j;
 }
 
+std::optional<Money> optional_money(std::optional<std::string> const& value) {
+    if (!value.has_value()) {
+        return std::nullopt;
+    }
+    return Money{std::string_view{*value}};
+}
+
+std::optional<Money> representable_money(std::optional<std::string> const& value) noexcept {
+    try {
+        return optional_money(value);
+    } catch (std::exception const&) {
+        return std::nullopt;
+    }
+}
+
 void append_timestamp(QueryParams& params, std::string const& key, std::optional<Timestamp> const& value) {
     if (value.has_value()) {
         params.emplace_back(key, format_timestamp(*value));
@@ -241,6 +257,19 @@ std::string to_string(OrderStatus status) {
     throw InvalidArgumentException("status", "Unknown OrderStatus");
 }
 
+bool is_terminal(OrderStatus status) noexcept {
+    switch (status) {
+    case OrderStatus::FILLED:
+    case OrderStatus::CANCELED:
+    case OrderStatus::EXPIRED:
+    case OrderStatus::REPLACED:
+    case OrderStatus::REJECTED:
+        return true;
+    default:
+        return false;
+    }
+}
+
 OrderStatus order_status_from_string(std::string const& value) {
     std::string const lower = to_lower_copy(value);
     if (lower == "new") {
@@ -482,6 +511,70 @@ void from_json(Json const& j, Order& order) {
     }
 }
 
+std::optional<Money> Order::qty_amount() const {
+    return optional_money(qty);
+}
+
+std::optional<Money> Order::notional_amount() const {
+    return optional_money(notional);
+}
+
+std::optional<Money> Order::filled_qty_amount() const {
+    return optional_money(filled_qty);
+}
+
+std::optional<Money> Order::filled_avg_price_amount() const {
+    return optional_money(filled_avg_price);
+}
+
+std::optional<Money> Order::limit_price_amount() const {
+    return optional_money(limit_price);
+}
+
+std::optional<Money> Order::stop_price_amount() const {
+    return optional_money(stop_price);
+}
+
+std::optional<Money> Order::trail_price_amount() const {
+    return optional_money(trail_price);
+}
+
+std::optional<Money> Order::high_water_mark_amount() const {
+    return optional_money(high_water_mark);
+}
+
+std::optional<Money> Order::qty_amount(std::nothrow_t) const noexcept {
+    return representable_money(qty);
+}
+
+std::optional<Money> Order::notional_amount(std::nothrow_t) const noexcept {
+    return representable_money(notional);
+}
+
+std::optional<Money> Order::filled_qty_amount(std::nothrow_t) const noexcept {
+    return representable_money(filled_qty);
+}
+
+std::optional<Money> Order::filled_avg_price_amount(std::nothrow_t) const noexcept {
+    return representable_money(filled_avg_price);
+}
+
+std::optional<Money> Order::limit_price_amount(std::nothrow_t) const noexcept {
+    return representable_money(limit_price);
+}
+
+std::optional<Money> Order::stop_price_amount(std::nothrow_t) const noexcept {
+    return representable_money(stop_price);
+}
+
+std::optional<Money> Order::trail_price_amount(std::nothrow_t) const noexcept {
+    return representable_money(trail_price);
+}
+
+std::optional<Money> Order::high_water_mark_amount(std::nothrow_t) const noexcept {
+    return representable_money(high_water_mark);
+}
+
 void to_json(Json& j, ReplaceOrderRequest const& request) {
     j = build_replace_order_payload(request);
 }
@@ -0,0 +1,788 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "alpaca/models/Order.hpp"
+
+namespace alpaca {
+namespace {
+
+enum class Field : std::uint8_t {
+    Unknown,
+    Id,
+    AssetId,
+    ClientOrderId,
+    AccountId,
+    CreatedAt,
+    UpdatedAt,
+    SubmittedAt,
+    FilledAt,
+    ExpiredAt,
+    CanceledAt,
+    FailedAt,
+    ReplacedAt,
+    ReplacedBy,
+    Replaces,
+    Symbol,
+    AssetClass,
+    Side,
+    Type,
+    TimeInForce,
+    OrderClass,
+    Status,
+    Qty,
+    Notional,
+    FilledQty,
+    FilledAvgPrice,
+    LimitPrice,
+    StopPrice,
+    TrailPrice,
+    TrailPercent,
+    HighWaterMark,
+    Hwm,
+    ExtendedHours,
+    BaseSymbol,
+    QuoteSymbol,
+    NotionalCurrency,
+    Venue,
+    RoutingStrategy,
+    PostOnly,
+    ReduceOnly,
+    Counterparty,
+    QuoteId,
+    SettlementDate,
+    Legs
+};
+
+/// Sorted by name for binary search.
+constexpr std::array<std::pair<std::string_view, Field>, 43> kFields{
+    {
+     {"account_id", Field::AccountId},
+     {"asset_class", Field::AssetClass},
+     {"asset_id", Field::AssetId},
+     {"base_symbol", Field::BaseSymbol},
+     {"canceled_at", Field::CanceledAt},
+     {"client_order_id", Field::ClientOrderId},
+     {"counterparty", Field::Counterparty},
+     {"created_at", Field::CreatedAt},
+     {"expired_at", Field::ExpiredAt},
+     {"extended_hours", Field::ExtendedHours},
+     {"failed_at", Field::FailedAt},
+     {"filled_at", Field::FilledAt},
+     {"filled_avg_price", Field::FilledAvgPrice},
+     {"filled_qty", Field::FilledQty},
+     {"high_water_mark", Field::HighWaterMark},
+     {"hwm", Field::Hwm},
+     {"id", Field::Id},
+     {"legs", Field::Legs},
+     {"limit_price", Field::LimitPrice},
+     {"notional", Field::Notional},
+     {"notional_currency", Field::NotionalCurrency},
+     {"order_class", Field::OrderClass},
+     {"post_only", Field::PostOnly},
+     {"qty", Field::Qty},
+     {"quote_id", Field::QuoteId},
+     {"quote_symbol", Field::QuoteSymbol},
+     {"reduce_only", Field::ReduceOnly},
+     {"replaced_at", Field::ReplacedAt},
+     {"replaced_by", Field::ReplacedBy},
+     {"replaces", Field::Replaces},
+     {"routing_strategy", Field::RoutingStrategy},
+     {"settlement_date", Field::SettlementDate},
+     {"side", Field::Side},
+     {"status", Field::Status},
+     {"stop_price", Field::StopPrice},
+     {"submitted_at", Field::SubmittedAt},
+     {"symbol", Field::Symbol},
+     {"time_in_force", Field::TimeInForce},
+     {"trail_percent", Field::TrailPercent},
+     {"trail_price", Field::TrailPrice},
+     {"type", Field::Type},
+     {"updated_at", Field::UpdatedAt},
+     {"venue", Field::Venue},
+     }
+};
+
+Field lookup_field(std::string_view name) noexcept {
+    auto const it = std::lower_bound(kFields.begin(), kFields.end(), name, [](auto const& entry, std::string_view key) {
+        return entry.first < key;
+    });
+    return it != kFields.end() && it->first == name ? it->second : Field::Unknown;
+}
+
+
+[[noreturn]] void throw_type_error(char const* expected, char const* actual) {
+    throw Json::type_error::create(302, std::string("type must be ") + expected + ", but is " + actual, nullptr);
+}
+
+[[noreturn]] void throw_missing_key(char const* key) {
+    throw Json::out_of_range::create(403, std::string("key '") + key + "' not found", nullptr);
+}
+
+[[noreturn]] void throw_wrong_type(Field field, char const* actual) {
+    switch (field) {
+    case Field::ExtendedHours:
+    case Field::PostOnly:
+    case Field::ReduceOnly:
+        throw_type_error("boolean", actual);
+    case Field::Legs:
+        throw_type_error("array", actual);
+    default:
+        throw_type_error("string", actual);
+    }
+}
+
+bool is_space(char ch) noexcept {
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+}
+
+bool is_digit(char ch) noexcept {
+    return ch >= '0' && ch <= '9';
+}
+
+/// Pull tokenizer over the response text. It validates JSON the way the Json parser does, but hands out string
+/// values as views into the text, so keys and short values are never copied.
+class Reader {
+  public:
+    explicit Reader(std::string_view text) : text_(text) {}
+
+    /// Next significant character, or '\0' at the end of the text.
+    char peek() {
+        while (pos_ < text_.size() && is_space(text_[pos_])) {
+            ++pos_;
+        }
+        return pos_ < text_.size() ? text_[pos_] : '\0';
+    }
+
+    bool consume(char expected) {
+        if (peek() != expected) {
+            return false;
+        }
+        ++pos_;
+        return true;
+    }
+
+    void expect(char expected) {
+        if (!consume(expected)) {
+            fail(std::string("expected '") + expected + "'");
+        }
+    }
+
+    void expect_end() {
+        if (peek() != '\0') {
+            fail("expected end of input");
+        }
+    }
+
+    /// Reads a string token. The view points into the text, or into a scratch buffer when the string has escapes; it
+    /// stays valid until the next call.
+    std::string_view read_string() {
+        expect('"');
+        auto const start = pos_;
+        while (pos_ < text_.size()) {
+            auto const ch = static_cast<unsigned char>(text_[pos_]);
+            if (ch == '"') {
+                return text_.substr(start, pos_++ - start);
+            }
+            if (ch == '\\') {
+                scratch_.assign(text_.data() + start, pos_ - start);
+                return read_escaped_string();
+            }
+            if (ch < 0x20) {
+                fail("control character in string");
+            }
+            pos_ = ch < 0x80 ? pos_ + 1 : skip_utf8(pos_);
+        }
+        fail("unterminated string");
+    }
+
+    void read_literal(std::string_view literal) {
+        if (text_.substr(pos_, literal.size()) != literal) {
+            fail("invalid literal");
+        }
+        pos_ += literal.size();
+    }
+
+    void read_number() {
+        consume('-');
+        if (pos_ < text_.size() && text_[pos_] == '0') {
+            ++pos_;
+        } else if (!read_digits()) {
+            fail("invalid number");
+        }
+        if (pos_ < text_.size() && text_[pos_] == '.') {
+            ++pos_;
+            if (!read_digits()) {
+                fail("invalid number");
+            }
+        }
+        if (pos_ < text_.size() && (text_[pos_] == 'e' || text_[pos_] == 'E')) {
+            ++pos_;
+            if (pos_ < text_.size() && (text_[pos_] == '+' || text_[pos_] == '-')) {
+                ++pos_;
+            }
+            if (!read_digits()) {
+                fail("invalid number");
+            }
+        }
+    }
+
+    /// Validates and discards one value of any type.
+    void skip_value() {
+        // Brackets of the containers being skipped; short enough to stay in the small-string buffer.
+        std::string open;
+        while (true) {
+            char const ch = peek();
+            if (ch == '{' || ch == '[') {
+                ++pos_;
+                if (!consume(ch == '{' ? '}' : ']')) {
+                    open.push_back(ch);
+                    if (ch == '{') {
+                        read_string();
+                        expect(':');
+                    }
+                    continue;
+                }
+            } else {
+                skip_scalar(ch);
+            }
+            // The value is complete: close every container it finished, then step to the next member or element.
+            while (!open.empty()) {
+                if (consume(',')) {
+                    if (open.back() == '{') {
+                        read_string();
+                        expect(':');
+                    }
+                    break;
+                }
+                expect(open.back() == '{' ? '}' : ']');
+                open.pop_back();
+            }
+            if (open.empty()) {
+                return;
+            }
+        }
+    }
+
+    [[noreturn]] void fail(std::string const& message) const {
+        throw Json::parse_error::create(101, pos_ + 1, "syntax error while parsing value - " + message, nullptr);
+    }
+
+  private:
+    bool read_digits() {
+        auto const start = pos_;
+        while (pos_ < text_.size() && is_digit(text_[pos_])) {
+            ++pos_;
+        }
+        return pos_ > start;
+    }
+
+    void skip_scalar(char ch) {
+        switch (ch) {
+        case '"':
+            read_string();
+            break;
+        case 't':
+            read_literal("true");
+            break;
+        case 'f':
+            read_literal("false");
+            break;
+        case 'n':
+            read_literal("null");
+            break;
+        default:
+            if (ch == '-' || is_digit(ch)) {
+                read_number();
+            } else {
+                fail("unexpected character");
+            }
+            break;
+        }
+    }
+
+    std::string_view read_escaped_string() {
+        while (pos_ < text_.size()) {
+            auto const ch = static_cast<unsigned char>(text_[pos_]);
+            if (ch == '"') {
+                ++pos_;
+                return scratch_;
+            }
+            if (ch < 0x20) {
+                fail("control character in string");
+            }
+            if (ch != '\\') {
+                auto const next = ch < 0x80 ? pos_ + 1 : skip_utf8(pos_);
+                scratch_.append(text_.data() + pos_, next - pos_);
+                pos_ = next;
+                continue;
+            }
+            if (++pos_ >= text_.size()) {
+                break;
+            }
+            switch (text_[pos_++]) {
+            case '"':
+                scratch_.push_back('"');
+                break;
+            case '\\':
+                scratch_.push_back('\\');
+                break;
+            case '/':
+                scratch_.push_back('/');
+                break;
+            case 'b':
+                scratch_.push_back('\b');
+                break;
+            case 'f':
+                scratch_.push_back('\f');
+                break;
+            case 'n':
+                scratch_.push_back('\n');
+                break;
+            case 'r':
+                scratch_.push_back('\r');
+                break;
+            case 't':
+                scratch_.push_back('\t');
+                break;
+            case 'u':
+                append_code_point(read_code_point());
+                break;
+            default:
+                fail("invalid escape");
+            }
+        }
+        fail("unterminated string");
+    }
+
+    std::uint32_t read_hex4() {
+        if (pos_ + 4 > text_.size()) {
+            fail("invalid \\u escape");
+        }
+        std::uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) {
+            char const ch = text_[pos_++];
+            value <<= 4;
+            if (is_digit(ch)) {
+                value |= static_cast<std::uint32_t>(ch - '0');
+            } else if (ch >= 'a' && ch <= 'f') {
+                value |= static_cast<std::uint32_t>(ch - 'a' + 10);
+            } else if (ch >= 'A' && ch <= 'F') {
+                value |= static_cast<std::uint32_t>(ch - 'A' + 10);
+            } else {
+                fail("invalid \\u escape");
+            }
+        }
+        return value;
+    }
+
+    std::uint32_t read_code_point() {
+        auto const high = read_hex4();
+        if (high >= 0xDC00 && high <= 0xDFFF) {
+            fail("unpaired low surrogate");
+        }
+        if (high < 0xD800 || high > 0xDBFF) {
+            return high;
+        }
+        if (text_.substr(pos_, 2) != "\\u") {
+            fail("unpaired high surrogate");
+        }
+        pos_ += 2;
+        auto const low = read_hex4();
+        if (low < 0xDC00 || low > 0xDFFF) {
+            fail("unpaired high surrogate");
+        }
+        return 0x10000 + ((high - 0xD800) << 10) + (low - 0xDC00);
+    }
+
+    void append_code_point(std::uint32_t code_point) {
+        if (code_point < 0x80) {
+            scratch_.push_back(static_cast<char>(code_point));
+        } else if (code_point < 0x800) {
+            scratch_.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+            scratch_.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+        } else if (code_point < 0x10000) {
+            scratch_.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+            scratch_.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+            scratch_.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+        } else {
+            scratch_.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+            scratch_.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+            scratch_.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+            scratch_.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+        }
+    }
+
+    /// Returns the index after the UTF-8 sequence starting at `at`, rejecting the same malformed input the Json
+    /// parser does.
+    std::size_t skip_utf8(std::size_t at) const {
+        auto const byte = [this](std::size_t index) {
+            return index < text_.size() ? static_cast<unsigned char>(text_[index]) : 0U;
+        };
+        auto const lead = byte(at);
+        auto const in = [](unsigned value, unsigned low, unsigned high) { return value >= low && value <= high; };
+        std::size_t length = 0;
+        bool valid = false;
+        if (in(lead, 0xC2, 0xDF)) {
+            length = 2;
+            valid = in(byte(at + 1), 0x80, 0xBF);
+        } else if (in(lead, 0xE0, 0xEF)) {
+            length = 3;
+            unsigned const low = lead == 0xE0 ? 0xA0 : 0x80;
+            unsigned const high = lead == 0xED ? 0x9F : 0xBF;
+            valid = in(byte(at + 1), low, high) && in(byte(at + 2), 0x80, 0xBF);
+        } else if (in(lead, 0xF0, 0xF4)) {
+            length = 4;
+            unsigned const low = lead == 0xF0 ? 0x90 : 0x80;
+            unsigned const high = lead == 0xF4 ? 0x8F : 0xBF;
+            valid = in(byte(at + 1), low, high) && in(byte(at + 2), 0x80, 0xBF) && in(byte(at + 3), 0x80, 0xBF);
+        }
+        if (!valid) {
+            fail("invalid UTF-8 byte");
+        }
+        return at + length;
+    }
+
+    std::string_view text_;
+    std::size_t pos_{0};
+    std::string scratch_;
+};
+
+/// Per-object bookkeeping for the checks `from_json` makes after reading every key.
+struct OrderFields {
+    bool has_id{false};
+    bool has_created_at{false};
+    bool has_high_water_mark{false};
+    std::optional<std::string> hwm{};
+};
+
+std::optional<Timestamp>* timestamp_field(Order& order, Field field) noexcept {
+    switch (field) {
+    case Field::UpdatedAt:
+        return &order.updated_at;
+    case Field::SubmittedAt:
+        return &order.submitted_at;
+    case Field::FilledAt:
+        return &order.filled_at;
+    case Field::ExpiredAt:
+        return &order.expired_at;
+    case Field::CanceledAt:
+        return &order.canceled_at;
+    case Field::FailedAt:
+        return &order.failed_at;
+    case Field::ReplacedAt:
+        return &order.replaced_at;
+    default:
+        return nullptr;
+    }
+}
+
+std::optional<std::string>* optional_string_field(Order& order, Field field) noexcept {
+    switch (field) {
+    case Field::Qty:
+        return &order.qty;
+    case Field::Notional:
+        return &order.notional;
+    case Field::FilledQty:
+        return &order.filled_qty;
+    case Field::FilledAvgPrice:
+        return &order.filled_avg_price;
+    case Field::LimitPrice:
+        return &order.limit_price;
+    case Field::StopPrice:
+        return &order.stop_price;
+    case Field::TrailPrice:
+        return &order.trail_price;
+    case Field::TrailPercent:
+        return &order.trail_percent;
+    case Field::BaseSymbol:
+        return &order.base_symbol;
+    case Field::QuoteSymbol:
+        return &order.quote_symbol;
+    case Field::NotionalCurrency:
+        return &order.notional_currency;
+    case Field::Venue:
+        return &order.venue;
+    case Field::RoutingStrategy:
+        return &order.routing_strategy;
+    case Field::Counterparty:
+        return &order.counterparty;
+    case Field::QuoteId:
+        return &order.quote_id;
+    case Field::SettlementDate:
+        return &order.settlement_date;
+    default:
+        return nullptr;
+    }
+}
+
+void apply_string(Order& order, OrderFields& fields, Field field, std::string_view value) {
+    switch (field) {
+    case Field::Unknown:
+        break;
+    case Field::Id:
+        order.id.assign(value);
+        fields.has_id = true;
+        break;
+    case Field::AssetId:
+        order.asset_id.assign(value);
+        break;
+    case Field::ClientOrderId:
+        order.client_order_id.assign(value);
+        break;
+    case Field::AccountId:
+        order.account_id.assign(value);
+        break;
+    case Field::CreatedAt:
+        order.created_at = parse_timestamp(value);
+        fields.has_created_at = true;
+        break;
+    case Field::ReplacedBy:
+        order.replaced_by.assign(value);
+        break;
+    case Field::Replaces:
+        order.replaces.assign(value);
+        break;
+    case Field::Symbol:
+        order.symbol.assign(value);
+        break;
+    case Field::AssetClass:
+        order.asset_class.assign(value);
+        break;
+    case Field::Side:
+        order.side = order_side_from_string(std::string(value));
+        break;
+    case Field::Type:
+        order.type = order_type_from_string(std::string(value));
+        break;
+    case Field::TimeInForce:
+        order.time_in_force = time_in_force_from_string(std::string(value));
+        break;
+    case Field::OrderClass:
+        order.order_class = order_class_from_string(std::string(value));
+        break;
+    case Field::Status:
+        order.status = order_status_from_string(std::string(value));
+        break;
+    case Field::HighWaterMark:
+        order.high_water_mark.emplace(value);
+        fields.has_high_water_mark = true;
+        break;
+    case Field::Hwm:
+        fields.hwm.emplace(value);
+        break;
+    case Field::ExtendedHours:
+    case Field::PostOnly:
+    case Field::ReduceOnly:
+    case Field::Legs:
+        throw_wrong_type(field, "string");
+    default:
+        if (auto* timestamp = timestamp_field(order, field)) {
+            *timestamp = value.empty() ? std::nullopt : std::optional<Timestamp>(parse_timestamp(value));
+        } else if (auto* text = optional_string_field(order, field)) {
+            text->emplace(value);
+        }
+        break;
+    }
+}
+
+void apply_null(Order& order, OrderFields& fields, Field field) {
+    switch (field) {
+    case Field::Id:
+    case Field::CreatedAt:
+        throw_type_error("string", "null");
+    case Field::AssetId:
+        order.asset_id.clear();
+        break;
+    case Field::ClientOrderId:
+        order.client_order_id.clear();
+        break;
+    case Field::AccountId:
+        order.account_id.clear();
+        break;
+    case Field::ReplacedBy:
+        order.replaced_by.clear();
+        break;
+    case Field::Replaces:
+        order.replaces.clear();
+        break;
+    case Field::Symbol:
+        order.symbol.clear();
+        break;
+    case Field::AssetClass:
+        order.asset_class.clear();
+        break;
+    case Field::OrderClass:
+        order.order_class.reset();
+        break;
+    case Field::Status:
+        order.status = OrderStatus::UNKNOWN;
+        break;
+    case Field::HighWaterMark:
+        fields.has_high_water_mark = false;
+        order.high_water_mark.reset();
+        break;
+    case Field::Hwm:
+        fields.hwm.reset();
+        break;
+    case Field::ExtendedHours:
+        order.extended_hours = false;
+        break;
+    case Field::PostOnly:
+        order.post_only.reset();
+        break;
+    case Field::ReduceOnly:
+        order.reduce_only.reset();
+        break;
+    case Field::Legs:
+        order.legs.clear();
+        break;
+    default:
+        // Side, type and time in force keep their defaults, as in from_json.
+        if (auto* timestamp = timestamp_field(order, field)) {
+            timestamp->reset();
+        } else if (auto* text = optional_string_field(order, field)) {
+            text->reset();
+        }
+        break;
+    }
+}
+
+void apply_boolean(Order& order, Field field, bool value) {
+    switch (field) {
+    case Field::Unknown:
+        break;
+    case Field::ExtendedHours:
+        order.extended_hours = value;
+        break;
+    case Field::PostOnly:
+        order.post_only = value;
+        break;
+    case Field::ReduceOnly:
+        order.reduce_only = value;
+        break;
+    default:
+        throw_wrong_type(field, "boolean");
+    }
+}
+
+void read_orders(Reader& in, std::vector<Order>& orders);
+
+void read_order(Reader& in, Order& order) {
+    OrderFields fields;
+    in.expect('{');
+    if (!in.consume('}')) {
+        do {
+            auto const field = lookup_field(in.read_string());
+            in.expect(':');
+            switch (in.peek()) {
+            case '"':
+                apply_string(order, fields, field, in.read_string());
+                break;
+            case 'n':
+                in.read_literal("null");
+                apply_null(order, fields, field);
+                break;
+            case 't':
+                in.read_literal("true");
+                apply_boolean(order, field, true);
+                break;
+            case 'f':
+                in.read_literal("false");
+                apply_boolean(order, field, false);
+                break;
+            case '[':
+                if (field == Field::Legs) {
+                    read_orders(in, order.legs);
+                    break;
+                }
+                [[fallthrough]];
+            default:
+                if (field != Field::Unknown) {
+                    char const ch = in.peek();
+                    throw_wrong_type(field, ch == '{' ? "object" : ch == '[' ? "array" : "number");
+                }
+                // Values of keys Order does not know, including nested objects and arrays, are validated and dropped.
+                in.skip_value();
+                break;
+            }
+        } while (in.consume(','));
+        in.expect('}');
+    }
+
+    if (!fields.has_id) {
+        throw_missing_key("id");
+    }
+    if (!fields.has_created_at) {
+        throw_missing_key("created_at");
+    }
+    if (!fields.has_high_water_mark && fields.hwm.has_value()) {
+        order.high_water_mark = std::move(fields.hwm);
+    }
+}
+
+void read_orders(Reader& in, std::vector<Order>& orders) {
+    orders.clear();
+    in.expect('[');
+    if (in.consume(']')) {
+        return;
+    }
+    do {
+        if (in.peek() != '{') {
+            throw Json::type_error::create(304, "cannot use at() with non-object", nullptr);
+        }
+        read_order(in, orders.emplace_back());
+    } while (in.consume(','));
+    in.expect(']');
+}
+
+char const* type_name(char token) noexcept {
+    switch (token) {
+    case '{':
+        return "object";
+    case '[':
+        return "array";
+    case '"':
+        return "string";
+    case 't':
+    case 'f':
+        return "boolean";
+    case 'n':
+        return "null";
+    default:
+        return "number";
+    }
+}
+
+} // namespace
+
+void decode_json(std::string_view text, Order& order) {
+    Reader in(text);
+    char const token = in.peek();
+    if (token != '{') {
+        in.skip_value();
+        in.expect_end();
+        throw_type_error("object", type_name(token));
+    }
+    order = Order{};
+    read_order(in, order);
+    in.expect_end();
+}
+
+void decode_json(std::string_view text, std::vector<Order>& orders) {
+    Reader in(text);
+    char const token = in.peek();
+    if (token != '[') {
+        in.skip_value();
+        in.expect_end();
+        throw_type_error("array", type_name(token));
+    }
+    read_orders(in, orders);
+    in.expect_end();
+}
+
+} // namespace alpaca
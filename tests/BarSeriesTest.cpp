@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include "alpaca/Json.hpp"
+#include "alpaca/models/BarSeries.hpp"
+
+namespace {
+
+alpaca::StockBar MakeBar(std::int64_t minute, double close, std::optional<double> vwap = std::nullopt) {
+    alpaca::StockBar bar;
+    bar.timestamp = alpaca::Timestamp{std::chrono::minutes{minute}};
+    bar.open = alpaca::Money{close - 0.5};
+    bar.high = alpaca::Money{close + 1.0};
+    bar.low = alpaca::Money{close - 1.0};
+    bar.close = alpaca::Money{close};
+    bar.volume = static_cast<std::uint64_t>(minute * 100);
+    bar.trade_count = static_cast<std::uint64_t>(minute);
+    if (vwap.has_value()) {
+        bar.vwap = alpaca::Money{*vwap};
+    }
+    return bar;
+}
+
+} // namespace
+
+TEST(BarSeriesTest, RoundTripsThroughStockBars) {
+    std::vector<alpaca::StockBar> bars{MakeBar(1, 10.25, 10.1), MakeBar(2, 11.5), MakeBar(3, 12.75, 12.5)};
+
+    alpaca::BarSeries series = alpaca::BarSeries::from_bars(bars);
+    ASSERT_EQ(series.size(), 3U);
+    EXPECT_EQ(series.closes()[1], alpaca::Money{11.5}.raw());
+    EXPECT_EQ(series.highs()[2], alpaca::Money{13.75}.raw());
+    EXPECT_EQ(series.volumes()[2], 300U);
+    EXPECT_EQ(series.has_vwap()[1], 0U);
+    EXPECT_EQ(series.vwaps()[1], 0);
+
+    std::vector<alpaca::StockBar> restored = series.to_bars();
+    ASSERT_EQ(restored.size(), bars.size());
+    for (std::size_t i = 0; i < bars.size(); ++i) {
+        EXPECT_EQ(restored[i].timestamp, bars[i].timestamp);
+        EXPECT_EQ(restored[i].open, bars[i].open);
+        EXPECT_EQ(restored[i].high, bars[i].high);
+        EXPECT_EQ(restored[i].low, bars[i].low);
+        EXPECT_EQ(restored[i].close, bars[i].close);
+        EXPECT_EQ(restored[i].volume, bars[i].volume);
+        EXPECT_EQ(restored[i].trade_count, bars[i].trade_count);
+        EXPECT_EQ(restored[i].vwap, bars[i].vwap);
+    }
+    EXPECT_THROW((void)series.at(3), std::out_of_range);
+}
+
+TEST(BarSeriesTest, DecodesJsonArrayDirectlyIntoColumns) {
+    auto const payload = alpaca::Json::parse(R"([
+        {"t": "2024-01-02T14:30:00Z", "o": 187.15, "h": 188.44, "l": 183.89, "c": 185.64, "v": 1000, "n": 12, "vw": 185.9},
+        {"t": "2024-01-02T14:31:00Z", "o": "185.64", "h": "186.00", "l": "185.10", "c": "185.50", "v": 500}
+    ])");
+
+    alpaca::BarSeries series;
+    series.reserve(8);
+    series.append_json(payload);
+
+    ASSERT_EQ(series.size(), 2U);
+    EXPECT_GE(series.capacity(), 8U);
+    EXPECT_EQ(series.timestamps()[0], alpaca::parse_timestamp("2024-01-02T14:30:00Z"));
+    EXPECT_EQ(series.opens()[1], alpaca::Money{185.64}.raw());
+    EXPECT_EQ(series.closes()[0], alpaca::Money{185.64}.raw());
+    EXPECT_EQ(series.trade_counts()[1], 0U);
+    EXPECT_EQ(series.has_vwap()[0], 1U);
+    EXPECT_EQ(series.vwaps()[0], alpaca::Money{185.9}.raw());
+
+    alpaca::StockBar const expected = payload.at(0).get<alpaca::StockBar>();
+    alpaca::StockBar const decoded = series.at(0);
+    EXPECT_EQ(decoded.high, expected.high);
+    EXPECT_EQ(decoded.vwap, expected.vwap);
+}
+
+TEST(BarSeriesTest, MalformedRowLeavesColumnsAligned) {
+    auto const payload = alpaca::Json::parse(R"([
+        {"t": "2024-01-02T14:30:00Z", "o": 1, "h": 2, "l": 0.5, "c": 1.5, "v": 10},
+        {"t": "2024-01-02T14:31:00Z", "o": 1, "h": 2, "l": 0.5, "c": 1.5}
+    ])");
+
+    alpaca::BarSeries series;
+    EXPECT_ANY_THROW(series.append_json(payload));
+    EXPECT_EQ(series.size(), 1U);
+    EXPECT_EQ(series.opens().size(), 1U);
+    EXPECT_EQ(series.has_vwap().size(), 1U);
+}
@@ -0,0 +1,32 @@
+#include "alpaca/Chrono.hpp"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+namespace alpaca {
+namespace {
+
+TEST(ChronoTest, FastUtcNowTracksTheSystemClock) {
+    calibrate_fast_clock();
+    for (int i = 0; i < 3; ++i) {
+        auto const before = utc_now();
+        auto const fast = fast_utc_now();
+        auto const after = utc_now();
+        EXPECT_GE(fast, before - std::chrono::milliseconds{1});
+        EXPECT_LE(fast, after + std::chrono::milliseconds{1});
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    }
+}
+
+TEST(ChronoTest, FirstReadingAfterCalibrationIsCheap) {
+    calibrate_fast_clock();
+    auto const started = std::chrono::steady_clock::now();
+    static_cast<void>(fast_utc_now());
+    // The calibration alone spins for 2 ms.
+    EXPECT_LT(std::chrono::steady_clock::now() - started, std::chrono::milliseconds{1});
+}
+
+} // namespace
+} // namespace alpaca
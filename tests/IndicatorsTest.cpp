@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "alpaca/Exceptions.hpp"
+#include "alpaca/Indicators.hpp"
+
+namespace {
+
+std::vector<alpaca::StockBar> MakeBars(std::size_t count) {
+    std::vector<alpaca::StockBar> bars;
+    bars.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        double const base = 100.0 + 5.0 * std::sin(static_cast<double>(i) * 0.3) + 0.05 * static_cast<double>(i);
+        alpaca::StockBar bar;
+        bar.timestamp = alpaca::Timestamp{std::chrono::minutes{static_cast<std::int64_t>(i)}};
+        bar.open = alpaca::Money{base - 0.25};
+        bar.high = alpaca::Money{base + 0.75};
+        bar.low = alpaca::Money{base - 0.90};
+        bar.close = alpaca::Money{base};
+        bar.volume = 1000 + (i % 7) * 150;
+        bars.push_back(bar);
+    }
+    return bars;
+}
+
+template <typename Indicator, typename Input>
+void ExpectIncrementalMatchesBatch(Indicator indicator, std::vector<Input> const& inputs,
+                                   std::vector<double> const& batch) {
+    ASSERT_EQ(inputs.size(), batch.size());
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        auto const value = indicator.update(inputs[i]);
+        if (std::isnan(batch[i])) {
+            EXPECT_FALSE(value.has_value()) << "index " << i;
+        } else {
+            ASSERT_TRUE(value.has_value()) << "index " << i;
+            EXPECT_NEAR(*value, batch[i], 1e-9) << "index " << i;
+        }
+    }
+}
+
+} // namespace
+
+TEST(IndicatorsTest, SmaMatchesHandComputedWindow) {
+    std::vector<double> const values{1.0, 2.0, 3.0, 4.0, 5.0};
+    auto const out = alpaca::indicators::sma(std::span<double const>(values), 3);
+    ASSERT_EQ(out.size(), values.size());
+    EXPECT_TRUE(std::isnan(out[0]));
+    EXPECT_TRUE(std::isnan(out[1]));
+    EXPECT_DOUBLE_EQ(out[2], 2.0);
+    EXPECT_DOUBLE_EQ(out[3], 3.0);
+    EXPECT_DOUBLE_EQ(out[4], 4.0);
+
+    std::vector<std::int64_t> const micro{1'000'000, 2'000'000, 3'000'000, 4'000'000, 5'000'000};
+    auto const exact = alpaca::indicators::sma(std::span<std::int64_t const>(micro), 3);
+    EXPECT_DOUBLE_EQ(exact[4], 4.0);
+}
+
+TEST(IndicatorsTest, RsiAndEmaReferenceValues) {
+    std::vector<double> const rising{1.0, 2.0, 3.0, 4.0, 5.0};
+    auto const strength = alpaca::indicators::rsi(std::span<double const>(rising), 2);
+    EXPECT_DOUBLE_EQ(strength[2], 100.0);
+    EXPECT_DOUBLE_EQ(strength[4], 100.0);
+
+    std::vector<double> const values{2.0, 4.0, 6.0, 8.0};
+    auto const smoothed = alpaca::indicators::ema(std::span<double const>(values), 3);
+    EXPECT_DOUBLE_EQ(smoothed[2], 4.0);
+    EXPECT_DOUBLE_EQ(smoothed[3], 6.0);
+
+    auto const deviation = alpaca::indicators::rolling_stddev(std::span<double const>(values), 2);
+    EXPECT_DOUBLE_EQ(deviation[1], 1.0);
+}
+
+TEST(IndicatorsTest, RollingStdDevStaysAccurateOnLargeOffsets) {
+    // A sum-of-squares formula loses every significant digit of the variance at this magnitude.
+    std::vector<double> values(100000);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        values[i] = 1.0e9 + static_cast<double>(i % 2);
+    }
+    auto const deviation = alpaca::indicators::rolling_stddev(std::span<double const>(values), 4);
+    EXPECT_NEAR(deviation[3], 0.5, 1e-6);
+    EXPECT_NEAR(deviation.back(), 0.5, 1e-6);
+
+    alpaca::indicators::RollingStdDev incremental(4);
+    std::optional<double> last;
+    for (double const value : values) {
+        last = incremental.update(value);
+    }
+    ASSERT_TRUE(last.has_value());
+    EXPECT_NEAR(*last, 0.5, 1e-6);
+}
+
+TEST(IndicatorsTest, SmaDoesNotDriftOverLongSeries) {
+    // Sliding a double sum this far leaves about 1e-5 of rounding behind, which swamps the small closing window.
+    std::vector<double> values;
+    for (std::size_t i = 0; i < 1000000; ++i) {
+        values.push_back(static_cast<double>((i * 7919) % 1000003) * 1.1);
+    }
+    values.insert(values.end(), 4, 0.001);
+
+    auto const batch = alpaca::indicators::sma(std::span<double const>(values), 4);
+    EXPECT_NEAR(batch.back(), 0.001, 1e-15);
+    alpaca::indicators::SimpleMovingAverage incremental(4);
+    std::optional<double> last;
+    for (double const value : values) {
+        last = incremental.update(value);
+    }
+    ASSERT_TRUE(last.has_value());
+    EXPECT_EQ(*last, batch.back());
+
+    // Money input keeps an integer sum, so it matches the micro-unit kernel exactly at every step.
+    std::vector<std::int64_t> micro;
+    alpaca::indicators::SimpleMovingAverage exact(3);
+    for (std::size_t i = 0; i < 10000; ++i) {
+        micro.push_back(static_cast<std::int64_t>((i * 104729) % 999983) * 1'000'003);
+    }
+    auto const micro_batch = alpaca::indicators::sma(std::span<std::int64_t const>(micro), 3);
+    for (std::size_t i = 0; i < micro.size(); ++i) {
+        auto const value = exact.update(alpaca::Money::from_raw(micro[i]));
+        if (i >= 2) {
+            ASSERT_TRUE(value.has_value());
+            EXPECT_EQ(*value, micro_batch[i]) << "index " << i;
+        }
+    }
+    EXPECT_THROW(static_cast<void>(exact.update(1.0)), alpaca::InvalidArgumentException);
+    exact.reset();
+    EXPECT_FALSE(exact.update(1.0).has_value());
+}
+
+TEST(IndicatorsTest, IncrementalKernelsMatchBatchKernels) {
+    auto const bars = MakeBars(120);
+    alpaca::BarSeries const series = alpaca::BarSeries::from_bars(bars);
+
+    std::vector<alpaca::Money> closes;
+    for (auto const& bar : bars) {
+        closes.push_back(bar.close);
+    }
+
+    namespace ind = alpaca::indicators;
+    ExpectIncrementalMatchesBatch(ind::SimpleMovingAverage(14), closes, ind::sma(series.closes(), 14));
+    ExpectIncrementalMatchesBatch(ind::ExponentialMovingAverage(14), closes, ind::ema(series.closes(), 14));
+    ExpectIncrementalMatchesBatch(ind::RollingStdDev(20), closes, ind::rolling_stddev(series.closes(), 20));
+    ExpectIncrementalMatchesBatch(ind::RelativeStrengthIndex(14), closes, ind::rsi(series.closes(), 14));
+    ExpectIncrementalMatchesBatch(ind::VolumeWeightedAveragePrice{}, bars, ind::vwap(series));
+    ExpectIncrementalMatchesBatch(ind::AverageTrueRange(14), bars, ind::atr(series, 14));
+}
+
+TEST(IndicatorsTest, RejectsZeroPeriod) {
+    std::vector<double> const values{1.0};
+    EXPECT_THROW((void)alpaca::indicators::sma(std::span<double const>(values), 0), alpaca::InvalidArgumentException);
+    EXPECT_THROW(alpaca::indicators::AverageTrueRange(0), alpaca::InvalidArgumentException);
+}
@@ -344,3 +344,38 @@ TEST(MarketDataClientTest, CustomRetryOptionsPropagateToRestClients) {
     EXPECT_THROW(client.get_latest_stock_trades(request), alpaca::Exception);
     ASSERT_EQ(fake->requests().size(), 1U);
 }
+
+TEST(MarketDataClientTest, StockBarSeriesFollowsPaginationAndReservesLimit) {
+    auto fake = std::make_shared<FakeHttpClient>();
+    fake->push_response(MakeHttpResponse(R"({
+        "symbol": "AAPL",
+        "bars": [
+            {"t": "2024-01-02T14:30:00Z", "o": 187.15, "h": 188.44, "l": 183.89, "c": 185.64, "v": 1000, "n": 12, "vw": 185.9}
+        ],
+        "next_page_token": "page-2"
+    })"));
+    fake->push_response(MakeHttpResponse(R"({
+        "symbol": "AAPL",
+        "bars": [
+            {"t": "2024-01-02T14:31:00Z", "o": 185.64, "h": 186.0, "l": 185.1, "c": 185.5, "v": 500, "n": 4}
+        ],
+        "next_page_token": null
+    })"));
+
+    alpaca::Configuration config = alpaca::Configuration::Paper("key", "secret");
+    alpaca::MarketDataClient client(config, fake);
+
+    alpaca::StockBarsRequest request;
+    request.limit = 16;
+    alpaca::BarSeries series = client.get_stock_bar_series("AAPL", request);
+
+    ASSERT_EQ(series.size(), 2U);
+    EXPECT_GE(series.capacity(), 16U);
+    EXPECT_EQ(series.closes()[1], alpaca::Money{185.5}.raw());
+    EXPECT_EQ(series.volumes()[0], 1000U);
+
+    ASSERT_EQ(fake->requests().size(), 2U);
+    EXPECT_NE(fake->requests()[0].request.url.find("/v2/stocks/AAPL/bars"), std::string::npos);
+    EXPECT_EQ(fake->requests()[0].request.url.find("page_token"), std::string::npos);
+    EXPECT_NE(fake->requests()[1].request.url.find("page_token=page-2"), std::string::npos);
+}
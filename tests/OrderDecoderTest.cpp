@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "alpaca/Exceptions.hpp"
+#include "alpaca/Json.hpp"
+#include "alpaca/models/Order.hpp"
+
+namespace {
+
+static_assert(alpaca::detail::has_direct_decoder<alpaca::Order>);
+static_assert(alpaca::detail::has_direct_decoder<std::vector<alpaca::Order>>);
+
+std::string const kFullOrder = R"({
+    "id": "61e69015-8549-4bfd-b9c3-01e75843f47d",
+    "client_order_id": "eb9e2aaa-f71a-4f51-b5b4-52a6c565dad4",
+    "created_at": "2021-03-16T18:38:01.942282Z",
+    "updated_at": "2021-03-16T18:38:01.942282Z",
+    "submitted_at": "2021-03-16T18:38:01.937734Z",
+    "filled_at": "",
+    "expired_at": null,
+    "canceled_at": null,
+    "failed_at": null,
+    "replaced_at": null,
+    "asset_id": "b0b6dd9d-8b9b-48a9-ba46-b9d54906e415",
+    "symbol": "AAPL",
+    "asset_class": "us_equity",
+    "notional": null,
+    "qty": "100",
+    "filled_qty": "25.5",
+    "filled_avg_price": "187.125",
+    "order_class": "bracket",
+    "order_type": "limit",
+    "type": "limit",
+    "side": "sell",
+    "time_in_force": "gtc",
+    "limit_price": "190.5",
+    "stop_price": null,
+    "status": "partially_filled",
+    "extended_hours": true,
+    "hwm": "191.25",
+    "trail_percent": null,
+    "trail_price": null,
+    "subtag": null,
+    "source": {"nested": [1, 2, {"deep": true}], "more": null},
+    "post_only": false,
+    "legs": [
+        {
+            "id": "leg-1",
+            "created_at": "2021-03-16T18:38:01.942282Z",
+            "symbol": "AAPL",
+            "side": "buy",
+            "type": "stop",
+            "stop_price": "180",
+            "status": "held",
+            "legs": null
+        }
+    ]
+})";
+
+void expect_same_order(alpaca::Order const& actual, alpaca::Order const& expected) {
+    EXPECT_EQ(actual.id, expected.id);
+    EXPECT_EQ(actual.asset_id, expected.asset_id);
+    EXPECT_EQ(actual.client_order_id, expected.client_order_id);
+    EXPECT_EQ(actual.account_id, expected.account_id);
+    EXPECT_EQ(actual.created_at, expected.created_at);
+    EXPECT_EQ(actual.updated_at, expected.updated_at);
+    EXPECT_EQ(actual.submitted_at, expected.submitted_at);
+    EXPECT_EQ(actual.filled_at, expected.filled_at);
+    EXPECT_EQ(actual.expired_at, expected.expired_at);
+    EXPECT_EQ(actual.canceled_at, expected.canceled_at);
+    EXPECT_EQ(actual.failed_at, expected.failed_at);
+    EXPECT_EQ(actual.replaced_at, expected.replaced_at);
+    EXPECT_EQ(actual.replaced_by, expected.replaced_by);
+    EXPECT_EQ(actual.replaces, expected.replaces);
+    EXPECT_EQ(actual.symbol, expected.symbol);
+    EXPECT_EQ(actual.asset_class, expected.asset_class);
+    EXPECT_EQ(actual.side, expected.side);
+    EXPECT_EQ(actual.type, expected.type);
+    EXPECT_EQ(actual.time_in_force, expected.time_in_force);
+    EXPECT_EQ(actual.order_class, expected.order_class);
+    EXPECT_EQ(actual.status, expected.status);
+    EXPECT_EQ(actual.qty, expected.qty);
+    EXPECT_EQ(actual.notional, expected.notional);
+    EXPECT_EQ(actual.filled_qty, expected.filled_qty);
+    EXPECT_EQ(actual.filled_avg_price, expected.filled_avg_price);
+    EXPECT_EQ(actual.limit_price, expected.limit_price);
+    EXPECT_EQ(actual.stop_price, expected.stop_price);
+    EXPECT_EQ(actual.trail_price, expected.trail_price);
+    EXPECT_EQ(actual.trail_percent, expected.trail_percent);
+    EXPECT_EQ(actual.high_water_mark, expected.high_water_mark);
+    EXPECT_EQ(actual.extended_hours, expected.extended_hours);
+    EXPECT_EQ(actual.base_symbol, expected.base_symbol);
+    EXPECT_EQ(actual.quote_symbol, expected.quote_symbol);
+    EXPECT_EQ(actual.notional_currency, expected.notional_currency);
+    EXPECT_EQ(actual.venue, expected.venue);
+    EXPECT_EQ(actual.routing_strategy, expected.routing_strategy);
+    EXPECT_EQ(actual.post_only, expected.post_only);
+    EXPECT_EQ(actual.reduce_only, expected.reduce_only);
+    EXPECT_EQ(actual.counterparty, expected.counterparty);
+    EXPECT_EQ(actual.quote_id, expected.quote_id);
+    EXPECT_EQ(actual.settlement_date, expected.settlement_date);
+    ASSERT_EQ(actual.legs.size(), expected.legs.size());
+    for (std::size_t i = 0; i < actual.legs.size(); ++i) {
+        expect_same_order(actual.legs[i], expected.legs[i]);
+    }
+}
+
+TEST(OrderDecoderTest, MatchesJsonDomDecoding) {
+    alpaca::Order decoded;
+    alpaca::decode_json(kFullOrder, decoded);
+
+    expect_same_order(decoded, alpaca::Json::parse(kFullOrder).get<alpaca::Order>());
+    EXPECT_EQ(decoded.status, alpaca::OrderStatus::PARTIALLY_FILLED);
+    EXPECT_EQ(decoded.high_water_mark, std::optional<std::string>("191.25"));
+    EXPECT_FALSE(decoded.filled_at.has_value());
+    ASSERT_EQ(decoded.legs.size(), 1U);
+    EXPECT_EQ(decoded.legs[0].type, alpaca::OrderType::STOP);
+}
+
+TEST(OrderDecoderTest, DecodesOrderArrays) {
+    std::string const body = "[" + kFullOrder + "," + kFullOrder + "]";
+
+    std::vector<alpaca::Order> decoded;
+    alpaca::decode_json(body, decoded);
+
+    auto const expected = alpaca::Json::parse(body).get<std::vector<alpaca::Order>>();
+    ASSERT_EQ(decoded.size(), expected.size());
+    for (std::size_t i = 0; i < decoded.size(); ++i) {
+        expect_same_order(decoded[i], expected[i]);
+    }
+
+    alpaca::decode_json("[]", decoded);
+    EXPECT_TRUE(decoded.empty());
+}
+
+TEST(OrderDecoderTest, UnescapesStringsAndSkipsUnknownValues) {
+    std::string const body = R"({"meta": {"a": "x}]\"", "b": [{"c": []}, -1.5e3, "\u00e9"]}, "id": "ord\u00e9\n\ud83d\ude00",)"
+                             R"("created_at": "2021-03-16T18:38:01Z", "client_order_id": "caf\u00e9 \"q\" \/", "tags": []})";
+
+    alpaca::Order decoded;
+    alpaca::decode_json(body, decoded);
+
+    expect_same_order(decoded, alpaca::Json::parse(body).get<alpaca::Order>());
+    EXPECT_EQ(decoded.id, "ord\xc3\xa9\n\xf0\x9f\x98\x80");
+    EXPECT_THROW(alpaca::decode_json("{\"id\": \"bad\xff\", \"created_at\": \"2021-03-16T18:38:01Z\"}", decoded),
+                 alpaca::Json::parse_error);
+}
+
+TEST(OrderDecoderTest, NullStringFieldsReadAsEmpty) {
+    alpaca::Order decoded;
+    alpaca::decode_json(R"({"id":"x","created_at":"2021-03-16T18:38:01Z","replaced_by":null,"replaces":null})",
+                        decoded);
+
+    EXPECT_TRUE(decoded.replaced_by.empty());
+    EXPECT_TRUE(decoded.replaces.empty());
+}
+
+TEST(OrderDecoderTest, RejectsWhatTheDomDecoderRejects) {
+    alpaca::Order decoded;
+    EXPECT_THROW(alpaca::decode_json(R"({"created_at":"2021-03-16T18:38:01Z"})", decoded), alpaca::Json::out_of_range);
+    EXPECT_THROW(alpaca::decode_json(R"({"id":"x"})", decoded), alpaca::Json::out_of_range);
+    EXPECT_THROW(alpaca::decode_json(R"({"id":"x","created_at":"2021-03-16T18:38:01Z","qty":10})", decoded),
+                 alpaca::Json::type_error);
+    EXPECT_THROW(alpaca::decode_json(R"({"id":"x","created_at":"2021-03-16T18:38:01Z","legs":{}})", decoded),
+                 alpaca::Json::type_error);
+    EXPECT_THROW(alpaca::decode_json(R"({"id":"x",)", decoded), alpaca::Json::parse_error);
+
+    std::vector<alpaca::Order> orders;
+    EXPECT_THROW(alpaca::decode_json(kFullOrder, orders), alpaca::Json::type_error);
+}
+
+TEST(OrderDecoderTest, ExposesDecimalFieldsAsMoney) {
+    alpaca::Order decoded;
+    alpaca::decode_json(kFullOrder, decoded);
+
+    EXPECT_EQ(decoded.qty_amount(), alpaca::Money(100, 0));
+    EXPECT_EQ(decoded.filled_qty_amount(), alpaca::Money(25, 500'000));
+    EXPECT_EQ(decoded.filled_avg_price_amount(), alpaca::Money(187, 125'000));
+    EXPECT_EQ(decoded.limit_price_amount(), alpaca::Money(190, 500'000));
+    EXPECT_EQ(decoded.high_water_mark_amount(), alpaca::Money(191, 250'000));
+    EXPECT_FALSE(decoded.stop_price_amount().has_value());
+    EXPECT_FALSE(decoded.notional_amount().has_value());
+
+    // Crypto quantities can carry more digits than Money holds.
+    decoded.filled_qty = "0.123456789";
+    EXPECT_THROW(static_cast<void>(decoded.filled_qty_amount()), alpaca::InvalidArgumentException);
+    EXPECT_FALSE(decoded.filled_qty_amount(std::nothrow).has_value());
+    EXPECT_EQ(decoded.filled_avg_price_amount(std::nothrow), alpaca::Money(187, 125'000));
+}
+
+} // namespace
@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "FakeHttpClient.hpp"
+#include "alpaca/Configuration.hpp"
+#include "alpaca/Exceptions.hpp"
+#include "alpaca/OrderLatencyTracer.hpp"
+#include "alpaca/TradingClient.hpp"
+
+namespace {
+
+using namespace std::chrono_literals;
+
+alpaca::NewOrderRequest make_order(std::string client_order_id) {
+    alpaca::NewOrderRequest request;
+    request.symbol = "AAPL";
+    request.side = alpaca::OrderSide::BUY;
+    request.type = alpaca::OrderType::MARKET;
+    request.time_in_force = alpaca::TimeInForce::DAY;
+    request.quantity = "10";
+    if (!client_order_id.empty()) {
+        request.client_order_id = std::move(client_order_id);
+    }
+    return request;
+}
+
+alpaca::HttpResponse accepted_response(std::string const& id, std::string const& client_order_id) {
+    alpaca::HttpResponse response{200,
+                                  R"({"id": ")" + id + R"(", "client_order_id": ")" + client_order_id +
+                                      R"(", "symbol": "AAPL", "qty": "10", "side": "buy", "type": "market",
+        "time_in_force": "day", "status": "accepted", "created_at": "2024-01-02T15:00:00Z"})",
+                                  {}};
+    response.timings = alpaca::HttpTimings{1us, 2us, 3us, 4us};
+    return response;
+}
+
+alpaca::streaming::OrderUpdateMessage make_update(std::string const& client_order_id, std::string event,
+                                                  alpaca::OrderStatus status) {
+    alpaca::streaming::OrderUpdateMessage update;
+    update.event = std::move(event);
+    update.order.client_order_id = client_order_id;
+    update.order.symbol = "AAPL";
+    update.order.status = status;
+    return update;
+}
+
+struct TracedClient {
+    std::shared_ptr<FakeHttpClient> http = std::make_shared<FakeHttpClient>();
+    alpaca::TradingClient client{alpaca::Configuration::Paper("key", "secret"), http};
+    std::shared_ptr<alpaca::OrderLatencyTracer> tracer;
+
+    explicit TracedClient(alpaca::OrderLatencyTracer::Options options = {})
+        : tracer(std::make_shared<alpaca::OrderLatencyTracer>(options)) {
+        client.set_latency_tracer(tracer);
+    }
+};
+
+TEST(OrderLatencyTracerTest, RecordsEachStageOfASubmission) {
+    TracedClient traced;
+    traced.http->push_response(accepted_response("order-1", "c-1"));
+
+    auto const order = traced.client.submit_order(make_order("c-1"));
+    EXPECT_EQ(order.id, "order-1");
+
+    auto const traces = traced.tracer->recent();
+    ASSERT_EQ(traces.size(), 1U);
+    auto const& trace = traces.front();
+    EXPECT_EQ(trace.client_order_id, "c-1");
+    EXPECT_EQ(trace.order_id, "order-1");
+    EXPECT_EQ(trace.symbol, "AAPL");
+    EXPECT_EQ(trace.attempts, 1U);
+    EXPECT_EQ(trace.connection_acquire, 1us);
+    EXPECT_EQ(trace.send, 2us);
+    EXPECT_EQ(trace.first_byte, 3us);
+    EXPECT_EQ(trace.body_complete, 4us);
+    EXPECT_EQ(trace.rate_limit_wait, 0ns);
+    EXPECT_GE(trace.response, trace.serialize + trace.decode);
+    EXPECT_TRUE(trace.error.empty());
+    EXPECT_FALSE(trace.accepted.has_value());
+
+    for (auto const stage : {alpaca::OrderStage::Serialize, alpaca::OrderStage::Send, alpaca::OrderStage::Decode,
+                             alpaca::OrderStage::Response}) {
+        EXPECT_EQ(traced.tracer->histogram(stage).count, 1U) << alpaca::to_string(stage);
+    }
+    EXPECT_EQ(traced.tracer->histogram(alpaca::OrderStage::Filled).count, 0U);
+
+    auto const json = alpaca::Json(trace);
+    EXPECT_EQ(json.at("order_id"), "order-1");
+    EXPECT_EQ(json.at("send_ns"), 2000);
+    EXPECT_TRUE(json.at("filled_ns").is_null());
+}
+
+TEST(OrderLatencyTracerTest, MatchesStreamEventsByClientOrderId) {
+    TracedClient traced;
+    traced.http->push_response(accepted_response("order-1", "c-1"));
+    // Submitted without a client order id: the response names one.
+    traced.http->push_response(accepted_response("order-2", "server-2"));
+
+    static_cast<void>(traced.client.submit_order(make_order("c-1")));
+    auto handler = traced.tracer->handler();
+    handler(make_update("c-1", "new", alpaca::OrderStatus::NEW), alpaca::streaming::MessageCategory::OrderUpdate);
+    handler(make_update("c-1", "partial_fill", alpaca::OrderStatus::PARTIALLY_FILLED),
+            alpaca::streaming::MessageCategory::OrderUpdate);
+    handler(make_update("c-1", "fill", alpaca::OrderStatus::FILLED),
+            alpaca::streaming::MessageCategory::OrderUpdate);
+
+    // The stream can beat the REST response; the event waits for the submission.
+    traced.tracer->apply(make_update("server-2", "new", alpaca::OrderStatus::NEW));
+    static_cast<void>(traced.client.submit_order(make_order("")));
+
+    auto const traces = traced.tracer->recent();
+    ASSERT_EQ(traces.size(), 2U);
+    ASSERT_TRUE(traces[0].accepted.has_value());
+    ASSERT_TRUE(traces[0].filled.has_value());
+    EXPECT_GE(*traces[0].filled, *traces[0].accepted);
+    EXPECT_EQ(traces[1].client_order_id, "server-2");
+    EXPECT_EQ(traces[1].accepted, std::chrono::nanoseconds{0});
+    EXPECT_EQ(traced.tracer->histogram(alpaca::OrderStage::Accepted).count, 2U);
+    // Only the first fill of an order is timed.
+    EXPECT_EQ(traced.tracer->histogram(alpaca::OrderStage::Filled).count, 1U);
+}
+
+TEST(OrderLatencyTracerTest, RecordsFailuresAndRethrows) {
+    TracedClient traced;
+    traced.http->push_response(alpaca::HttpResponse{403, R"({"code": 40310000, "message": "insufficient"})", {}});
+
+    EXPECT_THROW(static_cast<void>(traced.client.submit_order(make_order("c-1"))), alpaca::Exception);
+
+    auto const traces = traced.tracer->recent();
+    ASSERT_EQ(traces.size(), 1U);
+    EXPECT_FALSE(traces.front().error.empty());
+    EXPECT_EQ(traces.front().attempts, 1U);
+    EXPECT_EQ(traced.tracer->histogram(alpaca::OrderStage::Response).count, 0U);
+
+    // A failed submission never waits for stream events.
+    traced.tracer->apply(make_update("c-1", "new", alpaca::OrderStatus::NEW));
+    EXPECT_FALSE(traced.tracer->recent().front().accepted.has_value());
+}
+
+TEST(OrderLatencyTracerTest, KeepsOnlyTheMostRecentTraces) {
+    TracedClient traced(alpaca::OrderLatencyTracer::Options{.recent_capacity = 2, .pending_capacity = 2});
+    for (int i = 0; i < 3; ++i) {
+        auto const id = "c-" + std::to_string(i);
+        traced.http->push_response(accepted_response("order-" + std::to_string(i), id));
+        static_cast<void>(traced.client.submit_order(make_order(id)));
+    }
+
+    auto const traces = traced.tracer->recent();
+    ASSERT_EQ(traces.size(), 2U);
+    EXPECT_EQ(traces[0].client_order_id, "c-1");
+    EXPECT_EQ(traces[1].client_order_id, "c-2");
+
+    // c-0 fell out of the pending set, so its events are treated as early ones.
+    traced.tracer->apply(make_update("c-2", "fill", alpaca::OrderStatus::FILLED));
+    traced.tracer->apply(make_update("c-0", "fill", alpaca::OrderStatus::FILLED));
+    EXPECT_TRUE(traced.tracer->recent()[1].filled.has_value());
+    EXPECT_EQ(traced.tracer->histogram(alpaca::OrderStage::Filled).count, 1U);
+}
+
+} // namespace
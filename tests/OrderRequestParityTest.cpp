@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "alpaca/Json.hpp"
+#include "alpaca/OrderPayloadWriter.hpp"
 #include "alpaca/models/Common.hpp"
 #include "alpaca/models/Order.hpp"
 
@@ -175,6 +176,72 @@ TEST(ReplaceOrderRequestParityTest, SerializationMatchesCSharpBehavior) {
     EXPECT_EQ(json.at("client_order_id"), "replace-client-id");
 }
 
+template <typename Request> void expect_direct_payload_matches_dom(Request const& request) {
+    std::string direct;
+    alpaca::append_order_payload(direct, request);
+    EXPECT_EQ(direct, alpaca::to_json_payload(request).dump());
+    EXPECT_EQ(alpaca::format_order_payload(request), direct);
+}
+
+TEST(OrderPayloadWriterParityTest, NewOrderPayloadMatchesJsonDumpByteForByte) {
+    alpaca::NewOrderRequest request;
+    request.symbol = "AAPL";
+    request.quantity = "10";
+    expect_direct_payload_matches_dom(request);
+
+    request.side = alpaca::OrderSide::SELL;
+    request.type = alpaca::OrderType::TRAILING_STOP;
+    request.time_in_force = alpaca::TimeInForce::GTC;
+    request.quantity.reset();
+    request.notional = "2500.50";
+    request.limit_price = "101.25";
+    request.stop_price = "99";
+    request.trail_price = "1.5";
+    request.trail_percent = "0.75";
+    request.high_water_mark = "120";
+    request.client_order_id = "quote \" and \\ tab\t newline\n bell\a del\x7f";
+    request.order_class = alpaca::OrderClass::BRACKET;
+    request.take_profit = alpaca::TakeProfitParams{.limit_price = "130"};
+    request.stop_loss = alpaca::StopLossParams{.stop_price = "110", .limit_price = "109.5"};
+    request.extended_hours = true;
+    request.position_intent = alpaca::PositionIntent::CLOSING;
+    request.legs = {
+        alpaca::OptionLeg{"AAPL240621C00150000", 2, alpaca::OrderSide::SELL, alpaca::PositionIntent::CLOSING},
+        alpaca::OptionLeg{"AAPL240621P00150000", -1, alpaca::OrderSide::BUY, alpaca::PositionIntent::OPENING}
+    };
+    expect_direct_payload_matches_dom(request);
+
+    request.stop_loss = alpaca::StopLossParams{};
+    request.client_order_id = "caf\xc3\xa9-\xe2\x82\xac";
+    expect_direct_payload_matches_dom(request);
+}
+
+TEST(OrderPayloadWriterParityTest, ReplaceOrderPayloadMatchesJsonDumpByteForByte) {
+    alpaca::ReplaceOrderRequest request;
+    expect_direct_payload_matches_dom(request);
+
+    request.extended_hours = false;
+    expect_direct_payload_matches_dom(request);
+
+    request.quantity = "42";
+    request.limit_price = "210";
+    request.stop_price = "205";
+    request.time_in_force = "gtc";
+    request.extended_hours = true;
+    request.client_order_id = "replace\x01id";
+    expect_direct_payload_matches_dom(request);
+}
+
+TEST(OrderPayloadWriterParityTest, RejectsInvalidUtf8LikeJsonDump) {
+    alpaca::NewOrderRequest request;
+    request.symbol = "AAPL";
+    request.client_order_id = "bad\xff";
+
+    std::string direct;
+    EXPECT_THROW(alpaca::to_json_payload(request).dump(), alpaca::Json::type_error);
+    EXPECT_THROW(alpaca::append_order_payload(direct, request), alpaca::Json::type_error);
+}
+
 TEST(ListOrdersRequestParityTest, QueryParamsMatchCSharpBehavior) {
     using namespace std::chrono;
 
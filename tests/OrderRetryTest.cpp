@@ -0,0 +1,216 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "alpaca/Configuration.hpp"
+#include "alpaca/Exceptions.hpp"
+#include "alpaca/Json.hpp"
+#include "alpaca/TradingClient.hpp"
+
+namespace {
+
+/// What the fake API does with the next order submission.
+enum class Submission {
+    /// Places the order and answers.
+    Place,
+    /// Places the order, then loses the response.
+    PlaceThenDrop,
+    /// Loses the request before it reaches the API.
+    Drop,
+};
+
+/// Stands in for the orders API over an unreliable connection. Placed orders are kept by client order id, a
+/// second order with the same id is rejected, and lookups by client order id see every placed order.
+class UnreliableOrderHttpClient : public alpaca::HttpClient {
+  public:
+    void script(std::initializer_list<Submission> submissions) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        script_.insert(script_.end(), submissions);
+    }
+
+    alpaca::HttpResponse send(alpaca::HttpRequest const& request) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (request.method == alpaca::HttpMethod::GET) {
+            ++lookups_;
+            auto const id = request.url.substr(request.url.find("client_order_id=") + 16);
+            auto const it = placed_.find(id);
+            if (it == placed_.end()) {
+                return alpaca::HttpResponse{404, R"({"message": "order not found"})", {}};
+            }
+            return alpaca::HttpResponse{200, it->second, {}};
+        }
+
+        ++submissions_;
+        auto const submission = script_.empty() ? Submission::Place : script_.front();
+        if (!script_.empty()) {
+            script_.pop_front();
+        }
+        if (submission == Submission::Drop) {
+            throw alpaca::CurlException(alpaca::ErrorCode::CurlPerformFailure, "Timeout was reached",
+                                        "curl_easy_perform", 28);
+        }
+
+        auto const id = alpaca::Json::parse(request.body).at("client_order_id").get<std::string>();
+        if (placed_.contains(id)) {
+            return alpaca::HttpResponse{422, R"({"code": 40010001, "message": "client_order_id must be unique"})", {}};
+        }
+        auto const order = alpaca::Json{
+            {"id",              "order-" + std::to_string(placed_.size())},
+            {"client_order_id", id                                       },
+            {"created_at",      "2024-01-02T15:00:00Z"                   },
+            {"symbol",          "AAPL"                                   },
+            {"side",            "buy"                                    },
+            {"type",            "market"                                 },
+            {"time_in_force",   "day"                                    },
+            {"status",          "accepted"                               }
+        }.dump();
+        placed_.emplace(id, order);
+        if (submission == Submission::PlaceThenDrop) {
+            throw alpaca::CurlException(alpaca::ErrorCode::CurlPerformFailure, "Timeout was reached",
+                                        "curl_easy_perform", 28);
+        }
+        return alpaca::HttpResponse{200, order, {}};
+    }
+
+    [[nodiscard]] std::size_t placed() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return placed_.size();
+    }
+
+    [[nodiscard]] int submissions() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return submissions_;
+    }
+
+    [[nodiscard]] int lookups() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return lookups_;
+    }
+
+  private:
+    mutable std::mutex mutex_;
+    std::deque<Submission> script_{};
+    std::map<std::string, std::string> placed_{};
+    int submissions_{0};
+    int lookups_{0};
+};
+
+alpaca::NewOrderRequest make_order() {
+    alpaca::NewOrderRequest request;
+    request.symbol = "AAPL";
+    request.side = alpaca::OrderSide::BUY;
+    request.type = alpaca::OrderType::MARKET;
+    request.time_in_force = alpaca::TimeInForce::DAY;
+    request.quantity = "1";
+    return request;
+}
+
+struct RetryingClient {
+    std::shared_ptr<UnreliableOrderHttpClient> http = std::make_shared<UnreliableOrderHttpClient>();
+    alpaca::TradingClient client{alpaca::Configuration::Paper("key", "secret"), http};
+
+    RetryingClient() {
+        client.set_order_retry(alpaca::TradingClient::OrderRetryOptions{.max_attempts = 3, .retry_delay = {}});
+    }
+};
+
+TEST(OrderRetryTest, ResubmitsAnOrderThatNeverReachedTheApi) {
+    RetryingClient retrying;
+    retrying.http->script({Submission::Drop});
+
+    auto const order = retrying.client.submit_order(make_order());
+    // A client order id was generated so the retry could be reconciled.
+    EXPECT_FALSE(order.client_order_id.empty());
+    EXPECT_EQ(retrying.http->placed(), 1U);
+    EXPECT_EQ(retrying.http->submissions(), 2);
+    // The resubmission answered, so there was nothing to look up.
+    EXPECT_EQ(retrying.http->lookups(), 0);
+}
+
+TEST(OrderRetryTest, ReturnsTheOrderAnEarlierAttemptPlaced) {
+    RetryingClient retrying;
+    retrying.http->script({Submission::PlaceThenDrop});
+
+    auto request = make_order();
+    request.client_order_id = "strat-1";
+    auto const order = retrying.client.submit_order(request);
+    EXPECT_EQ(order.client_order_id, "strat-1");
+    EXPECT_EQ(order.id, "order-0");
+    EXPECT_EQ(retrying.http->placed(), 1U);
+    EXPECT_GE(retrying.http->lookups(), 1);
+}
+
+TEST(OrderRetryTest, StopsAfterTheLastAttempt) {
+    RetryingClient retrying;
+    retrying.http->script({Submission::Drop, Submission::Drop, Submission::Drop});
+
+    EXPECT_THROW(static_cast<void>(retrying.client.submit_order(make_order())), alpaca::CurlException);
+    EXPECT_EQ(retrying.http->submissions(), 3);
+    EXPECT_EQ(retrying.http->placed(), 0U);
+
+    // Templates are reconciled the same way.
+    retrying.http->script({Submission::PlaceThenDrop, Submission::Drop});
+    alpaca::OrderTemplate const order_template(make_order());
+    auto const order = retrying.client.submit_order(order_template, {"1", "", ""});
+    EXPECT_EQ(retrying.http->placed(), 1U);
+    EXPECT_FALSE(order.client_order_id.empty());
+}
+
+TEST(OrderRetryTest, LooksUpTheOrderBeforeGivingUpOnTheOnlyAttempt) {
+    auto http = std::make_shared<UnreliableOrderHttpClient>();
+    alpaca::TradingClient client(alpaca::Configuration::Paper("key", "secret"), http);
+    client.set_order_retry(alpaca::TradingClient::OrderRetryOptions{.max_attempts = 1, .retry_delay = {}});
+    http->script({Submission::PlaceThenDrop, Submission::Drop});
+
+    auto const order = client.submit_order(make_order());
+    EXPECT_EQ(order.id, "order-0");
+    EXPECT_EQ(http->submissions(), 1);
+    EXPECT_EQ(http->lookups(), 1);
+
+    // Nothing was placed, so the failure is rethrown after the lookup.
+    EXPECT_THROW(static_cast<void>(client.submit_order(make_order())), alpaca::CurlException);
+    EXPECT_EQ(http->submissions(), 2);
+    EXPECT_EQ(http->lookups(), 2);
+}
+
+TEST(OrderRetryTest, ProbesAlongsideEachResubmissionWhenAsked) {
+    auto http = std::make_shared<UnreliableOrderHttpClient>();
+    alpaca::TradingClient client(alpaca::Configuration::Paper("key", "secret"), http);
+    client.set_order_retry(
+        alpaca::TradingClient::OrderRetryOptions{.max_attempts = 3, .retry_delay = {}, .concurrent_probe = true});
+
+    http->script({Submission::PlaceThenDrop, Submission::Drop});
+    auto request = make_order();
+    request.client_order_id = "strat-1";
+    auto order = client.submit_order(request);
+    EXPECT_EQ(order.id, "order-0");
+    EXPECT_EQ(http->placed(), 1U);
+    EXPECT_EQ(http->submissions(), 2);
+
+    // The last resubmission places the order and loses the answer; its probe may have looked too early, so
+    // the lookup before giving up finds it.
+    http->script({Submission::Drop, Submission::Drop, Submission::PlaceThenDrop});
+    request.client_order_id = "strat-2";
+    order = client.submit_order(request);
+    EXPECT_EQ(order.id, "order-1");
+    EXPECT_EQ(http->placed(), 2U);
+}
+
+TEST(OrderRetryTest, LeavesFailuresAloneWhenRetriesAreOff) {
+    auto http = std::make_shared<UnreliableOrderHttpClient>();
+    alpaca::TradingClient client(alpaca::Configuration::Paper("key", "secret"), http);
+    http->script({Submission::Drop});
+
+    auto request = make_order();
+    request.client_order_id = "strat-1";
+    EXPECT_THROW(static_cast<void>(client.submit_order(request)), alpaca::CurlException);
+    EXPECT_EQ(http->submissions(), 1);
+    EXPECT_EQ(http->lookups(), 0);
+}
+
+} // namespace
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include "FakeHttpClient.hpp"
+#include "alpaca/Configuration.hpp"
+#include "alpaca/Exceptions.hpp"
+#include "alpaca/OrderPayloadWriter.hpp"
+#include "alpaca/OrderTemplate.hpp"
+#include "alpaca/TradingClient.hpp"
+
+namespace {
+
+alpaca::NewOrderRequest make_limit_order() {
+    alpaca::NewOrderRequest request;
+    request.symbol = "AAPL";
+    request.side = alpaca::OrderSide::BUY;
+    request.type = alpaca::OrderType::LIMIT;
+    request.time_in_force = alpaca::TimeInForce::GTC;
+    return request;
+}
+
+/// The template's body for `fields` must match what the request writer produces for the full request.
+void expect_parity(alpaca::NewOrderRequest request, alpaca::OrderTemplate::Fields const& fields) {
+    alpaca::OrderTemplate const order_template(request);
+    if (!fields.qty.empty()) {
+        request.quantity = std::string(fields.qty);
+    }
+    if (!fields.limit_price.empty()) {
+        request.limit_price = std::string(fields.limit_price);
+    }
+    if (!fields.client_order_id.empty()) {
+        request.client_order_id = std::string(fields.client_order_id);
+    }
+    std::string const expected(alpaca::format_order_payload(request));
+    EXPECT_EQ(order_template.format(fields), expected);
+}
+
+TEST(OrderTemplateTest, MatchesTheRequestWriterByteForByte) {
+    expect_parity(make_limit_order(), {"100", "187.42", "strat-7-000123"});
+    expect_parity(make_limit_order(), {"100", "187.42", ""});
+    expect_parity(make_limit_order(), {"100", "187.42", "quote\"and\\slash"});
+
+    auto bracket = make_limit_order();
+    bracket.extended_hours = true;
+    bracket.order_class = alpaca::OrderClass::BRACKET;
+    bracket.take_profit = alpaca::TakeProfitParams{.limit_price = "190.00"};
+    bracket.stop_loss = alpaca::StopLossParams{.stop_price = "185.00", .limit_price = "184.90"};
+    expect_parity(bracket, {"10", "187.42", "b-1"});
+
+    alpaca::NewOrderRequest notional;
+    notional.symbol = "SPY";
+    notional.notional = "2500";
+    expect_parity(notional, {"", "", ""});
+
+    alpaca::NewOrderRequest spread;
+    spread.type = alpaca::OrderType::LIMIT;
+    spread.symbol = "AAPL";
+    spread.legs = {
+        alpaca::OptionLeg{"AAPL250620C00190000", 1, alpaca::OrderSide::BUY, alpaca::PositionIntent::OPENING},
+        alpaca::OptionLeg{"AAPL250620C00200000", 1, alpaca::OrderSide::SELL, alpaca::PositionIntent::OPENING},
+    };
+    expect_parity(spread, {"2", "1.25", "spread-1"});
+
+    auto stop_limit = make_limit_order();
+    stop_limit.type = alpaca::OrderType::STOP_LIMIT;
+    stop_limit.stop_price = "186";
+    stop_limit.high_water_mark = "190";
+    expect_parity(stop_limit, {"5", "185.5", "s-1"});
+}
+
+TEST(OrderTemplateTest, ValidatesTheInvariantAndVaryingFields) {
+    auto missing_symbol = make_limit_order();
+    missing_symbol.symbol.clear();
+    EXPECT_THROW(alpaca::OrderTemplate{missing_symbol}, alpaca::InvalidArgumentException);
+
+    auto stop = make_limit_order();
+    stop.type = alpaca::OrderType::STOP;
+    EXPECT_THROW(alpaca::OrderTemplate{stop}, alpaca::InvalidArgumentException);
+
+    auto bracket = make_limit_order();
+    bracket.order_class = alpaca::OrderClass::BRACKET;
+    bracket.take_profit = alpaca::TakeProfitParams{.limit_price = "190.00"};
+    EXPECT_THROW(alpaca::OrderTemplate{bracket}, alpaca::InvalidArgumentException);
+
+    // Fields set on the request itself are not part of the template.
+    auto request = make_limit_order();
+    request.quantity = "100";
+    request.client_order_id = "ignored";
+    alpaca::OrderTemplate const limit(request);
+    EXPECT_FALSE(limit.request().quantity.has_value());
+    EXPECT_FALSE(limit.request().client_order_id.has_value());
+    EXPECT_THROW(static_cast<void>(limit.format({"100", "", "id"})), alpaca::InvalidArgumentException);
+    EXPECT_THROW(static_cast<void>(limit.format({"", "187.42", "id"})), alpaca::InvalidArgumentException);
+
+    alpaca::NewOrderRequest market;
+    market.symbol = "AAPL";
+    alpaca::OrderTemplate const market_template(market);
+    EXPECT_THROW(static_cast<void>(market_template.format({"1", "187.42", ""})), alpaca::InvalidArgumentException);
+}
+
+TEST(OrderTemplateTest, TradingClientSubmitsTheFormattedBody) {
+    auto http = std::make_shared<FakeHttpClient>();
+    alpaca::TradingClient client(alpaca::Configuration::Paper("key", "secret"), http);
+    http->push_response(alpaca::HttpResponse{200, R"({"id": "order-1", "client_order_id": "t-1", "symbol": "AAPL",
+        "qty": "100", "limit_price": "187.42", "side": "buy", "type": "limit", "time_in_force": "gtc",
+        "status": "new", "created_at": "2024-01-02T15:00:00Z"})",
+                                             {}});
+
+    alpaca::OrderTemplate const order_template(make_limit_order());
+    auto const order = client.submit_order(order_template, {"100", "187.42", "t-1"});
+    EXPECT_EQ(order.id, "order-1");
+    ASSERT_EQ(http->requests().size(), 1U);
+    auto const& sent = http->requests().front().request;
+    EXPECT_EQ(sent.method, alpaca::HttpMethod::POST);
+    EXPECT_NE(sent.url.find("/v2/orders"), std::string::npos);
+    EXPECT_EQ(sent.body, R"({"client_order_id":"t-1","limit_price":"187.42","qty":"100","side":"buy",)"
+                         R"("symbol":"AAPL","time_in_force":"gtc","type":"limit"})");
+}
+
+} // namespace
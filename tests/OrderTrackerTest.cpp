@@ -0,0 +1,235 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FakeHttpClient.hpp"
+#include "alpaca/Configuration.hpp"
+#include "alpaca/Json.hpp"
+#include "alpaca/OrderTracker.hpp"
+#include "alpaca/TradingClient.hpp"
+
+namespace {
+
+alpaca::Json make_order_json(std::string const& id, std::string const& status, std::string const& updated_at,
+                             std::string const& filled_qty = "0") {
+    return alpaca::Json{
+        {"id",              id                    },
+        {"client_order_id", "client-" + id        },
+        {"created_at",      "2024-01-02T15:00:00Z"},
+        {"updated_at",      updated_at            },
+        {"symbol",          "AAPL"                },
+        {"side",            "buy"                 },
+        {"type",            "limit"               },
+        {"time_in_force",   "day"                 },
+        {"qty",             "10"                  },
+        {"filled_qty",      filled_qty            },
+        {"limit_price",     "187.5"               },
+        {"status",          status                }
+    };
+}
+
+alpaca::Order make_order(std::string const& id, std::string const& status, std::string const& updated_at,
+                         std::string const& filled_qty = "0") {
+    return make_order_json(id, status, updated_at, filled_qty).get<alpaca::Order>();
+}
+
+alpaca::HttpResponse page(std::vector<alpaca::Json> orders) {
+    return alpaca::HttpResponse{200, alpaca::Json(std::move(orders)).dump(), {}};
+}
+
+class OrderTrackerTest : public ::testing::Test {
+  protected:
+    std::shared_ptr<FakeHttpClient> http = std::make_shared<FakeHttpClient>();
+    alpaca::TradingClient client{alpaca::Configuration::Paper("key", "secret"), http};
+};
+
+TEST_F(OrderTrackerTest, SeedsOpenOrdersFromListOrders) {
+    http->push_response(page({make_order_json("a", "new", "2024-01-02T15:00:00Z"),
+                              make_order_json("b", "partially_filled", "2024-01-02T15:00:01Z", "4")}));
+
+    alpaca::OrderTracker tracker(client);
+    tracker.seed();
+
+    ASSERT_EQ(http->requests().size(), 1U);
+    auto const& url = http->requests()[0].request.url;
+    EXPECT_NE(url.find("status=open"), std::string::npos);
+    EXPECT_NE(url.find("nested=true"), std::string::npos);
+    EXPECT_NE(url.find("limit=500"), std::string::npos);
+
+    EXPECT_EQ(tracker.open_order_count(), 2U);
+    ASSERT_TRUE(tracker.find("b").has_value());
+    EXPECT_EQ(tracker.find("b")->status, alpaca::OrderStatus::PARTIALLY_FILLED);
+    ASSERT_TRUE(tracker.find_by_client_order_id("client-a").has_value());
+    EXPECT_EQ(tracker.find_by_client_order_id("client-a")->id, "a");
+    EXPECT_FALSE(tracker.find("missing").has_value());
+}
+
+TEST_F(OrderTrackerTest, SeedFollowsPagesUntilNoNewOrders) {
+    alpaca::OrderTracker::Options options;
+    options.page_size = 2;
+    http->push_response(page({make_order_json("a", "new", "2024-01-02T15:00:00Z"),
+                              make_order_json("b", "new", "2024-01-02T15:00:00Z")}));
+    http->push_response(page({make_order_json("b", "new", "2024-01-02T15:00:00Z"),
+                              make_order_json("c", "new", "2024-01-02T15:00:00Z")}));
+    http->push_response(page({make_order_json("c", "new", "2024-01-02T15:00:00Z")}));
+
+    alpaca::OrderTracker tracker(client, options);
+    tracker.seed();
+
+    EXPECT_EQ(http->requests().size(), 3U);
+    EXPECT_NE(http->requests()[1].request.url.find("until="), std::string::npos);
+    EXPECT_EQ(tracker.open_order_count(), 3U);
+}
+
+TEST_F(OrderTrackerTest, AppliesStreamUpdatesAndIgnoresStaleOnes) {
+    alpaca::OrderTracker tracker(client);
+    auto handler = tracker.handler();
+
+    alpaca::streaming::OrderUpdateMessage update;
+    update.event = "new";
+    update.order = make_order("a", "new", "2024-01-02T15:00:00Z");
+    handler(alpaca::streaming::StreamMessage{update}, alpaca::streaming::MessageCategory::OrderUpdate);
+    EXPECT_EQ(tracker.open_order_count(), 1U);
+
+    update.event = "partial_fill";
+    update.order = make_order("a", "partially_filled", "2024-01-02T15:00:02Z", "6");
+    tracker.apply(update);
+
+    // Arrives late: older timestamp and a smaller filled quantity.
+    update.order = make_order("a", "partially_filled", "2024-01-02T15:00:01Z", "3");
+    tracker.apply(update);
+    update.order = make_order("a", "partially_filled", "2024-01-02T15:00:03Z", "3");
+    tracker.apply(update);
+    EXPECT_EQ(tracker.find("a")->filled_qty, std::optional<std::string>("6"));
+
+    update.event = "fill";
+    update.order = make_order("a", "filled", "2024-01-02T15:00:04Z", "10");
+    tracker.apply(update);
+    EXPECT_EQ(tracker.open_order_count(), 0U);
+    EXPECT_TRUE(tracker.open_orders().empty());
+
+    // A terminal order never reopens, even from a newer-looking message.
+    update.order = make_order("a", "new", "2024-01-02T15:00:05Z", "10");
+    tracker.apply(update);
+    EXPECT_EQ(tracker.find("a")->status, alpaca::OrderStatus::FILLED);
+
+    auto const stats = tracker.stats();
+    EXPECT_EQ(stats.applied_updates, 3U);
+    EXPECT_EQ(stats.stale_updates, 3U);
+}
+
+TEST_F(OrderTrackerTest, ForwardsEveryMessageToTheNextHandler) {
+    alpaca::OrderTracker tracker(client);
+    int forwarded = 0;
+    auto handler = tracker.handler(
+        [&forwarded](alpaca::streaming::StreamMessage const&, alpaca::streaming::MessageCategory) { ++forwarded; });
+
+    handler(alpaca::streaming::StreamMessage{alpaca::streaming::ErrorMessage{"boom"}},
+            alpaca::streaming::MessageCategory::Error);
+    handler(alpaca::streaming::StreamMessage{alpaca::streaming::OrderUpdateMessage{
+                "new", {}, make_order("a", "new", "2024-01-02T15:00:00Z")}},
+            alpaca::streaming::MessageCategory::OrderUpdate);
+
+    EXPECT_EQ(forwarded, 2);
+    EXPECT_EQ(tracker.open_order_count(), 1U);
+}
+
+TEST_F(OrderTrackerTest, FiltersOpenOrdersBySymbolAndForgetsOldClosedOrders) {
+    alpaca::OrderTracker::Options options;
+    options.closed_order_capacity = 1;
+    alpaca::OrderTracker tracker(client, options);
+
+    auto msft = make_order("m", "new", "2024-01-02T15:00:00Z");
+    msft.symbol = "MSFT";
+    tracker.apply(msft);
+    tracker.apply(make_order("a", "new", "2024-01-02T15:00:00Z"));
+    tracker.apply(make_order("x", "canceled", "2024-01-02T15:00:00Z"));
+    tracker.apply(make_order("y", "canceled", "2024-01-02T15:00:00Z"));
+
+    auto const open = tracker.open_orders("MSFT");
+    ASSERT_EQ(open.size(), 1U);
+    EXPECT_EQ(open[0].id, "m");
+    EXPECT_EQ(tracker.open_orders().size(), 2U);
+    EXPECT_FALSE(tracker.find("x").has_value());
+    EXPECT_FALSE(tracker.find_by_client_order_id("client-x").has_value());
+    EXPECT_TRUE(tracker.find("y").has_value());
+}
+
+TEST_F(OrderTrackerTest, FlattensNestedLegs) {
+    auto parent = make_order_json("p", "new", "2024-01-02T15:00:00Z");
+    parent["order_class"] = "bracket";
+    parent["legs"] = alpaca::Json::array({make_order_json("tp", "held", "2024-01-02T15:00:00Z"),
+                                          make_order_json("sl", "held", "2024-01-02T15:00:00Z")});
+
+    alpaca::OrderTracker tracker(client);
+    tracker.apply(parent.get<alpaca::Order>());
+
+    EXPECT_EQ(tracker.open_order_count(), 3U);
+    ASSERT_TRUE(tracker.find("sl").has_value());
+    EXPECT_EQ(tracker.find("sl")->status, alpaca::OrderStatus::HELD);
+}
+
+TEST_F(OrderTrackerTest, ReconcileRefreshesOrdersMissingFromTheSnapshot) {
+    alpaca::OrderTracker tracker(client);
+    tracker.apply(make_order("a", "new", "2024-01-02T15:00:00Z"));
+    tracker.apply(make_order("b", "new", "2024-01-02T15:00:00Z"));
+
+    // "b" closed while the stream was down; only "a" is still open.
+    http->push_response(page({make_order_json("a", "partially_filled", "2024-01-02T15:00:01Z", "2")}));
+    http->push_response(
+        alpaca::HttpResponse{200, make_order_json("b", "canceled", "2024-01-02T15:00:02Z").dump(), {}});
+
+    tracker.reconcile();
+
+    ASSERT_EQ(http->requests().size(), 2U);
+    EXPECT_NE(http->requests()[1].request.url.find("/orders/b"), std::string::npos);
+    EXPECT_EQ(tracker.find("a")->status, alpaca::OrderStatus::PARTIALLY_FILLED);
+    EXPECT_EQ(tracker.find("b")->status, alpaca::OrderStatus::CANCELED);
+    EXPECT_EQ(tracker.open_order_count(), 1U);
+
+    auto const stats = tracker.stats();
+    EXPECT_EQ(stats.reconciliations, 1U);
+    EXPECT_EQ(stats.reconciled_orders, 1U);
+}
+
+/// Answers every lookup of order "b" with a 404.
+class FailingLookupHttpClient : public FakeHttpClient {
+  public:
+    alpaca::HttpResponse send(alpaca::HttpRequest const& request) override {
+        if (request.url.find("/orders/b") != std::string::npos) {
+            return alpaca::HttpResponse{404, R"({"message": "order not found"})", {}};
+        }
+        return FakeHttpClient::send(request);
+    }
+};
+
+TEST(OrderTrackerReconcileTest, KeepsGoingWhenOneRefreshFails) {
+    auto http = std::make_shared<FailingLookupHttpClient>();
+    alpaca::TradingClient client{alpaca::Configuration::Paper("key", "secret"), http};
+    alpaca::OrderTracker tracker(client);
+    std::vector<std::string> errors;
+    tracker.set_error_handler([&errors](std::string const& message) {
+        errors.push_back(message);
+    });
+    tracker.apply(make_order("a", "new", "2024-01-02T15:00:00Z"));
+    tracker.apply(make_order("b", "new", "2024-01-02T15:00:00Z"));
+    tracker.apply(make_order("c", "new", "2024-01-02T15:00:00Z"));
+
+    // All three closed while the stream was down; looking up "b" fails whichever order it comes in.
+    http->push_response(page({}));
+    http->push_response(alpaca::HttpResponse{200, make_order_json("a", "canceled", "2024-01-02T15:00:02Z").dump(), {}});
+    http->push_response(alpaca::HttpResponse{200, make_order_json("c", "filled", "2024-01-02T15:00:02Z").dump(), {}});
+
+    EXPECT_NO_THROW(tracker.reconcile());
+
+    ASSERT_EQ(errors.size(), 1U);
+    EXPECT_NE(errors.front().find("could not refresh b"), std::string::npos);
+    // "b" stays open and is retried on the next pass.
+    EXPECT_EQ(tracker.open_order_count(), 1U);
+    EXPECT_EQ(tracker.find("b")->status, alpaca::OrderStatus::NEW);
+    EXPECT_EQ(tracker.stats().reconciled_orders, 2U);
+}
+
+} // namespace
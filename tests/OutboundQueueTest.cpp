@@ -0,0 +1,55 @@
+#include "alpaca/OutboundQueue.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace alpaca::streaming::detail {
+namespace {
+
+TEST(OutboundQueueTest, PreservesPerProducerOrderAcrossConcurrentSenders) {
+    constexpr int kProducers = 4;
+    constexpr int kFramesPerProducer = 5000;
+    OutboundQueue queue;
+    std::vector<std::vector<int>> received(kProducers);
+
+    auto drain = [&queue, &received]() {
+        while (queue.try_acquire_consumer()) {
+            while (auto frame = queue.pop()) {
+                auto const separator = frame->find(':');
+                received[std::stoi(frame->substr(0, separator))].push_back(std::stoi(frame->substr(separator + 1)));
+            }
+            queue.release_consumer();
+            if (queue.empty()) {
+                return;
+            }
+        }
+    };
+
+    std::vector<std::thread> producers;
+    for (int producer = 0; producer < kProducers; ++producer) {
+        producers.emplace_back([producer, &queue, &drain]() {
+            for (int i = 0; i < kFramesPerProducer; ++i) {
+                queue.push(std::to_string(producer) + ":" + std::to_string(i));
+                drain();
+            }
+        });
+    }
+    for (auto& thread : producers) {
+        thread.join();
+    }
+    drain();
+
+    EXPECT_TRUE(queue.empty());
+    for (auto const& frames : received) {
+        ASSERT_EQ(frames.size(), static_cast<std::size_t>(kFramesPerProducer));
+        for (int i = 0; i < kFramesPerProducer; ++i) {
+            EXPECT_EQ(frames[static_cast<std::size_t>(i)], i);
+        }
+    }
+}
+
+} // namespace
+} // namespace alpaca::streaming::detail
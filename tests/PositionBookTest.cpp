@@ -0,0 +1,305 @@
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "FakeHttpClient.hpp"
+#include "alpaca/Configuration.hpp"
+#include "alpaca/Json.hpp"
+#include "alpaca/PositionBook.hpp"
+#include "alpaca/TradingClient.hpp"
+
+namespace {
+
+alpaca::streaming::OrderUpdateMessage make_fill(std::string const& id, std::string const& symbol,
+                                                alpaca::OrderSide side, std::string const& filled_qty,
+                                                std::string const& filled_avg_price, alpaca::OrderStatus status) {
+    alpaca::streaming::OrderUpdateMessage update;
+    update.event = status == alpaca::OrderStatus::FILLED ? "fill" : "partial_fill";
+    update.order.id = id;
+    update.order.symbol = symbol;
+    update.order.asset_class = "us_equity";
+    update.order.side = side;
+    update.order.filled_qty = filled_qty;
+    update.order.filled_avg_price = filled_avg_price;
+    update.order.status = status;
+    return update;
+}
+
+alpaca::streaming::QuoteMessage make_quote(std::string const& symbol, double bid, double ask) {
+    alpaca::streaming::QuoteMessage quote;
+    quote.symbol = symbol;
+    quote.bid_price = alpaca::Money(bid);
+    quote.ask_price = alpaca::Money(ask);
+    return quote;
+}
+
+/// Serves one AAPL position and one open buy order from a shared account state, and lets a test run a step while
+/// the positions request is in flight, the way a fill can land while `seed` reads its snapshots.
+class AccountHttpClient : public alpaca::HttpClient {
+  public:
+    std::string position_qty{"3"};
+    std::string position_cost{"300"};
+    std::string order_filled{"3"};
+    std::string order_average{"100"};
+    std::function<void()> during_positions;
+    bool fail_positions{false};
+    int position_reads{0};
+
+    alpaca::HttpResponse send(alpaca::HttpRequest const& request) override {
+        if (request.url.find("/v2/options/positions") != std::string::npos) {
+            return alpaca::HttpResponse{200, "[]", {}};
+        }
+        if (request.url.find("/v2/positions") != std::string::npos) {
+            ++position_reads;
+            auto const body = R"([{"asset_id": "a1", "symbol": "AAPL", "asset_class": "us_equity", "qty": ")" +
+                              position_qty + R"(", "avg_entry_price": "100", "cost_basis": ")" + position_cost +
+                              R"(", "current_price": "100"}])";
+            if (auto step = std::exchange(during_positions, nullptr)) {
+                step();
+            }
+            if (fail_positions) {
+                return alpaca::HttpResponse{403, R"({"message": "forbidden"})", {}};
+            }
+            return alpaca::HttpResponse{200, body, {}};
+        }
+        return alpaca::HttpResponse{200,
+                                    R"([{"id": "b1", "client_order_id": "c1", "created_at": "2024-01-02T15:00:00Z",
+            "symbol": "AAPL", "side": "buy", "type": "limit", "time_in_force": "day",
+            "status": "partially_filled", "qty": "10", "filled_qty": ")" +
+                                        order_filled + R"(", "filled_avg_price": ")" + order_average + R"("}])",
+                                    {}};
+    }
+};
+
+class PositionBookTest : public ::testing::Test {
+  protected:
+    std::shared_ptr<FakeHttpClient> http = std::make_shared<FakeHttpClient>();
+    alpaca::TradingClient client{alpaca::Configuration::Paper("key", "secret"), http};
+};
+
+TEST_F(PositionBookTest, SeedsPositionsAndMarksToQuotes) {
+    // The open orders are read on both sides of the positions.
+    http->push_response(alpaca::HttpResponse{200, "[]", {}});
+    http->push_response(alpaca::HttpResponse{200, R"([
+        {"asset_id": "a1", "symbol": "AAPL", "asset_class": "us_equity", "qty": "10", "avg_entry_price": "100",
+         "cost_basis": "1000", "current_price": "101"},
+        {"asset_id": "a2", "symbol": "TSLA", "asset_class": "us_equity", "qty": "-5", "avg_entry_price": "200",
+         "cost_basis": "-1000", "current_price": "200"}])",
+                                             {}});
+    http->push_response(alpaca::HttpResponse{200, R"([
+        {"asset_id": "o1", "symbol": "AAPL240119C00100000", "asset_class": "us_option", "qty": "2",
+         "avg_entry_price": "2.5", "cost_basis": "500", "current_price": "2.5", "contract_multiplier": "100"}])",
+                                             {}});
+    http->push_response(alpaca::HttpResponse{200, "[]", {}});
+
+    alpaca::PositionBook book(client);
+    book.seed();
+    ASSERT_EQ(http->requests().size(), 4U);
+
+    auto const aapl = book.position("AAPL");
+    ASSERT_TRUE(aapl.has_value());
+    EXPECT_EQ(aapl->avg_entry_price, alpaca::Money(100, 0));
+    EXPECT_EQ(aapl->unrealized_pl, alpaca::Money(10, 0));
+
+    book.apply(make_quote("AAPL", 104.9, 105.1));
+    book.apply(make_quote("TSLA", 189.9, 190.1));
+    alpaca::streaming::TradeMessage trade;
+    trade.symbol = "AAPL240119C00100000";
+    trade.price = alpaca::Money(3, 0);
+    book.apply(trade);
+
+    EXPECT_EQ(book.position("AAPL")->mark_price, alpaca::Money(105, 0));
+    EXPECT_EQ(book.position("AAPL")->unrealized_pl, alpaca::Money(50, 0));
+    EXPECT_EQ(book.position("TSLA")->unrealized_pl, alpaca::Money(50, 0));
+    auto const option = book.position("AAPL240119C00100000");
+    EXPECT_EQ(option->avg_entry_price, alpaca::Money(2, 500'000));
+    EXPECT_EQ(option->market_value, alpaca::Money(600, 0));
+    EXPECT_EQ(option->unrealized_pl, alpaca::Money(100, 0));
+
+    auto const total = book.portfolio();
+    EXPECT_EQ(total.unrealized_pl, alpaca::Money(200, 0));
+    EXPECT_EQ(total.market_value, alpaca::Money(1050 - 950 + 600, 0));
+    EXPECT_EQ(book.positions().size(), 3U);
+    EXPECT_FALSE(book.position("MSFT").has_value());
+}
+
+TEST_F(PositionBookTest, AppliesFillDeltasAndRealisesClosingTrades) {
+    alpaca::PositionBook book(client);
+
+    book.apply(make_fill("b1", "MSFT", alpaca::OrderSide::BUY, "4", "100", alpaca::OrderStatus::PARTIALLY_FILLED));
+    // The second 6 shares filled at 110: cumulative average (4 * 100 + 6 * 110) / 10 = 106.
+    book.apply(make_fill("b1", "MSFT", alpaca::OrderSide::BUY, "10", "106", alpaca::OrderStatus::FILLED));
+    // Repeated and out-of-order events add nothing.
+    book.apply(make_fill("b1", "MSFT", alpaca::OrderSide::BUY, "10", "106", alpaca::OrderStatus::FILLED));
+    book.apply(make_fill("b1", "MSFT", alpaca::OrderSide::BUY, "4", "100", alpaca::OrderStatus::PARTIALLY_FILLED));
+
+    auto position = book.position("MSFT");
+    ASSERT_TRUE(position.has_value());
+    EXPECT_EQ(position->qty, alpaca::Money(10, 0));
+    EXPECT_EQ(position->avg_entry_price, alpaca::Money(106, 0));
+    EXPECT_EQ(position->mark_price, alpaca::Money(110, 0));
+
+    book.apply(make_fill("s1", "MSFT", alpaca::OrderSide::SELL, "4", "111", alpaca::OrderStatus::PARTIALLY_FILLED));
+    position = book.position("MSFT");
+    EXPECT_EQ(position->qty, alpaca::Money(6, 0));
+    EXPECT_EQ(position->avg_entry_price, alpaca::Money(106, 0));
+    EXPECT_EQ(position->realized_pl, alpaca::Money(20, 0));
+
+    // Selling 10 more closes the remaining 6 and opens a 4 share short at 111.
+    book.apply(make_fill("s1", "MSFT", alpaca::OrderSide::SELL, "14", "111", alpaca::OrderStatus::FILLED));
+    position = book.position("MSFT");
+    EXPECT_EQ(position->qty, alpaca::Money(-4, 0));
+    EXPECT_EQ(position->avg_entry_price, alpaca::Money(111, 0));
+    EXPECT_EQ(position->realized_pl, alpaca::Money(50, 0));
+    EXPECT_EQ(book.portfolio().realized_pl, alpaca::Money(50, 0));
+}
+
+TEST_F(PositionBookTest, SeedRecordsFillsAlreadyInThePositions) {
+    std::string const orders = R"([
+        {"id": "b1", "client_order_id": "c1", "created_at": "2024-01-02T15:00:00Z", "symbol": "AAPL",
+         "side": "buy", "type": "limit", "time_in_force": "day", "status": "partially_filled",
+         "qty": "10", "filled_qty": "3", "filled_avg_price": "100"}])";
+    http->push_response(alpaca::HttpResponse{200, orders, {}});
+    http->push_response(alpaca::HttpResponse{200, R"([
+        {"asset_id": "a1", "symbol": "AAPL", "asset_class": "us_equity", "qty": "3", "avg_entry_price": "100",
+         "cost_basis": "300", "current_price": "100"}])",
+                                             {}});
+    http->push_response(alpaca::HttpResponse{200, "[]", {}});
+    http->push_response(alpaca::HttpResponse{200, orders, {}});
+
+    alpaca::PositionBook book(client);
+    book.seed();
+    book.apply(make_fill("b1", "AAPL", alpaca::OrderSide::BUY, "5", "101.2", alpaca::OrderStatus::PARTIALLY_FILLED));
+
+    auto const position = book.position("AAPL");
+    ASSERT_TRUE(position.has_value());
+    EXPECT_EQ(position->qty, alpaca::Money(5, 0));
+    EXPECT_EQ(position->cost_basis, alpaca::Money(506, 0));
+}
+
+TEST(PositionBookSeedTest, CountsAFillThatLandsBetweenTheSnapshotsOnce) {
+    auto http = std::make_shared<AccountHttpClient>();
+    alpaca::TradingClient client(alpaca::Configuration::Paper("key", "secret"), http);
+    alpaca::PositionBook book(client);
+
+    // Two more shares fill after the positions were read; the event arrives while the orders are read again.
+    http->during_positions = [&] {
+        http->position_qty = "5";
+        http->position_cost = "506";
+        http->order_filled = "5";
+        http->order_average = "101.2";
+        book.apply(make_fill("b1", "AAPL", alpaca::OrderSide::BUY, "5", "101.2",
+                             alpaca::OrderStatus::PARTIALLY_FILLED));
+    };
+    book.seed();
+    EXPECT_EQ(http->position_reads, 2);
+    EXPECT_EQ(book.position("AAPL")->qty, alpaca::Money(5, 0));
+    EXPECT_EQ(book.position("AAPL")->cost_basis, alpaca::Money(506, 0));
+
+    book.apply(make_fill("b1", "AAPL", alpaca::OrderSide::BUY, "5", "101.2", alpaca::OrderStatus::PARTIALLY_FILLED));
+    book.apply(make_fill("b1", "AAPL", alpaca::OrderSide::BUY, "6", "101", alpaca::OrderStatus::PARTIALLY_FILLED));
+    EXPECT_EQ(book.position("AAPL")->qty, alpaca::Money(6, 0));
+}
+
+TEST(PositionBookSeedTest, AppliesHeldFillsToTheOldBookWhenASnapshotFails) {
+    auto http = std::make_shared<AccountHttpClient>();
+    alpaca::TradingClient client(alpaca::Configuration::Paper("key", "secret"), http);
+    alpaca::PositionBook book(client);
+    book.apply(make_fill("b1", "AAPL", alpaca::OrderSide::BUY, "3", "100", alpaca::OrderStatus::PARTIALLY_FILLED));
+
+    http->fail_positions = true;
+    http->during_positions = [&] {
+        book.apply(make_fill("b1", "AAPL", alpaca::OrderSide::BUY, "4", "100",
+                             alpaca::OrderStatus::PARTIALLY_FILLED));
+    };
+    EXPECT_ANY_THROW(book.seed());
+    EXPECT_EQ(book.position("AAPL")->qty, alpaca::Money(4, 0));
+
+    book.apply(make_fill("b1", "AAPL", alpaca::OrderSide::BUY, "5", "100", alpaca::OrderStatus::PARTIALLY_FILLED));
+    EXPECT_EQ(book.position("AAPL")->qty, alpaca::Money(5, 0));
+}
+
+TEST_F(PositionBookTest, LeavesOutCryptoAmountsMoneyCannotHold) {
+    http->push_response(alpaca::HttpResponse{200, "[]", {}});
+    http->push_response(alpaca::HttpResponse{200, R"([
+        {"asset_id": "a1", "symbol": "AAPL", "asset_class": "us_equity", "qty": "3", "avg_entry_price": "100",
+         "cost_basis": "300", "current_price": "100"},
+        {"asset_id": "c1", "symbol": "BTC/USD", "asset_class": "crypto", "qty": "0.123456789",
+         "avg_entry_price": "60000", "cost_basis": "7407.40734", "current_price": "60000"}])",
+                                             {}});
+    http->push_response(alpaca::HttpResponse{200, "[]", {}});
+    http->push_response(alpaca::HttpResponse{200, "[]", {}});
+
+    alpaca::PositionBook book(client);
+    std::vector<std::string> errors;
+    book.set_error_handler([&errors](std::string const& message) { errors.push_back(message); });
+    book.seed();
+    EXPECT_EQ(book.quantity("AAPL"), alpaca::Money(3, 0));
+    EXPECT_FALSE(book.position("BTC/USD").has_value());
+    ASSERT_EQ(errors.size(), 1U);
+    EXPECT_NE(errors.front().find("BTC/USD"), std::string::npos);
+
+    int forwarded = 0;
+    auto handler = book.handler(
+        [&forwarded](alpaca::streaming::StreamMessage const&, alpaca::streaming::MessageCategory) { ++forwarded; });
+    auto fill = make_fill("c2", "BTC/USD", alpaca::OrderSide::BUY, "0.000000001", "60000", alpaca::OrderStatus::FILLED);
+    fill.order.asset_class = "crypto";
+    handler(alpaca::streaming::StreamMessage{fill}, alpaca::streaming::MessageCategory::OrderUpdate);
+    EXPECT_EQ(forwarded, 1);
+    EXPECT_EQ(errors.size(), 2U);
+    EXPECT_FALSE(book.position("BTC/USD").has_value());
+}
+
+TEST_F(PositionBookTest, GrowsItsIndexAndDropsSymbolsASeedNoLongerHolds) {
+    alpaca::PositionBook book(client);
+    for (int i = 0; i < 200; ++i) {
+        auto const symbol = "S" + std::to_string(i);
+        book.apply(make_fill("b" + std::to_string(i), symbol, alpaca::OrderSide::BUY, "1", "10",
+                             alpaca::OrderStatus::FILLED));
+    }
+    EXPECT_EQ(book.positions().size(), 200U);
+    EXPECT_EQ(book.quantity("S0"), alpaca::Money(1, 0));
+    EXPECT_EQ(book.quantity("S199"), alpaca::Money(1, 0));
+    EXPECT_EQ(book.portfolio().cost_basis, alpaca::Money(2000, 0));
+
+    http->push_response(alpaca::HttpResponse{200, "[]", {}});
+    http->push_response(alpaca::HttpResponse{200, R"([
+        {"asset_id": "a1", "symbol": "S7", "asset_class": "us_equity", "qty": "4", "avg_entry_price": "10",
+         "cost_basis": "40", "current_price": "10"}])",
+                                             {}});
+    http->push_response(alpaca::HttpResponse{200, "[]", {}});
+    http->push_response(alpaca::HttpResponse{200, "[]", {}});
+    book.seed();
+
+    ASSERT_EQ(book.positions().size(), 1U);
+    EXPECT_EQ(book.quantity("S7"), alpaca::Money(4, 0));
+    EXPECT_FALSE(book.position("S8").has_value());
+    EXPECT_EQ(book.portfolio().cost_basis, alpaca::Money(40, 0));
+
+    // A symbol the seed dropped comes back with its next fill.
+    book.apply(make_fill("b-next", "S8", alpaca::OrderSide::BUY, "2", "11", alpaca::OrderStatus::FILLED));
+    EXPECT_EQ(book.position("S8")->qty, alpaca::Money(2, 0));
+    EXPECT_EQ(book.position("S8")->mark_price, alpaca::Money(11, 0));
+}
+
+TEST_F(PositionBookTest, HandlerAppliesStreamMessagesAndForwards) {
+    alpaca::PositionBook book(client);
+    int forwarded = 0;
+    auto handler = book.handler(
+        [&forwarded](alpaca::streaming::StreamMessage const&, alpaca::streaming::MessageCategory) { ++forwarded; });
+
+    handler(alpaca::streaming::StreamMessage{make_fill("b1", "AAPL", alpaca::OrderSide::BUY, "1", "100",
+                                                       alpaca::OrderStatus::FILLED)},
+            alpaca::streaming::MessageCategory::OrderUpdate);
+    handler(alpaca::streaming::StreamMessage{make_quote("AAPL", 101, 103)},
+            alpaca::streaming::MessageCategory::Quote);
+
+    EXPECT_EQ(forwarded, 2);
+    EXPECT_EQ(book.position("AAPL")->unrealized_pl, alpaca::Money(2, 0));
+}
+
+} // namespace
@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "FakeHttpClient.hpp"
+#include "alpaca/Configuration.hpp"
+#include "alpaca/Exceptions.hpp"
+#include "alpaca/PositionBook.hpp"
+#include "alpaca/PreTradeRisk.hpp"
+#include "alpaca/TradingClient.hpp"
+
+namespace {
+
+alpaca::NewOrderRequest make_order(std::string symbol, alpaca::OrderSide side, std::string qty,
+                                   std::optional<std::string> limit_price = std::nullopt) {
+    alpaca::NewOrderRequest request;
+    request.symbol = std::move(symbol);
+    request.side = side;
+    request.quantity = std::move(qty);
+    if (limit_price) {
+        request.type = alpaca::OrderType::LIMIT;
+        request.limit_price = std::move(limit_price);
+    }
+    return request;
+}
+
+alpaca::streaming::QuoteMessage make_quote(std::string const& symbol, std::string const& bid, std::string const& ask) {
+    alpaca::streaming::QuoteMessage quote;
+    quote.symbol = symbol;
+    quote.bid_price = alpaca::Money(bid);
+    quote.ask_price = alpaca::Money(ask);
+    return quote;
+}
+
+alpaca::PreTradeRisk::RuleStats rule_stats(alpaca::PreTradeRisk const& risk, alpaca::RiskRule rule) {
+    return risk.stats().rules.at(static_cast<std::size_t>(rule));
+}
+
+TEST(PreTradeRiskTest, EnforcesSizeNotionalAndCollarLimits) {
+    alpaca::PreTradeRisk risk;
+    alpaca::RiskLimits limits;
+    limits.max_order_qty = alpaca::Money("1000");
+    limits.max_order_notional = alpaca::Money("50000");
+    limits.price_collar_bps = 50;
+    risk.set_limits("AAPL", limits);
+
+    // Without a quote a market order cannot be valued, and a limit order cannot be collared.
+    auto decision = risk.check(make_order("AAPL", alpaca::OrderSide::BUY, "10"));
+    EXPECT_FALSE(decision);
+    EXPECT_EQ(decision.rule, alpaca::RiskRule::MaxNotional);
+    decision = risk.check(make_order("AAPL", alpaca::OrderSide::BUY, "10", "100"));
+    EXPECT_EQ(decision.rule, alpaca::RiskRule::PriceCollar);
+
+    risk.apply(make_quote("AAPL", "100", "100.10"));
+    EXPECT_TRUE(risk.check(make_order("AAPL", alpaca::OrderSide::BUY, "10")));
+    EXPECT_TRUE(risk.check(make_order("AAPL", alpaca::OrderSide::BUY, "10", "100.50")));
+
+    decision = risk.check(make_order("AAPL", alpaca::OrderSide::BUY, "1500", "100"));
+    EXPECT_EQ(decision.rule, alpaca::RiskRule::FatFinger);
+    EXPECT_EQ(decision.reason, "Order quantity 1500 exceeds the limit of 1000");
+
+    decision = risk.check(make_order("AAPL", alpaca::OrderSide::BUY, "600"));
+    EXPECT_EQ(decision.rule, alpaca::RiskRule::MaxNotional);
+    EXPECT_EQ(decision.reason, "Order notional 60060 exceeds the limit of 50000");
+
+    // Buys may reach 50bp past the ask, sells 50bp under the bid.
+    decision = risk.check(make_order("AAPL", alpaca::OrderSide::BUY, "10", "100.61"));
+    EXPECT_EQ(decision.rule, alpaca::RiskRule::PriceCollar);
+    EXPECT_EQ(decision.reason, "Limit price 100.61 is past the collar at 100.6005");
+    EXPECT_TRUE(risk.check(make_order("AAPL", alpaca::OrderSide::SELL, "10", "99.50")));
+    EXPECT_FALSE(risk.check(make_order("AAPL", alpaca::OrderSide::SELL, "10", "99.49")));
+
+    // Other symbols fall back to the defaults, which set no limits.
+    EXPECT_TRUE(risk.check(make_order("MSFT", alpaca::OrderSide::BUY, "1000000")));
+
+    auto const stats = risk.stats();
+    EXPECT_EQ(stats.checks, 10U);
+    EXPECT_EQ(stats.rejected, 6U);
+    ASSERT_EQ(stats.rules.size(), alpaca::kRiskRuleCount);
+    EXPECT_EQ(rule_stats(risk, alpaca::RiskRule::FatFinger).evaluations, 9U);
+    EXPECT_EQ(rule_stats(risk, alpaca::RiskRule::FatFinger).rejections, 1U);
+    EXPECT_EQ(rule_stats(risk, alpaca::RiskRule::PriceCollar).rejections, 3U);
+    EXPECT_EQ(rule_stats(risk, alpaca::RiskRule::SymbolThrottle).evaluations, 0U);
+}
+
+TEST(PreTradeRiskTest, LimitsThePositionAnOrderLeaves) {
+    auto http = std::make_shared<FakeHttpClient>();
+    alpaca::TradingClient client(alpaca::Configuration::Paper("key", "secret"), http);
+    http->push_response(alpaca::HttpResponse{200, "[]", {}});
+    http->push_response(alpaca::HttpResponse{200, R"([
+        {"asset_id": "a1", "symbol": "AAPL", "asset_class": "us_equity", "qty": "80", "avg_entry_price": "100",
+         "cost_basis": "8000", "current_price": "100"}])",
+                                             {}});
+    http->push_response(alpaca::HttpResponse{200, "[]", {}});
+    http->push_response(alpaca::HttpResponse{200, "[]", {}});
+    alpaca::PositionBook book(client);
+    book.seed();
+    EXPECT_EQ(book.quantity("AAPL"), alpaca::Money("80"));
+    EXPECT_EQ(book.quantity("MSFT"), alpaca::Money{});
+
+    alpaca::PreTradeRisk::Options options;
+    options.default_limits.max_position = alpaca::Money("100");
+    alpaca::PreTradeRisk risk(book, options);
+
+    EXPECT_TRUE(risk.check(make_order("AAPL", alpaca::OrderSide::BUY, "20")));
+    auto const decision = risk.check(make_order("AAPL", alpaca::OrderSide::BUY, "21"));
+    EXPECT_EQ(decision.rule, alpaca::RiskRule::MaxPosition);
+    EXPECT_EQ(decision.reason, "Position would reach 101 against the limit of 100");
+    EXPECT_TRUE(risk.check(make_order("AAPL", alpaca::OrderSide::SELL, "180")));
+    EXPECT_FALSE(risk.check(make_order("AAPL", alpaca::OrderSide::SELL, "181")));
+
+    // A notional order is sized at the far touch.
+    alpaca::NewOrderRequest notional;
+    notional.symbol = "MSFT";
+    notional.notional = "5000";
+    EXPECT_EQ(risk.check(notional).rule, alpaca::RiskRule::MaxPosition);
+    risk.apply(make_quote("MSFT", "49.90", "50"));
+    EXPECT_TRUE(risk.check(notional));
+    notional.notional = "5001";
+    EXPECT_FALSE(risk.check(notional));
+}
+
+TEST(PreTradeRiskTest, ThrottlesOnlyOrdersThatPassTheOtherRules) {
+    alpaca::PreTradeRisk::Options options;
+    options.max_orders_per_second = 0.001;
+    options.burst = 3;
+    options.default_limits.max_order_qty = alpaca::Money("100");
+    options.default_limits.max_orders_per_second = 0.001;
+    options.default_limits.burst = 2;
+    alpaca::PreTradeRisk risk(options);
+
+    EXPECT_FALSE(risk.check(make_order("AAPL", alpaca::OrderSide::BUY, "500")));
+    EXPECT_TRUE(risk.check(make_order("AAPL", alpaca::OrderSide::BUY, "10")));
+    EXPECT_TRUE(risk.check(make_order("AAPL", alpaca::OrderSide::BUY, "10")));
+    EXPECT_EQ(risk.check(make_order("AAPL", alpaca::OrderSide::BUY, "10")).rule, alpaca::RiskRule::SymbolThrottle);
+    EXPECT_TRUE(risk.check(make_order("MSFT", alpaca::OrderSide::BUY, "10")));
+    EXPECT_EQ(risk.check(make_order("TSLA", alpaca::OrderSide::BUY, "10")).rule, alpaca::RiskRule::AccountThrottle);
+
+    EXPECT_EQ(rule_stats(risk, alpaca::RiskRule::SymbolThrottle).evaluations, 5U);
+    EXPECT_EQ(rule_stats(risk, alpaca::RiskRule::AccountThrottle).evaluations, 4U);
+    EXPECT_EQ(rule_stats(risk, alpaca::RiskRule::AccountThrottle).rejections, 1U);
+}
+
+TEST(PreTradeRiskTest, AccountThrottleRejectionLeavesTheSymbolRateUnused) {
+    alpaca::PreTradeRisk::Options options;
+    options.max_orders_per_second = 20;
+    options.default_limits.max_orders_per_second = 0.001;
+    alpaca::PreTradeRisk risk(options);
+
+    EXPECT_TRUE(risk.check(make_order("AAPL", alpaca::OrderSide::BUY, "10")));
+    EXPECT_EQ(risk.check(make_order("MSFT", alpaca::OrderSide::BUY, "10")).rule, alpaca::RiskRule::AccountThrottle);
+    std::this_thread::sleep_for(std::chrono::milliseconds{60});
+    // MSFT's single slot was given back when the account refused the order.
+    EXPECT_TRUE(risk.check(make_order("MSFT", alpaca::OrderSide::BUY, "10")));
+}
+
+TEST(PreTradeRiskTest, KeepsQuotesForSymbolsNotYetChecked) {
+    alpaca::PreTradeRisk::Options options;
+    options.default_limits.max_order_notional = alpaca::Money("1000");
+    alpaca::PreTradeRisk risk(options);
+
+    risk.apply(make_quote("NVDA", "99.90", "100"));
+    risk.apply(make_quote("NVDA", "100.90", "101"));
+    EXPECT_TRUE(risk.check(make_order("NVDA", alpaca::OrderSide::BUY, "9")));
+    auto const decision = risk.check(make_order("NVDA", alpaca::OrderSide::BUY, "10"));
+    EXPECT_EQ(decision.reason, "Order notional 1010 exceeds the limit of 1000");
+
+    risk.apply(make_quote("NVDA", "89.90", "90"));
+    EXPECT_TRUE(risk.check(make_order("NVDA", alpaca::OrderSide::BUY, "10")));
+}
+
+TEST(PreTradeRiskTest, RefusesNotionalOrdersItCannotSize) {
+    alpaca::PreTradeRisk::Options options;
+    options.default_limits.max_order_qty = alpaca::Money("100");
+    alpaca::PreTradeRisk risk(options);
+
+    alpaca::NewOrderRequest notional;
+    notional.symbol = "AAPL";
+    notional.notional = "500";
+    auto const decision = risk.check(notional);
+    EXPECT_EQ(decision.rule, alpaca::RiskRule::FatFinger);
+    EXPECT_EQ(decision.reason, "No quote to size the order against its quantity limit");
+
+    risk.apply(make_quote("AAPL", "9.90", "10"));
+    EXPECT_TRUE(risk.check(notional));
+}
+
+TEST(PreTradeRiskTest, SubmitsOnlyAcceptedOrders) {
+    auto http = std::make_shared<FakeHttpClient>();
+    alpaca::TradingClient client(alpaca::Configuration::Paper("key", "secret"), http);
+    alpaca::PreTradeRisk::Options options;
+    options.default_limits.max_order_qty = alpaca::Money("100");
+    alpaca::PreTradeRisk risk(options);
+
+    try {
+        static_cast<void>(risk.submit_order(client, make_order("AAPL", alpaca::OrderSide::BUY, "101")));
+        FAIL() << "expected a risk rejection";
+    } catch (alpaca::RiskRejectedException const& ex) {
+        EXPECT_EQ(ex.rule(), "fat_finger");
+        EXPECT_EQ(ex.code(), alpaca::ErrorCode::PreTradeRiskRejected);
+        EXPECT_EQ(ex.metadata().at("symbol"), "AAPL");
+    }
+    EXPECT_TRUE(http->requests().empty());
+
+    http->push_response(alpaca::HttpResponse{200, R"({"id": "order-1", "symbol": "AAPL", "qty": "100",
+        "side": "buy", "type": "market", "time_in_force": "day", "status": "new",
+        "created_at": "2024-01-02T15:00:00Z"})",
+                                             {}});
+    auto const order = risk.submit_order(client, make_order("AAPL", alpaca::OrderSide::BUY, "100"));
+    EXPECT_EQ(order.id, "order-1");
+    EXPECT_EQ(http->requests().size(), 1U);
+}
+
+} // namespace
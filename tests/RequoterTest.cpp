@@ -0,0 +1,276 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "alpaca/Configuration.hpp"
+#include "alpaca/HttpClient.hpp"
+#include "alpaca/Json.hpp"
+#include "alpaca/OrderTracker.hpp"
+#include "alpaca/Requoter.hpp"
+#include "alpaca/TradingClient.hpp"
+
+namespace {
+
+/// In-memory order endpoint: accepts, replaces and cancels orders, rejecting reused client order ids like the API.
+class FakeExchange : public alpaca::HttpClient {
+  public:
+    alpaca::HttpResponse send(alpaca::HttpRequest const& request) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++counts_[request.method];
+        auto const path = request.url.substr(request.url.find("/v2/orders"));
+
+        if (request.method == alpaca::HttpMethod::POST) {
+            auto const body = alpaca::Json::parse(request.body);
+            auto const client_order_id = body.at("client_order_id").get<std::string>();
+            if (by_client_id_.contains(client_order_id)) {
+                return reject();
+            }
+            auto& order = create(client_order_id, body);
+            if (drop_next_response_) {
+                drop_next_response_ = false;
+                throw std::runtime_error("timed out waiting for the response");
+            }
+            return ok(order);
+        }
+        if (request.method == alpaca::HttpMethod::PATCH) {
+            auto& original = orders_.at(path.substr(std::string("/v2/orders/").size()));
+            auto const body = alpaca::Json::parse(request.body);
+            auto const client_order_id = body.at("client_order_id").get<std::string>();
+            if (original["status"] != "new" || by_client_id_.contains(client_order_id)) {
+                return reject();
+            }
+            original["status"] = "replaced";
+            auto patched = original;
+            for (auto const& [key, value] : body.items()) {
+                patched[key] = value;
+            }
+            return ok(create(client_order_id, patched));
+        }
+        if (request.method == alpaca::HttpMethod::DELETE_) {
+            orders_.at(path.substr(std::string("/v2/orders/").size()))["status"] = "canceled";
+            return alpaca::HttpResponse{204, "", {}};
+        }
+        auto const client_order_id = request.url.substr(request.url.find("client_order_id=") + 16);
+        auto const it = by_client_id_.find(client_order_id);
+        if (it == by_client_id_.end()) {
+            return alpaca::HttpResponse{404, R"({"message": "order not found"})", {}};
+        }
+        return ok(orders_.at(it->second));
+    }
+
+    /// The next submission is accepted but its response is lost.
+    void drop_next_response() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        drop_next_response_ = true;
+    }
+
+    /// Replays every order's current state, as the trade_updates stream would.
+    void stream_to(alpaca::OrderTracker& tracker) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto const& [id, order] : orders_) {
+            tracker.apply(order.get<alpaca::Order>());
+        }
+    }
+
+    [[nodiscard]] int count(alpaca::HttpMethod method) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return counts_[method];
+    }
+
+    [[nodiscard]] std::vector<alpaca::Json> live_orders() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<alpaca::Json> live;
+        for (auto const& [id, order] : orders_) {
+            if (order["status"] == "new") {
+                live.push_back(order);
+            }
+        }
+        return live;
+    }
+
+  private:
+    alpaca::Json& create(std::string const& client_order_id, alpaca::Json const& fields) {
+        auto const id = "order-" + std::to_string(orders_.size() + 1);
+        alpaca::Json order = fields;
+        order["id"] = id;
+        order["client_order_id"] = client_order_id;
+        order["created_at"] = "2024-01-02T15:00:00Z";
+        order["updated_at"] = "2024-01-02T15:00:00Z";
+        order["status"] = "new";
+        by_client_id_[client_order_id] = id;
+        return orders_[id] = order;
+    }
+
+    static alpaca::HttpResponse ok(alpaca::Json const& order) {
+        return alpaca::HttpResponse{200, order.dump(), {}};
+    }
+
+    static alpaca::HttpResponse reject() {
+        return alpaca::HttpResponse{422, R"({"code": 40010001, "message": "client_order_id must be unique"})", {}};
+    }
+
+    std::mutex mutex_;
+    std::map<std::string, alpaca::Json> orders_;
+    std::map<std::string, std::string> by_client_id_;
+    std::map<alpaca::HttpMethod, int> counts_;
+    bool drop_next_response_{false};
+};
+
+alpaca::QuoteTarget make_target(std::string key, std::string symbol, alpaca::OrderSide side, std::string price) {
+    alpaca::QuoteTarget target;
+    target.key = std::move(key);
+    target.symbol = std::move(symbol);
+    target.side = side;
+    target.qty = "100";
+    target.limit_price = std::move(price);
+    return target;
+}
+
+class RequoterTest : public ::testing::Test {
+  protected:
+    std::shared_ptr<FakeExchange> exchange = std::make_shared<FakeExchange>();
+    alpaca::TradingClient client{alpaca::Configuration::Paper("key", "secret"), exchange};
+    alpaca::OrderTracker tracker{client};
+
+    alpaca::Requoter make_requoter() {
+        alpaca::Requoter::Options options;
+        options.session = "s1";
+        options.max_in_flight = 4;
+        return alpaca::Requoter(client, tracker, options);
+    }
+};
+
+TEST_F(RequoterTest, IssuesOnlyTheRequestsTheDiffNeeds) {
+    auto requoter = make_requoter();
+    std::vector<alpaca::QuoteTarget> targets{
+        make_target("aapl-bid", "AAPL", alpaca::OrderSide::BUY, "187.40"),
+        make_target("aapl-ask", "AAPL", alpaca::OrderSide::SELL, "187.50"),
+        make_target("msft-bid", "MSFT", alpaca::OrderSide::BUY, "410.10"),
+    };
+
+    auto report = requoter.requote(targets);
+    EXPECT_EQ(report.submitted, 3U);
+    EXPECT_EQ(report.failed, 0U);
+    ASSERT_TRUE(tracker.find_by_client_order_id("rq-s1-aapl-bid-1").has_value());
+
+    // Same targets, with the price written differently: nothing to send.
+    targets[0].limit_price = "187.4";
+    report = requoter.requote(targets);
+    EXPECT_EQ(report.unchanged, 3U);
+    EXPECT_EQ(exchange->count(alpaca::HttpMethod::POST), 3);
+
+    targets[0].limit_price = "187.41";
+    targets.pop_back();
+    report = requoter.requote(targets);
+    EXPECT_EQ(report.replaced, 1U);
+    EXPECT_EQ(report.canceled, 1U);
+    EXPECT_EQ(report.unchanged, 1U);
+    EXPECT_EQ(exchange->count(alpaca::HttpMethod::PATCH), 1);
+    EXPECT_EQ(exchange->count(alpaca::HttpMethod::DELETE_), 1);
+    auto const replaced = tracker.find_by_client_order_id("rq-s1-aapl-bid-2");
+    ASSERT_TRUE(replaced.has_value());
+    EXPECT_EQ(replaced->limit_price, std::optional<std::string>("187.41"));
+
+    // The cancel waits for its confirmation instead of being sent again.
+    report = requoter.requote(targets);
+    EXPECT_EQ(report.pending, 1U);
+    EXPECT_EQ(exchange->count(alpaca::HttpMethod::DELETE_), 1);
+    exchange->stream_to(tracker);
+    report = requoter.requote(targets);
+    EXPECT_EQ(report.unchanged, 2U);
+    EXPECT_EQ(report.pending, 0U);
+    EXPECT_EQ(exchange->live_orders().size(), 2U);
+
+    auto const stats = requoter.stats();
+    EXPECT_EQ(stats.cycles, 5U);
+    EXPECT_EQ(stats.submitted, 3U);
+    EXPECT_EQ(stats.replaced, 1U);
+    EXPECT_EQ(stats.canceled, 1U);
+    EXPECT_GE(stats.max_cycle, stats.last_cycle);
+}
+
+TEST_F(RequoterTest, RetriesALostSubmissionUnderTheSameClientOrderId) {
+    auto requoter = make_requoter();
+    std::vector<alpaca::QuoteTarget> targets{make_target("bid", "AAPL", alpaca::OrderSide::BUY, "187.40")};
+
+    exchange->drop_next_response();
+    auto report = requoter.requote(targets);
+    EXPECT_EQ(report.failed, 1U);
+    ASSERT_EQ(report.errors.size(), 1U);
+    EXPECT_NE(report.errors[0].find("bid: "), std::string::npos);
+
+    // The retry reuses the id, so the exchange refuses a second order.
+    report = requoter.requote(targets);
+    EXPECT_EQ(report.failed, 1U);
+    EXPECT_EQ(exchange->live_orders().size(), 1U);
+
+    exchange->stream_to(tracker);
+    report = requoter.requote(targets);
+    EXPECT_EQ(report.unchanged, 1U);
+    EXPECT_EQ(exchange->live_orders().size(), 1U);
+}
+
+TEST_F(RequoterTest, CancelsAnUncertainOrderWhenItsSlotIsDropped) {
+    auto requoter = make_requoter();
+    std::vector<alpaca::QuoteTarget> targets{make_target("bid", "AAPL", alpaca::OrderSide::BUY, "187.40")};
+
+    exchange->drop_next_response();
+    static_cast<void>(requoter.requote(targets));
+
+    auto const report = requoter.requote({});
+    EXPECT_EQ(report.canceled, 1U);
+    EXPECT_EQ(exchange->count(alpaca::HttpMethod::GET), 1);
+    EXPECT_TRUE(exchange->live_orders().empty());
+}
+
+TEST_F(RequoterTest, StaysUncertainWhenTheRetryIsRefusedAsADuplicate) {
+    auto requoter = make_requoter();
+    std::vector<alpaca::QuoteTarget> targets{make_target("bid", "AAPL", alpaca::OrderSide::BUY, "187.40")};
+
+    exchange->drop_next_response();
+    static_cast<void>(requoter.requote(targets));
+    // The retry is refused as a duplicate before the stream has delivered the order.
+    EXPECT_EQ(requoter.requote(targets).failed, 1U);
+
+    auto const report = requoter.requote({});
+    EXPECT_EQ(report.canceled, 1U);
+    EXPECT_TRUE(exchange->live_orders().empty());
+}
+
+TEST_F(RequoterTest, DefaultSessionsStartedTogetherDoNotShareIds) {
+    alpaca::Requoter first(client, tracker);
+    alpaca::Requoter second(client, tracker);
+    std::vector<alpaca::QuoteTarget> targets{make_target("bid", "AAPL", alpaca::OrderSide::BUY, "187.40")};
+
+    EXPECT_EQ(first.requote(targets).submitted, 1U);
+    // A shared session would make the exchange refuse this as a duplicate.
+    EXPECT_EQ(second.requote(targets).submitted, 1U);
+    EXPECT_EQ(exchange->live_orders().size(), 2U);
+}
+
+TEST_F(RequoterTest, CancelsBeforeMovingASlotToAnotherSide) {
+    auto requoter = make_requoter();
+    std::vector<alpaca::QuoteTarget> targets{make_target("slot", "AAPL", alpaca::OrderSide::BUY, "187.40")};
+    static_cast<void>(requoter.requote(targets));
+
+    targets[0].side = alpaca::OrderSide::SELL;
+    auto report = requoter.requote(targets);
+    EXPECT_EQ(report.canceled, 1U);
+    EXPECT_EQ(report.submitted, 0U);
+
+    exchange->stream_to(tracker);
+    report = requoter.requote(targets);
+    EXPECT_EQ(report.submitted, 1U);
+    ASSERT_TRUE(tracker.find_by_client_order_id("rq-s1-slot-2").has_value());
+    EXPECT_EQ(tracker.find_by_client_order_id("rq-s1-slot-2")->side, alpaca::OrderSide::SELL);
+
+    EXPECT_THROW(static_cast<void>(requoter.requote(std::vector<alpaca::QuoteTarget>{targets[0], targets[0]})),
+                 alpaca::InvalidArgumentException);
+}
+
+} // namespace
@@ -0,0 +1,60 @@
+#include "alpaca/SequenceGapTracker.hpp"
+
+#include <gtest/gtest.h>
+
+namespace alpaca::streaming {
+namespace {
+
+TEST(SequenceGapTrackerTest, InternsChannelAndStreamPairsIntoDenseSlots) {
+    SequenceGapTracker tracker;
+
+    auto const trades = tracker.slot("t", "AAPL");
+    auto const quotes = tracker.slot("q", "AAPL");
+    auto const bare = tracker.slot({}, "AAPL");
+
+    EXPECT_EQ(trades, 0U);
+    EXPECT_EQ(quotes, 1U);
+    EXPECT_EQ(bare, 2U);
+    EXPECT_EQ(tracker.slot("t", "AAPL"), trades);
+    EXPECT_EQ(tracker.size(), 3U);
+    EXPECT_EQ(tracker.key(trades), "t|AAPL");
+    EXPECT_EQ(tracker.key(bare), "AAPL");
+    EXPECT_EQ(tracker.stream_id(quotes), "AAPL");
+
+    tracker.clear();
+    EXPECT_EQ(tracker.size(), 0U);
+    EXPECT_EQ(tracker.slot("q", "MSFT"), 0U);
+}
+
+TEST(SequenceGapTrackerTest, ReportsForwardGapsAndIgnoresStaleSequences) {
+    SequenceGapTracker tracker;
+    auto const slot = tracker.slot("t", "MSFT");
+
+    EXPECT_FALSE(tracker.observe(slot, 10).has_value());
+    EXPECT_FALSE(tracker.observe(slot, 11).has_value());
+
+    auto const gap = tracker.observe(slot, 15);
+    ASSERT_TRUE(gap.has_value());
+    EXPECT_EQ(gap->expected, 12U);
+    EXPECT_EQ(gap->observed, 15U);
+
+    EXPECT_FALSE(tracker.observe(slot, 13).has_value());
+    EXPECT_FALSE(tracker.observe(slot, 16).has_value());
+
+    auto const other = tracker.slot("t", "AAPL");
+    EXPECT_FALSE(tracker.observe(other, 1).has_value());
+}
+
+TEST(SequenceGapTrackerTest, KeepsTheLatestEventTimePerSlot) {
+    SequenceGapTracker tracker;
+    auto const slot = tracker.slot("t", "MSFT");
+    EXPECT_TRUE(tracker.last_time(slot).empty());
+
+    tracker.set_last_time(slot, "2024-05-01T12:00:01Z");
+    tracker.set_last_time(slot, "2024-05-01T12:00:02Z");
+    EXPECT_EQ(tracker.last_time(slot), "2024-05-01T12:00:02Z");
+    EXPECT_TRUE(tracker.last_time(tracker.slot("t", "AAPL")).empty());
+}
+
+} // namespace
+} // namespace alpaca::streaming
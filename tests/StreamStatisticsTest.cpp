@@ -0,0 +1,46 @@
+#include "alpaca/StreamStatistics.hpp"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+
+namespace alpaca::streaming {
+namespace {
+
+TEST(LatencyHistogramTest, BucketsCoverValuesWithBoundedRelativeError) {
+    for (std::uint64_t value : {0ULL, 1ULL, 15ULL, 16ULL, 17ULL, 1000ULL, 123456789ULL, ~0ULL}) {
+        auto const index = LatencyHistogram::bucket_index(value);
+        ASSERT_LT(index, LatencyHistogram::kBucketCount);
+        auto const lower = LatencyHistogram::bucket_lower_bound(index);
+        EXPECT_LE(lower, value);
+        EXPECT_LE(value - lower, lower / LatencyHistogram::kSubBuckets + 1);
+    }
+    EXPECT_LT(LatencyHistogram::bucket_index(31), LatencyHistogram::bucket_index(32));
+}
+
+TEST(LatencyHistogramTest, ReportsPercentilesAndResetsOnTake) {
+    LatencyHistogram histogram;
+    for (std::uint64_t value = 1; value <= 1000; ++value) {
+        histogram.record(std::chrono::microseconds{value});
+    }
+
+    auto const snapshot = histogram.snapshot();
+    EXPECT_EQ(snapshot.count, 1000U);
+    EXPECT_EQ(snapshot.min_ns, 1000U);
+    EXPECT_EQ(snapshot.max_ns, 1'000'000U);
+    EXPECT_NEAR(static_cast<double>(snapshot.mean().count()), 500'500.0, 1.0);
+    EXPECT_NEAR(static_cast<double>(snapshot.percentile(0.5).count()), 500'000.0, 500'000.0 / 16);
+    EXPECT_NEAR(static_cast<double>(snapshot.percentile(0.99).count()), 990'000.0, 990'000.0 / 16);
+    EXPECT_EQ(snapshot.percentile(1.0).count(), 1'000'000 - 1'000'000 % (1 << 15));
+
+    auto const taken = histogram.take();
+    EXPECT_EQ(taken.count, 1000U);
+    auto const empty = histogram.snapshot();
+    EXPECT_EQ(empty.count, 0U);
+    EXPECT_EQ(empty.min_ns, 0U);
+    EXPECT_EQ(empty.percentile(0.5).count(), 0);
+}
+
+} // namespace
+} // namespace alpaca::streaming
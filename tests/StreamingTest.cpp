@@ -6,10 +6,13 @@
 #include <atomic>
 #include <chrono>
 #include <cstddef>
+#include <functional>
 #include <future>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <string>
 #include <thread>
 #include <tuple>
 #include <utility>
@@ -17,9 +20,12 @@
 
 #include "FakeHttpClient.hpp"
 #include "alpaca/BackfillCoordinator.hpp"
+#include "alpaca/Chrono.hpp"
 #include "alpaca/Configuration.hpp"
+#include "alpaca/Exceptions.hpp"
 #include "alpaca/Json.hpp"
 #include "alpaca/MarketDataClient.hpp"
+#include "alpaca/SymbolFilter.hpp"
 #include "alpaca/models/Common.hpp"
 
 namespace alpaca::streaming {
@@ -30,6 +36,21 @@ class WebSocketClientHarness {
         client.handle_payload(payload);
     }
 
+    static void enqueue(WebSocketClient& client, Json const& payload) {
+        client.enqueue_incoming_message(payload, alpaca::fast_utc_now());
+    }
+
+    static void receive_frame(WebSocketClient& client, std::string const& frame,
+                              std::optional<std::size_t> wire_size = std::nullopt) {
+        client.handle_frame(frame, wire_size.value_or(frame.size()));
+    }
+
+    /// Queues a frame the way `send_text` does once it has seen the connection open.
+    static void push_outbound(WebSocketClient& client, std::string frame) {
+        client.outbound_.push(std::move(frame));
+        client.drain_outbound();
+    }
+
     static std::size_t pending_message_count(WebSocketClient const& client) {
         std::lock_guard<std::mutex> lock(client.connection_mutex_);
         return client.pending_messages_.size();
@@ -37,7 +58,11 @@ class WebSocketClientHarness {
 
     static std::vector<Json> pending_messages(WebSocketClient const& client) {
         std::lock_guard<std::mutex> lock(client.connection_mutex_);
-        return client.pending_messages_;
+        std::vector<Json> messages;
+        for (auto const& frame : client.pending_messages_) {
+            messages.push_back(Json::parse(frame));
+        }
+        return messages;
     }
 
     static void set_test_hooks(WebSocketClient& client, WebSocketClientTestHooks hooks) {
@@ -71,14 +96,14 @@ class WebSocketClientHarness {
         client.authenticate();
         client.replay_subscriptions();
 
-        std::vector<Json> pending;
+        std::vector<std::string> pending;
         {
             std::lock_guard<std::mutex> lock(client.connection_mutex_);
             pending.swap(client.pending_messages_);
         }
-        for (auto const& payload : pending) {
+        for (auto const& frame : pending) {
             set_connected(client, true);
-            client.send_raw(payload);
+            client.send_text(frame);
         }
 
         if (client.open_handler_) {
@@ -142,6 +167,15 @@ class WebSocketClientHarness {
         client.handle_control_payload(payload, type);
     }
 
+    static void post_task(WebSocketClient& client, std::function<void()> task) {
+        client.post_dispatcher_task(std::move(task));
+    }
+
+    static bool dispatcher_running(WebSocketClient& client) {
+        std::lock_guard<std::mutex> lock(client.dispatcher_mutex_);
+        return client.dispatcher_running_;
+    }
+
     static void trigger_heartbeat_timeout(WebSocketClient& client) {
         client.handle_heartbeat_timeout();
     }
@@ -160,6 +194,7 @@ using alpaca::streaming::StreamMessage;
 using alpaca::streaming::WebSocketClient;
 using alpaca::streaming::WebSocketClientHarness;
 using alpaca::streaming::WebSocketClientTestHooks;
+using Scheduling = alpaca::streaming::BackfillCoordinator::Scheduling;
 
 alpaca::HttpResponse MakeHttpResponse(std::string body) {
     return alpaca::HttpResponse{200, std::move(body), {}};
@@ -351,6 +386,46 @@ TEST(StreamingTest, AsyncSubscribeQueuesMessageWhileDisconnected) {
     EXPECT_EQ(WebSocketClientHarness::pending_message_count(client), 0U);
 }
 
+TEST(StreamingTest, CoalescesSubscriptionChangesWithinTheBatchingWindow) {
+    auto client = make_client();
+
+    std::mutex sent_mutex;
+    std::vector<Json> sent_messages;
+    WebSocketClientTestHooks hooks{};
+    hooks.on_send_raw = [&sent_mutex, &sent_messages](Json const& message) {
+        std::lock_guard<std::mutex> lock(sent_mutex);
+        sent_messages.push_back(message);
+    };
+    WebSocketClientHarness::set_test_hooks(client, std::move(hooks));
+    WebSocketClientHarness::set_connected(client, true);
+
+    alpaca::streaming::SubscriptionBatching batching;
+    batching.coalesce_window = std::chrono::hours{1};
+    client.set_subscription_batching(batching);
+
+    for (auto const* symbol : {"AAPL", "MSFT", "TSLA"}) {
+        MarketSubscription subscription;
+        subscription.trades.push_back(symbol);
+        client.subscribe(subscription);
+    }
+    MarketSubscription removal;
+    removal.trades.push_back("TSLA");
+    client.unsubscribe(removal);
+
+    {
+        std::lock_guard<std::mutex> lock(sent_mutex);
+        EXPECT_TRUE(sent_messages.empty());
+    }
+
+    client.flush_subscriptions();
+
+    std::lock_guard<std::mutex> lock(sent_mutex);
+    ASSERT_EQ(sent_messages.size(), 1U);
+    EXPECT_EQ(sent_messages.front().at("action"), "subscribe");
+    EXPECT_EQ(sent_messages.front().at("trades"), Json::array({"AAPL", "MSFT"}));
+    EXPECT_EQ(client.subscriptions().trades, std::vector<std::string>({"AAPL", "MSFT"}));
+}
+
 TEST(StreamingTest, AsyncSendRawBuffersMessageUntilConnected) {
     auto client = make_client();
 
@@ -362,6 +437,41 @@ TEST(StreamingTest, AsyncSendRawBuffersMessageUntilConnected) {
     EXPECT_EQ(WebSocketClientHarness::pending_message_count(client), 1U);
 }
 
+TEST(StreamingTest, SendTextBuffersSerialisedFramesUntilConnected) {
+    auto client = make_client();
+    client.set_pending_message_limit(1);
+
+    client.send_text(R"({"action":"noop"})");
+    EXPECT_THROW(client.send_text(R"({"action":"second"})"), alpaca::WebSocketQueueLimitException);
+
+    auto const pending = WebSocketClientHarness::pending_messages(client);
+    ASSERT_EQ(pending.size(), 1U);
+    EXPECT_EQ(pending.front().at("action"), "noop");
+}
+
+TEST(StreamingTest, SendTextKeepsFramesQueuedAcrossACloseForTheNextConnection) {
+    auto client = make_client();
+    std::vector<Json> sent;
+    WebSocketClientTestHooks hooks{};
+    hooks.on_send_raw = [&sent](Json const& message) {
+        sent.push_back(message);
+    };
+    WebSocketClientHarness::set_test_hooks(client, std::move(hooks));
+
+    // The sender saw the connection open, but it closed before the frame was written.
+    WebSocketClientHarness::set_connected(client, false);
+    WebSocketClientHarness::push_outbound(client, R"({"action":"late"})");
+    auto const pending = WebSocketClientHarness::pending_messages(client);
+    ASSERT_EQ(pending.size(), 1U);
+    EXPECT_EQ(pending.front().at("action"), "late");
+
+    WebSocketClientHarness::simulate_open(client);
+    EXPECT_EQ(WebSocketClientHarness::pending_message_count(client), 0U);
+    EXPECT_TRUE(std::any_of(sent.begin(), sent.end(), [](Json const& message) {
+        return message.value("action", "") == "late";
+    }));
+}
+
 TEST(StreamingTest, RoutesNewsMessages) {
     auto client = make_client();
     std::optional<MessageCategory> category;
@@ -611,6 +721,373 @@ TEST(StreamingTest, ReportsLatencyWhenThresholdExceeded) {
     EXPECT_GT(latency_events.front().second, std::chrono::milliseconds{10});
 }
 
+TEST(StreamingTest, LatencyMonitorFallsBackToDecodedMessageTimestamp) {
+    auto client = make_client();
+    client.set_message_handler([](StreamMessage const&, MessageCategory) {
+    });
+
+    std::vector<std::chrono::nanoseconds> latencies;
+    alpaca::streaming::LatencyMonitor monitor{};
+    monitor.max_latency = std::chrono::milliseconds{10};
+    monitor.latency_handler = [&latencies](std::string const&, std::chrono::nanoseconds latency, alpaca::Json const&) {
+        latencies.push_back(latency);
+    };
+    client.set_latency_monitor(std::move(monitor));
+
+    auto const now = std::chrono::time_point_cast<alpaca::Timestamp::duration>(std::chrono::system_clock::now());
+    for (auto const& event_time : {now - std::chrono::seconds(2), now + std::chrono::seconds(2)}) {
+        WebSocketClientHarness::feed(client, alpaca::Json{
+                                                 {"T", "q"                                 },
+                                                 {"S", "MSFT"                              },
+                                                 {"bp", 349.5                              },
+                                                 {"ap", 350.5                              },
+                                                 {"t", alpaca::format_timestamp(event_time)}
+        });
+    }
+
+    ASSERT_EQ(latencies.size(), 1U);
+    EXPECT_GT(latencies.front(), std::chrono::seconds{1});
+
+    client.clear_latency_monitor();
+    WebSocketClientHarness::feed(client, alpaca::Json{
+                                             {"T", "q"                                                     },
+                                             {"S", "MSFT"                                                  },
+                                             {"t", alpaca::format_timestamp(now - std::chrono::seconds(5))}
+    });
+    EXPECT_EQ(latencies.size(), 1U);
+}
+
+TEST(StreamingTest, RecordsStatisticsForDispatchedMessages) {
+    auto client = make_client();
+    client.set_message_handler([](StreamMessage const&, MessageCategory) {
+    });
+
+    auto event_time = std::chrono::time_point_cast<alpaca::Timestamp::duration>(std::chrono::system_clock::now() -
+                                                                                std::chrono::seconds(2));
+    alpaca::Json payload{
+        {"T", "t"                                 },
+        {"S", "MSFT"                              },
+        {"i", "10"                                },
+        {"p", 350.0                               },
+        {"s", 5                                   },
+        {"x", "XNAS"                              },
+        {"t", alpaca::format_timestamp(event_time)}
+    };
+    WebSocketClientHarness::feed(client, payload);
+    WebSocketClientHarness::feed(client, alpaca::Json{
+                                             {"T", "success"      },
+                                             {"msg", "authenticated"}
+    });
+
+    auto const stats = client.stats();
+    EXPECT_EQ(stats.messages, 2U);
+    EXPECT_EQ(stats.handler_duration.count, 2U);
+    ASSERT_EQ(stats.exchange_to_receive.count, 1U);
+    EXPECT_GE(stats.exchange_to_receive.percentile(0.5), std::chrono::seconds{1});
+
+    auto const interval = client.reset_stats();
+    EXPECT_EQ(interval.messages, 2U);
+    auto const after_reset = client.stats();
+    EXPECT_EQ(after_reset.messages, 0U);
+    EXPECT_EQ(after_reset.handler_duration.count, 0U);
+    EXPECT_EQ(after_reset.exchange_to_receive.count, 0U);
+}
+
+TEST(StreamingTest, BusyPollDispatcherDeliversQueuedPayloadsInOrder) {
+    auto client = make_client();
+    alpaca::streaming::DispatcherOptions options;
+    options.wait_strategy = alpaca::streaming::DispatchWaitStrategy::BusyPoll;
+    client.set_dispatcher_options(options);
+
+    std::mutex mutex;
+    std::vector<std::string> received;
+    std::promise<void> done;
+    client.set_message_handler([&](StreamMessage const& message, MessageCategory) {
+        std::lock_guard<std::mutex> lock(mutex);
+        received.push_back(std::get<alpaca::streaming::TradeMessage>(message).id);
+        if (received.size() == 3) {
+            done.set_value();
+        }
+    });
+
+    for (int i = 0; i < 3; ++i) {
+        WebSocketClientHarness::enqueue(client, alpaca::Json{
+                                                    {"T", "t"             },
+                                                    {"S", "AAPL"          },
+                                                    {"i", std::to_string(i)},
+                                                    {"p", 190.0           },
+                                                    {"s", 1               }
+        });
+    }
+    ASSERT_EQ(done.get_future().wait_for(std::chrono::seconds{5}), std::future_status::ready);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        EXPECT_EQ(received, (std::vector<std::string>{"0", "1", "2"}));
+    }
+    auto const stats = client.stats();
+    EXPECT_EQ(stats.receive_to_dispatch.count, 3U);
+    EXPECT_GT(stats.dispatcher_work_ns, 0U);
+
+    options.realtime_priority = 0;
+    EXPECT_THROW(client.set_dispatcher_options(options), alpaca::InvalidArgumentException);
+}
+
+TEST(StreamingTest, InlineDispatchRunsHandlersOnTheReceivingThread) {
+    auto client = make_client();
+    alpaca::streaming::DispatcherOptions options;
+    options.inline_dispatch = true;
+    options.slow_handler_threshold = std::chrono::microseconds{500};
+    client.set_dispatcher_options(options);
+
+    std::vector<std::thread::id> handler_threads;
+    client.set_message_handler([&](StreamMessage const& message, MessageCategory) {
+        handler_threads.push_back(std::this_thread::get_id());
+        if (std::get<alpaca::streaming::TradeMessage>(message).id == "slow") {
+            std::this_thread::sleep_for(std::chrono::milliseconds{2});
+        }
+    });
+
+    for (auto const* id : {"fast", "slow"}) {
+        WebSocketClientHarness::enqueue(client, alpaca::Json{
+                                                    {"T", "t"   },
+                                                    {"S", "AAPL"},
+                                                    {"i", id    },
+                                                    {"p", 190.0 },
+                                                    {"s", 1     }
+        });
+    }
+
+    EXPECT_EQ(handler_threads,
+              (std::vector<std::thread::id>{std::this_thread::get_id(), std::this_thread::get_id()}));
+    auto const stats = client.stats();
+    EXPECT_EQ(stats.messages, 2U);
+    EXPECT_EQ(stats.receive_to_dispatch.count, 0U);
+    EXPECT_EQ(stats.slow_handlers, 1U);
+    EXPECT_GT(stats.dispatcher_work_ns, 0U);
+}
+
+TEST(StreamingTest, SwitchingToInlineDispatchHandlesWhatTheDispatcherLeftBehind) {
+    auto client = make_client();
+    std::vector<std::string> handled;
+    client.set_message_handler([&](StreamMessage const& message, MessageCategory) {
+        handled.push_back(std::get<alpaca::streaming::TradeMessage>(message).id);
+    });
+
+    std::promise<void> blocking;
+    auto blocked = blocking.get_future();
+    WebSocketClientHarness::post_task(client, [&]() {
+        blocking.set_value();
+        // Keep the dispatcher busy until the switch has asked it to stop.
+        while (WebSocketClientHarness::dispatcher_running(client)) {
+            std::this_thread::yield();
+        }
+    });
+    bool task_ran = false;
+    WebSocketClientHarness::post_task(client, [&]() {
+        task_ran = true;
+    });
+    WebSocketClientHarness::enqueue(client, alpaca::Json{
+                                                {"T", "t"     },
+                                                {"S", "AAPL"  },
+                                                {"i", "queued"},
+                                                {"p", 190.0   },
+                                                {"s", 1       }
+    });
+    blocked.wait();
+
+    alpaca::streaming::DispatcherOptions options;
+    options.inline_dispatch = true;
+    client.set_dispatcher_options(options);
+
+    EXPECT_TRUE(task_ran);
+    EXPECT_EQ(handled, (std::vector<std::string>{"queued"}));
+}
+
+TEST(StreamingTest, WorkerPoolDispatchKeepsPerSymbolOrder) {
+    std::mutex mutex;
+    std::map<std::string, std::vector<std::string>> received;
+    std::atomic<int> handled{0};
+
+    auto client = make_client();
+    alpaca::streaming::DispatcherOptions options;
+    options.worker_threads = 3;
+    client.set_dispatcher_options(options);
+    client.set_message_handler([&](StreamMessage const& message, MessageCategory) {
+        auto const& quote = std::get<alpaca::streaming::QuoteMessage>(message);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            received[quote.symbol].push_back(quote.conditions.front());
+        }
+        handled.fetch_add(1);
+    });
+
+    for (int i = 0; i < 50; ++i) {
+        for (auto const* symbol : {"AAPL", "MSFT", "SPY"}) {
+            WebSocketClientHarness::enqueue(client, alpaca::Json{
+                                                        {"T", "q"                                     },
+                                                        {"S", symbol                                  },
+                                                        {"bp", 100.0                                  },
+                                                        {"ap", 100.1                                  },
+                                                        {"c", alpaca::Json::array({std::to_string(i)})}
+            });
+        }
+    }
+    auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    while (handled.load() < 150 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(received.size(), 3U);
+    for (auto const& [symbol, order] : received) {
+        ASSERT_EQ(order.size(), 50U) << symbol;
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            EXPECT_EQ(order[i], std::to_string(i)) << symbol;
+        }
+    }
+}
+
+TEST(StreamingTest, ConflatesQuotesAndBookSnapshotsWhileTheHandlerIsBehind) {
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    std::mutex mutex;
+    std::vector<std::string> delivered;
+    std::atomic<int> handled{0};
+
+    auto client = make_client();
+    client.set_conflation_policy({});
+    client.set_message_handler([&](StreamMessage const& message, MessageCategory) {
+        std::string label;
+        if (auto const* trade = std::get_if<alpaca::streaming::TradeMessage>(&message)) {
+            label = "trade:" + trade->id;
+            if (trade->id == "0") {
+                released.wait();
+            }
+        } else if (auto const* quote = std::get_if<alpaca::streaming::QuoteMessage>(&message)) {
+            label = "quote:" + quote->symbol + ":" + quote->conditions.front();
+        } else if (auto const* book = std::get_if<alpaca::streaming::OrderBookMessage>(&message)) {
+            label = "book:" + book->tape.value_or("");
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            delivered.push_back(label);
+        }
+        handled.fetch_add(1);
+    });
+
+    auto trade = [](char const* id) {
+        return alpaca::Json{
+            {"T", "t"   },
+            {"S", "AAPL"},
+            {"i", id    },
+            {"p", 190.0 },
+            {"s", 1     }
+        };
+    };
+    auto quote = [](char const* symbol, char const* tag) {
+        return alpaca::Json{
+            {"T", "q"                        },
+            {"S", symbol                     },
+            {"bp", 190.0                     },
+            {"ap", 190.1                     },
+            {"c", alpaca::Json::array({tag})}
+        };
+    };
+    auto book = [](char const* tag, bool snapshot) {
+        return alpaca::Json{
+            {"T", "o"       },
+            {"S", "BTC/USD" },
+            {"z", tag       },
+            {"r", snapshot  },
+            {"b", alpaca::Json::array()},
+            {"a", alpaca::Json::array()}
+        };
+    };
+
+    WebSocketClientHarness::enqueue(client, trade("0"));
+    for (auto const* tag : {"1", "2", "3"}) {
+        WebSocketClientHarness::enqueue(client, quote("AAPL", tag));
+    }
+    WebSocketClientHarness::enqueue(client, trade("1"));
+    WebSocketClientHarness::enqueue(client, quote("MSFT", "1"));
+    WebSocketClientHarness::enqueue(client, quote("AAPL", "4"));
+    WebSocketClientHarness::enqueue(client, book("s1", true));
+    WebSocketClientHarness::enqueue(client, book("i1", false));
+    WebSocketClientHarness::enqueue(client, book("s2", true));
+    WebSocketClientHarness::enqueue(client, book("s3", true));
+    release.set_value();
+
+    auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    while (handled.load() < 7 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_EQ(delivered, (std::vector<std::string>{"trade:0", "quote:AAPL:4", "trade:1", "quote:MSFT:1", "book:s1",
+                                                   "book:i1", "book:s3"}));
+    EXPECT_EQ(client.stats().conflated_messages, 4U);
+}
+
+TEST(StreamingTest, SymbolFilterSkipsPayloadsBeforeDecoding) {
+    auto client = make_client();
+    alpaca::streaming::DispatcherOptions options;
+    options.inline_dispatch = true;
+    client.set_dispatcher_options(options);
+
+    std::vector<std::string> delivered;
+    client.set_message_handler([&delivered](StreamMessage const& message, MessageCategory) {
+        if (auto const* bar = std::get_if<alpaca::streaming::BarMessage>(&message)) {
+            delivered.push_back(bar->symbol);
+        } else if (std::holds_alternative<alpaca::streaming::ControlMessage>(message)) {
+            delivered.push_back("control");
+        }
+    });
+
+    auto filter = std::make_shared<alpaca::streaming::SymbolFilter>();
+    filter->allow({"AAPL"});
+    client.set_symbol_filter(filter);
+
+    auto const frame = std::string{R"([{"T":"b","S":"AAPL","o":1,"h":1,"l":1,"c":1,"v":1},)"} +
+                       R"({"T":"b","S":"TSLA","o":1,"h":1,"l":1,"c":1,"v":1},{"T":"success","msg":"authenticated"}])";
+    WebSocketClientHarness::receive_frame(client, frame);
+    EXPECT_EQ(delivered, (std::vector<std::string>{"AAPL", "control"}));
+    EXPECT_EQ(client.stats().filtered_messages, 1U);
+
+    filter->assign({"TSLA"});
+    delivered.clear();
+    WebSocketClientHarness::receive_frame(client, frame);
+    EXPECT_EQ(delivered, (std::vector<std::string>{"TSLA", "control"}));
+
+    client.clear_symbol_filter();
+    delivered.clear();
+    WebSocketClientHarness::receive_frame(client, frame);
+    EXPECT_EQ(delivered, (std::vector<std::string>{"AAPL", "TSLA", "control"}));
+}
+
+TEST(StreamingTest, CountsWireAndPayloadBytesForCompression) {
+    auto client = make_client();
+    alpaca::streaming::CompressionOptions compression;
+    compression.enabled = true;
+    compression.client_max_window_bits = 7;
+    EXPECT_THROW(client.set_compression_options(compression), alpaca::InvalidArgumentException);
+    compression.client_max_window_bits = 10;
+    compression.server_no_context_takeover = true;
+    client.set_compression_options(compression);
+    EXPECT_FALSE(client.compression_negotiated());
+
+    std::string const frame = R"([{"T":"success","msg":"connected"}])";
+    WebSocketClientHarness::receive_frame(client, frame, 12);
+    WebSocketClientHarness::set_connected(client, true);
+    client.send_text(R"({"action":"noop"})");
+
+    auto const stats = client.stats();
+    EXPECT_EQ(stats.bytes, frame.size());
+    EXPECT_EQ(stats.wire_bytes_received, 12U);
+    EXPECT_EQ(stats.bytes_sent, std::string{R"({"action":"noop"})"}.size());
+    EXPECT_GT(stats.wire_bytes_sent, 0U);
+}
+
 TEST(StreamingTest, IssuesRestBackfillRequestWhenTradeSequenceGapDetected) {
     auto http = std::make_shared<FakeHttpClient>();
     http->push_response(MakeHttpResponse(R"({"trades":{"AAPL":[]}})"));
@@ -648,6 +1125,7 @@ TEST(StreamingTest, IssuesRestBackfillRequestWhenTradeSequenceGapDetected) {
     gap["i"] = "15";
     gap["t"] = "2024-05-01T12:00:05Z";
     WebSocketClientHarness::feed(client, gap);
+    coordinator->wait_for_idle();
 
     ASSERT_EQ(http->requests().size(), 1U);
     auto const& request = http->requests().front().request;
@@ -659,6 +1137,410 @@ TEST(StreamingTest, IssuesRestBackfillRequestWhenTradeSequenceGapDetected) {
     EXPECT_NE(request.url.find("sort=asc"), std::string::npos);
 }
 
+TEST(StreamingTest, BackfillCoordinatorCoalescesGapsAcrossSymbolsOffTheCallingThread) {
+    auto http = std::make_shared<FakeHttpClient>();
+    http->push_response(MakeHttpResponse(R"({"trades":{
+        "AAPL":[{"i":"13","x":"V","p":100.2,"s":5,"t":"2024-05-01T12:00:03Z"},
+                {"i":"12","x":"V","p":100.1,"s":5,"t":"2024-05-01T12:00:02Z"}],
+        "MSFT":[{"i":"7","x":"V","p":300.0,"s":1,"t":"2024-05-01T12:00:02Z"},
+                {"i":"8","x":"V","p":300.5,"s":1,"t":"2024-05-01T12:00:09Z"}]
+    }})"));
+
+    alpaca::Configuration config = alpaca::Configuration::Paper("key", "secret");
+    alpaca::MarketDataClient market(config, http);
+
+    alpaca::streaming::BackfillCoordinator::Options options;
+    options.coalesce_window = std::chrono::milliseconds{200};
+    auto coordinator = std::make_shared<alpaca::streaming::BackfillCoordinator>(
+    market, alpaca::streaming::StreamFeed::MarketData, options);
+
+    std::mutex replay_mutex;
+    std::map<std::string, std::vector<std::string>> replayed_ids;
+    std::thread::id replay_thread;
+    coordinator->set_trade_replay_handler(
+    [&](std::string const& symbol, std::vector<alpaca::StockTrade> const& trades) {
+        std::lock_guard<std::mutex> lock(replay_mutex);
+        replay_thread = std::this_thread::get_id();
+        for (auto const& trade : trades) {
+            replayed_ids[symbol].push_back(trade.id);
+        }
+    });
+
+    auto make_trade = [](std::string const& symbol, std::string const& id, std::string const& timestamp) {
+        return alpaca::Json{
+            {"T", "t"      },
+            {"S", symbol   },
+            {"i", id       },
+            {"t", timestamp}
+        };
+    };
+
+    coordinator->record_payload("t|AAPL", make_trade("AAPL", "11", "2024-05-01T12:00:01Z"));
+    coordinator->request_backfill("AAPL", 12, 13, make_trade("AAPL", "14", "2024-05-01T12:00:04Z"));
+    coordinator->record_payload("t|MSFT", make_trade("MSFT", "6", "2024-05-01T12:00:01Z"));
+    coordinator->request_backfill("MSFT", 7, 7, make_trade("MSFT", "8", "2024-05-01T12:00:03Z"));
+    coordinator->wait_for_idle();
+
+    ASSERT_EQ(http->requests().size(), 1U);
+    EXPECT_EQ(coordinator->issued_requests(), 1U);
+    auto const& url = http->requests().front().request.url;
+    EXPECT_TRUE(url.find("symbols=AAPL%2CMSFT") != std::string::npos ||
+                url.find("symbols=AAPL,MSFT") != std::string::npos);
+    EXPECT_NE(url.find("limit=3"), std::string::npos);
+    EXPECT_NE(url.find("start=2024-05-01T12%3A00%3A01Z"), std::string::npos);
+    EXPECT_NE(url.find("end=2024-05-01T12%3A00%3A04Z"), std::string::npos);
+
+    std::lock_guard<std::mutex> lock(replay_mutex);
+    EXPECT_NE(replay_thread, std::this_thread::get_id());
+    EXPECT_EQ(replayed_ids["AAPL"], (std::vector<std::string>{"12", "13"}));
+    EXPECT_EQ(replayed_ids["MSFT"], (std::vector<std::string>{"7"}));
+}
+
+TEST(StreamingTest, BackfillCoordinatorTellsTheObserverOnceWhenAReplayHandlerThrows) {
+    auto http = std::make_shared<FakeHttpClient>();
+    http->push_response(MakeHttpResponse(R"({"trades":{
+        "AAPL":[{"i":"12","x":"V","p":100.1,"s":5,"t":"2024-05-01T12:00:02Z"}],
+        "MSFT":[{"i":"7","x":"V","p":300.0,"s":1,"t":"2024-05-01T12:00:02Z"}]
+    }})"));
+
+    alpaca::Configuration config = alpaca::Configuration::Paper("key", "secret");
+    alpaca::MarketDataClient market(config, http);
+
+    alpaca::streaming::BackfillCoordinator::Options options;
+    options.coalesce_window = std::chrono::milliseconds{200};
+    auto coordinator = std::make_shared<alpaca::streaming::BackfillCoordinator>(
+    market, alpaca::streaming::StreamFeed::MarketData, options);
+
+    std::mutex observed_mutex;
+    std::vector<std::pair<std::string, bool>> observed;
+    std::atomic<int> errors{0};
+    coordinator->set_trade_replay_handler([](std::string const& symbol, std::vector<alpaca::StockTrade> const&) {
+        if (symbol == "MSFT") {
+            throw std::runtime_error("handler failed");
+        }
+    });
+    coordinator->set_trade_replay_observer(
+    [&](std::string const& symbol, std::vector<alpaca::StockTrade> const&, bool succeeded) {
+        std::lock_guard<std::mutex> lock(observed_mutex);
+        observed.emplace_back(symbol, succeeded);
+    });
+    coordinator->set_error_handler([&errors](std::exception_ptr) {
+        errors.fetch_add(1);
+    });
+
+    auto make_trade = [](std::string const& symbol, std::string const& id, std::string const& timestamp) {
+        return alpaca::Json{
+            {"T", "t"      },
+            {"S", symbol   },
+            {"i", id       },
+            {"t", timestamp}
+        };
+    };
+    coordinator->record_payload("t|AAPL", make_trade("AAPL", "11", "2024-05-01T12:00:01Z"));
+    coordinator->request_backfill("AAPL", 12, 12, make_trade("AAPL", "13", "2024-05-01T12:00:03Z"));
+    coordinator->record_payload("t|MSFT", make_trade("MSFT", "6", "2024-05-01T12:00:01Z"));
+    coordinator->request_backfill("MSFT", 7, 7, make_trade("MSFT", "8", "2024-05-01T12:00:03Z"));
+    coordinator->wait_for_idle();
+
+    ASSERT_EQ(http->requests().size(), 1U);
+    EXPECT_EQ(errors.load(), 1);
+    std::lock_guard<std::mutex> lock(observed_mutex);
+    EXPECT_EQ(observed, (std::vector<std::pair<std::string, bool>>{
+                            {"AAPL", true },
+                            {"MSFT", false}
+    }));
+}
+
+TEST(StreamingTest, BackfillCoordinatorPagesUntilEverySymbolIsCoveredAndReportsEmptyReplays) {
+    // The busy symbol fills the first page of the combined window; the quiet one only appears on the second.
+    auto http = std::make_shared<FakeHttpClient>();
+    http->push_response(MakeHttpResponse(R"({"trades":{"AAPL":[
+        {"i":"1","x":"V","p":100.0,"s":5,"t":"2024-05-01T12:00:01Z"},
+        {"i":"2","x":"V","p":100.0,"s":5,"t":"2024-05-01T12:00:02Z"},
+        {"i":"3","x":"V","p":100.0,"s":5,"t":"2024-05-01T12:00:08Z"}
+    ]},"next_page_token":"page-2"})"));
+    http->push_response(MakeHttpResponse(R"({"trades":{
+        "MSFT":[{"i":"7","x":"V","p":300.0,"s":1,"t":"2024-05-01T12:00:06Z"}]
+    },"next_page_token":"page-3"})"));
+
+    alpaca::Configuration config = alpaca::Configuration::Paper("key", "secret");
+    alpaca::MarketDataClient market(config, http);
+    alpaca::streaming::BackfillCoordinator::Options options;
+    options.coalesce_window = std::chrono::milliseconds{200};
+    alpaca::streaming::BackfillCoordinator coordinator(market, alpaca::streaming::StreamFeed::MarketData, options);
+
+    std::mutex observed_mutex;
+    std::map<std::string, std::pair<std::size_t, bool>> observed;
+    coordinator.set_trade_replay_observer(
+    [&](std::string const& symbol, std::vector<alpaca::StockTrade> const& trades, bool succeeded) {
+        std::lock_guard<std::mutex> lock(observed_mutex);
+        observed[symbol] = {trades.size(), succeeded};
+    });
+    std::vector<std::string> errors;
+    coordinator.set_error_handler([&](std::exception_ptr error) {
+        std::lock_guard<std::mutex> lock(observed_mutex);
+        try {
+            std::rethrow_exception(error);
+        } catch (alpaca::StreamingException const& ex) {
+            EXPECT_EQ(ex.code(), alpaca::ErrorCode::BackfillIncomplete);
+            errors.emplace_back(ex.what());
+        }
+    });
+
+    auto make_trade = [](std::string const& symbol, std::string const& id, std::string const& timestamp) {
+        return alpaca::Json{
+            {"T", "t"      },
+            {"S", symbol   },
+            {"i", id       },
+            {"t", timestamp}
+        };
+    };
+    coordinator.record_payload("t|AAPL", make_trade("AAPL", "0", "2024-05-01T12:00:00Z"));
+    EXPECT_EQ(coordinator.request_backfill("AAPL", 1, 2, make_trade("AAPL", "3", "2024-05-01T12:00:03Z")),
+              Scheduling::Scheduled);
+    coordinator.record_payload("t|MSFT", make_trade("MSFT", "6", "2024-05-01T12:00:05Z"));
+    EXPECT_EQ(coordinator.request_backfill("MSFT", 7, 7, make_trade("MSFT", "8", "2024-05-01T12:00:07Z")),
+              Scheduling::Scheduled);
+    coordinator.wait_for_idle();
+    // The summed limit of 3 was used up by AAPL, but paging went on until MSFT's record arrived.
+    EXPECT_EQ(http->requests().size(), 2U);
+
+    http->push_response(MakeHttpResponse(R"({"trades":{},"next_page_token":null})"));
+    coordinator.record_payload("t|TSLA", make_trade("TSLA", "1", "2024-05-01T12:00:01Z"));
+    EXPECT_EQ(coordinator.request_backfill("TSLA", 2, 2, make_trade("TSLA", "3", "2024-05-01T12:00:03Z")),
+              Scheduling::Scheduled);
+    coordinator.wait_for_idle();
+
+    std::lock_guard<std::mutex> lock(observed_mutex);
+    EXPECT_EQ(observed["AAPL"], std::make_pair(std::size_t{2}, true));
+    EXPECT_EQ(observed["MSFT"], std::make_pair(std::size_t{1}, true));
+    EXPECT_EQ(observed["TSLA"], std::make_pair(std::size_t{0}, false));
+    ASSERT_EQ(errors.size(), 1U);
+    EXPECT_NE(errors.front().find("TSLA"), std::string::npos);
+}
+
+TEST(StreamingTest, BackfillCoordinatorReportsQueuedReplaysDroppedAtShutdown) {
+    auto http = std::make_shared<FakeHttpClient>();
+    alpaca::Configuration config = alpaca::Configuration::Paper("key", "secret");
+    alpaca::MarketDataClient market(config, http);
+
+    alpaca::streaming::BackfillCoordinator::Options options;
+    options.coalesce_window = std::chrono::seconds{30};
+    std::vector<std::pair<std::string, bool>> observed;
+    {
+        alpaca::streaming::BackfillCoordinator coordinator(market, alpaca::streaming::StreamFeed::MarketData, options);
+        coordinator.set_trade_replay_observer(
+        [&](std::string const& symbol, std::vector<alpaca::StockTrade> const&, bool succeeded) {
+            observed.emplace_back(symbol, succeeded);
+        });
+        alpaca::Json const trade{
+            {"T", "t"                   },
+            {"S", "AAPL"                },
+            {"i", "5"                   },
+            {"t", "2024-05-01T12:00:05Z"}
+        };
+        EXPECT_EQ(coordinator.request_backfill("AAPL", 2, 4, trade), Scheduling::Scheduled);
+    }
+    EXPECT_TRUE(http->requests().empty());
+    EXPECT_EQ(observed, (std::vector<std::pair<std::string, bool>>{{"AAPL", false}}));
+}
+
+TEST(StreamingTest, AutomaticBackfillMergesReplayedTradesIntoLiveStreamInOrder) {
+    auto http = std::make_shared<FakeHttpClient>();
+    http->push_response(MakeHttpResponse(R"({"trades":{"AAPL":[
+        {"i":"11","x":"V","p":100.1,"s":5,"t":"2024-05-01T12:00:01Z"},
+        {"i":"12","x":"V","p":100.2,"s":5,"t":"2024-05-01T12:00:02Z"},
+        {"i":"13","x":"V","p":100.3,"s":5,"t":"2024-05-01T12:00:03Z"},
+        {"i":"14","x":"V","p":100.4,"s":5,"t":"2024-05-01T12:00:04Z"},
+        {"i":"15","x":"V","p":100.5,"s":5,"t":"2024-05-01T12:00:05Z"}
+    ]}})"));
+
+    alpaca::Configuration config = alpaca::Configuration::Paper("key", "secret");
+    alpaca::MarketDataClient market(config, http);
+    auto coordinator =
+    std::make_shared<alpaca::streaming::BackfillCoordinator>(market, alpaca::streaming::StreamFeed::MarketData);
+
+    std::mutex delivered_mutex;
+    std::vector<std::string> delivered;
+    WebSocketClient client{"wss://example.com", "key", "secret"};
+    client.set_message_handler([&](StreamMessage const& message, MessageCategory category) {
+        if (category != MessageCategory::Trade) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(delivered_mutex);
+        delivered.push_back(std::get<alpaca::streaming::TradeMessage>(message).id);
+    });
+    client.enable_automatic_backfill(coordinator, alpaca::streaming::BackfillMergePolicy{.enabled = true});
+
+    auto make_trade = [](std::string const& id, std::string const& timestamp) {
+        return Json{
+            {"T", "t"      },
+            {"S", "AAPL"   },
+            {"i", id       },
+            {"t", timestamp},
+            {"p", 100.0    },
+            {"s", 10       },
+            {"x", "XNAS"   }
+        };
+    };
+
+    WebSocketClientHarness::feed(client, make_trade("10", "2024-05-01T12:00:00Z"));
+    WebSocketClientHarness::feed(client, make_trade("11", "2024-05-01T12:00:01Z"));
+    WebSocketClientHarness::feed(client, make_trade("15", "2024-05-01T12:00:05Z"));
+    WebSocketClientHarness::feed(client, make_trade("16", "2024-05-01T12:00:06Z"));
+    coordinator->wait_for_idle();
+    // The replay finishes on the dispatcher thread once the coordinator hands it over.
+    auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    while (client.backfill_merge_stats().merges_completed == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    WebSocketClientHarness::feed(client, make_trade("17", "2024-05-01T12:00:07Z"));
+
+    std::lock_guard<std::mutex> lock(delivered_mutex);
+    EXPECT_EQ(delivered, (std::vector<std::string>{"10", "11", "12", "13", "14", "15", "16", "17"}));
+    auto const stats = client.backfill_merge_stats();
+    EXPECT_EQ(stats.duplicates_dropped, 2U);
+    EXPECT_EQ(stats.merges_completed, 1U);
+}
+
+TEST(StreamingTest, AutomaticBackfillReleasesLiveTradesWhenGapsShareOneReplay) {
+    auto http = std::make_shared<FakeHttpClient>();
+    http->push_response(MakeHttpResponse(R"({"trades":{"AAPL":[
+        {"i":"11","x":"V","p":100.1,"s":5,"t":"2024-05-01T12:00:01Z"},
+        {"i":"12","x":"V","p":100.2,"s":5,"t":"2024-05-01T12:00:02Z"},
+        {"i":"13","x":"V","p":100.3,"s":5,"t":"2024-05-01T12:00:03Z"},
+        {"i":"15","x":"V","p":100.5,"s":5,"t":"2024-05-01T12:00:05Z"},
+        {"i":"16","x":"V","p":100.6,"s":5,"t":"2024-05-01T12:00:06Z"},
+        {"i":"17","x":"V","p":100.7,"s":5,"t":"2024-05-01T12:00:07Z"}
+    ]}})"));
+
+    alpaca::Configuration config = alpaca::Configuration::Paper("key", "secret");
+    alpaca::MarketDataClient market(config, http);
+    alpaca::streaming::BackfillCoordinator::Options options;
+    // Long enough for the second gap to reach the coordinator before the worker takes the first one.
+    options.coalesce_window = std::chrono::milliseconds{300};
+    auto coordinator = std::make_shared<alpaca::streaming::BackfillCoordinator>(
+    market, alpaca::streaming::StreamFeed::MarketData, options);
+
+    std::mutex delivered_mutex;
+    std::vector<std::string> delivered;
+    WebSocketClient client{"wss://example.com", "key", "secret"};
+    client.set_message_handler([&](StreamMessage const& message, MessageCategory category) {
+        if (category != MessageCategory::Trade) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(delivered_mutex);
+        delivered.push_back(std::get<alpaca::streaming::TradeMessage>(message).id);
+    });
+    client.enable_automatic_backfill(coordinator, alpaca::streaming::BackfillMergePolicy{.enabled = true});
+
+    auto make_trade = [](std::string const& id, std::string const& timestamp) {
+        return Json{
+            {"T", "t"      },
+            {"S", "AAPL"   },
+            {"i", id       },
+            {"t", timestamp},
+            {"p", 100.0    },
+            {"s", 10       },
+            {"x", "XNAS"   }
+        };
+    };
+
+    WebSocketClientHarness::feed(client, make_trade("10", "2024-05-01T12:00:00Z"));
+    WebSocketClientHarness::feed(client, make_trade("11", "2024-05-01T12:00:01Z"));
+    WebSocketClientHarness::feed(client, make_trade("14", "2024-05-01T12:00:04Z"));
+    WebSocketClientHarness::feed(client, make_trade("15", "2024-05-01T12:00:05Z"));
+    WebSocketClientHarness::feed(client, make_trade("18", "2024-05-01T12:00:08Z"));
+    coordinator->wait_for_idle();
+    EXPECT_EQ(http->requests().size(), 1U);
+    // The replay finishes on the dispatcher thread once the coordinator hands it over.
+    auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    while (client.backfill_merge_stats().merges_completed == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    WebSocketClientHarness::feed(client, make_trade("19", "2024-05-01T12:00:09Z"));
+
+    std::lock_guard<std::mutex> lock(delivered_mutex);
+    EXPECT_EQ(delivered, (std::vector<std::string>{"10", "11", "12", "13", "14", "15", "16", "17", "18", "19"}));
+    auto const stats = client.backfill_merge_stats();
+    EXPECT_EQ(stats.merges_completed, 1U);
+    EXPECT_EQ(stats.merges_abandoned, 0U);
+}
+
+TEST(StreamingTest, SwitchingDispatchModesDuringASynchronousReplayKeepsItsTrades) {
+    /// Holds the replay request until the test lets it through.
+    class GatedHttpClient : public FakeHttpClient {
+      public:
+        std::promise<void> entered;
+        std::promise<void> release;
+
+        alpaca::HttpResponse send(alpaca::HttpRequest const& request) override {
+            entered.set_value();
+            release.get_future().wait();
+            return FakeHttpClient::send(request);
+        }
+    };
+    auto http = std::make_shared<GatedHttpClient>();
+    http->push_response(MakeHttpResponse(R"({"trades":{"AAPL":[
+        {"i":"11","x":"V","p":100.1,"s":5,"t":"2024-05-01T12:00:01Z"},
+        {"i":"12","x":"V","p":100.2,"s":5,"t":"2024-05-01T12:00:02Z"},
+        {"i":"13","x":"V","p":100.3,"s":5,"t":"2024-05-01T12:00:03Z"}
+    ]}})"));
+    auto entered = http->entered.get_future();
+
+    alpaca::Configuration config = alpaca::Configuration::Paper("key", "secret");
+    alpaca::MarketDataClient market(config, http);
+    alpaca::streaming::BackfillCoordinator::Options coordinator_options;
+    // The replay runs on the dispatcher, inside the handler of the trade that exposed the gap.
+    coordinator_options.worker_threads = 0;
+    auto coordinator = std::make_shared<alpaca::streaming::BackfillCoordinator>(
+    market, alpaca::streaming::StreamFeed::MarketData, coordinator_options);
+
+    std::mutex delivered_mutex;
+    std::vector<std::string> delivered;
+    WebSocketClient client{"wss://example.com", "key", "secret"};
+    client.set_message_handler([&](StreamMessage const& message, MessageCategory category) {
+        if (category != MessageCategory::Trade) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(delivered_mutex);
+        delivered.push_back(std::get<alpaca::streaming::TradeMessage>(message).id);
+    });
+    client.enable_automatic_backfill(coordinator, alpaca::streaming::BackfillMergePolicy{.enabled = true});
+
+    auto make_trade = [](std::string const& id, std::string const& timestamp) {
+        return Json{
+            {"T", "t"      },
+            {"S", "AAPL"   },
+            {"i", id       },
+            {"t", timestamp},
+            {"p", 100.0    },
+            {"s", 10       },
+            {"x", "XNAS"   }
+        };
+    };
+    WebSocketClientHarness::enqueue(client, make_trade("10", "2024-05-01T12:00:00Z"));
+    WebSocketClientHarness::enqueue(client, make_trade("14", "2024-05-01T12:00:04Z"));
+    entered.wait();
+
+    std::thread switcher([&client]() {
+        alpaca::streaming::DispatcherOptions options;
+        options.inline_dispatch = true;
+        client.set_dispatcher_options(options);
+    });
+    // Let the replay finish only once the switch is waiting for the dispatcher to stop.
+    while (WebSocketClientHarness::dispatcher_running(client)) {
+        std::this_thread::yield();
+    }
+    http->release.set_value();
+    switcher.join();
+    WebSocketClientHarness::enqueue(client, make_trade("15", "2024-05-01T12:00:05Z"));
+
+    std::lock_guard<std::mutex> lock(delivered_mutex);
+    EXPECT_EQ(delivered, (std::vector<std::string>{"10", "11", "12", "13", "14", "15"}));
+    EXPECT_EQ(client.backfill_merge_stats().merges_completed, 1U);
+}
+
 TEST(StreamingTest, CloseEventSchedulesReconnectAndReplaysSubscriptions) {
     auto client = make_client();
 
@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "alpaca/Configuration.hpp"
+#include "alpaca/Exceptions.hpp"
+#include "alpaca/HttpClient.hpp"
+#include "alpaca/Json.hpp"
+#include "alpaca/TradingClient.hpp"
+
+namespace {
+
+/// Answers order submissions from several threads at once, echoing the client order id, and records how many
+/// requests overlapped.
+class ConcurrentOrderHttpClient : public alpaca::HttpClient {
+  public:
+    alpaca::HttpResponse send(alpaca::HttpRequest const& request) override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++in_flight_;
+            max_in_flight_ = std::max(max_in_flight_, in_flight_);
+            ++requests_;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+
+        auto const client_order_id = alpaca::Json::parse(request.body).at("client_order_id").get<std::string>();
+        alpaca::HttpResponse response;
+        if (client_order_id == "reject-me") {
+            response.status_code = 403;
+            response.body = R"({"code": 40310000, "message": "insufficient buying power"})";
+        } else {
+            response.status_code = 200;
+            response.body = alpaca::Json{
+                {"id",              "order-" + client_order_id},
+                {"client_order_id", client_order_id           },
+                {"created_at",      "2024-01-02T15:00:00Z"    },
+                {"symbol",          "AAPL"                    },
+                {"side",            "buy"                     },
+                {"type",            "market"                  },
+                {"time_in_force",   "day"                     },
+                {"status",          "accepted"                }
+            }.dump();
+        }
+        response.headers = headers_;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        --in_flight_;
+        return response;
+    }
+
+    void set_headers(alpaca::HttpHeaders headers) {
+        headers_ = std::move(headers);
+    }
+
+    [[nodiscard]] int max_in_flight() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return max_in_flight_;
+    }
+
+    [[nodiscard]] int requests() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return requests_;
+    }
+
+  private:
+    mutable std::mutex mutex_;
+    int in_flight_{0};
+    int max_in_flight_{0};
+    int requests_{0};
+    alpaca::HttpHeaders headers_{};
+};
+
+std::vector<alpaca::NewOrderRequest> make_basket(std::size_t size) {
+    std::vector<alpaca::NewOrderRequest> basket(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        basket[i].symbol = "AAPL";
+        basket[i].side = alpaca::OrderSide::BUY;
+        basket[i].type = alpaca::OrderType::MARKET;
+        basket[i].time_in_force = alpaca::TimeInForce::DAY;
+        basket[i].quantity = "1";
+        basket[i].client_order_id = "basket-" + std::to_string(i);
+    }
+    return basket;
+}
+
+TEST(SubmitOrdersTest, KeepsTheWindowOfRequestsInFlight) {
+    auto http = std::make_shared<ConcurrentOrderHttpClient>();
+    alpaca::TradingClient client(alpaca::Configuration::Paper("key", "secret"), http);
+    auto const basket = make_basket(24);
+
+    alpaca::SubmitOrdersOptions options;
+    options.max_in_flight = 4;
+    std::set<std::size_t> completed;
+    options.on_result = [&completed](alpaca::BasketOrderResult const& result) { completed.insert(result.index); };
+
+    auto const response = client.submit_orders(basket, options);
+
+    EXPECT_EQ(http->requests(), 24);
+    EXPECT_LE(http->max_in_flight(), 4);
+    EXPECT_GT(http->max_in_flight(), 1);
+    EXPECT_EQ(completed.size(), 24U);
+    EXPECT_EQ(response.succeeded, 24U);
+    EXPECT_EQ(response.failed, 0U);
+    ASSERT_EQ(response.results.size(), 24U);
+    for (std::size_t i = 0; i < response.results.size(); ++i) {
+        EXPECT_EQ(response.results[i].index, i);
+        ASSERT_TRUE(response.results[i].order.has_value());
+        EXPECT_EQ(response.results[i].order->client_order_id, "basket-" + std::to_string(i));
+        EXPECT_GT(response.results[i].latency.count(), 0);
+    }
+    EXPECT_GE(response.elapsed, response.results[0].latency);
+}
+
+TEST(SubmitOrdersTest, ReportsFailuresWithoutStoppingTheBasket) {
+    auto http = std::make_shared<ConcurrentOrderHttpClient>();
+    alpaca::TradingClient client(alpaca::Configuration::Paper("key", "secret"), http);
+    auto basket = make_basket(6);
+    basket[2].client_order_id = "reject-me";
+
+    auto const response = client.submit_orders(basket);
+
+    EXPECT_EQ(response.succeeded, 5U);
+    EXPECT_EQ(response.failed, 1U);
+    auto const& failed = response.results[2];
+    EXPECT_FALSE(failed.order.has_value());
+    EXPECT_FALSE(failed.error_message.empty());
+    EXPECT_THROW(std::rethrow_exception(failed.error), alpaca::Exception);
+    EXPECT_TRUE(response.results[5].order.has_value());
+    EXPECT_TRUE(client.submit_orders({}).results.empty());
+}
+
+TEST(SubmitOrdersTest, StopsSendingWhenTheResultCallbackThrows) {
+    auto http = std::make_shared<ConcurrentOrderHttpClient>();
+    alpaca::TradingClient client(alpaca::Configuration::Paper("key", "secret"), http);
+    auto const basket = make_basket(5);
+
+    alpaca::SubmitOrdersOptions options;
+    options.max_in_flight = 1;
+    options.on_result = [](alpaca::BasketOrderResult const&) { throw std::runtime_error("position limit reached"); };
+    auto const response = client.submit_orders(basket, options);
+
+    EXPECT_EQ(http->requests(), 1);
+    EXPECT_EQ(response.succeeded, 1U);
+    EXPECT_EQ(response.not_sent, 4U);
+    ASSERT_TRUE(response.results[0].order.has_value());
+    EXPECT_FALSE(response.results[4].order.has_value());
+    EXPECT_EQ(response.results[4].index, 4U);
+    EXPECT_FALSE(response.results[4].error);
+    ASSERT_TRUE(response.callback_error);
+    EXPECT_THROW(std::rethrow_exception(response.callback_error), std::runtime_error);
+}
+
+TEST(SubmitOrdersTest, WaitsForTheRateLimitWindowToReset) {
+    auto http = std::make_shared<ConcurrentOrderHttpClient>();
+    auto const reset = std::chrono::duration_cast<std::chrono::seconds>(
+                           std::chrono::system_clock::now().time_since_epoch()) +
+                       std::chrono::seconds{1};
+    http->set_headers(alpaca::HttpHeaders{
+        {"x-ratelimit-limit",     "200"                          },
+        {"x-ratelimit-remaining", "0"                            },
+        {"x-ratelimit-reset",     std::to_string(reset.count())}
+    });
+    alpaca::TradingClient client(alpaca::Configuration::Paper("key", "secret"), http);
+    auto const basket = make_basket(2);
+
+    alpaca::SubmitOrdersOptions options;
+    options.max_in_flight = 1;
+    auto const response = client.submit_orders(basket, options);
+
+    EXPECT_EQ(response.succeeded, 2U);
+    EXPECT_GT(response.rate_limit_wait.count(), 0);
+    EXPECT_GE(response.elapsed, response.rate_limit_wait);
+}
+
+} // namespace
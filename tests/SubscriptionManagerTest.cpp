@@ -0,0 +1,81 @@
+#include "alpaca/SubscriptionManager.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace alpaca::streaming {
+namespace {
+
+MarketSubscription trades(std::vector<std::string> symbols) {
+    MarketSubscription subscription;
+    subscription.trades = std::move(symbols);
+    return subscription;
+}
+
+TEST(SubscriptionManagerTest, CancelsOpposingChangesWithinABatch) {
+    SubscriptionManager manager;
+    EXPECT_TRUE(manager.subscribe(trades({"AAPL", "MSFT"})));
+    auto const initial = manager.take_pending_frames(0);
+    ASSERT_EQ(initial.size(), 1U);
+    EXPECT_EQ(initial.front().at("action"), "subscribe");
+    EXPECT_EQ(initial.front().at("trades"), Json::array({"AAPL", "MSFT"}));
+
+    EXPECT_TRUE(manager.subscribe(trades({"TSLA"})));
+    EXPECT_TRUE(manager.unsubscribe(trades({"TSLA", "MSFT"})));
+    EXPECT_TRUE(manager.subscribe(trades({"MSFT"})));
+    EXPECT_FALSE(manager.subscribe(trades({"AAPL"})));
+    EXPECT_FALSE(manager.has_pending());
+    EXPECT_TRUE(manager.take_pending_frames(0).empty());
+
+    EXPECT_TRUE(manager.unsubscribe(trades({"AAPL"})));
+    MarketSubscription quotes;
+    quotes.quotes = {"NVDA"};
+    EXPECT_TRUE(manager.subscribe(quotes));
+    EXPECT_EQ(manager.pending_changes(), 2U);
+
+    auto const frames = manager.take_pending_frames(0);
+    ASSERT_EQ(frames.size(), 2U);
+    EXPECT_EQ(frames[0].at("action"), "unsubscribe");
+    EXPECT_EQ(frames[0].at("trades"), Json::array({"AAPL"}));
+    EXPECT_EQ(frames[1].at("action"), "subscribe");
+    EXPECT_EQ(frames[1].at("quotes"), Json::array({"NVDA"}));
+
+    auto const active = manager.active();
+    EXPECT_EQ(active.trades, std::vector<std::string>({"MSFT"}));
+    EXPECT_EQ(active.quotes, std::vector<std::string>({"NVDA"}));
+}
+
+TEST(SubscriptionManagerTest, SplitsFramesUnderTheByteLimit) {
+    SubscriptionManager manager;
+    MarketSubscription subscription;
+    for (int i = 0; i < 500; ++i) {
+        subscription.trades.push_back("SYM" + std::to_string(i));
+        subscription.quotes.push_back("SYM" + std::to_string(i));
+    }
+    manager.subscribe(subscription);
+    manager.take_pending_frames(0);
+
+    constexpr std::size_t kLimit = 512;
+    auto const frames = manager.take_replay_frames(kLimit);
+    ASSERT_GT(frames.size(), 1U);
+
+    std::size_t trade_count = 0;
+    std::size_t quote_count = 0;
+    for (auto const& frame : frames) {
+        EXPECT_LE(frame.dump().size(), kLimit);
+        EXPECT_EQ(frame.at("action"), "subscribe");
+        if (frame.contains("trades")) {
+            trade_count += frame.at("trades").size();
+        }
+        if (frame.contains("quotes")) {
+            quote_count += frame.at("quotes").size();
+        }
+    }
+    EXPECT_EQ(trade_count, 500U);
+    EXPECT_EQ(quote_count, 500U);
+}
+
+} // namespace
+} // namespace alpaca::streaming
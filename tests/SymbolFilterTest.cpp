@@ -0,0 +1,68 @@
+#include "alpaca/SymbolFilter.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace alpaca::streaming {
+namespace {
+
+TEST(SymbolFilterTest, TracksAllowedSymbolsAcrossUpdates) {
+    SymbolFilter filter;
+    EXPECT_FALSE(filter.allows("AAPL"));
+
+    filter.allow({"AAPL", "MSFT"});
+    EXPECT_TRUE(filter.allows("AAPL"));
+    EXPECT_TRUE(filter.allows("MSFT"));
+    EXPECT_FALSE(filter.allows("SPY"));
+
+    filter.block({"AAPL", "UNKNOWN"});
+    EXPECT_FALSE(filter.allows("AAPL"));
+    EXPECT_TRUE(filter.allows("MSFT"));
+
+    filter.assign({"SPY", "AAPL"});
+    EXPECT_EQ(filter.allowed(), (std::vector<std::string>{"AAPL", "SPY"}));
+    EXPECT_FALSE(filter.allows("MSFT"));
+}
+
+TEST(SymbolFilterTest, HandlesMoreSymbolsThanOneBitmapWord) {
+    SymbolFilter filter;
+    std::vector<std::string> symbols;
+    for (int i = 0; i < 200; ++i) {
+        symbols.push_back("SYM" + std::to_string(i));
+    }
+    filter.allow(symbols);
+    filter.block({"SYM64", "SYM199"});
+    EXPECT_TRUE(filter.allows("SYM0"));
+    EXPECT_TRUE(filter.allows("SYM63"));
+    EXPECT_FALSE(filter.allows("SYM64"));
+    EXPECT_TRUE(filter.allows("SYM65"));
+    EXPECT_FALSE(filter.allows("SYM199"));
+    EXPECT_EQ(filter.allowed().size(), 198U);
+}
+
+TEST(SymbolFilterTest, SplitsRawFramesAndLocatesTopLevelSymbols) {
+    auto const payloads = detail::split_raw_frame(
+    R"( [{"T":"b","S":"AAPL","o":1.5}, {"T":"s","x":{"S":"NESTED"},"S" : "MS\"FT"},{"T":"success","msg":"a,}b"}] )");
+    ASSERT_TRUE(payloads.has_value());
+    ASSERT_EQ(payloads->size(), 3U);
+    EXPECT_EQ((*payloads)[0].json, R"({"T":"b","S":"AAPL","o":1.5})");
+    EXPECT_EQ((*payloads)[0].symbol, "AAPL");
+    EXPECT_FALSE((*payloads)[1].symbol.has_value());
+    EXPECT_FALSE((*payloads)[2].symbol.has_value());
+    EXPECT_EQ((*payloads)[2].json, R"({"T":"success","msg":"a,}b"})");
+
+    auto const single = detail::split_raw_frame(R"({"T":"q","S":"SPY"})");
+    ASSERT_TRUE(single.has_value());
+    ASSERT_EQ(single->size(), 1U);
+    EXPECT_EQ(single->front().symbol, "SPY");
+
+    EXPECT_TRUE(detail::split_raw_frame("[]").has_value());
+    EXPECT_FALSE(detail::split_raw_frame(R"([{"S":"AAPL"})").has_value());
+    EXPECT_FALSE(detail::split_raw_frame(R"([1,2])").has_value());
+    EXPECT_FALSE(detail::split_raw_frame(R"({"S":"AAPL"} trailing)").has_value());
+}
+
+} // namespace
+} // namespace alpaca::streaming
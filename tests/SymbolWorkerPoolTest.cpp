@@ -0,0 +1,137 @@
+#include "alpaca/SymbolWorkerPool.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace alpaca::streaming {
+namespace {
+
+TEST(SymbolWorkerPoolTest, KeepsEachKeyInOrderAndNeverConcurrent) {
+    constexpr int kKeys = 16;
+    constexpr int kTasksPerKey = 500;
+    std::mutex mutex;
+    std::map<std::string, std::vector<int>> seen;
+    std::vector<std::atomic<int>> active(kKeys);
+    std::atomic<bool> overlapped{false};
+    {
+        SymbolWorkerPool pool(4);
+        for (int i = 0; i < kTasksPerKey; ++i) {
+            for (int key = 0; key < kKeys; ++key) {
+                auto const name = "SYM" + std::to_string(key);
+                pool.post(name, [&, name, key, i]() {
+                    if (active[static_cast<std::size_t>(key)].fetch_add(1) != 0) {
+                        overlapped = true;
+                    }
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        seen[name].push_back(i);
+                    }
+                    active[static_cast<std::size_t>(key)].fetch_sub(1);
+                });
+            }
+        }
+    }
+
+    EXPECT_FALSE(overlapped.load());
+    ASSERT_EQ(seen.size(), static_cast<std::size_t>(kKeys));
+    for (auto const& [name, order] : seen) {
+        ASSERT_EQ(order.size(), static_cast<std::size_t>(kTasksPerKey)) << name;
+        for (int i = 0; i < kTasksPerKey; ++i) {
+            EXPECT_EQ(order[static_cast<std::size_t>(i)], i) << name;
+        }
+    }
+}
+
+TEST(SymbolWorkerPoolTest, RunsDifferentKeysInParallel) {
+    // Every key's task waits until two tasks are running at once, which only happens if the lanes are spread over both
+    // workers (by hashing or by stealing) rather than queued behind each other.
+    SymbolWorkerPool pool(2);
+    std::atomic<int> running{0};
+    std::atomic<int> peak{0};
+    std::atomic<int> finished{0};
+    for (int key = 0; key < 8; ++key) {
+        pool.post("KEY" + std::to_string(key), [&]() {
+            int const now = running.fetch_add(1) + 1;
+            int previous = peak.load();
+            while (now > previous && !peak.compare_exchange_weak(previous, now)) {
+            }
+            auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+            while (peak.load() < 2 && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::yield();
+            }
+            running.fetch_sub(1);
+            finished.fetch_add(1);
+        });
+    }
+    auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+    while (finished.load() < 8 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    EXPECT_EQ(finished.load(), 8);
+    EXPECT_EQ(peak.load(), 2);
+}
+
+TEST(SymbolWorkerPoolTest, ReportsTaskExceptionsAndKeepsTheLaneRunning) {
+    std::vector<std::string> errors;
+    std::atomic<int> ran{0};
+    {
+        SymbolWorkerPool pool(1, [&errors](std::string const& message) {
+            errors.push_back(message);
+        });
+        pool.post("AAPL", []() {
+            throw std::runtime_error("handler failed");
+        });
+        pool.post("AAPL", [&ran]() {
+            ran.fetch_add(1);
+        });
+        pool.post("AAPL", []() {
+            throw 42;
+        });
+        pool.post("AAPL", [&ran]() {
+            ran.fetch_add(1);
+        });
+    }
+    EXPECT_EQ(errors, (std::vector<std::string>{"handler failed", "unknown error"}));
+    EXPECT_EQ(ran.load(), 2);
+}
+
+TEST(SymbolWorkerPoolTest, AcceptsPostsFromSeveralThreadsAndDropsIdleLanes) {
+    SymbolWorkerPool pool(2);
+    std::atomic<int> ran{0};
+    auto post_keys = [&](std::string const& prefix) {
+        for (int key = 0; key < 1000; ++key) {
+            pool.post(prefix + std::to_string(key), [&ran]() {
+                ran.fetch_add(1);
+            });
+        }
+    };
+    std::thread first(post_keys, "A");
+    std::thread second(post_keys, "B");
+    first.join();
+    second.join();
+    auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+    while (ran.load() < 2000 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    ASSERT_EQ(ran.load(), 2000);
+
+    // Every lane is idle now; new keys grow the map until the next sweep drops them.
+    auto const before = pool.lane_count();
+    bool shrank = false;
+    for (int key = 0; key < 4096 && !shrank; ++key) {
+        pool.post("C" + std::to_string(key), []() {});
+        shrank = pool.lane_count() < before;
+    }
+    EXPECT_TRUE(shrank);
+}
+
+} // namespace
+} // namespace alpaca::streaming
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "alpaca/TradeStreamMerger.hpp"
+
+namespace {
+
+using alpaca::streaming::TradeMessage;
+using alpaca::streaming::TradeStreamMerger;
+
+TradeMessage MakeTrade(std::string const& id, int second) {
+    TradeMessage trade;
+    trade.symbol = "AAPL";
+    trade.id = id;
+    trade.timestamp = alpaca::Timestamp{std::chrono::seconds{second}};
+    return trade;
+}
+
+std::vector<std::string> Ids(std::vector<TradeMessage> const& trades) {
+    std::vector<std::string> ids;
+    for (auto const& trade : trades) {
+        ids.push_back(trade.id);
+    }
+    return ids;
+}
+
+} // namespace
+
+TEST(TradeStreamMergerTest, PassesLiveTradesThroughWhileNoBackfillIsInFlight) {
+    TradeStreamMerger merger;
+    std::vector<TradeMessage> emitted;
+    auto emit = [&emitted](TradeMessage const& trade) {
+        emitted.push_back(trade);
+    };
+
+    merger.on_live(MakeTrade("1", 1), emit);
+    merger.on_live(MakeTrade("2", 2), emit);
+    merger.on_live(MakeTrade("2", 2), emit);
+
+    EXPECT_EQ(Ids(emitted), (std::vector<std::string>{"1", "2", "2"}));
+    EXPECT_EQ(merger.active(), 0U);
+    EXPECT_EQ(merger.stats().duplicates_dropped, 0U);
+}
+
+TEST(TradeStreamMergerTest, BuffersLiveTradesUntilReplayThenInterleavesInOrder) {
+    TradeStreamMerger merger;
+    std::vector<TradeMessage> emitted;
+    auto emit = [&emitted](TradeMessage const& trade) {
+        emitted.push_back(trade);
+    };
+
+    merger.on_live(MakeTrade("10", 1), emit);
+    merger.begin_backfill("AAPL", "10");
+    EXPECT_TRUE(merger.backfill_in_flight("AAPL"));
+    EXPECT_EQ(merger.active(), 1U);
+    merger.on_live(MakeTrade("14", 5), emit);
+    merger.on_live(MakeTrade("15", 5), emit);
+    EXPECT_EQ(Ids(emitted), (std::vector<std::string>{"10"}));
+
+    // The replay window overlaps both the trade delivered before the gap and the buffered live trades.
+    merger.complete_backfill("AAPL", {MakeTrade("10", 1), MakeTrade("12", 3), MakeTrade("11", 3), MakeTrade("14", 5)},
+                             emit);
+
+    EXPECT_FALSE(merger.backfill_in_flight("AAPL"));
+    EXPECT_EQ(merger.active(), 0U);
+    EXPECT_EQ(Ids(emitted), (std::vector<std::string>{"10", "11", "12", "14", "15"}));
+    EXPECT_EQ(merger.stats().duplicates_dropped, 2U);
+    EXPECT_EQ(merger.stats().live_buffered, 2U);
+    EXPECT_EQ(merger.stats().merges_completed, 1U);
+}
+
+TEST(TradeStreamMergerTest, ReleasesBufferWhenLimitReachedOrBackfillAbandoned) {
+    TradeStreamMerger::Options options;
+    options.max_buffered_messages = 2;
+    TradeStreamMerger merger(options);
+    std::vector<TradeMessage> emitted;
+    auto emit = [&emitted](TradeMessage const& trade) {
+        emitted.push_back(trade);
+    };
+
+    merger.begin_backfill("AAPL", "7");
+    merger.on_live(MakeTrade("9", 2), emit);
+    EXPECT_TRUE(emitted.empty());
+    merger.on_live(MakeTrade("8", 1), emit);
+    EXPECT_EQ(Ids(emitted), (std::vector<std::string>{"8", "9"}));
+    EXPECT_EQ(merger.stats().merges_abandoned, 1U);
+
+    // Live trades flow until the slow replay lands; it only adds what was not delivered yet.
+    merger.on_live(MakeTrade("11", 4), emit);
+    EXPECT_TRUE(merger.backfill_in_flight("AAPL"));
+    merger.complete_backfill("AAPL", {MakeTrade("7", 1), MakeTrade("8", 1), MakeTrade("10", 3)}, emit);
+    EXPECT_EQ(Ids(emitted), (std::vector<std::string>{"8", "9", "11", "10"}));
+    EXPECT_EQ(merger.stats().duplicates_dropped, 2U);
+    EXPECT_EQ(merger.active(), 0U);
+    // The overflowed merge counts as abandoned only.
+    EXPECT_EQ(merger.stats().merges_abandoned, 1U);
+    EXPECT_EQ(merger.stats().merges_completed, 0U);
+
+    merger.begin_backfill("AAPL");
+    merger.on_live(MakeTrade("20", 3), emit);
+    merger.abandon_backfill("AAPL", emit);
+    EXPECT_EQ(Ids(emitted), (std::vector<std::string>{"8", "9", "11", "10", "20"}));
+    EXPECT_EQ(merger.active(), 0U);
+}
+
+TEST(TradeStreamMergerTest, DropsLateRepeatsThenFreesTheSymbolOnceItsWindowPasses) {
+    TradeStreamMerger::Options options;
+    options.dedupe_window = 3;
+    TradeStreamMerger merger(options);
+    std::vector<TradeMessage> emitted;
+    auto emit = [&emitted](TradeMessage const& trade) {
+        emitted.push_back(trade);
+    };
+
+    merger.begin_backfill("AAPL", "10");
+    merger.complete_backfill("AAPL", {MakeTrade("11", 1), MakeTrade("12", 2)}, emit);
+    EXPECT_EQ(merger.tracked(), 1U);
+
+    // A live copy of a merged trade arriving late is still dropped inside the window.
+    merger.on_live(MakeTrade("12", 2), emit);
+    merger.on_live(MakeTrade("13", 3), emit);
+    EXPECT_EQ(Ids(emitted), (std::vector<std::string>{"11", "12", "13"}));
+    EXPECT_EQ(merger.stats().duplicates_dropped, 1U);
+    EXPECT_EQ(merger.tracked(), 1U);
+
+    merger.on_live(MakeTrade("14", 4), emit);
+    EXPECT_EQ(merger.tracked(), 0U);
+    merger.on_live(MakeTrade("12", 2), emit);
+    EXPECT_EQ(Ids(emitted), (std::vector<std::string>{"11", "12", "13", "14", "12"}));
+}